@@ -23,7 +23,6 @@
 #include "yb/common/row_operations.h"
 #include "yb/common/transaction.h"
 
-#include "yb/util/cast.h"
 #include "yb/util/debug-util.h"
 #include "yb/util/logging.h"
 
@@ -378,11 +377,8 @@ void WriteRpc::ProcessResponseFromTserver(Status status) {
         ql_op->mutable_response()->Swap(resp_.mutable_ql_response_batch(ql_idx));
         const auto& ql_response = ql_op->response();
         if (ql_response.has_rows_data_sidecar()) {
-          Slice rows_data;
-          CHECK_OK(retrier().controller().GetSidecar(
-              ql_response.rows_data_sidecar(), &rows_data));
-          down_cast<YBqlWriteOp*>(yb_op)->mutable_rows_data()->assign(
-              util::to_char_ptr(rows_data.data()), rows_data.size());
+          CHECK_OK(retrier().controller().GetSidecarBuffer(
+              ql_response.rows_data_sidecar(), ql_op->mutable_rows_data()));
         }
         ql_idx++;
         break;
@@ -536,11 +532,8 @@ void ReadRpc::ProcessResponseFromTserver(Status status) {
         ql_op->mutable_response()->Swap(resp_.mutable_ql_batch(ql_idx));
         const auto& ql_response = ql_op->response();
         if (ql_response.has_rows_data_sidecar()) {
-          Slice rows_data;
-          CHECK_OK(retrier().controller().GetSidecar(
-              ql_response.rows_data_sidecar(), &rows_data));
-          down_cast<YBqlReadOp*>(yb_op)->mutable_rows_data()->assign(
-              util::to_char_ptr(rows_data.data()), rows_data.size());
+          CHECK_OK(retrier().controller().GetSidecarBuffer(
+              ql_response.rows_data_sidecar(), ql_op->mutable_rows_data()));
         }
         ql_idx++;
         break;
@@ -206,12 +206,13 @@ MonoTime Batcher::ComputeDeadlineUnlocked() const {
   return ret;
 }
 
-void Batcher::FlushAsync(YBStatusCallback* cb) {
+void Batcher::FlushAsync(YBStatusCallback* cb, bool commit_transaction) {
   {
     std::lock_guard<simple_spinlock> l(lock_);
     CHECK_EQ(state_, kGatheringOps);
     state_ = kFlushing;
     flush_callback_ = cb;
+    commit_transaction_ = commit_transaction && !read_only_;
     deadline_ = ComputeDeadlineUnlocked();
   }
 
@@ -276,6 +277,16 @@ Status Batcher::Add(shared_ptr<YBOperation> yb_op) {
   if (yb_op->tablet()) {
     in_flight_op->tablet = yb_op->tablet();
     TabletLookupFinished(std::move(in_flight_op), Status::OK());
+    return Status::OK();
+  }
+
+  // Most ops of a batch go to tablets already in the meta cache. Resolve them in place instead of
+  // starting a lookup RPC per op, so that a large batch is grouped per tablet without the
+  // allocations and callbacks of the lookups.
+  in_flight_op->tablet = client_->data_->meta_cache_->LookupTabletByKeyFastPath(
+      yb_op->table(), in_flight_op->partition_key);
+  if (in_flight_op->tablet) {
+    TabletLookupFinished(std::move(in_flight_op), Status::OK());
   } else {
     // deadline_ is set in FlushAsync(), after all Add() calls are done, so
     // here we're forced to create a new deadline.
@@ -401,6 +412,7 @@ void Batcher::FlushBuffersIfReady() {
       // If transaction is not yet ready to do it, then it will notify as via provided when
       // it could be done.
       if (!transaction->Prepare(ops_,
+                                commit_transaction_,
                                 std::bind(&Batcher::TransactionReady,
                                           this,
                                           _1,
@@ -125,7 +125,11 @@ class Batcher : public RefCountedThreadSafe<Batcher> {
   // then the callback will receive Status::OK. Otherwise, it will receive IOError,
   // and the caller must inspect the ErrorCollector to retrieve more detailed
   // information on which operations failed.
-  void FlushAsync(YBStatusCallback* cb);
+  //
+  // commit_transaction means that the transaction of the session will be committed right after
+  // this flush, so the transaction could take single shard fast path, see
+  // YBTransaction::Prepare.
+  void FlushAsync(YBStatusCallback* cb, bool commit_transaction = false);
 
   // Returns the consistency mode set on the batcher by the session when it was initially
   // created.
@@ -274,6 +278,9 @@ class Batcher : public RefCountedThreadSafe<Batcher> {
   TransactionMetadata transaction_metadata_;
   HybridTime propagated_hybrid_time_;
 
+  // Set by FlushAsync, see its description.
+  bool commit_transaction_ = false;
+
   DISALLOW_COPY_AND_ASSIGN(Batcher);
 };
 
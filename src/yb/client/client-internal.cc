@@ -771,10 +771,14 @@ class GetTableSchemaRpc : public Rpc {
  public:
   GetTableSchemaRpc(YBClient* client,
                     StatusCallback user_cb,
-                    YBTableName table_name,
-                    YBSchema* out_schema,
-                    PartitionSchema* out_partition_schema,
-                    string* out_id,
+                    const YBTableName& table_name,
+                    YBTableInfo* info,
+                    const MonoTime& deadline,
+                    const shared_ptr<rpc::Messenger>& messenger);
+  GetTableSchemaRpc(YBClient* client,
+                    StatusCallback user_cb,
+                    const TableId& table_id,
+                    YBTableInfo* info,
                     const MonoTime& deadline,
                     const shared_ptr<rpc::Messenger>& messenger);
 
@@ -793,28 +797,37 @@ class GetTableSchemaRpc : public Rpc {
 
   YBClient* client_;
   StatusCallback user_cb_;
-  const YBTableName table_name_;
-  YBSchema* out_schema_;
-  PartitionSchema* out_partition_schema_;
-  string* out_id_;
+  master::TableIdentifierPB table_identifier_;
+  YBTableInfo* info_;
   GetTableSchemaResponsePB resp_;
 };
 
 GetTableSchemaRpc::GetTableSchemaRpc(YBClient* client,
                                      StatusCallback user_cb,
-                                     YBTableName table_name,
-                                     YBSchema* out_schema,
-                                     PartitionSchema* out_partition_schema,
-                                     string* out_id,
+                                     const YBTableName& table_name,
+                                     YBTableInfo* info,
+                                     const MonoTime& deadline,
+                                     const shared_ptr<rpc::Messenger>& messenger)
+    : Rpc(deadline, messenger),
+      client_(DCHECK_NOTNULL(client)),
+      user_cb_(std::move(user_cb)),
+      info_(DCHECK_NOTNULL(info)) {
+  table_name.SetIntoTableIdentifierPB(&table_identifier_);
+  // Keep the name the table was requested with, so tables opened by name are found by it.
+  info_->table_name = table_name;
+}
+
+GetTableSchemaRpc::GetTableSchemaRpc(YBClient* client,
+                                     StatusCallback user_cb,
+                                     const TableId& table_id,
+                                     YBTableInfo* info,
                                      const MonoTime& deadline,
                                      const shared_ptr<rpc::Messenger>& messenger)
     : Rpc(deadline, messenger),
       client_(DCHECK_NOTNULL(client)),
       user_cb_(std::move(user_cb)),
-      table_name_(std::move(table_name)),
-      out_schema_(DCHECK_NOTNULL(out_schema)),
-      out_partition_schema_(DCHECK_NOTNULL(out_partition_schema)),
-      out_id_(DCHECK_NOTNULL(out_id)) {
+      info_(DCHECK_NOTNULL(info)) {
+  table_identifier_.set_table_id(table_id);
 }
 
 GetTableSchemaRpc::~GetTableSchemaRpc() {
@@ -834,15 +847,15 @@ void GetTableSchemaRpc::SendRpc() {
       MonoTime::Earliest(rpc_deadline, retrier().deadline()));
 
   GetTableSchemaRequestPB req;
-  table_name_.SetIntoTableIdentifierPB(req.mutable_table());
+  req.mutable_table()->CopyFrom(table_identifier_);
   client_->data_->master_proxy()->GetTableSchemaAsync(
       req, &resp_, mutable_retrier()->mutable_controller(),
       std::bind(&GetTableSchemaRpc::SendRpcCb, this, Status::OK()));
 }
 
 string GetTableSchemaRpc::ToString() const {
-  return Substitute("GetTableSchemaRpc(table_name: $0, num_attempts: $1)",
-                    table_name_.ToString(), num_attempts());
+  return Substitute("GetTableSchemaRpc(table_identifier: $0, num_attempts: $1)",
+                    table_identifier_.ShortDebugString(), num_attempts());
 }
 
 void GetTableSchemaRpc::ResetLeaderMasterAndRetry() {
@@ -923,14 +936,20 @@ void GetTableSchemaRpc::SendRpcCb(const Status& status) {
     std::unique_ptr<Schema> schema(new Schema());
     new_status = SchemaFromPB(resp_.schema(), schema.get());
     if (new_status.ok()) {
-      out_schema_->Reset(std::move(schema));
-      out_schema_->set_version(resp_.version());
+      info_->schema.Reset(std::move(schema));
+      info_->schema.set_version(resp_.version());
       new_status = PartitionSchema::FromPB(resp_.partition_schema(),
-                                           GetSchema(out_schema_),
-                                           out_partition_schema_);
+                                           GetSchema(&info_->schema),
+                                           &info_->partition_schema);
 
-      *out_id_ = resp_.identifier().table_id();
-      CHECK_GT(out_id_->size(), 0) << "Running against a too-old master";
+      if (!table_identifier_.has_table_name()) {
+        info_->table_name = YBTableName(resp_.identifier().namespace_().name(),
+                                        resp_.identifier().table_name());
+      }
+      info_->table_id = resp_.identifier().table_id();
+      CHECK_GT(info_->table_id.size(), 0) << "Running against a too-old master";
+      info_->index_map.FromPB(resp_.indexes());
+      info_->indexed_table_id = resp_.indexed_table_id();
     }
   }
   if (!new_status.ok()) {
@@ -947,14 +966,39 @@ Status YBClient::Data::GetTableSchema(YBClient* client,
                                       YBSchema* schema,
                                       PartitionSchema* partition_schema,
                                       string* table_id) {
+  YBTableInfo info;
+  RETURN_NOT_OK(GetTableSchema(client, table_name, deadline, &info));
+  *schema = std::move(info.schema);
+  *partition_schema = std::move(info.partition_schema);
+  *table_id = std::move(info.table_id);
+  return Status::OK();
+}
+
+Status YBClient::Data::GetTableSchema(YBClient* client,
+                                      const YBTableName& table_name,
+                                      const MonoTime& deadline,
+                                      YBTableInfo* info) {
   Synchronizer sync;
   auto rpc = rpc::StartRpc<GetTableSchemaRpc>(
       client,
       sync.AsStatusCallback(),
       table_name,
-      schema,
-      partition_schema,
+      info,
+      deadline,
+      messenger_);
+  return sync.Wait();
+}
+
+Status YBClient::Data::GetTableSchema(YBClient* client,
+                                      const TableId& table_id,
+                                      const MonoTime& deadline,
+                                      YBTableInfo* info) {
+  Synchronizer sync;
+  auto rpc = rpc::StartRpc<GetTableSchemaRpc>(
+      client,
+      sync.AsStatusCallback(),
       table_id,
+      info,
       deadline,
       messenger_);
   return sync.Wait();
@@ -127,6 +127,14 @@ class YBClient::Data {
                                 YBSchema* schema,
                                 PartitionSchema* partition_schema,
                                 std::string* table_id);
+  CHECKED_STATUS GetTableSchema(YBClient* client,
+                                const YBTableName& table_name,
+                                const MonoTime& deadline,
+                                YBTableInfo* info);
+  CHECKED_STATUS GetTableSchema(YBClient* client,
+                                const TableId& table_id,
+                                const MonoTime& deadline,
+                                YBTableInfo* info);
 
   CHECKED_STATUS InitLocalHostNames();
 
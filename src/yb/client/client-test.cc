@@ -2799,10 +2799,10 @@ TEST_F(ClientTest, TestReadFromFollower) {
       EXPECT_EQ(QLResponsePB_QLStatus_YQL_STATUS_OK, ql_resp.status());
       EXPECT_TRUE(ql_resp.has_rows_data_sidecar());
 
-      Slice rows_data;
+      RefCntBuffer rows_data;
       EXPECT_TRUE(controller.finished());
-      EXPECT_OK(controller.GetSidecar(ql_resp.rows_data_sidecar(), &rows_data));
-      yb::ql::RowsResult rowsResult(kReadFromFollowerTable, selected_cols, rows_data.ToBuffer());
+      EXPECT_OK(controller.GetSidecarBuffer(ql_resp.rows_data_sidecar(), &rows_data));
+      yb::ql::RowsResult rowsResult(kReadFromFollowerTable, selected_cols, rows_data);
       rowBlock = rowsResult.GetRowBlock();
       return FLAGS_test_scan_num_rows == rowBlock->row_count();
     }, MonoDelta::FromSeconds(30), "Waiting for replication to followers"));
@@ -857,6 +857,29 @@ Status YBMetaDataCache::GetTable(
   {
     std::lock_guard<std::mutex> lock(cached_tables_mutex_);
     cached_tables_[table_name] = *table;
+    cached_tables_by_id_[(*table)->id()] = *table;
+  }
+  *cache_used = false;
+  return Status::OK();
+}
+
+Status YBMetaDataCache::GetTable(
+    const TableId& table_id, shared_ptr<YBTable>* table, bool* cache_used) {
+  {
+    std::lock_guard<std::mutex> lock(cached_tables_mutex_);
+    auto itr = cached_tables_by_id_.find(table_id);
+    if (itr != cached_tables_by_id_.end()) {
+      *table = itr->second;
+      *cache_used = true;
+      return Status::OK();
+    }
+  }
+
+  RETURN_NOT_OK(client_->OpenTable(table_id, table));
+  {
+    std::lock_guard<std::mutex> lock(cached_tables_mutex_);
+    cached_tables_[(*table)->name()] = *table;
+    cached_tables_by_id_[table_id] = *table;
   }
   *cache_used = false;
   return Status::OK();
@@ -865,6 +888,13 @@ Status YBMetaDataCache::GetTable(
 void YBMetaDataCache::RemoveCachedTable(const YBTableName& table_name) {
   std::lock_guard<std::mutex> lock(cached_tables_mutex_);
   cached_tables_.erase(table_name);
+  for (auto itr = cached_tables_by_id_.begin(); itr != cached_tables_by_id_.end();) {
+    if (itr->second->name() == table_name) {
+      itr = cached_tables_by_id_.erase(itr);
+    } else {
+      ++itr;
+    }
+  }
 }
 
 Status YBMetaDataCache::GetUDType(const string &keyspace_name,
@@ -898,25 +928,26 @@ void YBMetaDataCache::RemoveCachedUDType(const string& keyspace_name,
 }
 
 Status YBClient::OpenTable(const YBTableName& table_name, shared_ptr<YBTable>* table) {
-  YBSchema schema;
-  string table_id;
-  PartitionSchema partition_schema;
+  YBTableInfo info;
   MonoTime deadline = MonoTime::Now(MonoTime::FINE);
   deadline.AddDelta(default_admin_operation_timeout());
-  RETURN_NOT_OK(data_->GetTableSchema(this,
-                                      table_name,
-                                      deadline,
-                                      &schema,
-                                      &partition_schema,
-                                      &table_id));
+  RETURN_NOT_OK(data_->GetTableSchema(this, table_name, deadline, &info));
 
   // In the future, probably will look up the table in some map to reuse YBTable
   // instances.
-  std::shared_ptr<YBTable> ret(new YBTable(shared_from_this(),
-                                           table_name,
-                                           table_id,
-                                           schema,
-                                           partition_schema));
+  std::shared_ptr<YBTable> ret(new YBTable(shared_from_this(), info));
+  RETURN_NOT_OK(ret->data_->Open());
+  table->swap(ret);
+  return Status::OK();
+}
+
+Status YBClient::OpenTable(const TableId& table_id, shared_ptr<YBTable>* table) {
+  YBTableInfo info;
+  MonoTime deadline = MonoTime::Now(MonoTime::FINE);
+  deadline.AddDelta(default_admin_operation_timeout());
+  RETURN_NOT_OK(data_->GetTableSchema(this, table_id, deadline, &info));
+
+  std::shared_ptr<YBTable> ret(new YBTable(shared_from_this(), info));
   RETURN_NOT_OK(ret->data_->Open());
   table->swap(ret);
   return Status::OK();
@@ -1052,6 +1083,11 @@ YBTableCreator& YBTableCreator::replication_info(const ReplicationInfoPB& ri) {
   return *this;
 }
 
+YBTableCreator& YBTableCreator::indexed_table_id(const string& id) {
+  data_->indexed_table_id_ = id;
+  return *this;
+}
+
 YBTableCreator& YBTableCreator::timeout(const MonoDelta& timeout) {
   data_->timeout_ = timeout;
   return *this;
@@ -1086,6 +1122,9 @@ Status YBTableCreator::Create() {
   req.set_name(data_->table_name_.table_name());
   req.mutable_namespace_()->set_name(data_->table_name_.resolved_namespace_name());
   req.set_table_type(data_->table_type_);
+  if (!data_->indexed_table_id_.empty()) {
+    req.set_indexed_table_id(data_->indexed_table_id_);
+  }
 
   // Note that the check that the sum of min_num_replicas for each placement block being less or
   // equal than the overall placement info num_replicas is done on the master side and an error is
@@ -1192,13 +1231,8 @@ Status YBTableCreator::Create() {
 // YBTable
 ////////////////////////////////////////////////////////////
 
-YBTable::YBTable(
-    const shared_ptr<YBClient>& client,
-    const YBTableName& name,
-    const string& table_id,
-    const YBSchema& schema,
-    const PartitionSchema& partition_schema)
-  : data_(new YBTable::Data(client, name, table_id, schema, partition_schema)) {
+YBTable::YBTable(const shared_ptr<YBClient>& client, const YBTableInfo& info)
+  : data_(new YBTable::Data(client, info)) {
 }
 
 YBTable::~YBTable() {
@@ -1269,6 +1303,47 @@ const PartitionSchema& YBTable::partition_schema() const {
   return data_->partition_schema_;
 }
 
+Status YBTable::GetSplits(std::vector<YBTableSplit>* splits) const {
+  RepeatedPtrField<TabletLocationsPB> tablets;
+  RETURN_NOT_OK(client()->GetTablets(name(), 0 /* max_tablets */, &tablets));
+  const bool hash_partitioned =
+      partition_schema().hash_schema() == YBHashSchema::kMultiColumnHash;
+  splits->clear();
+  splits->reserve(tablets.size());
+  for (const TabletLocationsPB& tablet : tablets) {
+    splits->emplace_back();
+    YBTableSplit& split = splits->back();
+    split.tablet_id = tablet.tablet_id();
+    split.partition_key_start = tablet.partition().partition_key_start();
+    split.partition_key_end = tablet.partition().partition_key_end();
+    if (hash_partitioned) {
+      split.hash_code = split.partition_key_start.empty()
+          ? 0 : PartitionSchema::DecodeMultiColumnHashValue(split.partition_key_start);
+      split.max_hash_code = split.partition_key_end.empty()
+          ? std::numeric_limits<uint16_t>::max()
+          : PartitionSchema::DecodeMultiColumnHashValue(split.partition_key_end) - 1;
+    }
+    for (const master::TabletLocationsPB_ReplicaPB& replica : tablet.replicas()) {
+      if (replica.role() == consensus::RaftPeerPB::LEADER &&
+          replica.ts_info().rpc_addresses_size() > 0) {
+        split.leader_host = replica.ts_info().rpc_addresses(0).host();
+        split.leader_port = replica.ts_info().rpc_addresses(0).port();
+        break;
+      }
+    }
+    split.estimated_num_rows = tablet.estimated_num_rows();
+  }
+  return Status::OK();
+}
+
+const IndexMap& YBTable::index_map() const {
+  return data_->index_map_;
+}
+
+const string& YBTable::indexed_table_id() const {
+  return data_->indexed_table_id_;
+}
+
 YBPredicate* YBTable::NewComparisonPredicate(const Slice& col_name,
                                              YBPredicate::ComparisonOp op,
                                              YBValue* value) {
@@ -1380,6 +1455,14 @@ void YBSession::FlushAsync(YBStatusCallback* user_callback) {
   data_->FlushAsync(user_callback);
 }
 
+Status YBSession::FlushAndCommit() {
+  return data_->FlushAndCommit();
+}
+
+void YBSession::FlushAndCommitAsync(YBStatusCallback* user_callback) {
+  data_->FlushAndCommitAsync(user_callback);
+}
+
 bool YBSession::HasPendingOperations() const {
   std::lock_guard<simple_spinlock> l(data_->lock_);
   if (data_->batcher_->HasPendingOperations()) {
@@ -1476,6 +1559,11 @@ YBTableAlterer* YBTableAlterer::SetTableProperties(const TableProperties& table_
   return this;
 }
 
+YBTableAlterer* YBTableAlterer::MarkIndexBackfilled(const TableId& index_table_id) {
+  data_->backfilled_index_table_id_ = index_table_id;
+  return this;
+}
+
 YBTableAlterer* YBTableAlterer::timeout(const MonoDelta& timeout) {
   data_->timeout_ = timeout;
   return this;
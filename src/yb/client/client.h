@@ -50,6 +50,8 @@
 #ifdef YB_HEADERS_NO_STUBS
 #include <gtest/gtest_prod.h>
 #include "yb/common/entity_ids.h"
+#include "yb/common/index.h"
+#include "yb/common/partition.h"
 #include "yb/gutil/macros.h"
 #include "yb/gutil/port.h"
 #else
@@ -355,6 +357,10 @@ class YBClient : public std::enable_shared_from_this<YBClient> {
   CHECKED_STATUS OpenTable(const YBTableName& table_name,
                            std::shared_ptr<YBTable>* table);
 
+  // Open the table with the given id.
+  CHECKED_STATUS OpenTable(const TableId& table_id,
+                           std::shared_ptr<YBTable>* table);
+
   // Create a new session for interacting with the cluster.
   // User is responsible for destroying the session object.
   // This is a fully local operation (no RPCs or blocking).
@@ -478,6 +484,32 @@ class YBClient : public std::enable_shared_from_this<YBClient> {
   DISALLOW_COPY_AND_ASSIGN(YBClient);
 };
 
+// Table information returned by the master.
+struct YBTableInfo {
+  YBTableName table_name;
+  std::string table_id;
+  YBSchema schema;
+  PartitionSchema partition_schema;
+  IndexMap index_map;
+  std::string indexed_table_id;  // Set for an index table only.
+};
+
+// A tablet-aligned range of a table that can be scanned independently of the other ranges.
+struct YBTableSplit {
+  TabletId tablet_id;
+  std::string partition_key_start;
+  std::string partition_key_end;
+  // For a hash-partitioned table, the inclusive range of hash codes of the tablet, to be set as
+  // "hash_code" and "max_hash_code" in QLReadRequestPB.
+  uint16_t hash_code = 0;
+  uint16_t max_hash_code = 0;
+  // Address of the tablet leader, empty if it is not known.
+  std::string leader_host;
+  uint16_t leader_port = 0;
+  // Number of rows in the tablet as last estimated by its leader, 0 if not known.
+  uint64_t estimated_num_rows = 0;
+};
+
 class YBMetaDataCache {
  public:
   explicit YBMetaDataCache(std::shared_ptr<YBClient> client) : client_(client) {}
@@ -488,6 +520,10 @@ class YBMetaDataCache {
   CHECKED_STATUS GetTable(
       const YBTableName& table_name, std::shared_ptr<YBTable>* table, bool* cache_used);
 
+  // Same as above, but looks up the table by its id.
+  CHECKED_STATUS GetTable(
+      const TableId& table_id, std::shared_ptr<YBTable>* table, bool* cache_used);
+
   // Remove the table from cached_tables_ if it is in the cache.
   void RemoveCachedTable(const YBTableName& table_name);
 
@@ -510,6 +546,11 @@ class YBMetaDataCache {
                              std::shared_ptr<YBTable>,
                              boost::hash<YBTableName>> YBTableMap;
   YBTableMap cached_tables_;
+
+  // Map from table-id to YBTable instances.
+  typedef std::unordered_map<TableId, std::shared_ptr<YBTable>> YBTableByIdMap;
+  YBTableByIdMap cached_tables_by_id_;
+
   std::mutex cached_tables_mutex_;
 
   // Map from type-name to QLType instances.
@@ -600,6 +641,10 @@ class YBTableCreator {
 
   YBTableCreator& replication_info(const master::ReplicationInfoPB& ri);
 
+  // Makes the table an index of the table with the given id. The index columns must be named
+  // after the columns of the indexed table they are populated from.
+  YBTableCreator& indexed_table_id(const std::string& id);
+
   // Creates the table.
   //
   // The return value may indicate an error in the create table operation,
@@ -683,16 +728,24 @@ class YBTable : public std::enable_shared_from_this<YBTable> {
 
   const PartitionSchema& partition_schema() const;
 
+  // Secondary indexes of the table.
+  const IndexMap& index_map() const;
+
+  // For an index table: the id of the table it indexes, empty otherwise.
+  const std::string& indexed_table_id() const;
+
+  bool IsIndex() const { return !indexed_table_id().empty(); }
+
+  // Get the tablet-aligned ranges of the table with their leader locations and row estimates, in
+  // partition key order, so that a full table scan can be split into parallel scans.
+  CHECKED_STATUS GetSplits(std::vector<YBTableSplit>* splits) const;
+
  private:
   class Data;
 
   friend class YBClient;
 
-  YBTable(const std::shared_ptr<YBClient>& client,
-          const YBTableName& name,
-          const std::string& table_id,
-          const YBSchema& schema,
-          const PartitionSchema& partition_schema);
+  YBTable(const std::shared_ptr<YBClient>& client, const YBTableInfo& info);
 
   // Owned.
   Data* data_;
@@ -734,6 +787,9 @@ class YBTableAlterer {
   // Alter table properties
   YBTableAlterer* SetTableProperties(const TableProperties& table_properties);
 
+  // Marks the index of the given index table as backfilled, so that queries may read it.
+  YBTableAlterer* MarkIndexBackfilled(const TableId& index_table_id);
+
   // Set the timeout for the operation. This includes any waiting
   // after the alter has been submitted (i.e if the alter is slow
   // to be performed on a large table, it may time out and then
@@ -1021,6 +1077,19 @@ class YBSession : public std::enable_shared_from_this<YBSession> {
   CHECKED_STATUS Flush() WARN_UNUSED_RESULT;
   void FlushAsync(YBStatusCallback* cb);
 
+  // Flush any pending writes and commit the transaction of this session. The callback receives
+  // the status of the flush if it failed, otherwise the status of the commit.
+  //
+  // If nothing was flushed in context of the transaction before and all pending operations
+  // belong to the same tablet, then they are written as a single non transactional batch.
+  // I.e. the transaction is committed atomically by a single Raft write, without intents and
+  // without involving the status tablet.
+  //
+  // The session should be created with a transaction, and should not be in AUTO_FLUSH_BACKGROUND
+  // mode. Otherwise IllegalState or NotSupported is returned respectively.
+  CHECKED_STATUS FlushAndCommit() WARN_UNUSED_RESULT;
+  void FlushAndCommitAsync(YBStatusCallback* cb);
+
   // Abort the unflushed or in-flight operations in the session.
   void Abort();
 
@@ -1124,5 +1124,58 @@ TEST_F(QLDmlTest, TestError) {
   }
 }
 
+TEST_F(QLDmlTest, TestSplitScan) {
+  constexpr int kNumRows = 100;
+  {
+    const shared_ptr<YBSession> session(client_->NewSession(false /* read_only */));
+    CHECK_OK(session->SetFlushMode(YBSession::MANUAL_FLUSH));
+    for (int32_t i = 0; i < kNumRows; i++) {
+      InsertRow(session, i, "a", 2, "b", 3, "c");
+    }
+    ASSERT_OK(FlushSession(session.get()));
+  }
+
+  // The splits cover the whole hash range in order.
+  shared_ptr<YBTable> table;
+  ASSERT_OK(client_->OpenTable(kTableName, &table));
+  std::vector<YBTableSplit> splits;
+  ASSERT_OK(table->GetSplits(&splits));
+  ASSERT_FALSE(splits.empty());
+  EXPECT_EQ(splits.front().hash_code, 0);
+  EXPECT_EQ(splits.back().max_hash_code, std::numeric_limits<uint16_t>::max());
+  for (size_t i = 1; i < splits.size(); i++) {
+    EXPECT_EQ(splits[i].hash_code, splits[i - 1].max_hash_code + 1);
+  }
+
+  // Scan every split in pages bounded in bytes.
+  const shared_ptr<YBSession> session(client_->NewSession(true /* read_only */));
+  int num_rows = 0;
+  for (const YBTableSplit& split : splits) {
+    EXPECT_FALSE(split.leader_host.empty());
+    QLPagingStatePB paging_state;
+    do {
+      const shared_ptr<YBqlReadOp> op = table_.NewReadOp();
+      auto* const req = op->mutable_request();
+      req->set_hash_code(split.hash_code);
+      req->set_max_hash_code(split.max_hash_code);
+      req->set_limit(kNumRows);
+      req->set_limit_bytes(1);
+      req->set_return_paging_state(true);
+      if (paging_state.has_next_row_key()) {
+        *req->mutable_paging_state() = paging_state;
+      }
+      AddAllColumns(req);
+      ASSERT_OK(session->Apply(op));
+      ASSERT_EQ(op->response().status(), QLResponsePB::YQL_STATUS_OK);
+      unique_ptr<QLRowBlock> rowblock(RowsResult(op.get()).GetRowBlock());
+      // A page of 1 byte holds a single row.
+      ASSERT_LE(rowblock->row_count(), 1);
+      num_rows += rowblock->row_count();
+      paging_state = op->response().paging_state();
+    } while (paging_state.has_next_row_key());
+  }
+  EXPECT_EQ(num_rows, kNumRows);
+}
+
 }  // namespace client
 }  // namespace yb
@@ -29,6 +29,8 @@
 #include "yb/tserver/ts_tablet_manager.h"
 #include "yb/tserver/tablet_server.h"
 
+#include "yb/util/metrics.h"
+
 using namespace std::literals; // NOLINT
 
 DECLARE_uint64(transaction_timeout_usec);
@@ -39,6 +41,12 @@ DECLARE_int32(log_min_seconds_to_retain);
 DECLARE_bool(transaction_disable_heartbeat_in_tests);
 DECLARE_double(transaction_ignore_applying_probability_in_tests);
 DECLARE_uint64(transaction_check_interval_usec);
+DECLARE_bool(transaction_single_shard_fast_path);
+
+METRIC_DECLARE_counter(transaction_status_cache_hits);
+METRIC_DECLARE_counter(transaction_status_cache_misses);
+METRIC_DECLARE_counter(transaction_status_rpcs);
+METRIC_DECLARE_counter(transactions_with_intents);
 
 namespace yb {
 namespace client {
@@ -157,6 +165,24 @@ class QLTransactionTest : public QLDmlTestBase {
     return WriteRow(session, key, value, WriteOpType::UPDATE);
   }
 
+  // Buffers insert of the row into the session, that should be in MANUAL_FLUSH mode.
+  void BufferInsert(const YBSessionPtr& session, int32_t key, int32_t value) {
+    const auto op = table_.NewWriteOp(QLWriteRequestPB::QL_STMT_INSERT);
+    auto* const req = op->mutable_request();
+    table_.SetInt32Expression(req->add_hashed_column_values(), key);
+    table_.SetInt32ColumnValue(req->add_column_values(), "v", value);
+    ASSERT_OK(session->Apply(op));
+  }
+
+  // Writes the row by a separate transaction, that is committed together with the flush.
+  void WriteRowAndCommit(int32_t key, int32_t value) {
+    auto txn = std::make_shared<YBTransaction>(transaction_manager_.get_ptr(), SNAPSHOT_ISOLATION);
+    auto session = CreateSession(false /* read_only */, txn);
+    ASSERT_OK(session->SetFlushMode(YBSession::MANUAL_FLUSH));
+    BufferInsert(session, key, value);
+    ASSERT_OK(session->FlushAndCommit());
+  }
+
   void WriteRows(
       const YBSessionPtr& session, size_t transaction = 0,
       const WriteOpType op_type = WriteOpType::INSERT) {
@@ -236,6 +262,23 @@ class QLTransactionTest : public QLDmlTestBase {
     return result;
   }
 
+  // Number of transactions that wrote intents, summed over all tablet peers.
+  int64_t CountTransactionsWithIntents() {
+    int64_t result = 0;
+    for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      auto* tablet_manager = cluster_->mini_tablet_server(i)->server()->tablet_manager();
+      std::vector<tablet::TabletPeerPtr> peers;
+      tablet_manager->GetTabletPeers(&peers);
+      for (const auto& peer : peers) {
+        const auto& entity = peer->tablet()->GetMetricEntity();
+        if (entity) {
+          result += METRIC_transactions_with_intents.Instantiate(entity)->value();
+        }
+      }
+    }
+    return result;
+  }
+
   TableHandle table_;
   boost::optional<TransactionManager> transaction_manager_;
 };
@@ -347,6 +390,144 @@ TEST_F(QLTransactionTest, ResendApplying) {
   CHECK_OK(cluster_->RestartSync());
 }
 
+// Reads intents of committed, but not yet applied transactions. Statuses of those transactions
+// should be requested only once per tablet and then resolved from the participant cache.
+TEST_F(QLTransactionTest, StatusCache) {
+  google::FlagSaver flag_saver;
+  DisableApplyingIntents();
+
+  constexpr size_t kTransactions = 10;
+  for (size_t i = 0; i != kTransactions; ++i) {
+    auto txn = std::make_shared<YBTransaction>(transaction_manager_.get_ptr(), SNAPSHOT_ISOLATION);
+    auto session = CreateSession(false /* read_only */, txn);
+    WriteRows(session, i);
+    CommitAndResetSync(&txn);
+  }
+
+  VerifyData(kTransactions);
+  VerifyData(kTransactions);
+
+  int64_t hits = 0, misses = 0, rpcs = 0;
+  for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+    auto* tablet_manager = cluster_->mini_tablet_server(i)->server()->tablet_manager();
+    std::vector<tablet::TabletPeerPtr> peers;
+    tablet_manager->GetTabletPeers(&peers);
+    for (const auto& peer : peers) {
+      const auto& entity = peer->tablet()->GetMetricEntity();
+      if (!entity) {
+        continue;
+      }
+      hits += METRIC_transaction_status_cache_hits.Instantiate(entity)->value();
+      misses += METRIC_transaction_status_cache_misses.Instantiate(entity)->value();
+      rpcs += METRIC_transaction_status_rpcs.Instantiate(entity)->value();
+    }
+  }
+  LOG(INFO) << "Status cache hits: " << hits << ", misses: " << misses << ", rpcs: " << rpcs;
+  ASSERT_GT(misses, 0);
+  // Each row was read twice, so the second read of each row should hit the cache.
+  ASSERT_GE(hits, static_cast<int64_t>(kTransactions * kNumRows));
+  ASSERT_LE(rpcs, misses);
+}
+
+TEST_F(QLTransactionTest, SingleShard) {
+  // Each transaction writes a single row, so it takes single shard fast path.
+  for (size_t r = 0; r != kNumRows; ++r) {
+    WriteRowAndCommit(KeyForTransactionAndIndex(0, r),
+                      ValueForTransactionAndIndex(0, r, WriteOpType::INSERT));
+  }
+  VerifyData();
+  ASSERT_EQ(0, CountTransactionsWithIntents());
+
+  // Rows of this transaction belong to different tablets, so it is committed as usual.
+  {
+    auto txn = std::make_shared<YBTransaction>(transaction_manager_.get_ptr(), SNAPSHOT_ISOLATION);
+    auto session = CreateSession(false /* read_only */, txn);
+    ASSERT_OK(session->SetFlushMode(YBSession::MANUAL_FLUSH));
+    for (size_t r = 0; r != kNumRows; ++r) {
+      BufferInsert(session,
+                   KeyForTransactionAndIndex(1, r),
+                   ValueForTransactionAndIndex(1, r, WriteOpType::INSERT));
+    }
+    ASSERT_OK(session->FlushAndCommit());
+  }
+  VerifyData(2);
+  ASSERT_GT(CountTransactionsWithIntents(), 0);
+
+  // Fast path is not applicable after something was written in context of the transaction.
+  {
+    auto txn = std::make_shared<YBTransaction>(transaction_manager_.get_ptr(), SNAPSHOT_ISOLATION);
+    auto session = CreateSession(false /* read_only */, txn);
+    ASSERT_OK(WriteRow(session,
+                       KeyForTransactionAndIndex(2, 0),
+                       ValueForTransactionAndIndex(2, 0, WriteOpType::INSERT)));
+    ASSERT_OK(session->SetFlushMode(YBSession::MANUAL_FLUSH));
+    for (size_t r = 1; r != kNumRows; ++r) {
+      BufferInsert(session,
+                   KeyForTransactionAndIndex(2, r),
+                   ValueForTransactionAndIndex(2, r, WriteOpType::INSERT));
+    }
+    ASSERT_OK(session->FlushAndCommit());
+  }
+  VerifyData(3);
+  CHECK_OK(cluster_->RestartSync());
+}
+
+// Compares latency of single row transactions with and without single shard fast path.
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(QLTransactionTest, DISABLED_SingleShardBenchmark) {
+  google::FlagSaver flag_saver;
+
+  constexpr int32_t kTransactions = 200;
+  int32_t key = 0;
+  for (bool fast_path : {false, true}) {
+    FLAGS_transaction_single_shard_fast_path = fast_path;
+    auto start = MonoTime::FineNow();
+    for (int32_t i = 0; i != kTransactions; ++i, ++key) {
+      WriteRowAndCommit(key, key);
+    }
+    auto passed = MonoTime::FineNow() - start;
+    LOG(INFO) << "Fast path: " << fast_path << ", transactions: " << kTransactions
+              << ", time: " << passed.ToString() << ", avg latency: "
+              << passed.ToMicroseconds() / kTransactions << "us";
+  }
+
+  auto session = CreateSession(true /* read_only */);
+  for (int32_t i = 0; i != key; ++i) {
+    VerifyRow(session, i, i);
+  }
+}
+
+// Measures latency of commit and latency of reading the rows right after commit, while intents
+// of the transaction could be not yet applied.
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(QLTransactionTest, DISABLED_CommitLatencyBenchmark) {
+  constexpr size_t kTransactions = 100;
+  MonoDelta commit_time = MonoDelta::FromNanoseconds(0);
+  MonoDelta read_time = MonoDelta::FromNanoseconds(0);
+  auto read_session = CreateSession(true /* read_only */);
+  for (size_t i = 0; i != kTransactions; ++i) {
+    auto txn = std::make_shared<YBTransaction>(transaction_manager_.get_ptr(), SNAPSHOT_ISOLATION);
+    auto session = CreateSession(false /* read_only */, txn);
+    WriteRows(session, i);
+
+    auto start = MonoTime::FineNow();
+    ASSERT_OK(txn->CommitFuture().get());
+    auto committed = MonoTime::FineNow();
+    commit_time += committed - start;
+
+    for (size_t r = 0; r != kNumRows; ++r) {
+      VerifyRow(read_session,
+                KeyForTransactionAndIndex(i, r),
+                ValueForTransactionAndIndex(i, r, WriteOpType::INSERT));
+    }
+    read_time += MonoTime::FineNow() - committed;
+  }
+  LOG(INFO) << "Transactions: " << kTransactions
+            << ", avg commit latency: " << commit_time.ToMicroseconds() / kTransactions << "us"
+            << ", avg read after commit latency: "
+            << read_time.ToMicroseconds() / (kTransactions * kNumRows) << "us";
+}
+
 TEST_F(QLTransactionTest, ConflictResolution) {
   google::FlagSaver flag_saver;
 
@@ -38,6 +38,7 @@
 #include "yb/client/batcher.h"
 #include "yb/client/callbacks.h"
 #include "yb/client/error_collector.h"
+#include "yb/client/transaction.h"
 
 namespace yb {
 
@@ -116,6 +117,30 @@ void YBSessionData::FlushAsync(YBStatusCallback* callback) {
   NewBatcher()->FlushAsync(callback);
 }
 
+void YBSessionData::FlushAndCommitAsync(YBStatusCallback* callback) {
+  if (!transaction_) {
+    callback->Run(STATUS(IllegalState, "FlushAndCommit requires a transaction"));
+    return;
+  }
+  if (flush_mode_ == YBSession::AUTO_FLUSH_BACKGROUND) {
+    callback->Run(STATUS(NotSupported, "FlushAndCommit is not supported in background flush mode"));
+    return;
+  }
+
+  auto transaction = transaction_;
+  NewBatcher()->FlushAsync(
+      MakeYBStatusFunctorCallback([transaction, callback](const Status& status) {
+        if (!status.ok()) {
+          callback->Run(status);
+          return;
+        }
+        transaction->Commit([callback](const Status& status) {
+          callback->Run(status);
+        });
+      }),
+      true /* commit_transaction */);
+}
+
 Status YBSessionData::Apply(std::shared_ptr<YBOperation> yb_op) {
   CHECK_EQ(yb_op->read_only(), read_only_);
 
@@ -152,5 +177,12 @@ Status YBSessionData::Flush() {
   return s.Wait();
 }
 
+Status YBSessionData::FlushAndCommit() {
+  Synchronizer s;
+  YBStatusMemberCallback<Synchronizer> ksmcb(&s, &Synchronizer::StatusCB);
+  FlushAndCommitAsync(&ksmcb);
+  return s.Wait();
+}
+
 }  // namespace client
 }  // namespace yb
@@ -69,6 +69,10 @@ class YBSessionData : public std::enable_shared_from_this<YBSessionData> {
 
   CHECKED_STATUS Flush();
 
+  void FlushAndCommitAsync(YBStatusCallback* callback);
+
+  CHECKED_STATUS FlushAndCommit();
+
   // Called by Batcher when a flush has finished.
   void FlushFinished(internal::Batcher* b);
 
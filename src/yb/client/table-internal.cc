@@ -74,19 +74,16 @@ static Status PBToClientTableType(
   }
 }
 
-YBTable::Data::Data(
-    shared_ptr<YBClient> client,
-    YBTableName name,
-    string id,
-    const YBSchema& schema,
-    PartitionSchema partition_schema)
+YBTable::Data::Data(shared_ptr<YBClient> client, const YBTableInfo& info)
   : client_(std::move(client)),
-    name_(std::move(name)),
+    name_(info.table_name),
     // The table type is set after the table is opened.
     table_type_(YBTableType::UNKNOWN_TABLE_TYPE),
-    id_(std::move(id)),
-    schema_(schema),
-    partition_schema_(std::move(partition_schema)) {
+    id_(info.table_id),
+    schema_(info.schema),
+    partition_schema_(info.partition_schema),
+    index_map_(info.index_map),
+    indexed_table_id_(info.indexed_table_id) {
 }
 
 YBTable::Data::~Data() {
@@ -43,11 +43,7 @@ namespace client {
 
 class YBTable::Data {
  public:
-  Data(std::shared_ptr<YBClient> client,
-       YBTableName name,
-       std::string table_id,
-       const YBSchema& schema,
-       PartitionSchema partition_schema);
+  Data(std::shared_ptr<YBClient> client, const YBTableInfo& info);
   ~Data();
 
   CHECKED_STATUS Open();
@@ -64,6 +60,12 @@ class YBTable::Data {
   const YBSchema schema_;
   const PartitionSchema partition_schema_;
 
+  // Secondary indexes of the table.
+  const IndexMap index_map_;
+
+  // For an index table: the id of the table it indexes.
+  const std::string indexed_table_id_;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(Data);
 };
@@ -65,7 +65,8 @@ Status YBTableAlterer::Data::ToRequest(AlterTableRequestPB* req) {
     return status_;
   }
 
-  if (!rename_to_.is_initialized() && steps_.empty() && !table_properties_.is_initialized()) {
+  if (!rename_to_.is_initialized() && steps_.empty() && !table_properties_.is_initialized() &&
+      !backfilled_index_table_id_.is_initialized()) {
     return STATUS(InvalidArgument, "No alter steps provided");
   }
 
@@ -130,6 +131,10 @@ Status YBTableAlterer::Data::ToRequest(AlterTableRequestPB* req) {
     table_properties_->ToTablePropertiesPB(req->mutable_alter_properties());
   }
 
+  if (backfilled_index_table_id_.is_initialized()) {
+    req->set_backfilled_index_table_id(backfilled_index_table_id_.get());
+  }
+
   return Status::OK();
 }
 
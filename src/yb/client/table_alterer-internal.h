@@ -76,6 +76,8 @@ class YBTableAlterer::Data {
 
   boost::optional<TableProperties> table_properties_;
 
+  boost::optional<TableId> backfilled_index_table_id_;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(Data);
 };
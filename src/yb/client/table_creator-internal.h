@@ -67,6 +67,9 @@ class YBTableCreator::Data {
   master::ReplicationInfoPB replication_info_;
   bool has_replication_info_ = false;
 
+  // Id of the indexed table when creating an index table.
+  std::string indexed_table_id_;
+
   MonoDelta timeout_;
 
   bool wait_ = true;
@@ -19,6 +19,7 @@
 #include "yb/rpc/rpc.h"
 #include "yb/rpc/scheduler.h"
 
+#include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/random_util.h"
 #include "yb/util/result.h"
@@ -37,6 +38,12 @@ using namespace std::placeholders;
 
 DEFINE_uint64(transaction_heartbeat_usec, 500000, "Interval of transaction heartbeat in usec.");
 DEFINE_bool(transaction_disable_heartbeat_in_tests, false, "Disable heartbeat during test.");
+DEFINE_bool(transaction_single_shard_fast_path, true,
+            "Whether transaction, whose writes belong to a single tablet and are flushed together "
+            "with commit, should be written as a single non transactional batch, without "
+            "registering it at the status tablet.");
+TAG_FLAG(transaction_single_shard_fast_path, advanced);
+TAG_FLAG(transaction_single_shard_fast_path, runtime);
 
 namespace yb {
 namespace client {
@@ -71,6 +78,7 @@ class YBTransaction::Impl final {
   }
 
   bool Prepare(const std::unordered_set<internal::InFlightOpPtr>& ops,
+               bool commit,
                Waiter waiter,
                TransactionMetadata* metadata,
                HybridTime* propagated_hybrid_time) {
@@ -82,6 +90,11 @@ class YBTransaction::Impl final {
     bool has_tablets_without_parameters = false;
     {
       std::lock_guard<std::mutex> lock(mutex_);
+      if (commit && TrySingleShard(ops)) {
+        VLOG_WITH_PREFIX(1) << "Prepare, single shard: " << tablets_.begin()->first;
+        *propagated_hybrid_time = manager_->Now();
+        return true;
+      }
       if (!ready_) {
         RequestStatusTablet();
         waiters_.push_back(std::move(waiter));
@@ -126,7 +139,8 @@ class YBTransaction::Impl final {
           it->second.has_parameters = true;
         }
       }
-    } else if (status.IsTryAgain()) {
+    } else if (status.IsTryAgain() || single_shard_) {
+      // Single shard transaction is committed by the flush, so it fails together with it.
       SetError(status);
     }
     // We should not handle other errors, because it is just notification that batch was failed.
@@ -148,6 +162,14 @@ class YBTransaction::Impl final {
       }
       complete_.store(true, std::memory_order_release);
       commit_callback_ = std::move(callback);
+      if (single_shard_) {
+        // Writes of this transaction were flushed as a single non transactional batch,
+        // so it is already committed.
+        lock.unlock();
+        VLOG_WITH_PREFIX(1) << "Committed single shard";
+        commit_callback_(Status::OK());
+        return;
+      }
       if (tablets_.empty()) { // TODO(dtxn) abort empty transaction?
         commit_callback_(Status::OK());
         return;
@@ -174,6 +196,29 @@ class YBTransaction::Impl final {
   }
 
  private:
+  // Checks whether the transaction could be committed by writing ops as a single non
+  // transactional batch, i.e. all ops belong to the same tablet and nothing was done in context
+  // of this transaction yet. Should be called with mutex_ held.
+  bool TrySingleShard(const std::unordered_set<internal::InFlightOpPtr>& ops) {
+    if (!GetAtomicFlag(&FLAGS_transaction_single_shard_fast_path) ||
+        ops.empty() || !tablets_.empty() || requested_status_tablet_ ||
+        complete_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    const std::string* tablet_id = nullptr;
+    for (const auto& op : ops) {
+      DCHECK(op->tablet != nullptr);
+      if (!tablet_id) {
+        tablet_id = &op->tablet->tablet_id();
+      } else if (*tablet_id != op->tablet->tablet_id()) {
+        return false;
+      }
+    }
+    single_shard_ = true;
+    tablets_.emplace(*tablet_id, TabletState());
+    return true;
+  }
+
   void DoCommit(const Status& status, const YBTransactionPtr& transaction) {
     VLOG_WITH_PREFIX(1) << Format("Commit, tablets: $0, status: $1", tablets_, status);
     if (!status.ok()) {
@@ -333,6 +378,8 @@ class YBTransaction::Impl final {
   std::atomic<bool> complete_{false};
   // Transaction is successfully initialized and ready to process intents.
   bool ready_ = false;
+  // Transaction took single shard fast path, see TrySingleShard.
+  bool single_shard_ = false;
   CommitCallback commit_callback_;
   Status error_;
   rpc::Rpcs::Handle heartbeat_handle_;
@@ -362,10 +409,11 @@ YBTransaction::~YBTransaction() {
 }
 
 bool YBTransaction::Prepare(const std::unordered_set<internal::InFlightOpPtr>& ops,
+                            bool commit,
                             Waiter waiter,
                             TransactionMetadata* metadata,
                             HybridTime* propagated_hybrid_time) {
-  return impl_->Prepare(ops, std::move(waiter), metadata, propagated_hybrid_time);
+  return impl_->Prepare(ops, commit, std::move(waiter), metadata, propagated_hybrid_time);
 }
 
 void YBTransaction::Flushed(
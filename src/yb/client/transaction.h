@@ -48,7 +48,14 @@ class YBTransaction : public std::enable_shared_from_this<YBTransaction> {
   // This function is used to init metadata of Write/Read request.
   // If we don't have enough information, then the function returns false and stores
   // waiter, that will be invoked when we obtain such information.
+  //
+  // commit means that ops are the last operations of this transaction, that will be committed
+  // right after they are flushed. If nothing was flushed in context of this transaction before
+  // and all ops belong to the same tablet, then the transaction takes single shard fast path:
+  // metadata is left empty, so ops are written as a regular non transactional batch and the
+  // transaction is committed once this batch is written.
   bool Prepare(const std::unordered_set<internal::InFlightOpPtr>& ops,
+               bool commit,
                Waiter waiter,
                TransactionMetadata* metadata,
                HybridTime* propagated_hybrid_time);
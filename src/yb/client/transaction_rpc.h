@@ -61,7 +61,8 @@ MUST_USE_RESULT rpc::RpcCommandPtr UpdateTransaction(
 typedef std::function<void(const Status&, const tserver::GetTransactionStatusResponsePB&)>
     GetTransactionStatusCallback;
 
-// Gets status of specified transaction.
+// Gets status of specified transaction, or statuses of multiple transactions, see
+// GetTransactionStatusRequestPB.
 MUST_USE_RESULT rpc::RpcCommandPtr GetTransactionStatus(
     const MonoTime& deadline,
     internal::RemoteTablet* tablet,
@@ -40,6 +40,8 @@
 
 #include "yb/client/meta_cache.h"
 
+#include "yb/util/ref_cnt_buffer.h"
+
 namespace yb {
 
 class EncodedKey;
@@ -317,9 +319,11 @@ class YBqlOp : public YBOperation {
 
   QLResponsePB* mutable_response() { return ql_response_.get(); }
 
-  std::string&& rows_data() { return std::move(rows_data_); }
+  // Rows data in CQL wire format, as it was produced by the tablet server. The buffer is shared
+  // with the RPC response, so it is passed on without copying.
+  const RefCntBuffer& rows_data() const { return rows_data_; }
 
-  std::string* mutable_rows_data() { return &rows_data_; }
+  RefCntBuffer* mutable_rows_data() { return &rows_data_; }
 
   // Set the hash key in the partial row of this QL operation.
   virtual void SetHashCode(uint16_t hash_code) override = 0;
@@ -327,7 +331,7 @@ class YBqlOp : public YBOperation {
  protected:
   explicit YBqlOp(const std::shared_ptr<YBTable>& table);
   std::unique_ptr<QLResponsePB> ql_response_;
-  std::string rows_data_;
+  RefCntBuffer rows_data_;
 };
 
 class YBqlWriteOp : public YBqlOp {
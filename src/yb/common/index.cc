@@ -0,0 +1,95 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//
+// Classes that implement secondary index.
+//
+
+#include "yb/common/index.h"
+
+using google::protobuf::RepeatedPtrField;
+
+namespace yb {
+
+//--------------------------------------------------------------------------------------------------
+// IndexColumn
+//--------------------------------------------------------------------------------------------------
+
+IndexColumn::IndexColumn(const IndexInfoPB::IndexColumnPB& pb)
+    : column_id(pb.column_id()),
+      indexed_column_id(pb.indexed_column_id()) {
+}
+
+void IndexColumn::ToPB(IndexInfoPB::IndexColumnPB* pb) const {
+  pb->set_column_id(column_id);
+  pb->set_indexed_column_id(indexed_column_id);
+}
+
+//--------------------------------------------------------------------------------------------------
+// IndexInfo
+//--------------------------------------------------------------------------------------------------
+
+IndexInfo::IndexInfo(const IndexInfoPB& pb)
+    : table_id_(pb.table_id()),
+      indexed_table_id_(pb.indexed_table_id()),
+      hash_column_count_(pb.hash_column_count()),
+      range_column_count_(pb.range_column_count()),
+      is_backfilled_(pb.is_backfilled()) {
+  columns_.reserve(pb.columns_size());
+  for (const auto& column : pb.columns()) {
+    columns_.emplace_back(column);
+  }
+}
+
+const IndexColumn* IndexInfo::FindColumnByIndexedId(ColumnId indexed_column_id) const {
+  for (const auto& column : columns_) {
+    if (column.indexed_column_id == indexed_column_id) {
+      return &column;
+    }
+  }
+  return nullptr;
+}
+
+void IndexInfo::ToPB(IndexInfoPB* pb) const {
+  pb->set_table_id(table_id_);
+  pb->set_indexed_table_id(indexed_table_id_);
+  for (const auto& column : columns_) {
+    column.ToPB(pb->add_columns());
+  }
+  pb->set_hash_column_count(hash_column_count_);
+  pb->set_range_column_count(range_column_count_);
+  pb->set_is_backfilled(is_backfilled_);
+}
+
+//--------------------------------------------------------------------------------------------------
+// IndexMap
+//--------------------------------------------------------------------------------------------------
+
+IndexMap::IndexMap(const RepeatedPtrField<IndexInfoPB>& indexes) {
+  FromPB(indexes);
+}
+
+void IndexMap::FromPB(const RepeatedPtrField<IndexInfoPB>& indexes) {
+  clear();
+  for (const auto& index : indexes) {
+    emplace(index.table_id(), IndexInfo(index));
+  }
+}
+
+void IndexMap::ToPB(RepeatedPtrField<IndexInfoPB>* indexes) const {
+  indexes->Clear();
+  for (const auto& itr : *this) {
+    itr.second.ToPB(indexes->Add());
+  }
+}
+
+}  // namespace yb
@@ -0,0 +1,87 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//
+// Classes that implement secondary index.
+//
+
+#ifndef YB_COMMON_INDEX_H
+#define YB_COMMON_INDEX_H
+
+#include <unordered_map>
+#include <vector>
+
+#include <google/protobuf/repeated_field.h>
+
+#include "yb/common/common.pb.h"
+#include "yb/common/entity_ids.h"
+#include "yb/common/schema.h"
+
+namespace yb {
+
+// Index column mapping.
+struct IndexColumn {
+  ColumnId column_id;          // Column id in the index table.
+  ColumnId indexed_column_id;  // Corresponding column id in the indexed table.
+
+  explicit IndexColumn(const IndexInfoPB::IndexColumnPB& pb);
+  IndexColumn() {}
+
+  void ToPB(IndexInfoPB::IndexColumnPB* pb) const;
+};
+
+class IndexInfo {
+ public:
+  explicit IndexInfo(const IndexInfoPB& pb);
+  IndexInfo() {}
+
+  const TableId& table_id() const { return table_id_; }
+  const TableId& indexed_table_id() const { return indexed_table_id_; }
+  const std::vector<IndexColumn>& columns() const { return columns_; }
+  size_t hash_column_count() const { return hash_column_count_; }
+  size_t range_column_count() const { return range_column_count_; }
+  size_t key_column_count() const { return hash_column_count_ + range_column_count_; }
+  bool is_backfilled() const { return is_backfilled_; }
+
+  // Returns the index column mapped from the indexed table column, or nullptr if the column is
+  // neither indexed nor covered by the index.
+  const IndexColumn* FindColumnByIndexedId(ColumnId indexed_column_id) const;
+
+  // Is the indexed table column stored in the index table (as a key or a covering column)?
+  bool IsColumnCovered(ColumnId indexed_column_id) const {
+    return FindColumnByIndexedId(indexed_column_id) != nullptr;
+  }
+
+  void ToPB(IndexInfoPB* pb) const;
+
+ private:
+  TableId table_id_;
+  TableId indexed_table_id_;
+  std::vector<IndexColumn> columns_;
+  size_t hash_column_count_ = 0;
+  size_t range_column_count_ = 0;
+  bool is_backfilled_ = false;
+};
+
+// A map to look up an index by its index table id.
+class IndexMap : public std::unordered_map<TableId, IndexInfo> {
+ public:
+  explicit IndexMap(const google::protobuf::RepeatedPtrField<IndexInfoPB>& indexes);
+  IndexMap() {}
+
+  void FromPB(const google::protobuf::RepeatedPtrField<IndexInfoPB>& indexes);
+  void ToPB(google::protobuf::RepeatedPtrField<IndexInfoPB>* indexes) const;
+};
+
+}  // namespace yb
+
+#endif  // YB_COMMON_INDEX_H
@@ -0,0 +1,238 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <gtest/gtest.h>
+
+#include "yb/common/ql_batch_condition.h"
+#include "yb/common/ql_value.h"
+#include "yb/gutil/strings/substitute.h"
+#include "yb/util/stopwatch.h"
+#include "yb/util/test_util.h"
+
+namespace yb {
+namespace common {
+
+namespace {
+
+const ColumnId kIntColumn(10);
+const ColumnId kStringColumn(11);
+
+void SetColumn(QLExpressionPB* expr, ColumnId column_id) {
+  expr->set_column_id(column_id);
+}
+
+QLConditionPB* AddCondition(QLConditionPB* parent, QLOperator op) {
+  QLConditionPB* condition = parent->add_operands()->mutable_condition();
+  condition->set_op(op);
+  return condition;
+}
+
+// Add "column op literal" to the parent condition.
+void AddIntRelation(QLConditionPB* parent, QLOperator op, int64_t literal) {
+  QLConditionPB* condition = AddCondition(parent, op);
+  SetColumn(condition->add_operands(), kIntColumn);
+  condition->add_operands()->mutable_value()->set_int64_value(literal);
+}
+
+// Rows with an int64 column i and a string column s. Every 7th row has a null i and every 5th row
+// has no s.
+std::vector<QLTableRow> MakeRows(size_t num_rows) {
+  std::vector<QLTableRow> rows(num_rows);
+  for (size_t i = 0; i < num_rows; i++) {
+    if (i % 7 != 0) {
+      rows[i][kIntColumn].value.set_int64_value(i % 100);
+    } else {
+      rows[i][kIntColumn].value.Clear();
+    }
+    if (i % 5 != 0) {
+      rows[i][kStringColumn].value.set_string_value(strings::Substitute("s$0", i % 10));
+    }
+  }
+  return rows;
+}
+
+// Check that the batch evaluation selects the same rows as the row-wise evaluation.
+void CheckSameAsRowwise(const QLConditionPB& condition, const std::vector<QLTableRow>& rows) {
+  QLBatchCondition batch_condition(condition);
+  ASSERT_TRUE(batch_condition.supported()) << condition.ShortDebugString();
+  std::vector<uint8_t> match;
+  ASSERT_OK(batch_condition.Evaluate(rows, &match));
+  ASSERT_EQ(match.size(), rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    bool expected = false;
+    ASSERT_OK(EvaluateCondition(condition, rows[i], &expected));
+    ASSERT_EQ(expected, match[i] != 0) << "row " << i << ": " << condition.ShortDebugString();
+  }
+}
+
+} // namespace
+
+TEST(QLBatchConditionTest, TestRelationalOperators) {
+  const auto rows = MakeRows(1000);
+  for (QLOperator op : {QL_OP_EQUAL, QL_OP_NOT_EQUAL, QL_OP_LESS_THAN, QL_OP_LESS_THAN_EQUAL,
+                        QL_OP_GREATER_THAN, QL_OP_GREATER_THAN_EQUAL}) {
+    // column op literal.
+    QLConditionPB condition;
+    condition.set_op(op);
+    SetColumn(condition.add_operands(), kIntColumn);
+    condition.add_operands()->mutable_value()->set_int64_value(42);
+    CheckSameAsRowwise(condition, rows);
+
+    // literal op column.
+    condition.Clear();
+    condition.set_op(op);
+    condition.add_operands()->mutable_value()->set_int64_value(42);
+    SetColumn(condition.add_operands(), kIntColumn);
+    CheckSameAsRowwise(condition, rows);
+
+    // String column.
+    condition.Clear();
+    condition.set_op(op);
+    SetColumn(condition.add_operands(), kStringColumn);
+    condition.add_operands()->mutable_value()->set_string_value("s4");
+    CheckSameAsRowwise(condition, rows);
+
+    // Null literal.
+    condition.Clear();
+    condition.set_op(op);
+    SetColumn(condition.add_operands(), kIntColumn);
+    condition.add_operands()->mutable_value();
+    CheckSameAsRowwise(condition, rows);
+
+    // Null literal op column.
+    condition.Clear();
+    condition.set_op(op);
+    condition.add_operands()->mutable_value();
+    SetColumn(condition.add_operands(), kStringColumn);
+    CheckSameAsRowwise(condition, rows);
+  }
+}
+
+TEST(QLBatchConditionTest, TestLogicalOperators) {
+  const auto rows = MakeRows(1000);
+
+  // i >= 10 AND (i < 20 OR s IS NULL OR NOT s IN ('s1', 's2')) AND i IS NOT NULL
+  QLConditionPB condition;
+  condition.set_op(QL_OP_AND);
+  AddIntRelation(&condition, QL_OP_GREATER_THAN_EQUAL, 10);
+  QLConditionPB* or_condition = AddCondition(&condition, QL_OP_OR);
+  AddIntRelation(or_condition, QL_OP_LESS_THAN, 20);
+  SetColumn(AddCondition(or_condition, QL_OP_IS_NULL)->add_operands(), kStringColumn);
+  QLConditionPB* in_condition = AddCondition(AddCondition(or_condition, QL_OP_NOT), QL_OP_IN);
+  SetColumn(in_condition->add_operands(), kStringColumn);
+  QLSeqValuePB* list = in_condition->add_operands()->mutable_value()->mutable_list_value();
+  list->add_elems()->set_string_value("s1");
+  list->add_elems()->set_string_value("s2");
+  SetColumn(AddCondition(&condition, QL_OP_IS_NOT_NULL)->add_operands(), kIntColumn);
+  CheckSameAsRowwise(condition, rows);
+
+  // i NOT IN (1, 2, null)
+  condition.Clear();
+  condition.set_op(QL_OP_NOT_IN);
+  SetColumn(condition.add_operands(), kIntColumn);
+  list = condition.add_operands()->mutable_value()->mutable_list_value();
+  list->add_elems()->set_int64_value(1);
+  list->add_elems()->set_int64_value(2);
+  list->add_elems();
+  CheckSameAsRowwise(condition, rows);
+
+  // s IN (null, 's3')
+  condition.set_op(QL_OP_IN);
+  condition.clear_operands();
+  SetColumn(condition.add_operands(), kStringColumn);
+  list = condition.add_operands()->mutable_value()->mutable_list_value();
+  list->add_elems();
+  list->add_elems()->set_string_value("s3");
+  CheckSameAsRowwise(condition, rows);
+
+  // i IN (null)
+  condition.clear_operands();
+  SetColumn(condition.add_operands(), kIntColumn);
+  condition.add_operands()->mutable_value()->mutable_list_value()->add_elems();
+  CheckSameAsRowwise(condition, rows);
+}
+
+TEST(QLBatchConditionTest, TestFallback) {
+  // Unsupported operators and operands.
+  QLConditionPB condition;
+  condition.set_op(QL_OP_LIKE);
+  SetColumn(condition.add_operands(), kStringColumn);
+  condition.add_operands()->mutable_value()->set_string_value("s%");
+  EXPECT_FALSE(QLBatchCondition(condition).supported());
+
+  condition.Clear();
+  condition.set_op(QL_OP_EQUAL);
+  SetColumn(condition.add_operands(), kIntColumn);
+  condition.add_operands()->mutable_value()->set_double_value(1.0);
+  EXPECT_FALSE(QLBatchCondition(condition).supported());
+
+  // A value of an unexpected type is evaluated row by row and reports the same error.
+  condition.Clear();
+  condition.set_op(QL_OP_EQUAL);
+  SetColumn(condition.add_operands(), kIntColumn);
+  condition.add_operands()->mutable_value()->set_int32_value(1);
+  QLBatchCondition batch_condition(condition);
+  ASSERT_TRUE(batch_condition.supported());
+  std::vector<uint8_t> match;
+  ASSERT_FALSE(batch_condition.Evaluate(MakeRows(10), &match).ok());
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST(QLBatchConditionTest, DISABLED_BenchmarkFilteredScan) {
+  // Filter 1M rows in blocks like a scan does, row by row and in batch.
+  constexpr size_t kNumRows = 1000000;
+  constexpr size_t kBlockSize = 1024;
+  const auto rows = MakeRows(kBlockSize);
+
+  QLConditionPB condition;
+  condition.set_op(QL_OP_AND);
+  AddIntRelation(&condition, QL_OP_GREATER_THAN_EQUAL, 10);
+  AddIntRelation(&condition, QL_OP_LESS_THAN, 60);
+  QLConditionPB* string_condition = AddCondition(&condition, QL_OP_NOT_EQUAL);
+  SetColumn(string_condition->add_operands(), kStringColumn);
+  string_condition->add_operands()->mutable_value()->set_string_value("s3");
+
+  size_t rowwise_matches = 0;
+  Stopwatch rowwise_sw;
+  rowwise_sw.start();
+  for (size_t n = 0; n < kNumRows; n += kBlockSize) {
+    for (const auto& row : rows) {
+      bool match = false;
+      ASSERT_OK(EvaluateCondition(condition, row, &match));
+      rowwise_matches += match;
+    }
+  }
+  rowwise_sw.stop();
+
+  size_t batch_matches = 0;
+  QLBatchCondition batch_condition(condition);
+  ASSERT_TRUE(batch_condition.supported());
+  std::vector<uint8_t> match;
+  Stopwatch batch_sw;
+  batch_sw.start();
+  for (size_t n = 0; n < kNumRows; n += kBlockSize) {
+    ASSERT_OK(batch_condition.Evaluate(rows, &match));
+    for (const uint8_t m : match) {
+      batch_matches += m;
+    }
+  }
+  batch_sw.stop();
+
+  ASSERT_EQ(rowwise_matches, batch_matches);
+  LOG(INFO) << "Filtered " << kNumRows << " rows: row-wise "
+            << rowwise_sw.elapsed().wall_millis() << "ms, batch "
+            << batch_sw.elapsed().wall_millis() << "ms";
+}
+
+} // namespace common
+} // namespace yb
@@ -0,0 +1,419 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/common/ql_batch_condition.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "yb/common/ql_value.h"
+
+namespace yb {
+namespace common {
+
+namespace {
+
+bool IsIntValueCase(QLValuePB::ValueCase value_case) {
+  switch (value_case) {
+    case QLValuePB::kInt8Value: FALLTHROUGH_INTENDED;
+    case QLValuePB::kInt16Value: FALLTHROUGH_INTENDED;
+    case QLValuePB::kInt32Value: FALLTHROUGH_INTENDED;
+    case QLValuePB::kInt64Value: FALLTHROUGH_INTENDED;
+    case QLValuePB::kTimestampValue:
+      return true;
+    default:
+      return false;
+  }
+}
+
+int64_t IntValue(const QLValuePB& value) {
+  switch (value.value_case()) {
+    case QLValuePB::kInt8Value: return value.int8_value();
+    case QLValuePB::kInt16Value: return value.int16_value();
+    case QLValuePB::kInt32Value: return value.int32_value();
+    case QLValuePB::kInt64Value: return value.int64_value();
+    case QLValuePB::kTimestampValue: return value.timestamp_value();
+    default:
+      LOG(FATAL) << "Internal error: not an integer value " << value.value_case();
+  }
+  return 0;
+}
+
+// Swap the operands of a relational operator: "literal op column" -> "column op' literal".
+QLOperator MirrorOperator(QLOperator op) {
+  switch (op) {
+    case QL_OP_LESS_THAN: return QL_OP_GREATER_THAN;
+    case QL_OP_LESS_THAN_EQUAL: return QL_OP_GREATER_THAN_EQUAL;
+    case QL_OP_GREATER_THAN: return QL_OP_LESS_THAN;
+    case QL_OP_GREATER_THAN_EQUAL: return QL_OP_LESS_THAN_EQUAL;
+    default: return op;
+  }
+}
+
+// The value of null rows in the string vectors, so that the comparison loops need no branches.
+const std::string kEmptyString;
+
+// Compare the values of the non-null rows with the literal. The loop has no branches and no
+// indirection for integer values so that the compiler can vectorize it.
+template <class T, class Compare>
+void CompareValues(const std::vector<uint8_t>& not_null, const std::vector<T>& values,
+                   const T& literal, size_t num_rows, uint8_t* result) {
+  const Compare compare;
+  const uint8_t* not_null_data = not_null.data();
+  const T* values_data = values.data();
+  for (size_t i = 0; i < num_rows; i++) {
+    result[i] = not_null_data[i] & static_cast<uint8_t>(compare(values_data[i], literal));
+  }
+}
+
+template <class T>
+struct Deref {
+  bool operator()(const std::string* lhs, const std::string* rhs) const { return T()(*lhs, *rhs); }
+};
+
+template <class T, template <class> class Compare>
+void CompareColumn(QLOperator op, const std::vector<uint8_t>& not_null,
+                   const std::vector<T>& values, const T& literal, size_t num_rows,
+                   uint8_t* result) {
+  switch (op) {
+    case QL_OP_EQUAL:
+      return CompareValues<T, Compare<std::equal_to<>>>(not_null, values, literal, num_rows,
+                                                        result);
+    case QL_OP_NOT_EQUAL:
+      return CompareValues<T, Compare<std::not_equal_to<>>>(not_null, values, literal, num_rows,
+                                                            result);
+    case QL_OP_LESS_THAN:
+      return CompareValues<T, Compare<std::less<>>>(not_null, values, literal, num_rows, result);
+    case QL_OP_LESS_THAN_EQUAL:
+      return CompareValues<T, Compare<std::less_equal<>>>(not_null, values, literal, num_rows,
+                                                          result);
+    case QL_OP_GREATER_THAN:
+      return CompareValues<T, Compare<std::greater<>>>(not_null, values, literal, num_rows,
+                                                       result);
+    case QL_OP_GREATER_THAN_EQUAL:
+      return CompareValues<T, Compare<std::greater_equal<>>>(not_null, values, literal, num_rows,
+                                                             result);
+    default:
+      LOG(FATAL) << "Internal error: not a relational operator " << op;
+  }
+}
+
+// Identity adapter for the integer comparisons.
+template <class T>
+using Direct = T;
+
+} // namespace
+
+QLBatchCondition::QLBatchCondition(const QLConditionPB& condition) : condition_(condition) {
+  root_ = Compile(condition);
+  results_.resize(nodes_.size());
+}
+
+size_t QLBatchCondition::AddColumn(const ColumnId column_id,
+                                   const QLValuePB::ValueCase value_case) {
+  for (size_t i = 0; i < columns_.size(); i++) {
+    if (columns_[i].column_id == column_id && columns_[i].value_case == value_case) {
+      return i;
+    }
+  }
+  columns_.push_back(ColumnVector{column_id, value_case, {}, {}, {}});
+  return columns_.size() - 1;
+}
+
+bool QLBatchCondition::CompileLiterals(const QLValuePB& value,
+                                       const QLValuePB::ValueCase value_case, Node* node) {
+  if (IsIntValueCase(value_case)) {
+    node->int_literals.push_back(IntValue(value));
+    return true;
+  }
+  if (value_case == QLValuePB::kStringValue) {
+    node->string_literals.push_back(value.string_value());
+    return true;
+  }
+  return false;
+}
+
+size_t QLBatchCondition::Compile(const QLConditionPB& condition) {
+  const auto& operands = condition.operands();
+  Node node;
+  node.op = condition.op();
+  switch (condition.op()) {
+    case QL_OP_AND: FALLTHROUGH_INTENDED;
+    case QL_OP_OR: FALLTHROUGH_INTENDED;
+    case QL_OP_NOT: {
+      if (operands.size() == 0 || (condition.op() == QL_OP_NOT && operands.size() != 1)) {
+        supported_ = false;
+        break;
+      }
+      for (const auto& operand : operands) {
+        if (operand.expr_case() != QLExpressionPB::ExprCase::kCondition) {
+          supported_ = false;
+          break;
+        }
+        node.operands.push_back(Compile(operand.condition()));
+      }
+      break;
+    }
+
+    case QL_OP_IS_NULL: FALLTHROUGH_INTENDED;
+    case QL_OP_IS_NOT_NULL: {
+      if (operands.size() != 1 ||
+          operands.Get(0).expr_case() != QLExpressionPB::ExprCase::kColumnId) {
+        supported_ = false;
+        break;
+      }
+      node.column = AddColumn(ColumnId(operands.Get(0).column_id()), QLValuePB::VALUE_NOT_SET);
+      break;
+    }
+
+    case QL_OP_EQUAL: FALLTHROUGH_INTENDED;
+    case QL_OP_NOT_EQUAL: FALLTHROUGH_INTENDED;
+    case QL_OP_LESS_THAN: FALLTHROUGH_INTENDED;
+    case QL_OP_LESS_THAN_EQUAL: FALLTHROUGH_INTENDED;
+    case QL_OP_GREATER_THAN: FALLTHROUGH_INTENDED;
+    case QL_OP_GREATER_THAN_EQUAL: {
+      if (operands.size() != 2) {
+        supported_ = false;
+        break;
+      }
+      const QLExpressionPB* column = &operands.Get(0);
+      const QLExpressionPB* literal = &operands.Get(1);
+      if (column->expr_case() == QLExpressionPB::ExprCase::kValue) {
+        std::swap(column, literal);
+        node.op = MirrorOperator(node.op);
+      }
+      if (column->expr_case() != QLExpressionPB::ExprCase::kColumnId ||
+          literal->expr_case() != QLExpressionPB::ExprCase::kValue) {
+        supported_ = false;
+        break;
+      }
+      const QLValuePB& value = literal->value();
+      if (QLValue::IsNull(value)) {
+        // Only the null mask of the column is needed to compare with null.
+        node.null_literal = true;
+        node.column = AddColumn(ColumnId(column->column_id()), QLValuePB::VALUE_NOT_SET);
+        break;
+      }
+      node.column = AddColumn(ColumnId(column->column_id()), value.value_case());
+      supported_ = supported_ && CompileLiterals(value, value.value_case(), &node);
+      break;
+    }
+
+    case QL_OP_IN: FALLTHROUGH_INTENDED;
+    case QL_OP_NOT_IN: {
+      if (operands.size() != 2 ||
+          operands.Get(0).expr_case() != QLExpressionPB::ExprCase::kColumnId ||
+          operands.Get(1).expr_case() != QLExpressionPB::ExprCase::kValue ||
+          !operands.Get(1).value().has_list_value()) {
+        supported_ = false;
+        break;
+      }
+      // All non-null elements must have the same type. A null element matches the null rows.
+      QLValuePB::ValueCase value_case = QLValuePB::VALUE_NOT_SET;
+      for (const QLValuePB& elem : operands.Get(1).value().list_value().elems()) {
+        if (QLValue::IsNull(elem)) {
+          node.null_literal = true;
+          continue;
+        }
+        if (value_case != QLValuePB::VALUE_NOT_SET && elem.value_case() != value_case) {
+          supported_ = false;
+          break;
+        }
+        value_case = elem.value_case();
+        if (!CompileLiterals(elem, value_case, &node)) {
+          supported_ = false;
+          break;
+        }
+      }
+      node.column = AddColumn(ColumnId(operands.Get(0).column_id()), value_case);
+      break;
+    }
+
+    default:
+      supported_ = false;
+      break;
+  }
+  nodes_.push_back(std::move(node));
+  return nodes_.size() - 1;
+}
+
+bool QLBatchCondition::Gather(const std::vector<QLTableRow>& rows) {
+  const size_t num_rows = rows.size();
+  for (ColumnVector& column : columns_) {
+    const bool is_int = IsIntValueCase(column.value_case);
+    const bool is_string = column.value_case == QLValuePB::kStringValue;
+    column.not_null.resize(num_rows);
+    if (is_int) {
+      column.int_values.resize(num_rows);
+    } else if (is_string) {
+      column.string_values.resize(num_rows);
+    }
+    for (size_t i = 0; i < num_rows; i++) {
+      const auto it = rows[i].find(column.column_id);
+      if (it == rows[i].end() || QLValue::IsNull(it->second.value)) {
+        column.not_null[i] = 0;
+        if (is_int) {
+          column.int_values[i] = 0;
+        } else if (is_string) {
+          column.string_values[i] = &kEmptyString;
+        }
+        continue;
+      }
+      const QLValuePB& value = it->second.value;
+      if (column.value_case != QLValuePB::VALUE_NOT_SET &&
+          value.value_case() != column.value_case) {
+        return false;
+      }
+      column.not_null[i] = 1;
+      if (is_int) {
+        column.int_values[i] = IntValue(value);
+      } else if (is_string) {
+        column.string_values[i] = &value.string_value();
+      }
+    }
+  }
+  return true;
+}
+
+void QLBatchCondition::EvaluateNode(const size_t index, const size_t num_rows) {
+  const Node& node = nodes_[index];
+  std::vector<uint8_t>& result_vector = results_[index];
+  result_vector.resize(num_rows);
+  uint8_t* result = result_vector.data();
+
+  switch (node.op) {
+    case QL_OP_AND: FALLTHROUGH_INTENDED;
+    case QL_OP_OR: {
+      const bool is_and = node.op == QL_OP_AND;
+      EvaluateNode(node.operands[0], num_rows);
+      std::copy_n(results_[node.operands[0]].data(), num_rows, result);
+      for (size_t k = 1; k < node.operands.size(); k++) {
+        EvaluateNode(node.operands[k], num_rows);
+        const uint8_t* operand = results_[node.operands[k]].data();
+        if (is_and) {
+          for (size_t i = 0; i < num_rows; i++) {
+            result[i] &= operand[i];
+          }
+        } else {
+          for (size_t i = 0; i < num_rows; i++) {
+            result[i] |= operand[i];
+          }
+        }
+      }
+      return;
+    }
+    case QL_OP_NOT: {
+      EvaluateNode(node.operands[0], num_rows);
+      const uint8_t* operand = results_[node.operands[0]].data();
+      for (size_t i = 0; i < num_rows; i++) {
+        result[i] = operand[i] ^ 1;
+      }
+      return;
+    }
+
+    case QL_OP_IS_NULL: FALLTHROUGH_INTENDED;
+    case QL_OP_IS_NOT_NULL: {
+      const uint8_t flip = node.op == QL_OP_IS_NULL ? 1 : 0;
+      const uint8_t* not_null = columns_[node.column].not_null.data();
+      for (size_t i = 0; i < num_rows; i++) {
+        result[i] = not_null[i] ^ flip;
+      }
+      return;
+    }
+
+    case QL_OP_IN: FALLTHROUGH_INTENDED;
+    case QL_OP_NOT_IN: {
+      const ColumnVector& column = columns_[node.column];
+      if (node.null_literal) {
+        const uint8_t* not_null = column.not_null.data();
+        for (size_t i = 0; i < num_rows; i++) {
+          result[i] = not_null[i] ^ 1;
+        }
+      } else {
+        std::fill_n(result, num_rows, 0);
+      }
+      std::vector<uint8_t> equal(num_rows);
+      for (const int64_t literal : node.int_literals) {
+        CompareValues<int64_t, std::equal_to<>>(column.not_null, column.int_values, literal,
+                                                num_rows, equal.data());
+        for (size_t i = 0; i < num_rows; i++) {
+          result[i] |= equal[i];
+        }
+      }
+      for (const std::string& literal : node.string_literals) {
+        CompareValues<const std::string*, Deref<std::equal_to<>>>(
+            column.not_null, column.string_values, &literal, num_rows, equal.data());
+        for (size_t i = 0; i < num_rows; i++) {
+          result[i] |= equal[i];
+        }
+      }
+      if (node.op == QL_OP_NOT_IN) {
+        for (size_t i = 0; i < num_rows; i++) {
+          result[i] ^= 1;
+        }
+      }
+      return;
+    }
+
+    default: {
+      // Relational operators.
+      const ColumnVector& column = columns_[node.column];
+      if (node.null_literal) {
+        if (node.op == QL_OP_EQUAL) {
+          const uint8_t* not_null = column.not_null.data();
+          for (size_t i = 0; i < num_rows; i++) {
+            result[i] = not_null[i] ^ 1;
+          }
+        } else {
+          std::fill_n(result, num_rows, 0);
+        }
+        return;
+      }
+      if (!node.int_literals.empty()) {
+        CompareColumn<int64_t, Direct>(node.op, column.not_null, column.int_values,
+                                       node.int_literals[0], num_rows, result);
+      } else {
+        CompareColumn<const std::string*, Deref>(node.op, column.not_null,
+                                                     column.string_values,
+                                                     &node.string_literals[0], num_rows, result);
+      }
+      return;
+    }
+  }
+}
+
+Status QLBatchCondition::Evaluate(const std::vector<QLTableRow>& rows,
+                                  std::vector<uint8_t>* match) {
+  DCHECK(supported_);
+  const size_t num_rows = rows.size();
+  match->resize(num_rows);
+  if (num_rows == 0) {
+    return Status::OK();
+  }
+
+  if (!Gather(rows)) {
+    for (size_t i = 0; i < num_rows; i++) {
+      bool result = false;
+      RETURN_NOT_OK(EvaluateCondition(condition_, rows[i], &result));
+      (*match)[i] = result ? 1 : 0;
+    }
+    return Status::OK();
+  }
+
+  EvaluateNode(root_, num_rows);
+  std::copy_n(results_[root_].data(), num_rows, match->data());
+  return Status::OK();
+}
+
+} // namespace common
+} // namespace yb
@@ -0,0 +1,95 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//
+// This file contains QLBatchCondition that evaluates a QL WHERE condition over a block of rows.
+// The column values referenced by the condition are gathered into typed vectors first, and the
+// relational and logical operators are then evaluated with one tight loop per operator over the
+// whole block instead of walking the condition tree once per row.
+
+#ifndef YB_COMMON_QL_BATCH_CONDITION_H
+#define YB_COMMON_QL_BATCH_CONDITION_H
+
+#include <vector>
+
+#include "yb/common/ql_protocol.pb.h"
+#include "yb/common/ql_rowblock.h"
+
+namespace yb {
+namespace common {
+
+class QLBatchCondition {
+ public:
+  // Compile the condition. Only AND / OR / NOT of relational, IN and IS [NOT] NULL operators
+  // between a column and a literal of an integer, timestamp or string type are supported.
+  explicit QLBatchCondition(const QLConditionPB& condition);
+
+  // Whether the condition can be evaluated over a block of rows.
+  bool supported() const { return supported_; }
+
+  // Evaluate the condition for the given rows and set (*match)[i] to 1 if rows[i] is selected or
+  // to 0 otherwise. If a row holds a value of a different type than expected, the block is
+  // evaluated row by row so that the result and the error returned are the same as
+  // EvaluateCondition().
+  CHECKED_STATUS Evaluate(const std::vector<QLTableRow>& rows, std::vector<uint8_t>* match);
+
+ private:
+  // Typed values of a column in the rows of the block.
+  struct ColumnVector {
+    ColumnId column_id;
+    // The value type expected of the column, or VALUE_NOT_SET if the column is only tested for
+    // null.
+    QLValuePB::ValueCase value_case;
+    std::vector<uint8_t> not_null;
+    std::vector<int64_t> int_values;
+    std::vector<const std::string*> string_values;
+  };
+
+  // A node of the compiled condition.
+  struct Node {
+    QLOperator op;
+    // For AND / OR / NOT: the indexes of the operand nodes.
+    std::vector<size_t> operands;
+    // For the other operators: the index of the column vector and the literals compared with.
+    size_t column = 0;
+    std::vector<int64_t> int_literals;
+    std::vector<std::string> string_literals;
+    // Whether the literal (or an element of the IN list) is null. Like operator== of QLValuePB,
+    // equality with null selects the null rows and the other relational operators select none.
+    bool null_literal = false;
+  };
+
+  // Compile the condition into a node and return its index. Clear supported_ if not supported.
+  size_t Compile(const QLConditionPB& condition);
+  bool CompileLiterals(const QLValuePB& value, QLValuePB::ValueCase value_case, Node* node);
+  size_t AddColumn(ColumnId column_id, QLValuePB::ValueCase value_case);
+
+  // Gather the column values of the rows. Return false if a value has an unexpected type.
+  bool Gather(const std::vector<QLTableRow>& rows);
+
+  // Evaluate a node over the gathered block into the result vector of the node.
+  void EvaluateNode(size_t index, size_t num_rows);
+
+  const QLConditionPB& condition_;
+  bool supported_ = true;
+  std::vector<ColumnVector> columns_;
+  std::vector<Node> nodes_;
+  size_t root_ = 0;
+
+  // Per-node result of the last evaluation.
+  std::vector<std::vector<uint8_t>> results_;
+};
+
+} // namespace common
+} // namespace yb
+
+#endif // YB_COMMON_QL_BATCH_CONDITION_H
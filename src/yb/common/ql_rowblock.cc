@@ -131,7 +131,7 @@ Status QLRowBlock::Deserialize(const QLClient client, Slice* data) {
   return Status::OK();
 }
 
-Status QLRowBlock::GetRowCount(const QLClient client, const std::string& data, size_t* count) {
+Status QLRowBlock::GetRowCount(const QLClient client, const Slice& data, size_t* count) {
   CHECK_EQ(client, YQL_CLIENT_CQL);
   int32_t cnt = 0;
   Slice slice(data);
@@ -141,21 +141,23 @@ Status QLRowBlock::GetRowCount(const QLClient client, const std::string& data, s
 }
 
 Status QLRowBlock::AppendRowsData(
-    const QLClient client, const std::string& src, std::string* dst) {
+    const QLClient client, const RefCntBuffer& src, RefCntBuffer* dst) {
   CHECK_EQ(client, YQL_CLIENT_CQL);
   int32_t src_cnt = 0;
-  Slice src_slice(src);
+  Slice src_slice(src.udata(), src.size());
   RETURN_NOT_OK(CQLDecodeNum(sizeof(src_cnt), NetworkByteOrder::Load32, &src_slice, &src_cnt));
   if (src_cnt > 0) {
     int32_t dst_cnt = 0;
-    Slice dst_slice(*dst);
+    Slice dst_slice(dst->udata(), dst->size());
     RETURN_NOT_OK(CQLDecodeNum(sizeof(dst_cnt), NetworkByteOrder::Load32, &dst_slice, &dst_cnt));
     if (dst_cnt == 0) {
       *dst = src;
     } else {
-      dst->append(util::to_char_ptr(src_slice.data()), src_slice.size());
-      dst_cnt += src_cnt;
-      CQLEncodeLength(dst_cnt, &(*dst)[0]);
+      RefCntBuffer result(dst->size() + src_slice.size());
+      memcpy(result.data(), dst->data(), dst->size());
+      memcpy(result.data() + dst->size(), src_slice.data(), src_slice.size());
+      CQLEncodeLength(dst_cnt + src_cnt, result.data());
+      *dst = std::move(result);
     }
   }
   return Status::OK();
@@ -20,6 +20,7 @@
 
 #include "yb/common/ql_value.h"
 #include "yb/common/schema.h"
+#include "yb/util/ref_cnt_buffer.h"
 
 namespace yb {
 
@@ -112,10 +113,12 @@ class QLRowBlock {
 
   //-------------------------- utility functions for rows data ------------------------------
   // Return row count.
-  static CHECKED_STATUS GetRowCount(QLClient client, const std::string& data, size_t* count);
+  static CHECKED_STATUS GetRowCount(QLClient client, const Slice& data, size_t* count);
 
-  // Append rows data. Caller should ensure the column schemas are the same.
-  static CHECKED_STATUS AppendRowsData(QLClient client, const std::string& src, std::string* dst);
+  // Append rows data. Caller should ensure the column schemas are the same. The rows are merged
+  // into a new buffer, so buffers shared with dst before the call are not modified.
+  static CHECKED_STATUS AppendRowsData(
+      QLClient client, const RefCntBuffer& src, RefCntBuffer* dst);
 
  private:
   // Schema of the selected columns. (Note: this schema has no key column definitions)
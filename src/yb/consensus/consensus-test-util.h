@@ -34,6 +34,7 @@
 #define YB_CONSENSUS_CONSENSUS_TEST_UTIL_H_
 
 #include <gmock/gmock.h>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -146,7 +147,8 @@ class TestPeerProxy : public PeerProxy {
 
  protected:
   // Register the RPC callback in order to call later.
-  // We currently only support one request of each method being in flight at a time.
+  // We currently only support one registered request of each method at a time. Requests that are
+  // answered right away should use RespondNow, so any number of them could be in flight.
   virtual void RegisterCallback(Method method, const rpc::ResponseCallback& callback) {
     std::lock_guard<simple_spinlock> lock(lock_);
     InsertOrDie(&callbacks_, method, callback);
@@ -165,9 +167,13 @@ class TestPeerProxy : public PeerProxy {
     CHECK_OK(pool_->SubmitFunc(callback));
   }
 
+  // Answer the peer, without registering the callback.
+  void RespondNow(const rpc::ResponseCallback& callback) {
+    CHECK_OK(pool_->SubmitFunc(callback));
+  }
+
   virtual void RegisterCallbackAndRespond(Method method, const rpc::ResponseCallback& callback) {
-    RegisterCallback(method, callback);
-    Respond(method);
+    RespondNow(callback);
   }
 
   mutable simple_spinlock lock_;
@@ -195,16 +201,17 @@ class DelayablePeerProxy : public TestPeerProxy {
     latch_.Reset(1); // Reset for the next time.
   }
 
-  virtual void RespondUnlessDelayed(Method method) {
+  virtual void RespondUnlessDelayed(Method method, const rpc::ResponseCallback& callback) {
     {
       std::lock_guard<simple_spinlock> l(lock_);
       if (delay_response_) {
+        InsertOrDie(&callbacks_, method, callback);
         latch_.CountDown();
         delay_response_ = false;
         return;
       }
     }
-    TestPeerProxy::Respond(method);
+    RespondNow(callback);
   }
 
   virtual void Respond(Method method) override {
@@ -216,20 +223,18 @@ class DelayablePeerProxy : public TestPeerProxy {
                            ConsensusResponsePB* response,
                            rpc::RpcController* controller,
                            const rpc::ResponseCallback& callback) override {
-    RegisterCallback(kUpdate, callback);
     return proxy_->UpdateAsync(
         request, response, controller,
-        std::bind(&DelayablePeerProxy::RespondUnlessDelayed, this, kUpdate));
+        std::bind(&DelayablePeerProxy::RespondUnlessDelayed, this, kUpdate, callback));
   }
 
   virtual void RequestConsensusVoteAsync(const VoteRequestPB* request,
                                          VoteResponsePB* response,
                                          rpc::RpcController* controller,
                                          const rpc::ResponseCallback& callback) override {
-    RegisterCallback(kRequestVote, callback);
     return proxy_->RequestConsensusVoteAsync(
         request, response, controller,
-        std::bind(&DelayablePeerProxy::RespondUnlessDelayed, this, kRequestVote));
+        std::bind(&DelayablePeerProxy::RespondUnlessDelayed, this, kRequestVote, callback));
   }
 
   ProxyType* proxy() const {
@@ -448,18 +453,16 @@ class LocalTestPeerProxy : public TestPeerProxy {
                            ConsensusResponsePB* response,
                            rpc::RpcController* controller,
                            const rpc::ResponseCallback& callback) override {
-    RegisterCallback(kUpdate, callback);
     CHECK_OK(pool_->SubmitFunc(
-        std::bind(&LocalTestPeerProxy::SendUpdateRequest, this, request, response)));
+        std::bind(&LocalTestPeerProxy::SendUpdateRequest, this, request, response, callback)));
   }
 
   virtual void RequestConsensusVoteAsync(const VoteRequestPB* request,
                                          VoteResponsePB* response,
                                          rpc::RpcController* controller,
                                          const rpc::ResponseCallback& callback) override {
-    RegisterCallback(kRequestVote, callback);
     CHECK_OK(pool_->SubmitFunc(
-        std::bind(&LocalTestPeerProxy::SendVoteRequest, this, request, response)));
+        std::bind(&LocalTestPeerProxy::SendVoteRequest, this, request, response, callback)));
   }
 
   template<class Response>
@@ -473,7 +476,7 @@ class LocalTestPeerProxy : public TestPeerProxy {
   void RespondOrMissResponse(Request* request,
                              const Response& response_temp,
                              Response* final_response,
-                             Method method) {
+                             const rpc::ResponseCallback& callback) {
 
     bool miss_comm_copy;
     {
@@ -488,11 +491,17 @@ class LocalTestPeerProxy : public TestPeerProxy {
     } else {
       final_response->CopyFrom(response_temp);
     }
-    Respond(method);
+    RespondNow(callback);
   }
 
   void SendUpdateRequest(const ConsensusRequestPB* request,
-                         ConsensusResponsePB* response) {
+                         ConsensusResponsePB* response,
+                         const rpc::ResponseCallback& callback) {
+    int latency_ms = latency_ms_;
+    if (latency_ms > 0) {
+      SleepFor(MonoDelta::FromMilliseconds(latency_ms));
+    }
+
     // Copy the request and the response for the other peer so that ownership
     // remains as close to the dist. impl. as possible.
     ConsensusRequestPB other_peer_req;
@@ -518,13 +527,14 @@ class LocalTestPeerProxy : public TestPeerProxy {
     }
 
     response->CopyFrom(other_peer_resp);
-    RespondOrMissResponse(request, other_peer_resp, response, kUpdate);
+    RespondOrMissResponse(request, other_peer_resp, response, callback);
   }
 
 
 
   void SendVoteRequest(const VoteRequestPB* request,
-                       VoteResponsePB* response) {
+                       VoteResponsePB* response,
+                       const rpc::ResponseCallback& callback) {
 
     // Copy the request and the response for the other peer so that ownership
     // remains as close to the dist. impl. as possible.
@@ -547,7 +557,7 @@ class LocalTestPeerProxy : public TestPeerProxy {
     }
 
     response->CopyFrom(other_peer_resp);
-    RespondOrMissResponse(request, other_peer_resp, response, kRequestVote);
+    RespondOrMissResponse(request, other_peer_resp, response, callback);
   }
 
   void InjectCommFaultLeaderSide() {
@@ -556,6 +566,11 @@ class LocalTestPeerProxy : public TestPeerProxy {
     miss_comm_ = true;
   }
 
+  // Emulates network latency, update requests are delivered to the peer after the specified delay.
+  void SetLatencyMs(int latency_ms) {
+    latency_ms_ = latency_ms;
+  }
+
   const std::string& GetTarget() const {
     return peer_uuid_;
   }
@@ -564,6 +579,7 @@ class LocalTestPeerProxy : public TestPeerProxy {
   const std::string peer_uuid_;
   TestPeerMapManager* const peers_;
   bool miss_comm_;
+  std::atomic<int> latency_ms_{0};
 };
 
 class LocalTestPeerProxyFactory : public PeerProxyFactory {
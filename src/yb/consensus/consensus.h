@@ -79,6 +79,7 @@ namespace consensus {
 
 class ConsensusCommitContinuation;
 class ConsensusRound;
+class MultiRaftManager;
 class ReplicaOperationFactory;
 
 typedef int64_t ConsensusTerm;
@@ -90,6 +91,9 @@ typedef std::vector<ConsensusRoundPtr> ConsensusRounds;
 
 struct ConsensusOptions {
   std::string tablet_id;
+
+  // Server wide registry of heartbeat batchers, heartbeats are not batched when it is null.
+  MultiRaftManager* multi_raft_manager = nullptr;
 };
 
 // After completing bootstrap, some of the results need to be plumbed through
@@ -493,6 +497,11 @@ class ReplicaOperationFactory {
  public:
   virtual CHECKED_STATUS StartReplicaOperation(const ConsensusRoundPtr& context) = 0;
 
+  // Invoked before and after notifying a sequence of operations that they were committed, so
+  // applies of these operations could be grouped.
+  virtual void StartApplyGroup() {}
+  virtual void FinishApplyGroup() {}
+
   virtual ~ReplicaOperationFactory() {}
 };
 
@@ -47,6 +47,7 @@
 #include "yb/consensus/consensus.proxy.h"
 #include "yb/consensus/consensus_queue.h"
 #include "yb/consensus/log.h"
+#include "yb/consensus/multi_raft_batcher.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/substitute.h"
@@ -63,6 +64,12 @@ DEFINE_int32(consensus_rpc_timeout_ms, 2000,
              "Timeout used for all consensus internal RPC communications.");
 TAG_FLAG(consensus_rpc_timeout_ms, advanced);
 
+DEFINE_int32(consensus_max_requests_in_flight_per_peer, 4,
+             "Maximal number of UpdateConsensus requests that the leader sends to a peer without "
+             "waiting for their responses. Values greater than 1 let replication throughput to "
+             "a peer exceed one batch per round trip.");
+TAG_FLAG(consensus_max_requests_in_flight_per_peer, advanced);
+
 DECLARE_int32(raft_heartbeat_interval_ms);
 
 DEFINE_test_flag(double, fault_crash_on_leader_request_fraction, 0.0,
@@ -86,6 +93,24 @@ using rpc::Messenger;
 using rpc::RpcController;
 using strings::Substitute;
 
+struct Peer::InFlightRequest {
+  ConsensusRequestPB request;
+  ConsensusResponsePB response;
+  rpc::RpcController controller;
+
+  // Reference-counted pointers to the ReplicateMsgs of the request. We may have loaded these
+  // messages from the LogCache, in which case we are potentially sharing the same object as other
+  // peers. Since the PB request itself can't hold reference counts, this holds them.
+  ReplicateMsgs msg_refs;
+
+  PeerRequestInfo info;
+
+  ~InFlightRequest() {
+    // We don't own the ops (the queue does).
+    request.mutable_ops()->ExtractSubrange(0, request.ops_size(), nullptr);
+  }
+};
+
 Status Peer::NewRemotePeer(const RaftPeerPB& peer_pb,
                            const string& tablet_id,
                            const string& leader_uuid,
@@ -116,7 +141,9 @@ Peer::Peer(
       proxy_(proxy.Pass()),
       queue_(queue),
       failed_attempts_(0),
-      sem_(1),
+      max_requests_in_flight_(std::max(FLAGS_consensus_max_requests_in_flight_per_peer, 1)),
+      last_sent_committed_index_(kMinimumOpIdIndex),
+      sem_(max_requests_in_flight_),
       heartbeater_(
           peer_pb.permanent_uuid(), MonoDelta::FromMilliseconds(FLAGS_raft_heartbeat_interval_ms),
           std::bind(&Peer::SignalRequest, this, RequestTriggerMode::ALWAYS_SEND)),
@@ -125,7 +152,7 @@ Peer::Peer(
       consensus_(consensus) {}
 
 void Peer::SetTermForTest(int term) {
-  response_.set_responder_term(term);
+  term_for_tests_ = term;
 }
 
 Status Peer::Init() {
@@ -181,18 +208,22 @@ Status Peer::SignalRequest(RequestTriggerMode trigger_mode) {
 }
 
 void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
-  DCHECK_LE(sem_.GetValue(), 0) << "Cannot send request";
+  DCHECK_LT(sem_.GetValue(), max_requests_in_flight_) << "Cannot send request";
+
+  std::unique_lock<std::mutex> send_lock(send_mutex_);
 
   // The peer has no pending request nor is sending: send the request.
+  std::unique_ptr<InFlightRequest> request(new InFlightRequest);
+  request->info.allow_pipelining = max_requests_in_flight_ > 1;
   bool needs_remote_bootstrap = false;
   bool last_exchange_successful = false;
   RaftPeerPB::MemberType member_type = RaftPeerPB::UNKNOWN_MEMBER_TYPE;
-  int64_t commit_index_before = request_.has_committed_index() ?
-      request_.committed_index().index() : kMinimumOpIdIndex;
-  Status s = queue_->RequestForPeer(peer_pb_.permanent_uuid(), &request_,
-      &replicate_msg_refs_, &needs_remote_bootstrap, &member_type, &last_exchange_successful);
-  int64_t commit_index_after = request_.has_committed_index() ?
-      request_.committed_index().index() : kMinimumOpIdIndex;
+  int64_t commit_index_before = last_sent_committed_index_;
+  Status s = queue_->RequestForPeer(peer_pb_.permanent_uuid(), &request->request,
+      &request->msg_refs, &needs_remote_bootstrap, &member_type, &last_exchange_successful,
+      &request->info);
+  int64_t commit_index_after = request->request.has_committed_index() ?
+      request->request.committed_index().index() : kMinimumOpIdIndex;
 
   if (PREDICT_FALSE(!s.ok())) {
     LOG_WITH_PREFIX_UNLOCKED(INFO) << "Could not obtain request from queue for peer: "
@@ -216,7 +247,10 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
   if (last_exchange_successful &&
       (member_type == RaftPeerPB::PRE_VOTER || member_type == RaftPeerPB::PRE_OBSERVER)) {
     if (PREDICT_TRUE(consensus_)) {
+      // The request is not sent, so the ops that RequestForPeer() assigned to it are sent again.
+      queue_->RequestFailed(peer_pb_.permanent_uuid(), request->info);
       sem_.Release();
+      send_lock.unlock();
       consensus::ChangeConfigRequestPB req;
       consensus::ChangeConfigResponsePB resp;
 
@@ -244,11 +278,12 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
     }
   }
 
-  request_.set_tablet_id(tablet_id_);
-  request_.set_caller_uuid(leader_uuid_);
-  request_.set_dest_uuid(peer_pb_.permanent_uuid());
+  request->request.set_tablet_id(tablet_id_);
+  request->request.set_caller_uuid(leader_uuid_);
+  request->request.set_dest_uuid(peer_pb_.permanent_uuid());
 
-  const bool req_has_ops = (request_.ops_size() > 0) || (commit_index_after > commit_index_before);
+  const bool req_has_ops = (request->request.ops_size() > 0) ||
+                           (commit_index_after > commit_index_before);
 
   // If the queue is empty, check if we were told to send a status-only message (which is what
   // happens during heartbeats). If not, just return.
@@ -256,6 +291,7 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
     sem_.Release();
     return;
   }
+  last_sent_committed_index_ = commit_index_after;
 
   // If we're actually sending ops there's no need to heartbeat for a while, reset the heartbeater.
   if (req_has_ops) {
@@ -263,18 +299,34 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
   }
 
   MAYBE_FAULT(FLAGS_fault_crash_on_leader_request_fraction);
-  controller_.Reset();
+  if (PREDICT_FALSE(term_for_tests_ >= 0)) {
+    request->response.set_responder_term(term_for_tests_);
+  }
 
-  proxy_->UpdateAsync(&request_, &response_, &controller_, std::bind(&Peer::ProcessResponse, this));
+  // The request is sent under send_mutex_, so requests are sent in the order they were assembled.
+  const bool more_pending = request->info.more_pending;
+  InFlightRequest* in_flight = request.release();
+  proxy_->UpdateAsync(&in_flight->request, &in_flight->response, &in_flight->controller,
+                      std::bind(&Peer::ProcessResponse, this, in_flight));
+  send_lock.unlock();
+
+  // The queue has more ops for the peer than fit into one request, so send the next one without
+  // waiting for the response, if the window allows it.
+  if (more_pending) {
+    WARN_NOT_OK(SignalRequest(RequestTriggerMode::NON_EMPTY_ONLY),
+                LogPrefixUnlocked() + "Failed to send pipelined request");
+  }
 }
 
-void Peer::ProcessResponse() {
+void Peer::ProcessResponse(InFlightRequest* request) {
   // Note: This method runs on the reactor thread.
 
-  DCHECK_LE(sem_.GetValue(), 0) << "Got a response when nothing was pending";
+  DCHECK_LT(sem_.GetValue(), max_requests_in_flight_) << "Got a response when nothing was pending";
 
-  if (!controller_.status().ok()) {
-    if (controller_.status().IsRemoteError()) {
+  const auto& controller = request->controller;
+  const auto& response = request->response;
+  if (!controller.status().ok()) {
+    if (controller.status().IsRemoteError()) {
       // Most controller errors are caused by network issues or corner cases like shutdown and
       // failure to serialize a protobuf. Therefore, we generally consider these errors to indicate
       // an unreachable peer.  However, a RemoteError wraps some other error propagated from the
@@ -282,39 +334,44 @@ void Peer::ProcessResponse() {
       // remote is responsive.
       queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
     }
-    ProcessResponseError(controller_.status());
+    ProcessResponseError(request, controller.status());
     return;
   }
 
   // Pass through errors we can respond to, like not found, since in that case
   // we will need to remotely bootstrap. TODO: Handle DELETED response once implemented.
-  if ((response_.has_error() &&
-      response_.error().code() != tserver::TabletServerErrorPB::TABLET_NOT_FOUND) ||
-      (response_.status().has_error() &&
-          response_.status().error().code() == consensus::ConsensusErrorPB::CANNOT_PREPARE)) {
+  if ((response.has_error() &&
+      response.error().code() != tserver::TabletServerErrorPB::TABLET_NOT_FOUND) ||
+      (response.status().has_error() &&
+          response.status().error().code() == consensus::ConsensusErrorPB::CANNOT_PREPARE)) {
     // Again, let the queue know that the remote is still responsive, since we will not be sending
     // this error response through to the queue.
     queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
-    ProcessResponseError(StatusFromPB(response_.error().status()));
+    ProcessResponseError(request, StatusFromPB(response.error().status()));
     return;
   }
 
   // The queue's handling of the peer response may generate IO (reads against the WAL) and
   // SendNextRequest() may do the same thing. So we run the rest of the response handling logic on
   // our thread pool and not on the reactor thread.
-  Status s = thread_pool_->SubmitClosure(Bind(&Peer::DoProcessResponse, Unretained(this)));
+  Status s = thread_pool_->SubmitFunc(std::bind(&Peer::DoProcessResponse, this, request));
   if (PREDICT_FALSE(!s.ok())) {
     LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Unable to process peer response: " << s.ToString()
-        << ": " << response_.ShortDebugString();
+        << ": " << response.ShortDebugString();
+    queue_->RequestFailed(peer_pb_.permanent_uuid(), request->info);
+    delete request;
     sem_.Release();
   }
 }
 
-void Peer::DoProcessResponse() {
+void Peer::DoProcessResponse(InFlightRequest* request) {
+  std::unique_ptr<InFlightRequest> request_holder(request);
   failed_attempts_ = 0;
 
   bool more_pending;
-  queue_->ResponseFromPeer(peer_pb_.permanent_uuid(), response_, &more_pending);
+  queue_->ResponseFromPeer(
+      peer_pb_.permanent_uuid(), request->response, &more_pending, &request->info);
+  request_holder.reset();
 
   // We're OK to read the state_ without a lock here -- if we get a race,
   // the worst thing that could happen is that we'll make one more request before
@@ -332,11 +389,19 @@ Status Peer::SendRemoteBootstrapRequest() {
     return STATUS(NotSupported, "remote bootstrap is disabled");
   }
 
+  if (rb_in_flight_.exchange(true)) {
+    return STATUS(IllegalState, "Remote bootstrap request is already in flight");
+  }
+
   LOG_WITH_PREFIX_UNLOCKED(INFO) << "Sending request to remotely bootstrap";
-  RETURN_NOT_OK(queue_->GetRemoteBootstrapRequestForPeer(peer_pb_.permanent_uuid(), &rb_request_));
-  controller_.Reset();
+  Status s = queue_->GetRemoteBootstrapRequestForPeer(peer_pb_.permanent_uuid(), &rb_request_);
+  if (!s.ok()) {
+    rb_in_flight_ = false;
+    return s;
+  }
+  rb_controller_.Reset();
   proxy_->StartRemoteBootstrap(
-      &rb_request_, &rb_response_, &controller_,
+      &rb_request_, &rb_response_, &rb_controller_,
       std::bind(&Peer::ProcessRemoteBootstrapResponse, this));
   return Status::OK();
 }
@@ -347,15 +412,18 @@ void Peer::ProcessRemoteBootstrapResponse() {
     LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Unable to begin remote bootstrap on peer: "
                                       << rb_response_.ShortDebugString();
   }
+  rb_in_flight_ = false;
   sem_.Release();
 }
 
-void Peer::ProcessResponseError(const Status& status) {
+void Peer::ProcessResponseError(InFlightRequest* request, const Status& status) {
   failed_attempts_++;
   LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Couldn't send request to peer " << peer_pb_.permanent_uuid()
       << " for tablet " << tablet_id_
       << " Status: " << status.ToString() << ". Retrying in the next heartbeat period."
       << " Already tried " << failed_attempts_ << " times.";
+  queue_->RequestFailed(peer_pb_.permanent_uuid(), request->info);
+  delete request;
   sem_.Release();
 }
 
@@ -377,14 +445,16 @@ void Peer::Close() {
   }
   LOG_WITH_PREFIX_UNLOCKED(INFO) << "Closing peer: " << peer_pb_.permanent_uuid();
 
-  // Acquire the semaphore to wait for any concurrent request to finish.  They will see the state_
-  // == kPeerClosed and not start any new requests, but we can't currently cancel the already-sent
-  // ones. (see KUDU-699)
-  std::lock_guard<Semaphore> l(sem_);
+  // Acquire all units of the semaphore to wait for any concurrent requests to finish.  They will
+  // see the state_ == kPeerClosed and not start any new requests, but we can't currently cancel the
+  // already-sent ones. (see KUDU-699)
+  for (int i = 0; i != max_requests_in_flight_; ++i) {
+    sem_.Acquire();
+  }
   queue_->UntrackPeer(peer_pb_.permanent_uuid());
-  // We don't own the ops (the queue does).
-  request_.mutable_ops()->ExtractSubrange(0, request_.ops_size(), nullptr);
-  replicate_msg_refs_.clear();
+  for (int i = 0; i != max_requests_in_flight_; ++i) {
+    sem_.Release();
+  }
 }
 
 Peer::~Peer() {
@@ -392,15 +462,24 @@ Peer::~Peer() {
 }
 
 RpcPeerProxy::RpcPeerProxy(gscoped_ptr<HostPort> hostport,
-                           gscoped_ptr<ConsensusServiceProxy> consensus_proxy)
+                           gscoped_ptr<ConsensusServiceProxy> consensus_proxy,
+                           std::shared_ptr<MultiRaftHeartbeatBatcher> batcher)
     : hostport_(hostport.Pass()),
-      consensus_proxy_(consensus_proxy.Pass()) {
+      consensus_proxy_(consensus_proxy.Pass()),
+      batcher_(std::move(batcher)) {
 }
 
 void RpcPeerProxy::UpdateAsync(const ConsensusRequestPB* request,
                                ConsensusResponsePB* response,
                                rpc::RpcController* controller,
                                const rpc::ResponseCallback& callback) {
+  const int64_t committed_index = request->committed_index().index();
+  const bool advances_commit = committed_index > last_sent_committed_index_;
+  last_sent_committed_index_ = std::max(last_sent_committed_index_, committed_index);
+  if (batcher_ && !advances_commit && MultiRaftHeartbeatBatcher::CanBatch(*request)) {
+    batcher_->AddRequestToBatch(request, response, controller, callback);
+    return;
+  }
   controller->set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
   consensus_proxy_->UpdateConsensusAsync(*request, response, controller, callback);
 }
@@ -438,9 +517,7 @@ RpcPeerProxy::~RpcPeerProxy() {}
 
 namespace {
 
-Status CreateConsensusServiceProxyForHost(const shared_ptr<Messenger>& messenger,
-                                          const HostPort& hostport,
-                                          gscoped_ptr<ConsensusServiceProxy>* new_proxy) {
+Status ResolvePeerAddress(const HostPort& hostport, Endpoint* endpoint) {
   std::vector<Endpoint> addrs;
   RETURN_NOT_OK(hostport.ResolveAddresses(&addrs));
   if (addrs.size() > 1) {
@@ -448,22 +525,37 @@ Status CreateConsensusServiceProxyForHost(const shared_ptr<Messenger>& messenger
                  << "resolves to " << addrs.size() << " different addresses. Using "
                  << addrs[0];
   }
-  new_proxy->reset(new ConsensusServiceProxy(messenger, addrs[0]));
+  *endpoint = addrs[0];
+  return Status::OK();
+}
+
+Status CreateConsensusServiceProxyForHost(const shared_ptr<Messenger>& messenger,
+                                          const HostPort& hostport,
+                                          gscoped_ptr<ConsensusServiceProxy>* new_proxy) {
+  Endpoint endpoint;
+  RETURN_NOT_OK(ResolvePeerAddress(hostport, &endpoint));
+  new_proxy->reset(new ConsensusServiceProxy(messenger, endpoint));
   return Status::OK();
 }
 
 } // anonymous namespace
 
-RpcPeerProxyFactory::RpcPeerProxyFactory(shared_ptr<Messenger> messenger)
-    : messenger_(std::move(messenger)) {}
+RpcPeerProxyFactory::RpcPeerProxyFactory(shared_ptr<Messenger> messenger,
+                                         MultiRaftManager* multi_raft_manager)
+    : messenger_(std::move(messenger)), multi_raft_manager_(multi_raft_manager) {}
 
 Status RpcPeerProxyFactory::NewProxy(const RaftPeerPB& peer_pb,
                                      gscoped_ptr<PeerProxy>* proxy) {
   gscoped_ptr<HostPort> hostport(new HostPort);
   RETURN_NOT_OK(HostPortFromPB(peer_pb.last_known_addr(), hostport.get()));
-  gscoped_ptr<ConsensusServiceProxy> new_proxy;
-  RETURN_NOT_OK(CreateConsensusServiceProxyForHost(messenger_, *hostport, &new_proxy));
-  proxy->reset(new RpcPeerProxy(hostport.Pass(), new_proxy.Pass()));
+  Endpoint endpoint;
+  RETURN_NOT_OK(ResolvePeerAddress(*hostport, &endpoint));
+  gscoped_ptr<ConsensusServiceProxy> new_proxy(new ConsensusServiceProxy(messenger_, endpoint));
+  std::shared_ptr<MultiRaftHeartbeatBatcher> batcher;
+  if (multi_raft_manager_) {
+    batcher = multi_raft_manager_->AddOrGetBatcher(endpoint);
+  }
+  proxy->reset(new RpcPeerProxy(hostport.Pass(), new_proxy.Pass(), std::move(batcher)));
   return Status::OK();
 }
 
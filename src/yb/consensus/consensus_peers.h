@@ -33,7 +33,9 @@
 #ifndef YB_CONSENSUS_CONSENSUS_PEERS_H_
 #define YB_CONSENSUS_CONSENSUS_PEERS_H_
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -60,6 +62,8 @@ class Log;
 
 namespace consensus {
 class ConsensusServiceProxy;
+class MultiRaftHeartbeatBatcher;
+class MultiRaftManager;
 class PeerProxy;
 class PeerProxyFactory;
 class PeerMessageQueue;
@@ -116,6 +120,10 @@ class VoteResponsePB;
 //        v                               v
 //  SignalRequest()                    return
 //
+// Up to FLAGS_consensus_max_requests_in_flight_per_peer requests could be in flight at the same
+// time, so "processing" above means that all of them are in flight. Requests are assembled and
+// sent one at a time, so the peer receives them in order in the common case, and the queue takes
+// care of responses that arrive out of order or that report failures.
 class Peer {
  public:
   // Initializes a peer and get its status.
@@ -157,15 +165,18 @@ class Peer {
        gscoped_ptr<PeerProxy> proxy, PeerMessageQueue* queue,
        ThreadPool* thread_pool, Consensus* consensus);
 
+  // Update request that was sent to the peer and whose response was not processed yet.
+  struct InFlightRequest;
+
   void SendNextRequest(RequestTriggerMode trigger_mode);
 
   // Signals that a response was received from the peer.  This method is called from the reactor
   // thread and calls DoProcessResponse() on thread_pool_ to do any work that requires IO or
   // lock-taking.
-  void ProcessResponse();
+  void ProcessResponse(InFlightRequest* request);
 
   // Run on 'thread_pool'. Does response handling that requires IO or may block.
-  void DoProcessResponse();
+  void DoProcessResponse(InFlightRequest* request);
 
   // Fetch the desired remote bootstrap request from the queue and send it to the peer. The callback
   // goes to ProcessRemoteBootstrapResponse().
@@ -178,7 +189,7 @@ class Peer {
   void ProcessRemoteBootstrapResponse();
 
   // Signals there was an error sending the request to the peer.
-  void ProcessResponseError(const Status& status);
+  void ProcessResponseError(InFlightRequest* request, const Status& status);
 
   std::string LogPrefixUnlocked() const;
 
@@ -192,26 +203,30 @@ class Peer {
   gscoped_ptr<PeerProxy> proxy_;
 
   PeerMessageQueue* queue_;
-  uint64_t failed_attempts_;
+  std::atomic<uint64_t> failed_attempts_;
+
+  // Maximal number of update requests in flight.
+  const int max_requests_in_flight_;
+
+  // Serializes assembling and sending of requests, so they are sent in the order of their ops.
+  std::mutex send_mutex_;
 
-  // The latest consensus update request and response.
-  ConsensusRequestPB request_;
-  ConsensusResponsePB response_;
+  // Committed index sent with the latest update request. Protected by send_mutex_.
+  int64_t last_sent_committed_index_;
+
+  // Responder term set to responses before sending, for tests.
+  int64_t term_for_tests_ = -1;
 
   // The latest remote bootstrap request and response.
   StartRemoteBootstrapRequestPB rb_request_;
   StartRemoteBootstrapResponsePB rb_response_;
+  rpc::RpcController rb_controller_;
 
-  // Reference-counted pointers to any ReplicateMsgs which are in-flight to the peer. We may have
-  // loaded these messages from the LogCache, in which case we are potentially sharing the same
-  // object as other peers. Since the PB request_ itself can't hold reference counts, this holds
-  // them.
-  ReplicateMsgs replicate_msg_refs_;
-
-  rpc::RpcController controller_;
+  // Whether the remote bootstrap request is in flight.
+  std::atomic<bool> rb_in_flight_{false};
 
-  // Held if there is an outstanding request.  This is used in order to ensure that we only have a
-  // single request oustanding at a time, and to wait for the outstanding requests at Close().
+  // Each in flight request holds a unit.  This is used in order to limit the number of requests
+  // in flight to max_requests_in_flight_, and to wait for the outstanding requests at Close().
   Semaphore sem_;
 
   // Heartbeater for remote peer implementations.  This will send status only requests to the remote
@@ -292,8 +307,10 @@ class PeerProxyFactory {
 // PeerProxy implementation that does RPC calls
 class RpcPeerProxy : public PeerProxy {
  public:
+  // If batcher is not null, heartbeats are sent through it.
   RpcPeerProxy(gscoped_ptr<HostPort> hostport,
-               gscoped_ptr<ConsensusServiceProxy> consensus_proxy);
+               gscoped_ptr<ConsensusServiceProxy> consensus_proxy,
+               std::shared_ptr<MultiRaftHeartbeatBatcher> batcher = nullptr);
 
   virtual void UpdateAsync(const ConsensusRequestPB* request,
                            ConsensusResponsePB* response,
@@ -325,12 +342,20 @@ class RpcPeerProxy : public PeerProxy {
  private:
   gscoped_ptr<HostPort> hostport_;
   gscoped_ptr<ConsensusServiceProxy> consensus_proxy_;
+  std::shared_ptr<MultiRaftHeartbeatBatcher> batcher_;
+
+  // Committed index of the last request sent to the peer. Requests advancing it are not batched,
+  // so followers learn about commits without the batch window delay. UpdateAsync calls are
+  // serialized by the peer, so no locking is needed.
+  int64_t last_sent_committed_index_ = -1;
 };
 
 // PeerProxyFactory implementation that generates RPCPeerProxies
 class RpcPeerProxyFactory : public PeerProxyFactory {
  public:
-  explicit RpcPeerProxyFactory(std::shared_ptr<rpc::Messenger> messenger);
+  // multi_raft_manager could be null, in that case heartbeats are not batched.
+  explicit RpcPeerProxyFactory(std::shared_ptr<rpc::Messenger> messenger,
+                               MultiRaftManager* multi_raft_manager = nullptr);
 
   virtual CHECKED_STATUS NewProxy(const RaftPeerPB& peer_pb,
                           gscoped_ptr<PeerProxy>* proxy) override;
@@ -338,6 +363,7 @@ class RpcPeerProxyFactory : public PeerProxyFactory {
   virtual ~RpcPeerProxyFactory();
  private:
   std::shared_ptr<rpc::Messenger> messenger_;
+  MultiRaftManager* const multi_raft_manager_;
 };
 
 // Query the consensus service at last known host/port that is specified in 'remote_peer' and set
@@ -334,6 +334,86 @@ TEST_F(ConsensusQueueTest, TestGetPagedMessages) {
   request.mutable_ops()->ExtractSubrange(0, request.ops_size(), nullptr);
 }
 
+// Tests that next_index of a peer is advanced past the ops of a request before it is acked when
+// pipelining is allowed, and that it is moved back when a pipelined request fails.
+TEST_F(ConsensusQueueTest, TestPipelinedRequests) {
+  queue_->Init(MinimumOpId());
+  queue_->SetLeaderMode(MinimumOpId(), MinimumOpId().term(), BuildRaftConfigPBForTests(2));
+
+  // Use small batches, so 100 ops don't fit into a single request.
+  google::FlagSaver saver;
+  FLAGS_consensus_max_batch_size_bytes = 1024;
+
+  ConsensusRequestPB request;
+  ConsensusResponsePB response;
+  response.set_responder_uuid(kPeerUuid);
+  bool more_pending = false;
+
+  UpdatePeerWatermarkToOp(&request, &response, MinimumOpId(), MinimumOpId(), &more_pending);
+  AppendReplicateMessagesToQueue(queue_.get(), clock_, 1, 100);
+
+  // The last exchange was not successful, so the first request is not pipelined.
+  ReplicateMsgs refs;
+  bool needs_remote_bootstrap;
+  PeerRequestInfo info1;
+  info1.allow_pipelining = true;
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &request, &refs, &needs_remote_bootstrap, nullptr,
+                                   nullptr, &info1));
+  ASSERT_FALSE(info1.pipelined);
+  ASSERT_GT(request.ops_size(), 0);
+  ASSERT_LT(request.ops_size(), 100);
+  OpId last = request.ops(request.ops_size() - 1).id();
+  SetLastReceivedAndLastCommitted(&response, last);
+  queue_->ResponseFromPeer(response.responder_uuid(), response, &more_pending, &info1);
+  ASSERT_TRUE(more_pending);
+  request.mutable_ops()->ExtractSubrange(0, request.ops_size(), nullptr);
+
+  // The following requests are assembled without waiting for responses.
+  ConsensusRequestPB request2;
+  PeerRequestInfo info2;
+  info2.allow_pipelining = true;
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &request2, &refs, &needs_remote_bootstrap, nullptr,
+                                   nullptr, &info2));
+  ASSERT_TRUE(info2.pipelined);
+  ASSERT_TRUE(info2.more_pending);
+  ASSERT_EQ(last.index() + 1, request2.ops(0).id().index());
+
+  ConsensusRequestPB request3;
+  PeerRequestInfo info3;
+  info3.allow_pipelining = true;
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &request3, &refs, &needs_remote_bootstrap, nullptr,
+                                   nullptr, &info3));
+  ASSERT_TRUE(info3.pipelined);
+  ASSERT_EQ(request2.ops(request2.ops_size() - 1).id().index() + 1,
+            request3.ops(0).id().index());
+
+  // The second request failed, so its ops should be sent again.
+  queue_->RequestFailed(kPeerUuid, info2);
+  ConsensusRequestPB request4;
+  PeerRequestInfo info4;
+  info4.allow_pipelining = true;
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &request4, &refs, &needs_remote_bootstrap, nullptr,
+                                   nullptr, &info4));
+  ASSERT_EQ(request2.ops(0).id().index(), request4.ops(0).id().index());
+  const int64_t next_index = request4.ops(request4.ops_size() - 1).id().index() + 1;
+  ASSERT_EQ(next_index, queue_->GetTrackedPeerForTests(kPeerUuid).next_index);
+
+  // The peer rejects the third request, since it did not receive the second one. This response is
+  // obsolete and should not move next_index back.
+  RefuseWithLogPropertyMismatch(&response, last, last);
+  queue_->ResponseFromPeer(response.responder_uuid(), response, &more_pending, &info3);
+  ASSERT_FALSE(more_pending);
+  ASSERT_EQ(next_index, queue_->GetTrackedPeerForTests(kPeerUuid).next_index);
+
+  // Failure of an obsolete request is ignored as well.
+  queue_->RequestFailed(kPeerUuid, info3);
+  ASSERT_EQ(next_index, queue_->GetTrackedPeerForTests(kPeerUuid).next_index);
+
+  for (auto* req : {&request2, &request3, &request4}) {
+    req->mutable_ops()->ExtractSubrange(0, req->ops_size(), nullptr);
+  }
+}
+
 TEST_F(ConsensusQueueTest, TestPeersDontAckBeyondWatermarks) {
   queue_->Init(MinimumOpId());
   queue_->SetLeaderMode(MinimumOpId(), MinimumOpId().term(), BuildRaftConfigPBForTests(3));
@@ -304,10 +304,14 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
                                         ReplicateMsgs* msg_refs,
                                         bool* needs_remote_bootstrap,
                                         RaftPeerPB::MemberType* member_type,
-                                        bool* last_exchange_successful) {
+                                        bool* last_exchange_successful,
+                                        PeerRequestInfo* request_info) {
   TrackedPeer* peer = nullptr;
   OpId preceding_id;
   MonoDelta unreachable_time = MonoDelta::kMin;
+  bool is_new;
+  int64_t next_index;
+  bool allow_pipelining = false;
   {
     LockGuard lock(queue_lock_);
     DCHECK_EQ(queue_state_.state, State::kQueueOpen);
@@ -325,6 +329,18 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     peer->last_leader_lease_expiration_sent_to_follower =
         MonoTime::FineNow() + MonoDelta::FromMilliseconds(FLAGS_leader_lease_duration_ms);
     peer->last_ht_lease_expiration_sent_to_follower = ht_lease_expiration_micros;
+    if (request_info) {
+      request_info->leader_lease_expiration = peer->last_leader_lease_expiration_sent_to_follower;
+      request_info->ht_lease_expiration = ht_lease_expiration_micros;
+      request_info->generation = peer->pipeline_generation;
+      request_info->pipelined = false;
+      request_info->more_pending = false;
+      allow_pipelining = request_info->allow_pipelining && peer->is_last_exchange_successful;
+    }
+
+    // Other requests to this peer could be in flight, so next_index is read under the lock.
+    is_new = peer->is_new;
+    next_index = peer->next_index;
 
     // Clear the requests without deleting the entries, as they may be in use by other peers.
     request->mutable_ops()->ExtractSubrange(0, request->ops_size(), nullptr);
@@ -363,14 +379,14 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
   // If we've never communicated with the peer, we don't know what messages to
   // send, so we'll send a status-only request. Otherwise, we grab requests
   // from the log starting at the last_received point.
-  if (!peer->is_new) {
+  if (!is_new) {
     DCHECK_LT(FLAGS_consensus_max_batch_size_bytes + 1_KB, FLAGS_rpc_max_message_size);
     // The batch of messages to send to the peer.
     ReplicateMsgs messages;
     int max_batch_size = FLAGS_consensus_max_batch_size_bytes - request->ByteSize();
 
     // We try to get the follower's next_index from our log.
-    Status s = log_cache_.ReadOps(peer->next_index - 1,
+    Status s = log_cache_.ReadOps(next_index - 1,
                                   max_batch_size,
                                   &messages,
                                   &preceding_id);
@@ -407,6 +423,17 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     }
     msg_refs->swap(messages);
     DCHECK_LE(request->ByteSize(), FLAGS_consensus_max_batch_size_bytes);
+
+    if (allow_pipelining && request->ops_size() > 0) {
+      LockGuard lock(queue_lock_);
+      // Requests to the same peer are assembled one at a time, so next_index could change since
+      // it was read only if it was moved back by a response, which also changes the generation.
+      if (peer->pipeline_generation == request_info->generation) {
+        peer->next_index = request->ops(request->ops_size() - 1).id().index() + 1;
+        request_info->pipelined = true;
+        request_info->more_pending = log_cache_.HasOpBeenWritten(peer->next_index);
+      }
+    }
   }
 
   DCHECK(preceding_id.IsInitialized());
@@ -611,9 +638,22 @@ void PeerMessageQueue::NotifyPeerIsResponsiveDespiteError(const std::string& pee
   peer->last_successful_communication_time = MonoTime::Now(MonoTime::FINE);
 }
 
+void PeerMessageQueue::RequestFailed(const std::string& peer_uuid,
+                                     const PeerRequestInfo& request_info) {
+  LockGuard l(queue_lock_);
+  TrackedPeer* peer = FindPtrOrNull(peers_map_, peer_uuid);
+  if (!peer || !request_info.pipelined || request_info.generation != peer->pipeline_generation) {
+    return;
+  }
+  // Resume sending after the last op acked by the peer, requests in flight become obsolete.
+  peer->next_index = peer->last_received.index() + 1;
+  ++peer->pipeline_generation;
+}
+
 void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
                                         const ConsensusResponsePB& response,
-                                        bool* more_pending) {
+                                        bool* more_pending,
+                                        const PeerRequestInfo* request_info) {
   DCHECK(response.IsInitialized()) << "Error: Uninitialized: "
       << response.InitializationErrorString() << ". Response: " << response.ShortDebugString();
 
@@ -673,6 +713,18 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
 
     const ConsensusStatusPB& status = response.status();
 
+    // The request was sent before next_index was moved back, so the peer state is already being
+    // recovered by the requests sent after it.
+    const bool obsolete = request_info != nullptr &&
+                          request_info->generation != peer->pipeline_generation;
+    if (obsolete && status.has_error() &&
+        status.error().code() == ConsensusErrorPB::PRECEDING_ENTRY_DIDNT_MATCH) {
+      VLOG_WITH_PREFIX_UNLOCKED(1) << "Ignoring LMP mismatch for obsolete request to peer: "
+                                   << peer->ToString();
+      *more_pending = false;
+      return;
+    }
+
     // Take a snapshot of the current peer status.
     TrackedPeer previous = *peer;
 
@@ -687,18 +739,28 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
     // sent them anything, start after the last-committed op in their log, which
     // is guaranteed by the Raft protocol to be a valid op.
 
+    // When several requests are in flight, their responses could arrive out of order, so
+    // last_received is not moved back by a response to an earlier request.
+    auto update_last_received = [peer, request_info](const OpId& last_received) {
+      if (request_info == nullptr || last_received.index() > peer->last_received.index() ||
+          !peer->is_last_exchange_successful) {
+        peer->last_received = last_received;
+      }
+    };
+
+    int64_t next_index;
     bool peer_has_prefix_of_log = IsOpInLog(status.last_received());
     if (peer_has_prefix_of_log) {
       // If the latest thing in their log is in our log, we are in sync.
-      peer->last_received = status.last_received();
-      peer->next_index = peer->last_received.index() + 1;
+      update_last_received(status.last_received());
+      next_index = status.last_received().index() + 1;
 
     } else if (!OpIdEquals(status.last_received_current_leader(), MinimumOpId())) {
       // Their log may have diverged from ours, however we are in the process
       // of replicating our ops to them, so continue doing so. Eventually, we
       // will cause the divergent entry in their log to be overwritten.
-      peer->last_received = status.last_received_current_leader();
-      peer->next_index = peer->last_received.index() + 1;
+      update_last_received(status.last_received_current_leader());
+      next_index = status.last_received_current_leader().index() + 1;
 
     } else {
       // The peer is divergent and they have not (successfully) received
@@ -708,7 +770,19 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
       // error, we jump back to the last committed op indicated by the peer with
       // the hope that doing so will result in a faster catch-up process.
       DCHECK_GE(peer->last_known_committed_idx, 0);
-      peer->next_index = peer->last_known_committed_idx + 1;
+      next_index = peer->last_known_committed_idx + 1;
+    }
+
+    if (request_info == nullptr || status.has_error()) {
+      // Without pipelining, or after an error, next_index follows the peer state.
+      if (request_info != nullptr && next_index < peer->next_index) {
+        // Requests that are in flight were assembled for the old next_index.
+        ++peer->pipeline_generation;
+      }
+      peer->next_index = next_index;
+    } else if (!obsolete) {
+      // Ops after next_index could be already sent by other requests in flight.
+      peer->next_index = std::max(peer->next_index, next_index);
     }
 
     if (PREDICT_FALSE(status.has_error())) {
@@ -776,11 +850,20 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
       }
       majority_replicated.op_id = queue_state_.majority_replicated_opid;
 
-      peer->last_leader_lease_expiration_received_by_follower =
-          peer->last_leader_lease_expiration_sent_to_follower;
+      if (request_info) {
+        // Later requests could be already sent, so use the leases of the acked one.
+        peer->last_leader_lease_expiration_received_by_follower.MakeAtLeast(
+            request_info->leader_lease_expiration);
+        peer->last_ht_lease_expiration_received_by_follower = std::max(
+            peer->last_ht_lease_expiration_received_by_follower,
+            request_info->ht_lease_expiration);
+      } else {
+        peer->last_leader_lease_expiration_received_by_follower =
+            peer->last_leader_lease_expiration_sent_to_follower;
 
-      peer->last_ht_lease_expiration_received_by_follower =
-          peer->last_ht_lease_expiration_sent_to_follower;
+        peer->last_ht_lease_expiration_received_by_follower =
+            peer->last_ht_lease_expiration_sent_to_follower;
+      }
 
       majority_replicated.leader_lease_expiration = LeaderLeaseExpirationWatermark();
 
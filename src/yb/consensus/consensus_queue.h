@@ -76,6 +76,27 @@ struct MajorityReplicatedData;
 // The id for the server-wide consensus queue MemTracker.
 extern const char kConsensusQueueParentTrackerId[];
 
+// Describes a request to a peer, so its response could be handled correctly when several requests
+// to the same peer are in flight.
+struct PeerRequestInfo {
+  // Whether next_index of the peer could be advanced past the ops of the request before they are
+  // acked by the peer. Set by the caller of RequestForPeer().
+  bool allow_pipelining = false;
+
+  // Whether next_index of the peer was advanced past the ops of this request.
+  bool pipelined = false;
+
+  // Whether the queue has ops for the peer after the ones included in this request.
+  bool more_pending = false;
+
+  // Value of TrackedPeer::pipeline_generation when the request was assembled.
+  int64_t generation = 0;
+
+  // Lease expirations sent to the peer with this request.
+  MonoTime leader_lease_expiration;
+  MicrosTime ht_lease_expiration = HybridTime::kMin.GetPhysicalValueMicros();
+};
+
 // Tracks the state of the peers and which transactions they have replicated.  Owns the LogCache
 // which actually holds the replicate messages which are en route to the various peers.
 //
@@ -84,8 +105,9 @@ extern const char kConsensusQueueParentTrackerId[];
 //
 // This class is used only on the LEADER side.
 //
-// TODO Currently this class is able to track one outstanding operation per peer. If we want to have
-// more than one outstanding RPC we need to modify it.
+// Several requests to the same peer could be in flight, see PeerRequestInfo. In this case
+// next_index of the peer is advanced when a request is assembled, and moved back when a request
+// fails or the peer reports a log mismatch.
 class PeerMessageQueue {
  public:
   struct TrackedPeer {
@@ -112,6 +134,10 @@ class PeerMessageQueue {
     // Next index to send to the peer.  This corresponds to "nextIndex" as specified in Raft.
     int64_t next_index = kInvalidOpIdIndex;
 
+    // Incremented each time next_index is moved back, so requests that were in flight at this
+    // moment became obsolete. Responses to obsolete requests don't move next_index.
+    int64_t pipeline_generation = 0;
+
     // The last operation that we've sent to this peer and that it acked. Used for watermark
     // movement.
     OpId last_received;
@@ -235,7 +261,8 @@ class PeerMessageQueue {
       ReplicateMsgs* msg_refs,
       bool* needs_remote_bootstrap,
       RaftPeerPB::MemberType* member_type = nullptr,
-      bool* last_exchange_successful = nullptr);
+      bool* last_exchange_successful = nullptr,
+      PeerRequestInfo* request_info = nullptr);
 
   // Fill in a StartRemoteBootstrapRequest for the specified peer.  If that peer should not remotely
   // bootstrap, returns a non-OK status.  On success, also internally resets
@@ -250,10 +277,16 @@ class PeerMessageQueue {
   void NotifyPeerIsResponsiveDespiteError(const std::string& peer_uuid);
 
   // Updates the request queue with the latest response of a peer, returns whether this peer has
-  // more requests pending.
+  // more requests pending. request_info should be the info filled by RequestForPeer() for the
+  // request this response belongs to, if it was requested.
   virtual void ResponseFromPeer(const std::string& peer_uuid,
                                 const ConsensusResponsePB& response,
-                                bool* more_pending);
+                                bool* more_pending,
+                                const PeerRequestInfo* request_info = nullptr);
+
+  // Notifies the queue that the request was not delivered to the peer, so ops of this request and
+  // of the requests sent after it should be sent again.
+  void RequestFailed(const std::string& peer_uuid, const PeerRequestInfo& request_info);
 
   // Closes the queue, peers are still allowed to call UntrackPeer() and ResponseFromPeer() but no
   // additional peers can be tracked or messages queued.
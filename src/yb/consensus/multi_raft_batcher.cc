@@ -0,0 +1,173 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/consensus/multi_raft_batcher.h"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "yb/rpc/messenger.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/metrics.h"
+#include "yb/util/monotime.h"
+
+DEFINE_bool(enable_multi_raft_heartbeat_batcher, true,
+            "Whether heartbeats of tablets, that are sent to the same tablet server, should be "
+            "folded into a single RPC.");
+TAG_FLAG(enable_multi_raft_heartbeat_batcher, advanced);
+
+DEFINE_int32(multi_raft_heartbeat_batch_window_ms, 10,
+             "How long heartbeats to the same tablet server are collected before they are sent "
+             "as a single RPC. Delays every batched heartbeat, so should be significantly less "
+             "than raft_heartbeat_interval_ms.");
+TAG_FLAG(multi_raft_heartbeat_batch_window_ms, advanced);
+
+DECLARE_int32(consensus_rpc_timeout_ms);
+
+METRIC_DEFINE_counter(server, multi_raft_batched_heartbeats,
+                      "Batched Raft Heartbeats",
+                      yb::MetricUnit::kRequests,
+                      "Number of Raft heartbeats that were sent as part of a MultiRaftUpdateConsensus "
+                      "RPC.");
+
+METRIC_DEFINE_counter(server, multi_raft_heartbeat_rpcs_saved,
+                      "Raft Heartbeat RPCs Saved",
+                      yb::MetricUnit::kRequests,
+                      "Number of RPCs that were not sent, because Raft heartbeats were batched.");
+
+namespace yb {
+namespace consensus {
+
+MultiRaftHeartbeatBatcher::MultiRaftHeartbeatBatcher(
+    const std::shared_ptr<rpc::Messenger>& messenger,
+    const Endpoint& endpoint,
+    scoped_refptr<Counter> batched_heartbeats,
+    scoped_refptr<Counter> rpcs_saved)
+    : messenger_(messenger),
+      endpoint_(endpoint),
+      proxy_(messenger, endpoint),
+      batched_heartbeats_(std::move(batched_heartbeats)),
+      rpcs_saved_(std::move(rpcs_saved)) {
+}
+
+bool MultiRaftHeartbeatBatcher::CanBatch(const ConsensusRequestPB& request) {
+  return FLAGS_enable_multi_raft_heartbeat_batcher && request.ops_size() == 0;
+}
+
+void MultiRaftHeartbeatBatcher::AddRequestToBatch(const ConsensusRequestPB* request,
+                                                  ConsensusResponsePB* response,
+                                                  rpc::RpcController* controller,
+                                                  const rpc::ResponseCallback& callback) {
+  bool schedule = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!current_batch_) {
+      current_batch_ = std::make_shared<Batch>();
+      schedule = true;
+    }
+    current_batch_->queued.push_back({request, response, controller, callback});
+  }
+  if (schedule) {
+    messenger_->ScheduleOnReactor(
+        std::bind(&MultiRaftHeartbeatBatcher::SendBatch, shared_from_this(),
+                  std::placeholders::_1),
+        MonoDelta::FromMilliseconds(FLAGS_multi_raft_heartbeat_batch_window_ms));
+  }
+}
+
+void MultiRaftHeartbeatBatcher::SendBatch(const Status& status) {
+  std::shared_ptr<Batch> batch;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    batch.swap(current_batch_);
+  }
+  if (!batch) {
+    return;
+  }
+
+  if (!status.ok()) {
+    // The scheduled task was aborted, for instance because the messenger is shutting down.
+    SendIndividually(batch.get());
+    return;
+  }
+
+  if (batch->queued.size() == 1) {
+    // Nothing to fold, avoid the overhead of the batched RPC.
+    SendIndividually(batch.get());
+    return;
+  }
+
+  for (const auto& queued : batch->queued) {
+    *batch->request.add_consensus_request() = *queued.request;
+  }
+  batch->controller.set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
+  proxy_.MultiRaftUpdateConsensusAsync(
+      batch->request, &batch->response, &batch->controller,
+      std::bind(&MultiRaftHeartbeatBatcher::ProcessResponse, shared_from_this(), batch));
+}
+
+void MultiRaftHeartbeatBatcher::ProcessResponse(const std::shared_ptr<Batch>& batch) {
+  const auto num_requests = batch->queued.size();
+  if (!batch->controller.status().ok() ||
+      static_cast<size_t>(batch->response.consensus_response_size()) != num_requests) {
+    LOG(WARNING) << "Batched heartbeat RPC to " << endpoint_ << " failed: "
+                 << batch->controller.status().ToString() << ", got "
+                 << batch->response.consensus_response_size() << " responses for "
+                 << num_requests << " requests. Sending heartbeats one by one.";
+    SendIndividually(batch.get());
+    return;
+  }
+
+  if (batched_heartbeats_) {
+    batched_heartbeats_->IncrementBy(num_requests);
+    rpcs_saved_->IncrementBy(num_requests - 1);
+  }
+  for (size_t i = 0; i != num_requests; ++i) {
+    auto& queued = batch->queued[i];
+    queued.response->Swap(batch->response.mutable_consensus_response(i));
+    queued.callback();
+  }
+}
+
+void MultiRaftHeartbeatBatcher::SendIndividually(Batch* batch) {
+  for (const auto& queued : batch->queued) {
+    queued.controller->set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
+    proxy_.UpdateConsensusAsync(*queued.request, queued.response, queued.controller,
+                                queued.callback);
+  }
+}
+
+MultiRaftManager::MultiRaftManager(std::shared_ptr<rpc::Messenger> messenger,
+                                   const scoped_refptr<MetricEntity>& metric_entity)
+    : messenger_(std::move(messenger)) {
+  if (metric_entity) {
+    batched_heartbeats_ = METRIC_multi_raft_batched_heartbeats.Instantiate(metric_entity);
+    rpcs_saved_ = METRIC_multi_raft_heartbeat_rpcs_saved.Instantiate(metric_entity);
+  }
+}
+
+std::shared_ptr<MultiRaftHeartbeatBatcher> MultiRaftManager::AddOrGetBatcher(
+    const Endpoint& endpoint) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& weak_batcher = batchers_[endpoint];
+  auto batcher = weak_batcher.lock();
+  if (!batcher) {
+    batcher = std::make_shared<MultiRaftHeartbeatBatcher>(
+        messenger_, endpoint, batched_heartbeats_, rpcs_saved_);
+    weak_batcher = batcher;
+  }
+  return batcher;
+}
+
+} // namespace consensus
+} // namespace yb
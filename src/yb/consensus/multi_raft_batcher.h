@@ -0,0 +1,118 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+#define YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/consensus/consensus.pb.h"
+#include "yb/consensus/consensus.proxy.h"
+#include "yb/gutil/ref_counted.h"
+#include "yb/rpc/response_callback.h"
+#include "yb/rpc/rpc_controller.h"
+#include "yb/util/net/sockaddr.h"
+
+namespace yb {
+
+class Counter;
+class MetricEntity;
+
+namespace rpc {
+class Messenger;
+} // namespace rpc
+
+namespace consensus {
+
+// Folds UpdateConsensus requests without ops (i.e. heartbeats of idle tablets), that are sent by
+// tablets of this server to the same remote server, into a single MultiRaftUpdateConsensus RPC.
+//
+// The first request added to an empty batch schedules sending of the batch after
+// multi_raft_heartbeat_batch_window_ms. When the batched RPC completes, responses are demultiplexed
+// to the callers. If the batched RPC fails, its requests are resent one by one, so each caller
+// observes the RPC status in its own controller exactly like without batching.
+class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftHeartbeatBatcher> {
+ public:
+  MultiRaftHeartbeatBatcher(const std::shared_ptr<rpc::Messenger>& messenger,
+                            const Endpoint& endpoint,
+                            scoped_refptr<Counter> batched_heartbeats,
+                            scoped_refptr<Counter> rpcs_saved);
+
+  // Whether the request could be added to a batch.
+  static bool CanBatch(const ConsensusRequestPB& request);
+
+  // Has the same contract as PeerProxy::UpdateAsync(). The request and response should stay valid
+  // until the callback is invoked.
+  void AddRequestToBatch(const ConsensusRequestPB* request,
+                         ConsensusResponsePB* response,
+                         rpc::RpcController* controller,
+                         const rpc::ResponseCallback& callback);
+
+ private:
+  struct QueuedRequest {
+    const ConsensusRequestPB* request;
+    ConsensusResponsePB* response;
+    rpc::RpcController* controller;
+    rpc::ResponseCallback callback;
+  };
+
+  struct Batch {
+    std::vector<QueuedRequest> queued;
+    MultiRaftConsensusRequestPB request;
+    MultiRaftConsensusResponsePB response;
+    rpc::RpcController controller;
+  };
+
+  void SendBatch(const Status& status);
+  void ProcessResponse(const std::shared_ptr<Batch>& batch);
+
+  // Sends requests of the batch as separate UpdateConsensus RPCs.
+  void SendIndividually(Batch* batch);
+
+  std::shared_ptr<rpc::Messenger> messenger_;
+  const Endpoint endpoint_;
+  ConsensusServiceProxy proxy_;
+  scoped_refptr<Counter> batched_heartbeats_;
+  scoped_refptr<Counter> rpcs_saved_;
+
+  std::mutex mutex_;
+  // Batch that is being collected, null if there are no queued requests.
+  std::shared_ptr<Batch> current_batch_;
+};
+
+// Server wide registry of heartbeat batchers, one per remote server.
+class MultiRaftManager {
+ public:
+  MultiRaftManager(std::shared_ptr<rpc::Messenger> messenger,
+                   const scoped_refptr<MetricEntity>& metric_entity);
+
+  // Returns the batcher for the remote server at the specified endpoint. Batchers are shared by
+  // all proxies to the same server and destroyed when the last of them is destroyed.
+  std::shared_ptr<MultiRaftHeartbeatBatcher> AddOrGetBatcher(const Endpoint& endpoint);
+
+ private:
+  std::shared_ptr<rpc::Messenger> messenger_;
+  scoped_refptr<Counter> batched_heartbeats_;
+  scoped_refptr<Counter> rpcs_saved_;
+
+  std::mutex mutex_;
+  std::unordered_map<Endpoint, std::weak_ptr<MultiRaftHeartbeatBatcher>, EndpointHash> batchers_;
+};
+
+} // namespace consensus
+} // namespace yb
+
+#endif // YB_CONSENSUS_MULTI_RAFT_BATCHER_H
@@ -229,7 +229,8 @@ scoped_refptr<RaftConsensus> RaftConsensus::Create(
     const Callback<void(std::shared_ptr<StateChangeContext> context)> mark_dirty_clbk,
     TableType table_type,
     LostLeadershipListener lost_leadership_listener) {
-  gscoped_ptr<PeerProxyFactory> rpc_factory(new RpcPeerProxyFactory(messenger));
+  gscoped_ptr<PeerProxyFactory> rpc_factory(new RpcPeerProxyFactory(
+      messenger, options.multi_raft_manager));
 
   // The message queue that keeps track of which operations need to be replicated
   // where.
@@ -61,6 +61,8 @@
 
 DECLARE_int32(raft_heartbeat_interval_ms);
 DECLARE_bool(enable_leader_failure_detection);
+DECLARE_int32(consensus_max_batch_size_bytes);
+DECLARE_int32(consensus_max_requests_in_flight_per_peer);
 
 METRIC_DECLARE_entity(tablet);
 
@@ -407,6 +409,52 @@ class RaftConsensusQuorumTest : public YBTest {
     }
   }
 
+  // Appends num_ops messages to the leader of a 3 peer config, while update requests from the
+  // leader to followers are delayed by latency_ms, and waits for all of them to be replicated.
+  // Returns the replication throughput in ops per second.
+  void MeasureReplicationThroughput(int num_ops, int latency_ms, double* ops_per_second) {
+    const int kFollower0Idx = 0;
+    const int kFollower1Idx = 1;
+    const int kLeaderIdx = 2;
+
+    // Use small batches, so replication of the whole sequence takes multiple round trips.
+    FLAGS_consensus_max_batch_size_bytes = 1024;
+    ASSERT_OK(BuildAndStartConfig(3));
+    GetLeaderProxyToPeer(kFollower0Idx, kLeaderIdx)->SetLatencyMs(latency_ms);
+    GetLeaderProxyToPeer(kFollower1Idx, kLeaderIdx)->SetLatencyMs(latency_ms);
+
+    MonoTime start = MonoTime::Now(MonoTime::FINE);
+    vector<scoped_refptr<ConsensusRound>> rounds;
+    for (int i = 0; i < num_ops; i++) {
+      scoped_refptr<ConsensusRound> round;
+      ASSERT_OK(AppendDummyMessage(kLeaderIdx, &round));
+      rounds.push_back(round);
+    }
+    for (const auto& round : rounds) {
+      ASSERT_OK(WaitForReplicate(round.get()));
+    }
+    OpId last_op_id = rounds.back()->id();
+    WaitForReplicateIfNotAlreadyPresent(last_op_id, kFollower0Idx);
+    WaitForReplicateIfNotAlreadyPresent(last_op_id, kFollower1Idx);
+    MonoDelta elapsed = MonoTime::Now(MonoTime::FINE).GetDeltaSince(start);
+    *ops_per_second = num_ops / elapsed.ToSeconds();
+    LOG(INFO) << "Replicated " << num_ops << " ops with "
+              << FLAGS_consensus_max_requests_in_flight_per_peer << " requests in flight per peer "
+              << "and " << latency_ms << "ms latency in " << elapsed.ToString() << ": "
+              << *ops_per_second << " ops/sec";
+
+    GetLeaderProxyToPeer(kFollower0Idx, kLeaderIdx)->SetLatencyMs(0);
+    GetLeaderProxyToPeer(kFollower1Idx, kLeaderIdx)->SetLatencyMs(0);
+    shared_ptr<Synchronizer> commit_sync;
+    for (const auto& round : rounds) {
+      ASSERT_OK(CommitDummyMessage(kLeaderIdx, round.get(), &commit_sync));
+    }
+    ASSERT_OK(commit_sync->Wait());
+    WaitForCommitIfNotAlreadyPresent(last_op_id, kFollower0Idx, kLeaderIdx);
+    WaitForCommitIfNotAlreadyPresent(last_op_id, kFollower1Idx, kLeaderIdx);
+    VerifyLogs(kLeaderIdx, kFollower0Idx, kFollower1Idx);
+  }
+
   log::LogEntries GatherLogEntries(int idx, const scoped_refptr<Log>& log) {
     EXPECT_OK(log->WaitUntilAllFlushed());
     EXPECT_OK(log->Close());
@@ -809,6 +857,25 @@ TEST_F(RaftConsensusQuorumTest, TestReplicasHandleCommunicationErrors) {
   VerifyLogs(2, 0, 1);
 }
 
+// Replication with a single request in flight per peer, the baseline for
+// TestPipelinedReplicationThroughput.
+TEST_F(RaftConsensusQuorumTest, TestSequentialReplicationThroughput) {
+  FLAGS_consensus_max_requests_in_flight_per_peer = 1;
+  double ops_per_second = 0;
+  ASSERT_NO_FATALS(MeasureReplicationThroughput(AllowSlowTests() ? 2000 : 500, 10,
+                                                &ops_per_second));
+}
+
+// Replication with multiple requests in flight per peer. Responses could arrive out of order
+// and the followers could receive requests out of order, so this also checks that the logs end
+// up identical.
+TEST_F(RaftConsensusQuorumTest, TestPipelinedReplicationThroughput) {
+  FLAGS_consensus_max_requests_in_flight_per_peer = 4;
+  double ops_per_second = 0;
+  ASSERT_NO_FATALS(MeasureReplicationThroughput(AllowSlowTests() ? 2000 : 500, 10,
+                                                &ops_per_second));
+}
+
 // In this test we test the ability of the leader to send heartbeats
 // to replicas by simply pushing nothing after the configuration round
 // and still expecting for the replicas Update() hooks to be called.
@@ -13,6 +13,9 @@
 
 #include <regex>
 
+#include <lz4.h>
+#include <snappy.h>
+
 #include "yb/client/client.h"
 #include "yb/common/ql_protocol.pb.h"
 #include "yb/cqlserver/cql_message.h"
@@ -20,6 +23,7 @@
 
 #include "yb/gutil/endian.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/util/flag_tags.h"
 
 namespace yb {
 namespace cqlserver {
@@ -38,6 +42,13 @@ using util::to_char_ptr;
 
 DEFINE_bool(use_cassandra_authentication, false, "If to require authentication on startup.");
 
+DEFINE_int32(cql_compression_min_body_size, 64,
+             "Response bodies smaller than this are sent uncompressed even when the client "
+             "negotiated compression, since they could not be made any smaller.");
+TAG_FLAG(cql_compression_min_body_size, advanced);
+
+DECLARE_int32(max_message_length);
+
 #define RETURN_NOT_ENOUGH(sz)                               \
   do {                                                      \
     if (body_.size() < (sz)) {                              \
@@ -147,6 +158,80 @@ Status CQLMessage::QueryParameters::ValidateConsistency() {
   return Status::OK();
 }
 
+Status CQLMessage::CompressBody(
+    const CompressionScheme compression_scheme, const Slice& body, faststring* compressed) {
+  switch (compression_scheme) {
+    case CompressionScheme::LZ4: {
+      const size_t max_length = LZ4_compressBound(body.size());
+      compressed->resize(kIntSize + max_length);
+      NetworkByteOrder::Store32(compressed->data(), static_cast<uint32_t>(body.size()));
+      const int length = LZ4_compress_default(
+          to_char_ptr(body.data()), to_char_ptr(compressed->data() + kIntSize), body.size(),
+          max_length);
+      if (length <= 0) {
+        return STATUS(Corruption, "Failed to compress CQL message with LZ4");
+      }
+      compressed->resize(kIntSize + length);
+      return Status::OK();
+    }
+    case CompressionScheme::SNAPPY: {
+      compressed->resize(snappy::MaxCompressedLength(body.size()));
+      size_t length = 0;
+      snappy::RawCompress(
+          to_char_ptr(body.data()), body.size(), to_char_ptr(compressed->data()), &length);
+      compressed->resize(length);
+      return Status::OK();
+    }
+    case CompressionScheme::NONE:
+      break;
+  }
+  return STATUS_SUBSTITUTE(
+      InvalidArgument, "Invalid compression scheme $0", static_cast<int>(compression_scheme));
+}
+
+Status CQLMessage::UncompressBody(
+    const CompressionScheme compression_scheme, const Slice& body, faststring* uncompressed) {
+  switch (compression_scheme) {
+    case CompressionScheme::LZ4: {
+      if (body.size() < kIntSize) {
+        return STATUS(NetworkError, "Truncated LZ4-compressed CQL message");
+      }
+      const uint32_t length = NetworkByteOrder::Load32(body.data());
+      if (length > static_cast<size_t>(FLAGS_max_message_length)) {
+        return STATUS_SUBSTITUTE(
+            NetworkError, "Uncompressed CQL message length $0 is too long", length);
+      }
+      uncompressed->resize(length);
+      const int result = LZ4_decompress_safe(
+          to_char_ptr(body.data() + kIntSize), to_char_ptr(uncompressed->data()),
+          body.size() - kIntSize, length);
+      if (result < 0 || static_cast<uint32_t>(result) != length) {
+        return STATUS(Corruption, "Failed to uncompress LZ4-compressed CQL message");
+      }
+      return Status::OK();
+    }
+    case CompressionScheme::SNAPPY: {
+      size_t length = 0;
+      if (!snappy::GetUncompressedLength(to_char_ptr(body.data()), body.size(), &length)) {
+        return STATUS(Corruption, "Invalid Snappy-compressed CQL message");
+      }
+      if (length > static_cast<size_t>(FLAGS_max_message_length)) {
+        return STATUS_SUBSTITUTE(
+            NetworkError, "Uncompressed CQL message length $0 is too long", length);
+      }
+      uncompressed->resize(length);
+      if (!snappy::RawUncompress(
+              to_char_ptr(body.data()), body.size(), to_char_ptr(uncompressed->data()))) {
+        return STATUS(Corruption, "Failed to uncompress Snappy-compressed CQL message");
+      }
+      return Status::OK();
+    }
+    case CompressionScheme::NONE:
+      break;
+  }
+  return STATUS(NetworkError, "Compressed CQL message while compression was not negotiated");
+}
+
 namespace {
 
 template<class Type>
@@ -168,7 +253,8 @@ Type LoadInt(const Slice& slice, size_t offset) {
 
 // ------------------------------------ CQL request -----------------------------------
 bool CQLRequest::ParseRequest(
-  const Slice& mesg, unique_ptr<CQLRequest>* request, unique_ptr<CQLResponse>* error_response) {
+  const Slice& mesg, const CompressionScheme compression_scheme, unique_ptr<CQLRequest>* request,
+  unique_ptr<CQLResponse>* error_response) {
 
   *request = nullptr;
   *error_response = nullptr;
@@ -211,10 +297,25 @@ bool CQLRequest::ParseRequest(
     return false;
   }
 
-  const Slice body =
+  Slice body =
       (mesg.size() == kMessageHeaderLength) ?
       Slice() : Slice(&mesg[kMessageHeaderLength], mesg.size() - kMessageHeaderLength);
 
+  // Uncompress the body if needed. The request refers to the uncompressed body only while it is
+  // parsed below, so it does not need to outlive this function.
+  faststring uncompressed_body;
+  if (header.flags & kCompressionFlag) {
+    const Status status = UncompressBody(compression_scheme, body, &uncompressed_body);
+    if (!status.ok()) {
+      error_response->reset(
+          new ErrorResponse(
+              header.stream_id, ErrorResponse::Code::PROTOCOL_ERROR,
+              status.message().ToString()));
+      return false;
+    }
+    body = Slice(uncompressed_body.data(), uncompressed_body.size());
+  }
+
   // Construct the skeleton request by the opcode
   switch (header.opcode) {
     case Opcode::STARTUP:
@@ -474,6 +575,19 @@ Status StartupRequest::ParseBody() {
   return ParseStringMap(&options_);
 }
 
+CQLMessage::CompressionScheme StartupRequest::compression_scheme() const {
+  const auto it = options_.find("COMPRESSION");
+  if (it != options_.end()) {
+    if (it->second == "lz4") {
+      return CompressionScheme::LZ4;
+    }
+    if (it->second == "snappy") {
+      return CompressionScheme::SNAPPY;
+    }
+  }
+  return CompressionScheme::NONE;
+}
+
 CQLResponse* StartupRequest::Execute() const {
   for (const auto& option : options_) {
     const auto& name = option.first;
@@ -723,14 +837,57 @@ CQLResponse::~CQLResponse() {
 #define SERIALIZE_LONG(buf, pos, value) \
   NetworkByteOrder::Store64(&(buf)[pos], static_cast<int64_t>(value))
 
-void CQLResponse::Serialize(faststring* mesg) const {
+void CQLResponse::Serialize(const CompressionScheme compression_scheme, faststring* mesg) const {
   const size_t start_pos = mesg->size(); // save the start position
   SerializeHeader(mesg);
   SerializeBody(mesg);
+  const RefCntBuffer tail = body_tail();
+  if (!tail.empty()) {
+    mesg->append(tail.data(), tail.size());
+  }
+
+  // The compression flag is set per message, so the body is sent uncompressed when it is too small
+  // or when compression does not make it smaller.
+  const size_t body_pos = start_pos + kMessageHeaderLength;
+  const size_t body_size = mesg->size() - body_pos;
+  Flags flags = this->flags() & ~kCompressionFlag;
+  if (compression_scheme != CompressionScheme::NONE &&
+      body_size >= static_cast<size_t>(FLAGS_cql_compression_min_body_size)) {
+    faststring compressed;
+    const Status s = CompressBody(
+        compression_scheme, Slice(mesg->data() + body_pos, body_size), &compressed);
+    if (!s.ok()) {
+      LOG(WARNING) << "Sending CQL response uncompressed: " << s.ToString();
+    } else if (compressed.size() < body_size) {
+      mesg->resize(body_pos);
+      mesg->append(compressed.data(), compressed.size());
+      flags |= kCompressionFlag;
+    }
+  }
+  SERIALIZE_BYTE(mesg->data(), start_pos + kHeaderPosFlags, flags);
   SERIALIZE_INT(
       mesg->data(), start_pos + kHeaderPosLength, mesg->size() - start_pos - kMessageHeaderLength);
 }
 
+void CQLResponse::SerializeToBuffers(
+    const CompressionScheme compression_scheme, std::vector<RefCntBuffer>* buffers) const {
+  RefCntBuffer tail = body_tail();
+  faststring mesg;
+  if (tail.empty() || compression_scheme != CompressionScheme::NONE) {
+    // The body is compressed as a whole, so the tail is copied into the message anyway.
+    Serialize(compression_scheme, &mesg);
+    buffers->emplace_back(mesg);
+    return;
+  }
+
+  SerializeHeader(&mesg);
+  SerializeBody(&mesg);
+  SERIALIZE_BYTE(mesg.data(), kHeaderPosFlags, flags() & ~kCompressionFlag);
+  SERIALIZE_INT(mesg.data(), kHeaderPosLength, mesg.size() - kMessageHeaderLength + tail.size());
+  buffers->emplace_back(mesg);
+  buffers->push_back(std::move(tail));
+}
+
 void CQLResponse::SerializeHeader(faststring* mesg) const {
   uint8_t buffer[kMessageHeaderLength];
   SERIALIZE_BYTE(buffer, kHeaderPosVersion, version());
@@ -973,7 +1130,7 @@ void AuthenticateResponse::SerializeBody(faststring* mesg) const {
 
 //----------------------------------------------------------------------------------------
 const unordered_map<string, vector<string>> SupportedResponse::options_ = {
-  {"COMPRESSION", { } },
+  {"COMPRESSION", {"lz4", "snappy"} },
   {"CQL_VERSION", {"3.0.0" /* minimum */, "3.4.2" /* current */} }
 };
 
@@ -1432,7 +1589,6 @@ void RowsResultResponse::SerializeResultBody(faststring* mesg) const {
   SerializeRowsMetadata(
       RowsMetadata(result_->table_name(), result_->column_schemas(),
                    result_->paging_state(), skip_metadata_), mesg);
-  mesg->append(result_->rows_data());
 }
 
 //----------------------------------------------------------------------------------------
@@ -1518,12 +1674,13 @@ SchemaChangeResultResponse::SchemaChangeResultResponse(
 SchemaChangeResultResponse::~SchemaChangeResultResponse() {
 }
 
-void SchemaChangeResultResponse::Serialize(faststring* mesg) const {
-  ResultResponse::Serialize(mesg);
+void SchemaChangeResultResponse::Serialize(
+    const CompressionScheme compression_scheme, faststring* mesg) const {
+  ResultResponse::Serialize(compression_scheme, mesg);
   // TODO: Replace this hack that piggybacks a SCHEMA_CHANGE event along a SCHEMA_CHANGE result
   // response with a formal event notification mechanism.
   SchemaChangeEventResponse event(change_type_, target_, keyspace_, object_, argument_types_);
-  event.Serialize(mesg);
+  event.Serialize(compression_scheme, mesg);
 }
 
 void SchemaChangeResultResponse::SerializeResultBody(faststring* mesg) const {
@@ -1655,8 +1812,9 @@ void AuthSuccessResponse::SerializeBody(faststring* mesg) const {
 CQLServerEvent::CQLServerEvent(std::unique_ptr<EventResponse> event_response)
     : event_response_(std::move(event_response)) {
   CHECK_NOTNULL(event_response_.get());
+  // The same serialized event is sent to all registered connections, so it is never compressed.
   faststring temp;
-  event_response_->Serialize(&temp);
+  event_response_->Serialize(CQLMessage::CompressionScheme::NONE, &temp);
   serialized_response_ = RefCntBuffer(temp);
 }
 
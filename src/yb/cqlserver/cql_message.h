@@ -24,11 +24,14 @@
 #include <memory>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 #include "yb/common/wire_protocol.h"
 #include "yb/rpc/server_event.h"
 #include "yb/ql/util/statement_params.h"
 #include "yb/ql/util/statement_result.h"
+#include "yb/util/faststring.h"
+#include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/slice.h"
 #include "yb/util/status.h"
 #include "yb/util/net/sockaddr.h"
@@ -78,6 +81,20 @@ class CQLMessage {
   using StreamId = uint16_t;
   static constexpr StreamId kEventStreamId = 0xffff; // Special stream id for events.
 
+  // Compression of message bodies, negotiated by the COMPRESSION option of STARTUP.
+  enum class CompressionScheme : uint8_t {
+    NONE   = 0x00,
+    LZ4    = 0x01,
+    SNAPPY = 0x02
+  };
+
+  // Compress / uncompress a message body. Per protocol, the LZ4-compressed body is prefixed with
+  // the 4-byte length of the uncompressed body.
+  static CHECKED_STATUS CompressBody(
+      CompressionScheme compression_scheme, const Slice& body, faststring* compressed);
+  static CHECKED_STATUS UncompressBody(
+      CompressionScheme compression_scheme, const Slice& body, faststring* uncompressed);
+
   enum class Opcode : uint8_t {
     ERROR          = 0x00,
     STARTUP        = 0x01,
@@ -213,9 +230,10 @@ class CQLRequest : public CQLMessage {
   // "Factory" function to parse a CQL serlized request message and construct a request object.
   // Return true iff a request is parsed successfully without error. If an error occurs, an error
   // response will be returned instead and it should be sent back to the CQL client.
+  // <compression_scheme> is the compression negotiated on the connection the request came from.
   static bool ParseRequest(
-      const Slice& mesg, std::unique_ptr<CQLRequest>* request,
-      std::unique_ptr<CQLResponse>* error_response);
+      const Slice& mesg, CompressionScheme compression_scheme,
+      std::unique_ptr<CQLRequest>* request, std::unique_ptr<CQLResponse>* error_response);
 
   static StreamId ParseStreamId(const Slice& mesg) {
     return static_cast<StreamId>(NetworkByteOrder::Load16(mesg.data() + kHeaderPosStreamId));
@@ -309,6 +327,9 @@ class StartupRequest : public CQLRequest {
   virtual ~StartupRequest() override;
   virtual CQLResponse* Execute() const override;
 
+  // Compression requested by the client. Valid only after Execute() succeeded.
+  CompressionScheme compression_scheme() const;
+
  protected:
   virtual CHECKED_STATUS ParseBody() override;
 
@@ -460,7 +481,15 @@ class RegisterRequest : public CQLRequest {
 // ------------------------------------ CQL response -----------------------------------
 class CQLResponse : public CQLMessage {
  public:
-  virtual void Serialize(faststring* mesg) const;
+  // Serialize the response. The body is compressed using <compression_scheme>, unless it is too
+  // small to benefit from it.
+  virtual void Serialize(CompressionScheme compression_scheme, faststring* mesg) const;
+
+  // Serialize the response into buffers that form the message when concatenated. The body tail
+  // of an uncompressed response is not copied, its buffer is shared instead.
+  void SerializeToBuffers(
+      CompressionScheme compression_scheme, std::vector<RefCntBuffer>* buffers) const;
+
   virtual ~CQLResponse();
  protected:
   CQLResponse(const CQLRequest& request, Opcode opcode);
@@ -469,6 +498,9 @@ class CQLResponse : public CQLMessage {
 
   // Function to serialize a response body that all CQLResponse subclasses need to implement
   virtual void SerializeBody(faststring* mesg) const = 0;
+
+  // Data that is already in CQL wire format and is sent as is after the serialized body.
+  virtual RefCntBuffer body_tail() const { return RefCntBuffer(); }
 };
 
 // ------------------------------ Individual CQL responses -----------------------------------
@@ -731,6 +763,9 @@ class RowsResultResponse : public ResultResponse {
  protected:
   virtual void SerializeResultBody(faststring* mesg) const override;
 
+  // Rows data is produced in CQL wire format by the tablet server and is sent without copying.
+  virtual RefCntBuffer body_tail() const override { return result_->rows_data(); }
+
  private:
   const ql::RowsResult::SharedPtr result_;
   const bool skip_metadata_;
@@ -787,7 +822,7 @@ class SchemaChangeResultResponse : public ResultResponse {
   SchemaChangeResultResponse(const CQLRequest& request, const ql::SchemaChangeResult& result);
   virtual ~SchemaChangeResultResponse() override;
 
-  void Serialize(faststring* mesg) const override;
+  void Serialize(CompressionScheme compression_scheme, faststring* mesg) const override;
 
  protected:
   virtual void SerializeResultBody(faststring* mesg) const override;
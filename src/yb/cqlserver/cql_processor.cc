@@ -22,6 +22,13 @@
 #include "yb/gutil/strings/escaping.h"
 #include "yb/rpc/rpc_context.h"
 #include "yb/util/crypt.h"
+#include "yb/util/flag_tags.h"
+
+DEFINE_bool(cql_cache_unprepared_queries, true,
+            "Whether to lift constants of unprepared DML queries into bind markers and cache the "
+            "resulting statements, so queries that differ only in constants are parsed and "
+            "analyzed once.");
+TAG_FLAG(cql_cache_unprepared_queries, runtime);
 
 METRIC_DEFINE_histogram(
     server, handler_latency_yb_cqlserver_CQLServerService_GetProcessor,
@@ -49,6 +56,14 @@ METRIC_DEFINE_histogram(
 METRIC_DEFINE_counter(
     server, yb_cqlserver_CQLServerService_ParsingErrors, "Errors encountered when parsing ",
     yb::MetricUnit::kRequests, "Errors encountered when parsing ");
+METRIC_DEFINE_counter(
+    server, yb_cqlserver_CQLServerService_QueryCacheHits, "Unprepared query cache hits",
+    yb::MetricUnit::kRequests,
+    "Unprepared queries executed from cached statements of their normalized text");
+METRIC_DEFINE_counter(
+    server, yb_cqlserver_CQLServerService_QueryCacheMisses, "Unprepared query cache misses",
+    yb::MetricUnit::kRequests,
+    "Unprepared queries which normalized text had to be parsed and analyzed to be cached");
 METRIC_DEFINE_histogram(
     server, handler_latency_yb_cqlserver_CQLServerService_Any,
     "yb.cqlserver.CQLServerService.AnyMethod RPC Time", yb::MetricUnit::kMicroseconds,
@@ -80,6 +95,22 @@ using ql::ErrorCode;
 using ql::GetErrorCode;
 using yb::util::bcrypt_checkpw;
 
+namespace {
+
+// Whether preparing a normalized query failed because of its text, so that preparing it again
+// would fail the same way. Execution errors, like a table that is not found, and undefined columns
+// could be gone after a concurrent DDL.
+bool IsRepeatableError(const Status& s) {
+  if (!s.IsQLError()) {
+    return false;
+  }
+  const ErrorCode code = GetErrorCode(s);
+  return code < ErrorCode::LIMITATION_ERROR && code > ErrorCode::EXEC_ERROR &&
+         code != ErrorCode::UNDEFINED_COLUMN;
+}
+
+}  // namespace
+
 //------------------------------------------------------------------------------------------------
 CQLMetrics::CQLMetrics(const scoped_refptr<yb::MetricEntity>& metric_entity)
     : QLMetrics(metric_entity) {
@@ -99,13 +130,18 @@ CQLMetrics::CQLMetrics(const scoped_refptr<yb::MetricEntity>& metric_entity)
       METRIC_handler_latency_yb_cqlserver_CQLServerService_Any.Instantiate(metric_entity);
   num_errors_parsing_cql_ =
       METRIC_yb_cqlserver_CQLServerService_ParsingErrors.Instantiate(metric_entity);
+  num_query_cache_hits_ =
+      METRIC_yb_cqlserver_CQLServerService_QueryCacheHits.Instantiate(metric_entity);
+  num_query_cache_misses_ =
+      METRIC_yb_cqlserver_CQLServerService_QueryCacheMisses.Instantiate(metric_entity);
 }
 
 //------------------------------------------------------------------------------------------------
 CQLProcessor::CQLProcessor(CQLServiceImpl* service_impl, const CQLProcessorListPos& pos)
     : QLProcessor(
           service_impl->messenger(), service_impl->client(), service_impl->metadata_cache(),
-          service_impl->cql_metrics().get(), service_impl->cql_rpc_env()),
+          service_impl->cql_metrics().get(), service_impl->cql_rpc_env(),
+          service_impl->transaction_manager()),
       service_impl_(service_impl),
       cql_metrics_(service_impl->cql_metrics()),
       pos_(pos),
@@ -126,7 +162,8 @@ void CQLProcessor::ProcessCall(rpc::InboundCallPtr call) {
 
   // Parse the CQL request. If the parser failed, it sets the error message in response.
   parse_begin_ = MonoTime::Now(MonoTime::FINE);
-  if (!CQLRequest::ParseRequest(call_->serialized_request(), &request, &response)) {
+  if (!CQLRequest::ParseRequest(
+          call_->serialized_request(), call_->compression_scheme(), &request, &response)) {
     cql_metrics_->num_errors_parsing_cql_->Increment();
     SendResponse(*response);
     service_impl_->ReturnProcessor(pos_);
@@ -153,9 +190,9 @@ void CQLProcessor::SendResponse(const CQLResponse& response) {
   // Serialize the response to return to the CQL client. In case of error, an error response
   // should still be present.
   MonoTime response_begin = MonoTime::Now(MonoTime::FINE);
-  faststring msg;
-  response.Serialize(&msg);
-  call_->RespondSuccess(RefCntBuffer(msg), cql_metrics_->rpc_method_metrics_);
+  std::vector<RefCntBuffer> buffers;
+  response.SerializeToBuffers(call_->compression_scheme(), &buffers);
+  call_->RespondSuccess(std::move(buffers), cql_metrics_->rpc_method_metrics_);
 
   MonoTime response_done = MonoTime::Now(MonoTime::FINE);
   cql_metrics_->time_to_process_request_->Increment(
@@ -172,6 +209,8 @@ void CQLProcessor::SendResponse(const CQLResponse& response) {
   request_ = nullptr;
   stmts_.clear();
   parse_trees_.clear();
+  query_stmt_ = nullptr;
+  query_params_ = nullptr;
   SetCurrentCall(nullptr);
   Return();
 }
@@ -188,11 +227,23 @@ CQLResponse* CQLProcessor::ProcessRequest(const CQLRequest& req) {
       return ProcessBatch(static_cast<const BatchRequest&>(req));
     case CQLMessage::Opcode::AUTH_RESPONSE:
       return ProcessAuthResponse(static_cast<const AuthResponseRequest&>(req));
+    case CQLMessage::Opcode::STARTUP:
+      return ProcessStartup(static_cast<const StartupRequest&>(req));
     default:
       return req.Execute();
   }
 }
 
+CQLResponse* CQLProcessor::ProcessStartup(const StartupRequest& req) {
+  CQLResponse* response = req.Execute();
+  if (response->opcode() != CQLMessage::Opcode::ERROR) {
+    // The response to STARTUP itself is sent uncompressed, since it is serialized with the
+    // compression this call was received with.
+    call_->SetConnectionCompressionScheme(req.compression_scheme());
+  }
+  return response;
+}
+
 CQLResponse* CQLProcessor::ProcessPrepare(const PrepareRequest& req) {
   VLOG(1) << "PREPARE " << req.query();
   const CQLMessage::QueryId query_id = CQLStatement::GetQueryId(
@@ -234,10 +285,67 @@ CQLResponse* CQLProcessor::ProcessExecute(const ExecuteRequest& req) {
 
 CQLResponse* CQLProcessor::ProcessQuery(const QueryRequest& req) {
   VLOG(1) << "QUERY " << req.query();
+  // Retry after stale metadata goes through the regular path, that reparses with fresh metadata.
+  if (FLAGS_cql_cache_unprepared_queries && retry_count_ == 0 && req.params().values.empty() &&
+      ExecuteNormalizedQuery(req)) {
+    return nullptr;
+  }
   RunAsync(req.query(), req.params(), statement_executed_cb_);
   return nullptr;
 }
 
+bool CQLProcessor::ExecuteNormalizedQuery(const QueryRequest& req) {
+  CQLNormalizedQuery query;
+  if (!query.Init(req.query())) {
+    return false;
+  }
+  const CQLMessage::QueryId query_id = CQLStatement::GetQueryId(
+      ql_env_.CurrentKeyspace(), query.text());
+  if (service_impl_->IsUncacheableQuery(query_id)) {
+    return false;
+  }
+
+  // The normalized query is cached apart from the prepared statements, so that clients cannot
+  // execute it by id and it does not evict the statements the clients prepared.
+  shared_ptr<CQLStatement> stmt = service_impl_->AllocateNormalizedStatement(
+      query_id, ql_env_.CurrentKeyspace(), query.text());
+  const bool cached = !stmt->unprepared();
+  PreparedResult::UniPtr result;
+  Status s = stmt->Prepare(this, service_impl_->normalized_stmts_mem_tracker(), &result);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to prepare normalized query " << query.text() << ": " << s.ToString();
+    service_impl_->DeleteNormalizedStatement(stmt);
+    // Bind markers are not allowed where some of the constants are. Other failures, like a table
+    // that is being created, are retried with the next query.
+    if (IsRepeatableError(s)) {
+      service_impl_->AddUncacheableQuery(query_id);
+    }
+    return false;
+  }
+  (cached ? cql_metrics_->num_query_cache_hits_ : cql_metrics_->num_query_cache_misses_)
+      ->Increment();
+
+  std::vector<QLValuePB> values;
+  s = result != nullptr ? query.BindConstants(result->bind_variable_schemas(), &values)
+                        : STATUS(NotSupported, "Not a DML statement");
+  if (!s.ok()) {
+    VLOG(1) << "Failed to bind constants of " << req.query() << ": " << s.ToString();
+    if (s.IsNotSupported()) {
+      service_impl_->AddUncacheableQuery(query_id);
+    }
+    return false;
+  }
+
+  stmt->clear_reparsed();
+  query_stmt_ = stmt;
+  query_params_.reset(new CQLNormalizedQueryParameters(req.params(), std::move(values)));
+  s = stmt->ExecuteAsync(this, *query_params_, statement_executed_cb_);
+  if (PREDICT_FALSE(!s.ok())) {
+    StatementExecuted(s);
+  }
+  return true;
+}
+
 CQLResponse* CQLProcessor::ProcessBatch(const BatchRequest& req) {
   VLOG(1) << "BATCH " << req.queries().size();
 
@@ -245,12 +353,20 @@ CQLResponse* CQLProcessor::ProcessBatch(const BatchRequest& req) {
 
   BeginBatch(statement_executed_cb_);
 
+  // A batch often repeats the same statement with different bind values. Look up a prepared
+  // statement, or parse and analyze a query, only once when it is repeated in a row.
+  shared_ptr<const CQLStatement> stmt;
+  const BatchRequest::Query* last_query = nullptr;
+  const ql::ParseTree* last_parse_tree = nullptr;
+
   for (const BatchRequest::Query& query : req.queries()) {
 
     if (query.is_prepared) {
 
       VLOG(1) << "BATCH EXECUTE " << b2a_hex(query.query_id);
-      const shared_ptr<const CQLStatement> stmt = GetPreparedStatement(query.query_id);
+      if (stmt == nullptr || !last_query->is_prepared || last_query->query_id != query.query_id) {
+        stmt = GetPreparedStatement(query.query_id);
+      }
       if (stmt == nullptr) {
         unprepared_id_ = query.query_id;
         StatementExecuted(ErrorStatus(ErrorCode::UNPREPARED_STATEMENT));
@@ -264,11 +380,18 @@ CQLResponse* CQLProcessor::ProcessBatch(const BatchRequest& req) {
     } else {
 
       VLOG(1) << "BATCH QUERY " << query.query;
-      ql::ParseTree::UniPtr parse_tree;
-      RunBatch(query.query, query.params, &parse_tree, retry_count > 0);
-      parse_trees_.insert(std::move(parse_tree));
+      if (last_parse_tree != nullptr && !last_query->is_prepared &&
+          last_query->query == query.query) {
+        ExecuteBatch(query.query, *last_parse_tree, query.params);
+      } else {
+        ql::ParseTree::UniPtr parse_tree;
+        RunBatch(query.query, query.params, &parse_tree, retry_count > 0);
+        last_parse_tree = parse_tree.get();
+        parse_trees_.insert(std::move(parse_tree));
+      }
 
     }
+    last_query = &query;
 
     // If an error occurs while a statement is queued in the batch above, our StatementExecuted
     // callback will be called synchronously under us, which can either trigger a recursive retry
@@ -340,6 +463,12 @@ CQLResponse* CQLProcessor::ProcessResult(Status s, const ExecutedResult::SharedP
             unprepared_id_ = stmt->query_id();
           }
         }
+        // The client did not prepare the statement of a normalized query, so it is just dropped
+        // from the cache and the query is retried below.
+        if (query_stmt_ != nullptr) {
+          service_impl_->DeleteNormalizedStatement(query_stmt_);
+          query_stmt_ = nullptr;
+        }
         if (!unprepared_id_.empty()) {
           return new UnpreparedErrorResponse(*request_, unprepared_id_);
         }
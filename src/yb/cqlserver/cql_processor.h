@@ -45,6 +45,10 @@ class CQLMetrics : public ql::QLMetrics {
 
   scoped_refptr<yb::Histogram> time_to_queue_cql_response_;
   scoped_refptr<yb::Counter> num_errors_parsing_cql_;
+  // Unprepared queries executed from cached normalized statements, and those that had to be
+  // parsed and analyzed to be cached.
+  scoped_refptr<yb::Counter> num_query_cache_hits_;
+  scoped_refptr<yb::Counter> num_query_cache_misses_;
   // Rpc level metrics
   yb::rpc::RpcMethodMetrics rpc_method_metrics_;
 };
@@ -68,13 +72,18 @@ class CQLProcessor : public ql::QLProcessor {
   // Process a CQL request.
   CQLResponse* ProcessRequest(const CQLRequest& req);
 
-  // Process a PREPARE, EXECUTE, QUERY, BATCH or AUTH_RESPONSE request.
+  // Process a STARTUP, PREPARE, EXECUTE, QUERY, BATCH or AUTH_RESPONSE request.
+  CQLResponse* ProcessStartup(const StartupRequest& req);
   CQLResponse* ProcessPrepare(const PrepareRequest& req);
   CQLResponse* ProcessExecute(const ExecuteRequest& req);
   CQLResponse* ProcessQuery(const QueryRequest& req);
   CQLResponse* ProcessBatch(const BatchRequest& req);
   CQLResponse* ProcessAuthResponse(const AuthResponseRequest& req);
 
+  // Execute an unprepared query from the cached statement of its normalized text. Return false
+  // if the query should be executed from its original text instead.
+  bool ExecuteNormalizedQuery(const QueryRequest& req);
+
   // Get a prepared statement and adds it to the set of statements currently being executed.
   std::shared_ptr<const CQLStatement> GetPreparedStatement(const CQLMessage::QueryId& id);
 
@@ -107,6 +116,10 @@ class CQLProcessor : public ql::QLProcessor {
   std::unordered_set<std::shared_ptr<const CQLStatement>> stmts_;
   std::unordered_set<ql::ParseTree::UniPtr> parse_trees_;
 
+  // Cached statement and parameters of the normalized unprepared query being executed.
+  std::shared_ptr<const CQLStatement> query_stmt_;
+  std::unique_ptr<CQLNormalizedQueryParameters> query_params_;
+
   // Current retry count.
   int retry_count_ = 0;
 
@@ -104,7 +104,8 @@ Status CQLConnectionContext::HandleInboundCall(const rpc::ConnectionPtr& connect
 
   auto call = std::make_shared<CQLInboundCall>(connection,
       call_processed_listener(),
-      ql_session_);
+      ql_session_,
+      compression_scheme());
 
   Status s = call->ParseFrom(slice);
   if (!s.ok()) {
@@ -137,9 +138,17 @@ void CQLConnectionContext::DumpPB(const rpc::DumpRunningRpcsRequestPB& req,
 
 CQLInboundCall::CQLInboundCall(rpc::ConnectionPtr conn,
                                CallProcessedListener call_processed_listener,
-                               ql::QLSession::SharedPtr ql_session)
+                               ql::QLSession::SharedPtr ql_session,
+                               CQLMessage::CompressionScheme compression_scheme)
     : InboundCall(std::move(conn), std::move(call_processed_listener)),
-      ql_session_(std::move(ql_session)) {
+      ql_session_(std::move(ql_session)),
+      compression_scheme_(compression_scheme) {
+}
+
+void CQLInboundCall::SetConnectionCompressionScheme(
+    CQLMessage::CompressionScheme compression_scheme) {
+  down_cast<CQLConnectionContext&>(connection()->context()).set_compression_scheme(
+      compression_scheme);
 }
 
 Status CQLInboundCall::ParseFrom(Slice source) {
@@ -169,9 +178,9 @@ const std::string& CQLInboundCall::method_name() const {
 
 void CQLInboundCall::Serialize(std::deque<RefCntBuffer>* output) const {
   TRACE_EVENT0("rpc", "CQLInboundCall::Serialize");
-  CHECK_GT(response_msg_buf_.size(), 0);
+  CHECK(!response_msg_bufs_.empty());
 
-  output->push_back(response_msg_buf_);
+  output->insert(output->end(), response_msg_bufs_.begin(), response_msg_bufs_.end());
 }
 
 void CQLInboundCall::RespondFailure(rpc::ErrorStatusPB::RpcErrorCodePB error_code,
@@ -181,7 +190,7 @@ void CQLInboundCall::RespondFailure(rpc::ErrorStatusPB::RpcErrorCodePB error_cod
     case rpc::ErrorStatusPB::ERROR_SERVER_TOO_BUSY: {
       // Return OVERLOADED error to redirect CQL client to the next host.
       ErrorResponse(stream_id_, ErrorResponse::Code::OVERLOADED, "CQL service queue full")
-          .Serialize(&msg);
+          .Serialize(compression_scheme_, &msg);
       break;
     }
     case rpc::ErrorStatusPB::ERROR_APPLICATION: FALLTHROUGH_INTENDED;
@@ -197,19 +206,20 @@ void CQLInboundCall::RespondFailure(rpc::ErrorStatusPB::RpcErrorCodePB error_cod
       LOG(ERROR) << "Unexpected error status: "
                  << rpc::ErrorStatusPB::RpcErrorCodePB_Name(error_code);
       ErrorResponse(stream_id_, ErrorResponse::Code::SERVER_ERROR, "Server error")
-          .Serialize(&msg);
+          .Serialize(compression_scheme_, &msg);
       break;
     }
   }
-  response_msg_buf_ = RefCntBuffer(msg);
+  response_msg_bufs_.clear();
+  response_msg_bufs_.emplace_back(msg);
 
   QueueResponse(false);
 }
 
-void CQLInboundCall::RespondSuccess(const RefCntBuffer& buffer,
+void CQLInboundCall::RespondSuccess(std::vector<RefCntBuffer> buffers,
                                     const yb::rpc::RpcMethodMetrics& metrics) {
   RecordHandlingCompleted(metrics.handler_latency);
-  response_msg_buf_ = buffer;
+  response_msg_bufs_ = std::move(buffers);
 
   QueueResponse(true);
 }
@@ -37,6 +37,15 @@ class CQLConnectionContext : public rpc::ConnectionContextWithCallId {
   void DumpPB(const rpc::DumpRunningRpcsRequestPB& req,
               rpc::RpcConnectionPB* resp) override;
 
+  // Compression negotiated by the STARTUP request of this connection.
+  CQLMessage::CompressionScheme compression_scheme() const {
+    return compression_scheme_.load(std::memory_order_acquire);
+  }
+
+  void set_compression_scheme(CQLMessage::CompressionScheme compression_scheme) {
+    compression_scheme_.store(compression_scheme, std::memory_order_release);
+  }
+
  private:
   uint64_t ExtractCallId(rpc::InboundCall* call) override;
   void RunNegotiation(rpc::ConnectionPtr connection, const MonoTime& deadline) override;
@@ -54,13 +63,17 @@ class CQLConnectionContext : public rpc::ConnectionContextWithCallId {
   // Cassandra ROLE), consider adding a CreateNewConnection method in rpc::ServiceIf so that
   // CQLConnection can be created and returned from CQLServiceImpl.CreateNewConnection().
   ql::QLSession::SharedPtr ql_session_;
+
+  std::atomic<CQLMessage::CompressionScheme> compression_scheme_{
+      CQLMessage::CompressionScheme::NONE};
 };
 
 class CQLInboundCall : public rpc::InboundCall {
  public:
   explicit CQLInboundCall(rpc::ConnectionPtr conn,
                           CallProcessedListener call_processed_listener,
-                          ql::QLSession::SharedPtr ql_session);
+                          ql::QLSession::SharedPtr ql_session,
+                          CQLMessage::CompressionScheme compression_scheme);
 
   CHECKED_STATUS ParseFrom(Slice source);
 
@@ -74,9 +87,9 @@ class CQLInboundCall : public rpc::InboundCall {
 
   MonoTime GetClientDeadline() const override;
 
-  // Return the response message buffer.
-  RefCntBuffer& response_msg_buf() {
-    return response_msg_buf_;
+  // Return the buffers of the response message.
+  const std::vector<RefCntBuffer>& response_msg_bufs() const {
+    return response_msg_bufs_;
   }
 
   // Return the SQL session of this CQL call.
@@ -90,12 +103,21 @@ class CQLInboundCall : public rpc::InboundCall {
 
   bool TryResume();
 
+  // Compression of the connection at the time this call was received. It is used both to
+  // uncompress the request and to compress the response.
+  CQLMessage::CompressionScheme compression_scheme() const { return compression_scheme_; }
+
+  // Sets the compression for the calls that are received on this connection afterwards.
+  void SetConnectionCompressionScheme(CQLMessage::CompressionScheme compression_scheme);
+
   uint16_t stream_id() const { return stream_id_; }
 
   const std::string& service_name() const override;
   const std::string& method_name() const override;
   void RespondFailure(rpc::ErrorStatusPB::RpcErrorCodePB error_code, const Status& status) override;
-  void RespondSuccess(const RefCntBuffer& buffer, const yb::rpc::RpcMethodMetrics& metrics);
+  // Respond with the message that is formed by the concatenation of buffers.
+  void RespondSuccess(std::vector<RefCntBuffer> buffers,
+                      const yb::rpc::RpcMethodMetrics& metrics);
   void GetCallDetails(rpc::RpcCallInProgressPB *call_in_progress_pb);
   void SetRequest(std::shared_ptr<const CQLRequest> request, CQLServiceImpl* service_impl) {
     service_impl_ = service_impl;
@@ -110,9 +132,10 @@ class CQLInboundCall : public rpc::InboundCall {
   void RecordHandlingStarted(scoped_refptr<Histogram> incoming_queue_time) override;
 
   Callback<void(void)>* resume_from_ = nullptr;
-  RefCntBuffer response_msg_buf_;
+  std::vector<RefCntBuffer> response_msg_bufs_;
   ql::QLSession::SharedPtr ql_session_;
   uint16_t stream_id_;
+  const CQLMessage::CompressionScheme compression_scheme_;
   std::shared_ptr<const CQLRequest> request_;
   // Pointer to the containing CQL service implementation.
   CQLServiceImpl* service_impl_;
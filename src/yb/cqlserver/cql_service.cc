@@ -24,14 +24,24 @@
 
 #include "yb/gutil/strings/substitute.h"
 #include "yb/rpc/rpc_context.h"
+#include "yb/server/hybrid_clock.h"
 #include "yb/tserver/tablet_server.h"
 
 #include "yb/util/bytes_formatter.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/mem_tracker.h"
 
 DEFINE_int64(cql_service_max_prepared_statement_size_bytes, 0,
              "The maximum amount of memory the CQL proxy should use to maintain prepared "
              "statements. 0 or negative means unlimited.");
+DEFINE_uint64(cql_max_uncacheable_queries, 4096,
+              "The maximum number of normalized unprepared queries, that could not be executed "
+              "as prepared statements, to remember.");
+TAG_FLAG(cql_max_uncacheable_queries, advanced);
+DEFINE_int64(cql_max_normalized_statement_size_bytes, 64 * 1024 * 1024,
+             "The maximum amount of memory the CQL proxy should use to cache statements of "
+             "normalized unprepared queries. 0 or negative means unlimited.");
+TAG_FLAG(cql_max_normalized_statement_size_bytes, advanced);
 DEFINE_int32(cql_ybclient_reactor_threads, 24,
              "The number of reactor threads to be used for processing ybclient "
              "requests originating in the cql layer");
@@ -75,6 +85,15 @@ CQLServiceImpl::CQLServiceImpl(CQLServer* server, const CQLServerOptions& opts)
   prepared_stmts_mem_tracker_->AddGcFunction(
       std::bind(&CQLServiceImpl::DeleteLruPreparedStatement, this));
 
+  // Normalized statements are created for any unprepared query, so they get a separate tracker
+  // and are evicted on their own.
+  normalized_stmts_mem_tracker_ = MemTracker::CreateTracker(
+      FLAGS_cql_max_normalized_statement_size_bytes > 0 ?
+      FLAGS_cql_max_normalized_statement_size_bytes : -1,
+      "CQL normalized statements' memory usage", server->mem_tracker());
+  normalized_stmts_mem_tracker_->AddGcFunction(
+      std::bind(&CQLServiceImpl::DeleteLruNormalizedStatement, this));
+
   auth_prepared_stmt_ = std::make_shared<ql::Statement>(
       "",
       // TODO: enhance this once we need the other fields to create an AuthenticatedUser.
@@ -93,6 +112,9 @@ const std::shared_ptr<client::YBClient>& CQLServiceImpl::client() const {
       }
       // Create and save the metadata cache object.
       metadata_cache_ = std::make_shared<YBMetaDataCache>(client);
+      scoped_refptr<server::Clock> clock(new server::HybridClock());
+      CHECK_OK(clock->Init());
+      transaction_manager_.reset(new client::TransactionManager(client, clock));
       is_metadata_initialized_.store(std::memory_order_release);
     }
   }
@@ -105,6 +127,12 @@ const std::shared_ptr<client::YBMetaDataCache>& CQLServiceImpl::metadata_cache()
   return metadata_cache_;
 }
 
+client::TransactionManager* CQLServiceImpl::transaction_manager() const {
+  // Call client to wait for client and initialize transaction_manager if not already done.
+  (void)client();
+  return transaction_manager_.get();
+}
+
 void CQLServiceImpl::Shutdown() {
   async_client_init_.Shutdown();
 }
@@ -158,21 +186,8 @@ shared_ptr<CQLStatement> CQLServiceImpl::AllocatePreparedStatement(
   // Get exclusive lock before allocating a prepared statement and updating the LRU list.
   std::lock_guard<std::mutex> guard(prepared_stmts_mutex_);
 
-  shared_ptr<CQLStatement> stmt;
-  const auto itr = prepared_stmts_map_.find(query_id);
-  if (itr == prepared_stmts_map_.end()) {
-    // Allocate the prepared statement placeholder that multiple clients trying to prepare the same
-    // statement to contend on. The statement will then be prepared by one client while the rest
-    // wait for the results.
-    stmt = prepared_stmts_map_.emplace(
-        query_id, std::make_shared<CQLStatement>(
-            keyspace, ql_stmt, prepared_stmts_list_.end())).first->second;
-    InsertLruPreparedStatementUnlocked(stmt);
-  } else {
-    // Return existing statement if found.
-    stmt = itr->second;
-    MoveLruPreparedStatementUnlocked(stmt);
-  }
+  shared_ptr<CQLStatement> stmt = AllocateStatementUnlocked(
+      query_id, keyspace, ql_stmt, &prepared_stmts_map_, &prepared_stmts_list_);
 
   VLOG(1) << "InsertPreparedStatement: CQL prepared statement cache count = "
           << prepared_stmts_map_.size() << "/" << prepared_stmts_list_.size()
@@ -199,11 +214,11 @@ shared_ptr<const CQLStatement> CQLServiceImpl::GetPreparedStatement(
   }
   // If the statement is stale, delete it.
   if (stmt->stale()) {
-    DeletePreparedStatementUnlocked(stmt);
+    DeleteStatementUnlocked(stmt, &prepared_stmts_map_, &prepared_stmts_list_);
     return nullptr;
   }
 
-  MoveLruPreparedStatementUnlocked(stmt);
+  MoveLruStatementUnlocked(stmt, &prepared_stmts_list_);
   return stmt;
 }
 
@@ -211,37 +226,98 @@ void CQLServiceImpl::DeletePreparedStatement(const shared_ptr<const CQLStatement
   // Get exclusive lock before deleting the prepared statement.
   std::lock_guard<std::mutex> guard(prepared_stmts_mutex_);
 
-  DeletePreparedStatementUnlocked(stmt);
+  DeleteStatementUnlocked(stmt, &prepared_stmts_map_, &prepared_stmts_list_);
 
   VLOG(1) << "DeletePreparedStatement: CQL prepared statement cache count = "
           << prepared_stmts_map_.size() << "/" << prepared_stmts_list_.size()
           << ", memory usage = " << prepared_stmts_mem_tracker_->consumption();
 }
 
-void CQLServiceImpl::InsertLruPreparedStatementUnlocked(const shared_ptr<CQLStatement>& stmt) {
+shared_ptr<CQLStatement> CQLServiceImpl::AllocateNormalizedStatement(
+    const CQLMessage::QueryId& query_id, const string& keyspace, const string& ql_stmt) {
+  std::lock_guard<std::mutex> guard(normalized_stmts_mutex_);
+
+  shared_ptr<CQLStatement> stmt = AllocateStatementUnlocked(
+      query_id, keyspace, ql_stmt, &normalized_stmts_map_, &normalized_stmts_list_);
+
+  VLOG(1) << "AllocateNormalizedStatement: CQL normalized statement cache count = "
+          << normalized_stmts_map_.size() << "/" << normalized_stmts_list_.size()
+          << ", memory usage = " << normalized_stmts_mem_tracker_->consumption();
+
+  return stmt;
+}
+
+void CQLServiceImpl::DeleteNormalizedStatement(const shared_ptr<const CQLStatement>& stmt) {
+  std::lock_guard<std::mutex> guard(normalized_stmts_mutex_);
+
+  DeleteStatementUnlocked(stmt, &normalized_stmts_map_, &normalized_stmts_list_);
+
+  VLOG(1) << "DeleteNormalizedStatement: CQL normalized statement cache count = "
+          << normalized_stmts_map_.size() << "/" << normalized_stmts_list_.size()
+          << ", memory usage = " << normalized_stmts_mem_tracker_->consumption();
+}
+
+void CQLServiceImpl::AddUncacheableQuery(const CQLMessage::QueryId& query_id) {
+  std::lock_guard<std::mutex> guard(uncacheable_queries_mutex_);
+  // Start over when the set becomes too large, instead of tracking the least recently used ids.
+  if (uncacheable_queries_.size() >= FLAGS_cql_max_uncacheable_queries) {
+    uncacheable_queries_.clear();
+  }
+  uncacheable_queries_.insert(query_id);
+}
+
+bool CQLServiceImpl::IsUncacheableQuery(const CQLMessage::QueryId& query_id) {
+  std::lock_guard<std::mutex> guard(uncacheable_queries_mutex_);
+  return uncacheable_queries_.count(query_id) != 0;
+}
+
+shared_ptr<CQLStatement> CQLServiceImpl::AllocateStatementUnlocked(
+    const CQLMessage::QueryId& query_id, const string& keyspace, const string& ql_stmt,
+    CQLStatementMap* map, CQLStatementList* list) {
+  shared_ptr<CQLStatement> stmt;
+  const auto itr = map->find(query_id);
+  if (itr == map->end()) {
+    // Allocate the prepared statement placeholder that multiple clients trying to prepare the same
+    // statement to contend on. The statement will then be prepared by one client while the rest
+    // wait for the results.
+    stmt = map->emplace(
+        query_id, std::make_shared<CQLStatement>(keyspace, ql_stmt, list->end())).first->second;
+    InsertLruStatementUnlocked(stmt, list);
+  } else {
+    // Return existing statement if found.
+    stmt = itr->second;
+    MoveLruStatementUnlocked(stmt, list);
+  }
+  return stmt;
+}
+
+void CQLServiceImpl::InsertLruStatementUnlocked(
+    const shared_ptr<CQLStatement>& stmt, CQLStatementList* list) {
   // Insert the statement at the front of the LRU list.
-  stmt->set_pos(prepared_stmts_list_.insert(prepared_stmts_list_.begin(), stmt));
+  stmt->set_pos(list->insert(list->begin(), stmt));
 }
 
-void CQLServiceImpl::MoveLruPreparedStatementUnlocked(const shared_ptr<CQLStatement>& stmt) {
+void CQLServiceImpl::MoveLruStatementUnlocked(
+    const shared_ptr<CQLStatement>& stmt, CQLStatementList* list) {
   // Move the statement to the front of the LRU list.
-  prepared_stmts_list_.splice(prepared_stmts_list_.begin(), prepared_stmts_list_, stmt->pos());
+  list->splice(list->begin(), *list, stmt->pos());
 }
 
-void CQLServiceImpl::DeletePreparedStatementUnlocked(
-    const std::shared_ptr<const CQLStatement> stmt) {
+void CQLServiceImpl::DeleteStatementUnlocked(
+    const std::shared_ptr<const CQLStatement> stmt, CQLStatementMap* map,
+    CQLStatementList* list) {
   // Remove statement from cache by looking it up by query ID and only when it is same statement
   // object. Note that the "stmt" parameter above is not a ref ("&") intentionally so that we have
-  // a separate copy of the shared_ptr and not the very shared_ptr in prepared_stmts_map_ or
-  // prepared_stmt_list_ we are deleting.
-  const auto itr = prepared_stmts_map_.find(stmt->query_id());
-  if (itr != prepared_stmts_map_.end() && itr->second == stmt) {
-    prepared_stmts_map_.erase(itr);
+  // a separate copy of the shared_ptr and not the very shared_ptr in the map or the list we are
+  // deleting.
+  const auto itr = map->find(stmt->query_id());
+  if (itr != map->end() && itr->second == stmt) {
+    map->erase(itr);
   }
   // Remove statement from LRU list only when it is in the list, i.e. pos() != end().
-  if (stmt->pos() != prepared_stmts_list_.end()) {
-    prepared_stmts_list_.erase(stmt->pos());
-    stmt->set_pos(prepared_stmts_list_.end());
+  if (stmt->pos() != list->end()) {
+    list->erase(stmt->pos());
+    stmt->set_pos(list->end());
   }
 }
 
@@ -251,7 +327,8 @@ void CQLServiceImpl::DeleteLruPreparedStatement() {
   std::lock_guard<std::mutex> guard(prepared_stmts_mutex_);
 
   if (!prepared_stmts_list_.empty()) {
-    DeletePreparedStatementUnlocked(prepared_stmts_list_.back());
+    DeleteStatementUnlocked(
+        prepared_stmts_list_.back(), &prepared_stmts_map_, &prepared_stmts_list_);
   }
 
   VLOG(1) << "DeleteLruPreparedStatement: CQL prepared statement cache count = "
@@ -259,5 +336,18 @@ void CQLServiceImpl::DeleteLruPreparedStatement() {
           << ", memory usage = " << prepared_stmts_mem_tracker_->consumption();
 }
 
+void CQLServiceImpl::DeleteLruNormalizedStatement() {
+  std::lock_guard<std::mutex> guard(normalized_stmts_mutex_);
+
+  if (!normalized_stmts_list_.empty()) {
+    DeleteStatementUnlocked(
+        normalized_stmts_list_.back(), &normalized_stmts_map_, &normalized_stmts_list_);
+  }
+
+  VLOG(1) << "DeleteLruNormalizedStatement: CQL normalized statement cache count = "
+          << normalized_stmts_map_.size() << "/" << normalized_stmts_list_.size()
+          << ", memory usage = " << normalized_stmts_mem_tracker_->consumption();
+}
+
 }  // namespace cqlserver
 }  // namespace yb
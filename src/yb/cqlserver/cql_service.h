@@ -17,6 +17,7 @@
 #ifndef YB_CQLSERVER_CQL_SERVICE_H_
 #define YB_CQLSERVER_CQL_SERVICE_H_
 
+#include <unordered_set>
 #include <vector>
 
 #include "yb/cqlserver/cql_message.h"
@@ -31,6 +32,7 @@
 
 #include "yb/client/async_initializer.h"
 #include "yb/client/client.h"
+#include "yb/client/transaction_manager.h"
 
 namespace yb {
 
@@ -73,17 +75,41 @@ class CQLServiceImpl : public CQLServerServiceIf {
   // Delete the prepared statement from the cache.
   void DeletePreparedStatement(const std::shared_ptr<const CQLStatement>& stmt);
 
+  // Allocate a statement for a normalized unprepared query. Normalized statements are kept apart
+  // from the prepared ones, so that clients cannot execute them by id and they do not evict the
+  // statements the clients prepared. If the statement already exists, return it instead.
+  std::shared_ptr<CQLStatement> AllocateNormalizedStatement(
+      const CQLMessage::QueryId& id, const std::string& keyspace, const std::string& ql_stmt);
+
+  // Delete the normalized statement from the cache.
+  void DeleteNormalizedStatement(const std::shared_ptr<const CQLStatement>& stmt);
+
+  // Remember that the normalized query with the given id could not be executed as a prepared
+  // statement, so that it is executed from its original text afterwards.
+  void AddUncacheableQuery(const CQLMessage::QueryId& id);
+
+  // Whether the normalized query with the given id could not be executed as a prepared statement.
+  bool IsUncacheableQuery(const CQLMessage::QueryId& id);
+
   // Return the memory tracker for prepared statements.
   std::shared_ptr<MemTracker> prepared_stmts_mem_tracker() const {
     return prepared_stmts_mem_tracker_;
   }
 
+  // Return the memory tracker for normalized statements.
+  std::shared_ptr<MemTracker> normalized_stmts_mem_tracker() const {
+    return normalized_stmts_mem_tracker_;
+  }
+
   // Return the YBClient to communicate with either master or tserver.
   const std::shared_ptr<client::YBClient>& client() const;
 
   // Return the YBClientCache.
   const std::shared_ptr<client::YBMetaDataCache>& metadata_cache() const;
 
+  // Return the transaction manager to create distributed transactions with.
+  client::TransactionManager* transaction_manager() const;
+
   // Return the CQL metrics.
   std::shared_ptr<CQLMetrics> cql_metrics() const { return cql_metrics_; }
 
@@ -99,21 +125,33 @@ class CQLServiceImpl : public CQLServerServiceIf {
   // Either gets an available processor or creates a new one.
   CQLProcessor *GetProcessor();
 
-  // Insert a prepared statement at the front of the LRU list. "prepared_stmts_mutex_" needs to be
+  // Allocate a statement in the given cache, or return the existing one. The mutex that protects
+  // the cache needs to be locked before this call.
+  static std::shared_ptr<CQLStatement> AllocateStatementUnlocked(
+      const CQLMessage::QueryId& id, const std::string& keyspace, const std::string& ql_stmt,
+      CQLStatementMap* map, CQLStatementList* list);
+
+  // Insert a statement at the front of the LRU list. The mutex that protects the list needs to be
   // locked before this call.
-  void InsertLruPreparedStatementUnlocked(const std::shared_ptr<CQLStatement>& stmt);
+  static void InsertLruStatementUnlocked(
+      const std::shared_ptr<CQLStatement>& stmt, CQLStatementList* list);
 
-  // Move a prepared statement to the front of the LRU list. "prepared_stmts_mutex_" needs to be
+  // Move a statement to the front of the LRU list. The mutex that protects the list needs to be
   // locked before this call.
-  void MoveLruPreparedStatementUnlocked(const std::shared_ptr<CQLStatement>& stmt);
+  static void MoveLruStatementUnlocked(
+      const std::shared_ptr<CQLStatement>& stmt, CQLStatementList* list);
 
-  // Delete a prepared statement from the cache and the LRU list. "prepared_stmts_mutex_" needs to
-  // be locked before this call.
-  void DeletePreparedStatementUnlocked(const std::shared_ptr<const CQLStatement> stmt);
+  // Delete a statement from the cache and the LRU list. The mutex that protects them needs to be
+  // locked before this call.
+  static void DeleteStatementUnlocked(
+      const std::shared_ptr<const CQLStatement> stmt, CQLStatementMap* map, CQLStatementList* list);
 
   // Delete the least recently used prepared statement from the cache to free up memory.
   void DeleteLruPreparedStatement();
 
+  // Delete the least recently used normalized statement from the cache to free up memory.
+  void DeleteLruNormalizedStatement();
+
   // CQLServer of this service.
   CQLServer* const server_;
 
@@ -125,6 +163,9 @@ class CQLServiceImpl : public CQLServerServiceIf {
   mutable std::atomic<bool> is_metadata_initialized_ = { false };
   mutable std::mutex metadata_init_mutex_;
 
+  // Transaction manager shared by the CQL processors. Initialized together with the metadata cache.
+  mutable std::unique_ptr<client::TransactionManager> transaction_manager_;
+
   // List of CQL processors (in-use and available). In-use ones are at the beginning and available
   // ones at the end.
   CQLProcessorList processors_;
@@ -144,11 +185,29 @@ class CQLServiceImpl : public CQLServerServiceIf {
   // Mutex that protects the prepared statements and the LRU list.
   std::mutex prepared_stmts_mutex_;
 
+  // Normalized unprepared queries cache.
+  CQLStatementMap normalized_stmts_map_;
+
+  // Normalized statements LRU list (least recently used one at the end).
+  CQLStatementList normalized_stmts_list_;
+
+  // Mutex that protects the normalized statements and the LRU list.
+  std::mutex normalized_stmts_mutex_;
+
+  // Ids of normalized queries that could not be executed as prepared statements.
+  std::unordered_set<CQLMessage::QueryId> uncacheable_queries_;
+
+  // Mutex that protects uncacheable_queries_.
+  std::mutex uncacheable_queries_mutex_;
+
   std::shared_ptr<ql::Statement> auth_prepared_stmt_;
 
   // Tracker to measure and limit memory usage of prepared statements.
   std::shared_ptr<MemTracker> prepared_stmts_mem_tracker_;
 
+  // Tracker to measure and limit memory usage of normalized statements.
+  std::shared_ptr<MemTracker> normalized_stmts_mem_tracker_;
+
   // Metrics to be collected and reported.
   yb::rpc::RpcMethodMetrics metrics_;
 
@@ -18,6 +18,9 @@
 #include <sasl/md5global.h>
 #include <sasl/md5.h>
 
+#include "yb/util/date_time.h"
+#include "yb/util/stol_utils.h"
+
 namespace yb {
 namespace cqlserver {
 
@@ -40,5 +43,226 @@ CQLMessage::QueryId CQLStatement::GetQueryId(const string& keyspace, const strin
   return CQLMessage::QueryId(util::to_char_ptr(md5), sizeof(md5));
 }
 
+//------------------------------------------------------------------------------------------------
+namespace {
+
+bool IsIdentifierStart(char c) {
+  return isalpha(c) || c == '_';
+}
+
+bool IsIdentifierChar(char c) {
+  return isalnum(c) || c == '_';
+}
+
+} // namespace
+
+bool CQLNormalizedQuery::Init(const string& query) {
+  text_.clear();
+  constants_.clear();
+
+  const size_t size = query.size();
+  size_t pos = 0;
+  while (pos < size && isspace(query[pos])) {
+    ++pos;
+  }
+  size_t end = pos;
+  while (end < size && IsIdentifierChar(query[end])) {
+    ++end;
+  }
+  const string verb = query.substr(pos, end - pos);
+  if (strcasecmp(verb.c_str(), "SELECT") != 0 && strcasecmp(verb.c_str(), "INSERT") != 0 &&
+      strcasecmp(verb.c_str(), "UPDATE") != 0 && strcasecmp(verb.c_str(), "DELETE") != 0) {
+    return false;
+  }
+
+  // Whitespaces are collapsed, constants are replaced by "?" and everything else is copied as is.
+  // Signed numbers and numbers that are part of other literals (such as uuids or blobs) are not
+  // lifted.
+  bool pending_space = false;
+  while (pos < size) {
+    const char c = query[pos];
+    if (isspace(c)) {
+      pending_space = true;
+      ++pos;
+      continue;
+    }
+    const char last = text_.empty() ? 0 : text_.back();
+    if (pending_space && !text_.empty()) {
+      text_ += ' ';
+    }
+    pending_space = false;
+
+    const char next = pos + 1 < size ? query[pos + 1] : 0;
+    if (c == '?' || (c == ':' && IsIdentifierStart(next)) || (c == '$' && next == '$') ||
+        (c == '-' && next == '-') || (c == '/' && (next == '/' || next == '*'))) {
+      // Bind markers, dollar-quoted strings and comments.
+      return false;
+    }
+
+    if (c == '\'' || c == '"') {
+      // String constant or quoted identifier. The quote character is escaped by doubling it.
+      string value;
+      end = pos + 1;
+      for (;;) {
+        if (end >= size) {
+          return false;
+        }
+        if (query[end] == c) {
+          if (end + 1 < size && query[end + 1] == c) {
+            value += c;
+            end += 2;
+            continue;
+          }
+          ++end;
+          break;
+        }
+        value += query[end++];
+      }
+      if (c == '\'') {
+        text_ += '?';
+        constants_.push_back({Constant::Kind::STRING, std::move(value)});
+      } else {
+        text_.append(query, pos, end - pos);
+      }
+      pos = end;
+      continue;
+    }
+
+    if (IsIdentifierStart(c)) {
+      end = pos;
+      while (end < size && IsIdentifierChar(query[end])) {
+        ++end;
+      }
+      text_.append(query, pos, end - pos);
+      pos = end;
+      continue;
+    }
+
+    if (isdigit(c)) {
+      end = pos;
+      size_t num_dots = 0;
+      bool digits_only = true;
+      while (end < size && (IsIdentifierChar(query[end]) || query[end] == '.')) {
+        if (query[end] == '.') {
+          ++num_dots;
+        } else if (!isdigit(query[end])) {
+          digits_only = false;
+        }
+        ++end;
+      }
+      const bool liftable = digits_only && num_dots <= 1 && query[end - 1] != '.' &&
+                            last != '-' && last != '+' && (end >= size || query[end] != '-');
+      if (liftable) {
+        text_ += '?';
+        constants_.push_back({num_dots == 0 ? Constant::Kind::INTEGER : Constant::Kind::FLOAT,
+                              query.substr(pos, end - pos)});
+      } else {
+        text_.append(query, pos, end - pos);
+      }
+      pos = end;
+      continue;
+    }
+
+    text_ += c;
+    ++pos;
+  }
+  return true;
+}
+
+Status CQLNormalizedQuery::BindConstants(const std::vector<ColumnSchema>& bind_variable_schemas,
+                                         std::vector<QLValuePB>* values) const {
+  if (bind_variable_schemas.size() != constants_.size()) {
+    return STATUS_SUBSTITUTE(NotSupported, "$0 bind variables for $1 constants",
+                             bind_variable_schemas.size(), constants_.size());
+  }
+  values->clear();
+  values->resize(constants_.size());
+  for (size_t i = 0; i != constants_.size(); ++i) {
+    RETURN_NOT_OK(BindConstant(
+        constants_[i], bind_variable_schemas[i].type()->main(), &(*values)[i]));
+  }
+  return Status::OK();
+}
+
+// Conversions below match the conversions of the same constants by the executor.
+Status CQLNormalizedQuery::BindConstant(
+    const Constant& constant, const DataType type, QLValuePB* value) const {
+  switch (constant.kind) {
+    case Constant::Kind::STRING:
+      if (type == DataType::STRING) {
+        value->set_string_value(constant.value);
+        return Status::OK();
+      }
+      break;
+    case Constant::Kind::INTEGER:
+      switch (type) {
+        case DataType::INT8: {
+          auto result = util::CheckedStoInt<int8_t>(constant.value);
+          RETURN_NOT_OK(result);
+          value->set_int8_value(*result);
+          return Status::OK();
+        }
+        case DataType::INT16: {
+          auto result = util::CheckedStoInt<int16_t>(constant.value);
+          RETURN_NOT_OK(result);
+          value->set_int16_value(*result);
+          return Status::OK();
+        }
+        case DataType::INT32: {
+          auto result = util::CheckedStoInt<int32_t>(constant.value);
+          RETURN_NOT_OK(result);
+          value->set_int32_value(*result);
+          return Status::OK();
+        }
+        case DataType::INT64: {
+          auto result = util::CheckedStoll(constant.value);
+          RETURN_NOT_OK(result);
+          value->set_int64_value(*result);
+          return Status::OK();
+        }
+        case DataType::TIMESTAMP: {
+          auto result = util::CheckedStoll(constant.value);
+          RETURN_NOT_OK(result);
+          value->set_timestamp_value(DateTime::TimestampFromInt(*result).ToInt64());
+          return Status::OK();
+        }
+        default:
+          break;
+      }
+      FALLTHROUGH_INTENDED;
+    case Constant::Kind::FLOAT:
+      switch (type) {
+        case DataType::FLOAT: {
+          auto result = util::CheckedStold(constant.value);
+          RETURN_NOT_OK(result);
+          value->set_float_value(*result);
+          return Status::OK();
+        }
+        case DataType::DOUBLE: {
+          auto result = util::CheckedStold(constant.value);
+          RETURN_NOT_OK(result);
+          value->set_double_value(*result);
+          return Status::OK();
+        }
+        default:
+          break;
+      }
+      break;
+  }
+  return STATUS_SUBSTITUTE(NotSupported, "Constant $0 is not converted to datatype $1",
+                           constant.value, static_cast<int>(type));
+}
+
+Status CQLNormalizedQueryParameters::GetBindVariable(const std::string& name,
+                                                     const int64_t pos,
+                                                     const std::shared_ptr<QLType>& type,
+                                                     QLValue* value) const {
+  if (pos < 0 || pos >= constant_values_.size()) {
+    return STATUS_SUBSTITUTE(RuntimeError, "Bind variable at position $0 not found", pos + 1);
+  }
+  *value = constant_values_[pos];
+  return Status::OK();
+}
+
 }  // namespace cqlserver
 }  // namespace yb
@@ -13,7 +13,9 @@
 //
 //
 // This class defines a CQL statement. A CQL statement extends from a SQL statement to handle query
-// ID and caching prepared statements in a list.
+// ID and caching prepared statements in a list. It also defines the normalization of unprepared
+// queries, which lifts constants into bind markers so that the normalized query can be cached as a
+// prepared statement too.
 //--------------------------------------------------------------------------------------------------
 
 #ifndef YB_CQLSERVER_CQL_STATEMENT_H_
@@ -21,6 +23,7 @@
 
 #include <list>
 
+#include "yb/common/schema.h"
 #include "yb/cqlserver/cql_message.h"
 #include "yb/ql/statement.h"
 
@@ -59,6 +62,59 @@ class CQLStatement : public ql::Statement {
   mutable CQLStatementListPos pos_;
 };
 
+// An unprepared DML query with its constants lifted into bind markers. Queries that differ only in
+// constants have the same normalized text, so they could share the parsed and analyzed statement.
+class CQLNormalizedQuery {
+ public:
+  // Normalize the query text. Return false if the query could not be normalized, i.e. it is not a
+  // SELECT, INSERT, UPDATE or DELETE statement, or it already has bind markers or comments.
+  bool Init(const std::string& query);
+
+  // Return the normalized query text.
+  const std::string& text() const { return text_; }
+
+  // Convert the lifted constants to the values of the bind variables of the normalized statement.
+  // Return NotSupported when a constant is used for a datatype that is not converted here, so the
+  // statement should be executed from its original text instead.
+  CHECKED_STATUS BindConstants(const std::vector<ColumnSchema>& bind_variable_schemas,
+                               std::vector<QLValuePB>* values) const;
+
+ private:
+  struct Constant {
+    enum class Kind {
+      INTEGER,
+      FLOAT,
+      STRING
+    };
+
+    Kind kind;
+    std::string value;
+  };
+
+  CHECKED_STATUS BindConstant(const Constant& constant, DataType type, QLValuePB* value) const;
+
+  std::string text_;
+  std::vector<Constant> constants_;
+};
+
+// Parameters to execute a normalized query with: the parameters of the original query request and
+// the values of the constants lifted from it.
+class CQLNormalizedQueryParameters : public CQLMessage::QueryParameters {
+ public:
+  CQLNormalizedQueryParameters(const CQLMessage::QueryParameters& params,
+                               std::vector<QLValuePB> values)
+      : CQLMessage::QueryParameters(params), constant_values_(std::move(values)) {
+  }
+
+  CHECKED_STATUS GetBindVariable(const std::string& name,
+                                 int64_t pos,
+                                 const std::shared_ptr<QLType>& type,
+                                 QLValue* value) const override;
+
+ private:
+  std::vector<QLValuePB> constant_values_;
+};
+
 }  // namespace cqlserver
 }  // namespace yb
 
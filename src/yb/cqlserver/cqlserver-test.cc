@@ -20,12 +20,24 @@
 
 #include "yb/cqlserver/cql_message.h"
 #include "yb/cqlserver/cql_server.h"
+#include "yb/cqlserver/cql_statement.h"
 
+#include "yb/gutil/endian.h"
+#include "yb/gutil/stringprintf.h"
 #include "yb/gutil/strings/join.h"
 #include "yb/util/cast.h"
+#include "yb/util/metrics.h"
 #include "yb/util/net/net_util.h"
 #include "yb/util/test_util.h"
 
+DECLARE_int32(cql_compression_min_body_size);
+DECLARE_bool(cql_cache_unprepared_queries);
+
+METRIC_DECLARE_counter(yb_cqlserver_CQLServerService_QueryCacheHits);
+METRIC_DECLARE_counter(yb_cqlserver_CQLServerService_QueryCacheMisses);
+METRIC_DECLARE_histogram(handler_latency_yb_cqlserver_SQLProcessor_ParseRequest);
+METRIC_DECLARE_histogram(handler_latency_yb_cqlserver_SQLProcessor_AnalyzeRequest);
+
 namespace yb {
 namespace cqlserver {
 
@@ -45,7 +57,19 @@ class TestCQLService : public YBTableTestBase {
 
   void SendRequestAndExpectResponse(const string& cmd, const string& resp);
 
+  // Send a QUERY request and receive its response, skipping event messages. Return the opcode
+  // of the response and optionally its body.
+  CQLMessage::Opcode ExecuteQuery(const string& query, string* body = nullptr);
+
+  // Send a request with the specified opcode and body and receive its response, skipping event
+  // messages. Return the opcode of the response and optionally its body.
+  CQLMessage::Opcode SendRequest(CQLMessage::Opcode opcode, const string& request_body,
+                                 string* body = nullptr);
+
   int server_port() { return cql_server_port_; }
+
+  const scoped_refptr<MetricEntity>& metric_entity() { return server_->metric_entity(); }
+
  private:
   Status SendRequestAndGetResponse(
       const string& cmd, int expected_resp_length, int timeout_in_millis = 1000);
@@ -132,6 +156,56 @@ void TestCQLService::SendRequestAndExpectResponse(const string& cmd, const strin
   CHECK_EQ(resp, string(reinterpret_cast<char*>(resp_), resp.length()));
 }
 
+CQLMessage::Opcode TestCQLService::ExecuteQuery(const string& query, string* body) {
+  char length[CQLMessage::kIntSize];
+  NetworkByteOrder::Store32(length, query.size());
+  string request_body = string(length, sizeof(length)) + query;
+  request_body += BINARY_STRING("\x00\x04" "\x00");  // QUORUM consistency, no flags.
+  const auto opcode = SendRequest(CQLMessage::Opcode::QUERY, request_body, body);
+  if (opcode == CQLMessage::Opcode::ERROR) {
+    LOG(INFO) << query << " failed";
+  }
+  return opcode;
+}
+
+CQLMessage::Opcode TestCQLService::SendRequest(
+    CQLMessage::Opcode opcode, const string& request_body, string* body) {
+  char length[CQLMessage::kIntSize];
+  NetworkByteOrder::Store32(length, request_body.size());
+  const string request = BINARY_STRING("\x04\x00\x00\x01") +
+                         string(1, static_cast<char>(opcode)) +
+                         string(length, sizeof(length)) + request_body;
+  int32_t bytes_written = 0;
+  CHECK_OK(client_sock_.Write(util::to_uchar_ptr(request.c_str()), request.length(),
+                              &bytes_written));
+
+  for (;;) {
+    MonoTime deadline = MonoTime::FineNow();
+    deadline.AddDelta(MonoDelta::FromSeconds(60));
+    uint8_t header[CQLMessage::kMessageHeaderLength];
+    size_t bytes_read = 0;
+    CHECK_OK(client_sock_.BlockingRecv(header, sizeof(header), &bytes_read, deadline));
+    string response_body(NetworkByteOrder::Load32(header + CQLMessage::kHeaderPosLength), 0);
+    if (!response_body.empty()) {
+      CHECK_OK(client_sock_.BlockingRecv(util::to_uchar_ptr(&response_body[0]),
+                                         response_body.size(), &bytes_read, deadline));
+    }
+    if (NetworkByteOrder::Load16(header + CQLMessage::kHeaderPosStreamId) ==
+        CQLMessage::kEventStreamId) {
+      continue;
+    }
+    const auto response_opcode =
+        static_cast<CQLMessage::Opcode>(header[CQLMessage::kHeaderPosOpcode]);
+    if (response_opcode == CQLMessage::Opcode::ERROR) {
+      LOG(INFO) << "Request failed: " << response_body.substr(6);
+    }
+    if (body != nullptr) {
+      *body = std::move(response_body);
+    }
+    return response_opcode;
+  }
+}
+
 // The following test cases test the CQL protocol marshalling/unmarshalling with hand-coded
 // request messages and expected responses. They are good as basic and error-handling tests.
 // These are expected to be few.
@@ -173,7 +247,87 @@ TEST_F(TestCQLService, OptionsRequest) {
                     "\x00\x02" "\x00\x0b" "CQL_VERSION"
                                "\x00\x02" "\x00\x05" "3.0.0" "\x00\x05" "3.4.2"
                                "\x00\x0b" "COMPRESSION"
-                               "\x00\x00"));
+                               "\x00\x02" "\x00\x03" "lz4" "\x00\x06" "snappy"));
+}
+
+namespace {
+
+// Returns a request made of the 5-byte header prefix (version, flags, stream id and opcode) and
+// the body compressed using the specified compression scheme.
+string CompressedRequest(
+    CQLMessage::CompressionScheme compression_scheme, const string& header, const string& body) {
+  faststring compressed;
+  CHECK_OK(CQLMessage::CompressBody(compression_scheme, body, &compressed));
+  char length[CQLMessage::kIntSize];
+  NetworkByteOrder::Store32(length, compressed.size());
+  return header + string(length, sizeof(length)) + compressed.ToString();
+}
+
+} // namespace
+
+TEST_F(TestCQLService, CompressedRequest) {
+  LOG(INFO) << "Test compressed CQL requests";
+  // Send compressed OPTIONS request before compression is negotiated
+  SendRequestAndExpectResponse(
+      CompressedRequest(
+          CQLMessage::CompressionScheme::LZ4, BINARY_STRING("\x04\x01\x00\x00\x05"), ""),
+      BINARY_STRING("\x84\x00\x00\x00\x00" "\x00\x00\x00\x41"
+                    "\x00\x00\x00\x0a" "\x00\x3b"
+                    "Compressed CQL message while compression was not negotiated"));
+
+  // Send STARTUP request with unsupported compression
+  SendRequestAndExpectResponse(
+      BINARY_STRING("\x04\x00\x00\x00\x01" "\x00\x00\x00\x2c"
+                    "\x00\x02" "\x00\x0b" "CQL_VERSION"
+                               "\x00\x05" "3.0.0"
+                               "\x00\x0b" "COMPRESSION"
+                               "\x00\x07" "deflate"),
+      BINARY_STRING("\x84\x00\x00\x00\x00" "\x00\x00\x00\x24"
+                    "\x00\x00\x00\x0a" "\x00\x1e" "Unsupported option COMPRESSION"));
+
+  const string kSupportedResponse = BINARY_STRING(
+      "\x84\x00\x00\x00\x06" "\x00\x00\x00\x3b"
+      "\x00\x02" "\x00\x0b" "CQL_VERSION"
+                 "\x00\x02" "\x00\x05" "3.0.0" "\x00\x05" "3.4.2"
+                 "\x00\x0b" "COMPRESSION"
+                 "\x00\x02" "\x00\x03" "lz4" "\x00\x06" "snappy");
+
+  // Negotiate LZ4 compression. READY response itself is not compressed.
+  SendRequestAndExpectResponse(
+      BINARY_STRING("\x04\x00\x00\x00\x01" "\x00\x00\x00\x28"
+                    "\x00\x02" "\x00\x0b" "CQL_VERSION"
+                               "\x00\x05" "3.0.0"
+                               "\x00\x0b" "COMPRESSION"
+                               "\x00\x03" "lz4"),
+      BINARY_STRING("\x84\x00\x00\x00\x02" "\x00\x00\x00\x00"));
+
+  // The SUPPORTED response is too small to be compressed.
+  SendRequestAndExpectResponse(
+      CompressedRequest(
+          CQLMessage::CompressionScheme::LZ4, BINARY_STRING("\x04\x01\x00\x00\x05"), ""),
+      kSupportedResponse);
+
+  // Send corrupted LZ4 body
+  SendRequestAndExpectResponse(
+      BINARY_STRING("\x04\x01\x00\x00\x05" "\x00\x00\x00\x06"
+                    "\x00\x00\x00\x10" "\xff\xff"),
+      BINARY_STRING("\x84\x00\x00\x00\x00" "\x00\x00\x00\x35"
+                    "\x00\x00\x00\x0a" "\x00\x2f"
+                    "Failed to uncompress LZ4-compressed CQL message"));
+
+  // Switch to Snappy compression
+  SendRequestAndExpectResponse(
+      BINARY_STRING("\x04\x00\x00\x00\x01" "\x00\x00\x00\x2b"
+                    "\x00\x02" "\x00\x0b" "CQL_VERSION"
+                               "\x00\x05" "3.0.0"
+                               "\x00\x0b" "COMPRESSION"
+                               "\x00\x06" "snappy"),
+      BINARY_STRING("\x84\x00\x00\x00\x02" "\x00\x00\x00\x00"));
+
+  SendRequestAndExpectResponse(
+      CompressedRequest(
+          CQLMessage::CompressionScheme::SNAPPY, BINARY_STRING("\x04\x01\x00\x00\x05"), ""),
+      kSupportedResponse);
 }
 
 TEST_F(TestCQLService, InvalidRequest) {
@@ -224,6 +378,414 @@ TEST_F(TestCQLService, InvalidRequest) {
                     "\x00\x00\x00\x0a" "\x00\x17" "Request length too long"));
 }
 
+class TestCQLCompression : public YBTest {
+};
+
+TEST_F(TestCQLCompression, CompressResponse) {
+  string message;
+  for (int i = 0; i != 100; ++i) {
+    message += Substitute("Error in tablet $0. ", i);
+  }
+  ErrorResponse response(
+      static_cast<CQLMessage::StreamId>(1), ErrorResponse::Code::SERVER_ERROR, message);
+  faststring uncompressed;
+  response.Serialize(CQLMessage::CompressionScheme::NONE, &uncompressed);
+  const Slice uncompressed_body(
+      uncompressed.data() + CQLMessage::kMessageHeaderLength,
+      uncompressed.size() - CQLMessage::kMessageHeaderLength);
+
+  for (auto compression_scheme :
+       {CQLMessage::CompressionScheme::LZ4, CQLMessage::CompressionScheme::SNAPPY}) {
+    faststring mesg;
+    response.Serialize(compression_scheme, &mesg);
+    ASSERT_LT(mesg.size(), uncompressed.size());
+    ASSERT_EQ(static_cast<int>(CQLMessage::kCompressionFlag), mesg[CQLMessage::kHeaderPosFlags]);
+    ASSERT_EQ(mesg.size() - CQLMessage::kMessageHeaderLength,
+              NetworkByteOrder::Load32(mesg.data() + CQLMessage::kHeaderPosLength));
+
+    faststring body;
+    ASSERT_OK(CQLMessage::UncompressBody(
+        compression_scheme,
+        Slice(mesg.data() + CQLMessage::kMessageHeaderLength,
+              mesg.size() - CQLMessage::kMessageHeaderLength),
+        &body));
+    ASSERT_EQ(uncompressed_body, Slice(body.data(), body.size()));
+  }
+
+  // Small response is sent uncompressed.
+  ErrorResponse small_response(
+      static_cast<CQLMessage::StreamId>(1), ErrorResponse::Code::SERVER_ERROR, "Server error");
+  faststring mesg;
+  small_response.Serialize(CQLMessage::CompressionScheme::LZ4, &mesg);
+  ASSERT_EQ(0, mesg[CQLMessage::kHeaderPosFlags]);
+}
+
+namespace {
+
+void AppendCQLBytes(const string& value, string* out) {
+  char length[CQLMessage::kIntSize];
+  NetworkByteOrder::Store32(length, value.size());
+  out->append(length, sizeof(length));
+  out->append(value);
+}
+
+template <class Int>
+string CQLInt(Int value) {
+  string result(sizeof(Int), 0);
+  for (size_t i = sizeof(Int); i-- > 0; value >>= 8) {
+    result[i] = static_cast<char>(value & 0xff);
+  }
+  return result;
+}
+
+// Returns the rows content of a typical result page: rows of (bigint id, text name, text email,
+// text country, int age, timestamp updated_at), each column serialized as CQL <bytes>.
+string MakeRowsPage(int num_rows) {
+  static const vector<string> kCountries = {"US", "India", "Germany", "Brazil", "Japan"};
+  string result = CQLInt<int32_t>(num_rows);
+  const int64_t kBaseTime = 1514764800000;
+  for (int i = 0; i != num_rows; ++i) {
+    const string name = Substitute("user_$0_$1", i, (i * 7919) % 10007);
+    AppendCQLBytes(CQLInt<int64_t>(1000000 + i * 7), &result);
+    AppendCQLBytes(name, &result);
+    AppendCQLBytes(name + "@example.com", &result);
+    AppendCQLBytes(kCountries[i % kCountries.size()], &result);
+    AppendCQLBytes(CQLInt<int32_t>(18 + i % 60), &result);
+    AppendCQLBytes(CQLInt<int64_t>(kBaseTime + i * 1013), &result);
+  }
+  return result;
+}
+
+} // namespace
+
+// Measures bytes on wire and CPU cost of compression for typical result pages.
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(TestCQLCompression, DISABLED_CompressionBenchmark) {
+  constexpr int kIterations = 200;
+  for (int num_rows : {100, 5000}) {
+    const string page = MakeRowsPage(num_rows);
+    for (auto compression_scheme :
+         {CQLMessage::CompressionScheme::LZ4, CQLMessage::CompressionScheme::SNAPPY}) {
+      faststring compressed;
+      faststring uncompressed;
+      MonoDelta compress_time = MonoDelta::FromNanoseconds(0);
+      MonoDelta uncompress_time = MonoDelta::FromNanoseconds(0);
+      for (int i = 0; i != kIterations; ++i) {
+        auto start = MonoTime::FineNow();
+        ASSERT_OK(CQLMessage::CompressBody(compression_scheme, page, &compressed));
+        auto compressed_time = MonoTime::FineNow();
+        ASSERT_OK(CQLMessage::UncompressBody(
+            compression_scheme, Slice(compressed.data(), compressed.size()), &uncompressed));
+        auto uncompressed_time = MonoTime::FineNow();
+        compress_time += compressed_time.GetDeltaSince(start);
+        uncompress_time += uncompressed_time.GetDeltaSince(compressed_time);
+      }
+      ASSERT_EQ(page, uncompressed.ToString());
+      LOG(INFO) << (compression_scheme == CQLMessage::CompressionScheme::LZ4 ? "LZ4" : "Snappy")
+                << ", rows: " << num_rows << ", bytes: " << page.size() << " -> "
+                << compressed.size() << " ("
+                << StringPrintf("%.1f%%", compressed.size() * 100.0 / page.size()) << ")"
+                << ", compress: " << compress_time.ToMicroseconds() / kIterations << "us"
+                << ", uncompress: " << uncompress_time.ToMicroseconds() / kIterations << "us";
+    }
+  }
+}
+
+class TestCQLRowsResponse : public YBTest {
+ protected:
+  // Returns a response to a QUERY request with the rows of a typical result page.
+  std::unique_ptr<CQLResponse> MakeRowsResponse(int num_rows) {
+    string query = "SELECT * FROM t";
+    string body = CQLInt<int32_t>(query.size()) + query + CQLInt<int16_t>(0x0004) + string(1, 0);
+    string mesg = BINARY_STRING("\x04\x00\x00\x01\x07") + CQLInt<int32_t>(body.size()) + body;
+    std::unique_ptr<CQLResponse> error_response;
+    CHECK(CQLRequest::ParseRequest(
+        mesg, CQLMessage::CompressionScheme::NONE, &request_, &error_response));
+
+    auto column_schemas = std::make_shared<std::vector<ColumnSchema>>();
+    column_schemas->emplace_back("id", INT64);
+    column_schemas->emplace_back("name", STRING);
+    column_schemas->emplace_back("email", STRING);
+    column_schemas->emplace_back("country", STRING);
+    column_schemas->emplace_back("age", INT32);
+    column_schemas->emplace_back("updated_at", TIMESTAMP);
+    rows_data_ = RefCntBuffer(MakeRowsPage(num_rows));
+    auto result = std::make_shared<ql::RowsResult>(
+        client::YBTableName("test_ks", "t"), column_schemas, rows_data_);
+    return std::make_unique<RowsResultResponse>(
+        down_cast<const QueryRequest&>(*request_), result);
+  }
+
+  std::unique_ptr<CQLRequest> request_;
+  RefCntBuffer rows_data_;
+};
+
+TEST_F(TestCQLRowsResponse, SerializeToBuffers) {
+  auto response = MakeRowsResponse(100);
+  faststring expected;
+  response->Serialize(CQLMessage::CompressionScheme::NONE, &expected);
+
+  // Rows data is shared by the response buffers instead of being copied into the message.
+  std::vector<RefCntBuffer> buffers;
+  response->SerializeToBuffers(CQLMessage::CompressionScheme::NONE, &buffers);
+  ASSERT_EQ(2, buffers.size());
+  ASSERT_EQ(rows_data_.data(), buffers[1].data());
+  ASSERT_EQ(expected.ToString(), buffers[0].ToBuffer() + buffers[1].ToBuffer());
+
+  // Compressed body is serialized as a single buffer.
+  expected.clear();
+  response->Serialize(CQLMessage::CompressionScheme::LZ4, &expected);
+  buffers.clear();
+  response->SerializeToBuffers(CQLMessage::CompressionScheme::LZ4, &buffers);
+  ASSERT_EQ(1, buffers.size());
+  ASSERT_EQ(expected.ToString(), buffers[0].ToBuffer());
+}
+
+// Measures serialization time of wide result pages, when rows data is copied into the message
+// and when it is shared.
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(TestCQLRowsResponse, DISABLED_SerializeBenchmark) {
+  constexpr int kIterations = 200;
+  for (int num_rows : {100, 5000}) {
+    auto response = MakeRowsResponse(num_rows);
+    auto start = MonoTime::FineNow();
+    for (int i = 0; i != kIterations; ++i) {
+      faststring mesg;
+      response->Serialize(CQLMessage::CompressionScheme::NONE, &mesg);
+      RefCntBuffer buffer(mesg);
+    }
+    auto copied = MonoTime::FineNow();
+    for (int i = 0; i != kIterations; ++i) {
+      std::vector<RefCntBuffer> buffers;
+      response->SerializeToBuffers(CQLMessage::CompressionScheme::NONE, &buffers);
+    }
+    auto shared = MonoTime::FineNow();
+    LOG(INFO) << "Rows: " << num_rows << ", bytes: " << rows_data_.size()
+              << ", copied: " << copied.GetDeltaSince(start).ToMicroseconds() / kIterations
+              << "us, shared: " << shared.GetDeltaSince(copied).ToMicroseconds() / kIterations
+              << "us";
+  }
+}
+
+class TestCQLNormalizedQuery : public YBTest {
+};
+
+TEST_F(TestCQLNormalizedQuery, Normalize) {
+  CQLNormalizedQuery query;
+  ASSERT_TRUE(query.Init("  SELECT v FROM t WHERE h = 1  AND r = 'it''s'\n AND s >= 2.5;"));
+  ASSERT_EQ("SELECT v FROM t WHERE h = ? AND r = ? AND s >= ?;", query.text());
+
+  std::vector<QLValuePB> values;
+  ASSERT_OK(query.BindConstants({ColumnSchema("h", QLType::Create(DataType::INT32)),
+                                 ColumnSchema("r", QLType::Create(DataType::STRING)),
+                                 ColumnSchema("s", QLType::Create(DataType::DOUBLE))},
+                                &values));
+  ASSERT_EQ(3, values.size());
+  ASSERT_EQ(1, values[0].int32_value());
+  ASSERT_EQ("it's", values[1].string_value());
+  ASSERT_EQ(2.5, values[2].double_value());
+
+  // Constants of datatypes that are not converted, and out of range constants.
+  ASSERT_TRUE(query.BindConstants({ColumnSchema("h", QLType::Create(DataType::INT32)),
+                                   ColumnSchema("r", QLType::Create(DataType::TIMESTAMP)),
+                                   ColumnSchema("s", QLType::Create(DataType::DOUBLE))},
+                                  &values).IsNotSupported());
+  ASSERT_TRUE(query.Init("UPDATE t SET v = 300 WHERE h = 1"));
+  ASSERT_TRUE(query.BindConstants({ColumnSchema("v", QLType::Create(DataType::INT8)),
+                                   ColumnSchema("h", QLType::Create(DataType::INT32))},
+                                  &values).IsInvalidArgument());
+
+  // Signed numbers, uuids, blobs, identifiers and quoted identifiers are kept as is.
+  ASSERT_TRUE(query.Init(
+      "insert into t (\"Col 1\", c2, c3, c4, c5) values (-5, 0x0a1f, "
+      "123e4567-e89b-12d3-a456-426655440000, 12345678-1234-1234-1234-123456789012, 7)"));
+  ASSERT_EQ("insert into t (\"Col 1\", c2, c3, c4, c5) values (-5, 0x0a1f, "
+            "123e4567-e89b-12d3-a456-426655440000, 12345678-1234-1234-1234-123456789012, ?)",
+            query.text());
+
+  // Not normalized.
+  ASSERT_FALSE(query.Init("CREATE TABLE t (h int PRIMARY KEY)"));
+  ASSERT_FALSE(query.Init("SELECT v FROM t WHERE h = ?"));
+  ASSERT_FALSE(query.Init("SELECT v FROM t WHERE h = :h"));
+  ASSERT_FALSE(query.Init("SELECT v FROM t WHERE h = 1 -- comment"));
+  ASSERT_FALSE(query.Init("SELECT v FROM t WHERE r = 'abc"));
+}
+
+TEST_F(TestCQLService, QueryCache) {
+  auto hits = METRIC_yb_cqlserver_CQLServerService_QueryCacheHits.Instantiate(metric_entity());
+  auto misses = METRIC_yb_cqlserver_CQLServerService_QueryCacheMisses.Instantiate(metric_entity());
+
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery("CREATE KEYSPACE test_ks"));
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery("USE test_ks"));
+  ASSERT_EQ(CQLMessage::Opcode::RESULT,
+            ExecuteQuery("CREATE TABLE t (h int PRIMARY KEY, v text, d double)"));
+  ASSERT_EQ(0, hits->value());
+  ASSERT_EQ(0, misses->value());
+
+  constexpr int kNumRows = 10;
+  for (int i = 0; i != kNumRows; ++i) {
+    ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery(
+        Substitute("INSERT INTO t (h, v, d) VALUES ($0, 'value_$0', $0.5)", i)));
+  }
+  ASSERT_EQ(kNumRows - 1, hits->value());
+  ASSERT_EQ(1, misses->value());
+
+  for (int i = 0; i != kNumRows; ++i) {
+    string body;
+    ASSERT_EQ(CQLMessage::Opcode::RESULT,
+              ExecuteQuery(Substitute("SELECT v FROM t WHERE h = $0", i), &body));
+    ASSERT_NE(string::npos, body.find(Substitute("value_$0", i))) << i;
+  }
+  ASSERT_EQ(2 * kNumRows - 2, hits->value());
+  ASSERT_EQ(2, misses->value());
+
+  // Constant that is not valid for its column fails the same way as without the cache.
+  ASSERT_EQ(CQLMessage::Opcode::ERROR, ExecuteQuery("INSERT INTO t (h, v) VALUES ('a', 'b')"));
+
+  // Normalized statements are not visible to clients as prepared statements.
+  const string query_id = CQLStatement::GetQueryId("test_ks", "SELECT v FROM t WHERE h = ?");
+  string body;
+  ASSERT_EQ(CQLMessage::Opcode::ERROR, SendRequest(
+      CQLMessage::Opcode::EXECUTE,
+      CQLInt<uint16_t>(query_id.size()) + query_id + CQLInt<int16_t>(0x0001) + string(1, 0),
+      &body));
+  ASSERT_EQ(CQLInt<int32_t>(static_cast<int32_t>(ErrorResponse::Code::UNPREPARED)),
+            body.substr(0, 4));
+
+  // Query of a table that does not exist yet is cached once the table is created.
+  ASSERT_EQ(CQLMessage::Opcode::ERROR, ExecuteQuery("SELECT v FROM u WHERE h = 1"));
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery("CREATE TABLE u (h int PRIMARY KEY, v text)"));
+  const auto num_misses = misses->value();
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery("SELECT v FROM u WHERE h = 1"));
+  ASSERT_EQ(num_misses + 1, misses->value());
+
+  FLAGS_cql_cache_unprepared_queries = false;
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery("SELECT v FROM t WHERE h = 1"));
+  ASSERT_EQ(2 * kNumRows - 2, hits->value());
+}
+
+// Measures parse and analyze time per unprepared statement with and without the query cache.
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(TestCQLService, DISABLED_QueryCacheBenchmark) {
+  auto parse_time = METRIC_handler_latency_yb_cqlserver_SQLProcessor_ParseRequest.Instantiate(
+      metric_entity());
+  auto analyze_time = METRIC_handler_latency_yb_cqlserver_SQLProcessor_AnalyzeRequest.Instantiate(
+      metric_entity());
+
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery("CREATE KEYSPACE test_ks"));
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery("USE test_ks"));
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery(
+      "CREATE TABLE t (h int, r int, v1 text, v2 bigint, v3 double, PRIMARY KEY ((h), r))"));
+
+  constexpr int kNumQueries = 1000;
+  int row = 0;
+  for (bool cache : {false, true}) {
+    FLAGS_cql_cache_unprepared_queries = cache;
+    const auto parse_count = parse_time->TotalCount();
+    const auto analyze_count = analyze_time->TotalCount();
+    const auto start = MonoTime::FineNow();
+    for (int i = 0; i != kNumQueries; ++i, ++row) {
+      ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery(Substitute(
+          "INSERT INTO t (h, r, v1, v2, v3) VALUES ($0, $1, 'value_$0_$1', $2, $1.25)",
+          row % 100, row, row * 1000)));
+    }
+    const auto elapsed = MonoTime::FineNow().GetDeltaSince(start);
+    LOG(INFO) << "Query cache " << (cache ? "enabled" : "disabled")
+              << ": parsed " << parse_time->TotalCount() - parse_count
+              << " times, analyzed " << analyze_time->TotalCount() - analyze_count
+              << " times, mean parse time: " << parse_time->MeanValueForTests()
+              << "us, mean analyze time: " << analyze_time->MeanValueForTests()
+              << "us, latency per query: " << elapsed.ToMicroseconds() / kNumQueries << "us";
+  }
+}
+
+namespace {
+
+// Appends a batch statement with the specified int and text bind values. A prepared statement is
+// referenced by its id, otherwise query is sent as is.
+void AppendBatchStatement(bool is_prepared, const string& query, int32_t h, const string& v,
+                          string* batch) {
+  if (is_prepared) {
+    batch->push_back(1);
+    batch->append(CQLInt<uint16_t>(query.size()));
+    batch->append(query);
+  } else {
+    batch->push_back(0);
+    AppendCQLBytes(query, batch);
+  }
+  batch->append(CQLInt<uint16_t>(2));
+  AppendCQLBytes(CQLInt<int32_t>(h), batch);
+  AppendCQLBytes(v, batch);
+}
+
+string BatchRequestBody(int num_statements, const string& statements) {
+  // LOGGED batch, statements, QUORUM consistency, no flags.
+  return string(1, 0) + CQLInt<uint16_t>(num_statements) + statements +
+         BINARY_STRING("\x00\x04" "\x00");
+}
+
+} // namespace
+
+// Sends batches that repeat prepared and unprepared statements in a row, so that looked up
+// statements and parse trees are reused across statements of the batch.
+TEST_F(TestCQLService, BatchRequest) {
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery("CREATE KEYSPACE test_ks"));
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery("USE test_ks"));
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery("CREATE TABLE t (h int PRIMARY KEY, v text)"));
+
+  const string insert = "INSERT INTO t (h, v) VALUES (?, ?)";
+  string prepare_body;
+  AppendCQLBytes(insert, &prepare_body);
+  string body;
+  ASSERT_EQ(CQLMessage::Opcode::RESULT,
+            SendRequest(CQLMessage::Opcode::PREPARE, prepare_body, &body));
+  // Prepared result: <kind><short bytes id><metadata>.
+  ASSERT_EQ(CQLInt<int32_t>(0x00000004), body.substr(0, 4));
+  const string query_id = body.substr(6, NetworkByteOrder::Load16(body.data() + 4));
+  const string unprepared_id(query_id.size(), 'x');
+
+  // Runs of prepared statements, of the same unprepared query, and then prepared statements again.
+  constexpr int kRunLength = 3;
+  string statements;
+  int h = 0;
+  for (bool is_prepared : {true, false, true}) {
+    for (int i = 0; i != kRunLength; ++i, ++h) {
+      AppendBatchStatement(is_prepared, is_prepared ? query_id : insert, h,
+                           Substitute("value_$0", h), &statements);
+    }
+  }
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, SendRequest(
+      CQLMessage::Opcode::BATCH, BatchRequestBody(h, statements)));
+  for (int i = 0; i != h; ++i) {
+    ASSERT_EQ(CQLMessage::Opcode::RESULT,
+              ExecuteQuery(Substitute("SELECT v FROM t WHERE h = $0", i), &body));
+    ASSERT_NE(string::npos, body.find(Substitute("value_$0", i))) << i;
+  }
+
+  // Unknown statement id in the middle of a run of prepared statements fails the batch.
+  statements.clear();
+  AppendBatchStatement(true, query_id, 100, "value_100", &statements);
+  AppendBatchStatement(true, query_id, 101, "value_101", &statements);
+  AppendBatchStatement(true, unprepared_id, 102, "value_102", &statements);
+  AppendBatchStatement(true, query_id, 103, "value_103", &statements);
+  ASSERT_EQ(CQLMessage::Opcode::ERROR, SendRequest(
+      CQLMessage::Opcode::BATCH, BatchRequestBody(4, statements), &body));
+  ASSERT_EQ(CQLInt<int32_t>(static_cast<int32_t>(ErrorResponse::Code::UNPREPARED)),
+            body.substr(0, 4));
+  // Unprepared error carries the unknown id after the error message.
+  ASSERT_EQ(CQLInt<uint16_t>(unprepared_id.size()) + unprepared_id,
+            body.substr(body.size() - unprepared_id.size() - 2));
+
+  // Statement that follows the unknown id in the next batch is still resolved.
+  statements.clear();
+  AppendBatchStatement(true, query_id, 104, "value_104", &statements);
+  AppendBatchStatement(true, query_id, 105, "value_105", &statements);
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, SendRequest(
+      CQLMessage::Opcode::BATCH, BatchRequestBody(2, statements)));
+  ASSERT_EQ(CQLMessage::Opcode::RESULT, ExecuteQuery("SELECT v FROM t WHERE h = 105", &body));
+  ASSERT_NE(string::npos, body.find("value_105"));
+}
+
 TEST_F(TestCQLService, TestCQLServerEventConst) {
   std::unique_ptr<SchemaChangeEventResponse> response(
       new SchemaChangeEventResponse("", "", "", "", {}));
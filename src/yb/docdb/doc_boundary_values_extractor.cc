@@ -13,9 +13,15 @@
 //
 //
 
+#include <limits>
+
 #include "yb/rocksdb/db/dbformat.h"
 
 #include "yb/docdb/doc_key.h"
+#include "yb/docdb/doc_kv_util.h"
+#include "yb/docdb/value.h"
+
+#include "yb/util/logging.h"
 
 namespace yb {
 namespace docdb {
@@ -29,6 +35,7 @@ Status GetPrimitiveValue(const rocksdb::UserBoundaryValues& values,
 namespace {
 
 constexpr rocksdb::UserBoundaryTag kDocHybridTimeTag = 1;
+constexpr rocksdb::UserBoundaryTag kValueTtlTag = 2;
 // Here we reserve some tags for future use.
 // Because Tag is persistent.
 constexpr rocksdb::UserBoundaryTag kRangeComponentsStart = 10;
@@ -135,6 +142,65 @@ class PrimitiveBoundaryValue : public rocksdb::UserBoundaryValue {
   boost::container::small_vector<uint8_t, 128> buffer_;
 };
 
+// Wrapper for UserBoundaryValue that stores TTL of value in milliseconds.
+// kTableTtl is used for values without their own TTL, so table TTL is applied to them.
+// kNeverExpires is used for values with reset TTL and for intents, that should never be dropped
+// because of TTL.
+class ValueTtlBoundaryValue : public rocksdb::UserBoundaryValue {
+ public:
+  static constexpr uint64_t kTableTtl = 0;
+  static constexpr uint64_t kNeverExpires = std::numeric_limits<uint64_t>::max();
+
+  explicit ValueTtlBoundaryValue(uint64_t ttl_ms) : ttl_ms_(ttl_ms) {
+    BigEndian::Store64(buffer_, ttl_ms);
+  }
+
+  static CHECKED_STATUS Create(Slice data, rocksdb::UserBoundaryValuePtr* value) {
+    CHECK_NOTNULL(value);
+    if (data.size() != sizeof(uint64_t)) {
+      return STATUS_SUBSTITUTE(Corruption, "Wrong size of encoded value TTL: $0", data.size());
+    }
+
+    *value = std::make_shared<ValueTtlBoundaryValue>(BigEndian::Load64(data.data()));
+    return Status::OK();
+  }
+
+  static uint64_t TtlToMilliseconds(const MonoDelta& ttl) {
+    if (ttl.Equals(Value::kMaxTtl)) {
+      return kTableTtl;
+    }
+    const int64_t ms = ttl.ToMilliseconds();
+    if (ms == static_cast<int64_t>(kResetTTL)) {
+      return kNeverExpires;
+    }
+    // Keep explicit TTLs distinguishable from the special values.
+    return std::min<uint64_t>(std::max<int64_t>(ms, 1), kNeverExpires - 1);
+  }
+
+  virtual ~ValueTtlBoundaryValue() {}
+
+  rocksdb::UserBoundaryTag Tag() override {
+    return kValueTtlTag;
+  }
+
+  Slice Encode() override {
+    return Slice(buffer_, sizeof(buffer_));
+  }
+
+  int CompareTo(const UserBoundaryValue& pre_rhs) override {
+    const auto* rhs = down_cast<const ValueTtlBoundaryValue*>(&pre_rhs);
+    return ttl_ms_ < rhs->ttl_ms_ ? -1 : (ttl_ms_ > rhs->ttl_ms_ ? 1 : 0);
+  }
+
+  uint64_t ttl_ms() const {
+    return ttl_ms_;
+  }
+
+ private:
+  uint64_t ttl_ms_;
+  char buffer_[sizeof(uint64_t)];
+};
+
 class DocBoundaryValuesExtractor : public rocksdb::BoundaryValuesExtractor {
  public:
   virtual ~DocBoundaryValuesExtractor() {}
@@ -146,6 +212,9 @@ class DocBoundaryValuesExtractor : public rocksdb::BoundaryValuesExtractor {
     if (tag == kDocHybridTimeTag) {
       return DocHybridTimeValue::Create(data, value);
     }
+    if (tag == kValueTtlTag) {
+      return ValueTtlBoundaryValue::Create(data, value);
+    }
     if (tag >= kRangeComponentsStart) {
       return PrimitiveBoundaryValue::Create(tag - kRangeComponentsStart, data, value);
     }
@@ -154,6 +223,27 @@ class DocBoundaryValuesExtractor : public rocksdb::BoundaryValuesExtractor {
   }
 
   Status Extract(Slice user_key, Slice value, rocksdb::UserBoundaryValues* values) override {
+    CHECK_NOTNULL(values);
+    uint64_t ttl_ms;
+    if (!user_key.empty() && static_cast<ValueType>(user_key[0]) == ValueType::kIntentPrefix) {
+      // Intents are resolved or aborted by transaction, so file containing them should never be
+      // dropped because of TTL.
+      ttl_ms = ValueTtlBoundaryValue::kNeverExpires;
+    } else {
+      MonoDelta ttl;
+      auto status = Value::DecodeTTL(value, &ttl);
+      if (status.ok()) {
+        ttl_ms = ValueTtlBoundaryValue::TtlToMilliseconds(ttl);
+      } else {
+        // TTL is used only to decide whether the whole file could be dropped, so failing the
+        // flush or compaction because of it would be too strict. Just keep such file.
+        YB_LOG_EVERY_N_SECS(WARNING, 10) << "Failed to decode TTL of " << user_key.ToDebugString()
+                                         << ": " << status;
+        ttl_ms = ValueTtlBoundaryValue::kNeverExpires;
+      }
+    }
+    values->push_back(std::make_shared<ValueTtlBoundaryValue>(ttl_ms));
+
     if (user_key.size() >= 2 &&
         static_cast<ValueType>(user_key[0]) == ValueType::kIntentPrefix &&
         static_cast<ValueType>(user_key[1]) == ValueType::kTransactionId) {
@@ -162,7 +252,6 @@ class DocBoundaryValuesExtractor : public rocksdb::BoundaryValuesExtractor {
       return Status::OK();
     }
 
-    CHECK_NOTNULL(values);
     boost::container::small_vector<Slice, 20> slices;
     auto user_key_copy = user_key;
     RETURN_NOT_OK(SubDocKey::PartiallyDecode(&user_key_copy, &slices));
@@ -248,6 +337,36 @@ Status GetDocHybridTime(const rocksdb::UserBoundaryValues& values, DocHybridTime
   return time_value->value(out);
 }
 
+bool AllValuesExpired(const rocksdb::UserBoundaryValues& smallest,
+                      const rocksdb::UserBoundaryValues& largest,
+                      const MonoDelta& table_ttl,
+                      HybridTime history_cutoff) {
+  DocHybridTime max_ht;
+  auto min_ttl = rocksdb::UserValueWithTag(smallest, kValueTtlTag);
+  auto max_ttl = rocksdb::UserValueWithTag(largest, kValueTtlTag);
+  // Files written before value TTL was tracked are never considered expired.
+  if (!min_ttl || !max_ttl || !GetDocHybridTime(largest, &max_ht).ok()) {
+    return false;
+  }
+  const auto min_ttl_ms = down_cast<ValueTtlBoundaryValue*>(min_ttl.get())->ttl_ms();
+  auto ttl_ms = down_cast<ValueTtlBoundaryValue*>(max_ttl.get())->ttl_ms();
+  if (ttl_ms == ValueTtlBoundaryValue::kNeverExpires) {
+    return false;
+  }
+  if (min_ttl_ms == ValueTtlBoundaryValue::kTableTtl) {
+    if (table_ttl.Equals(Value::kMaxTtl)) {
+      return false;
+    }
+    ttl_ms = std::max<uint64_t>(ttl_ms, table_ttl.ToMilliseconds());
+  }
+  bool has_expired = false;
+  if (!HasExpiredTTL(max_ht.hybrid_time(), MonoDelta::FromMilliseconds(ttl_ms), history_cutoff,
+                     &has_expired).ok()) {
+    return false;
+  }
+  return has_expired;
+}
+
 rocksdb::UserBoundaryTag TagForRangeComponent(size_t index) {
   return PrimitiveBoundaryValue::TagForIndex(index);
 }
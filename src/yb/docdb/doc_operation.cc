@@ -23,9 +23,11 @@
 #include "yb/docdb/doc_expr.h"
 #include "yb/docdb/doc_rowwise_iterator.h"
 #include "yb/docdb/doc_ql_scanspec.h"
+#include "yb/docdb/non_blocking_read.h"
 #include "yb/docdb/subdocument.h"
 #include "yb/server/hybrid_clock.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/trace.h"
 
 DECLARE_bool(trace_docdb_calls);
@@ -39,6 +41,11 @@ DEFINE_bool(emulate_redis_responses,
     "and HDEL. If emulate_redis_responses is true, we read the required records to compute the "
     "response as specified by the official Redis API documentation. https://redis.io/commands");
 
+DEFINE_int32(ql_where_evaluation_block_rows, 1024,
+             "Number of rows scanned by a QL read whose WHERE condition is evaluated together as "
+             "a block. Set to 0 to evaluate the condition row by row.");
+TAG_FLAG(ql_where_evaluation_block_rows, advanced);
+
 namespace yb {
 namespace docdb {
 
@@ -1277,6 +1284,20 @@ Status QLWriteOperation::Apply(
 
             auto ql_type = column.type();
 
+            if (column_value.is_increment()) {
+              // A blind increment of a counter column, added up with the older values of the
+              // column when it is read or compacted.
+              if (!column.is_counter() || !column_value.expr().has_value() ||
+                  !column_value.expr().value().has_int64_value()) {
+                return STATUS_FORMAT(InvalidArgument, "Invalid counter increment: $0",
+                                     column_value.ShortDebugString());
+              }
+              RETURN_NOT_OK(doc_write_batch->SetPrimitive(
+                  sub_path, Value::CounterDelta(column_value.expr().value().int64_value()),
+                  InitMarkerBehavior::OPTIONAL));
+              continue;
+            }
+
             WriteAction write_action = WriteAction::REPLACE; // default
             SubDocument sub_doc;
             RETURN_NOT_OK(SubDocument::FromQLExpressionPB(column_value.expr(),
@@ -1433,6 +1454,10 @@ Status QLReadOperation::Execute(const common::QLStorageIf& ql_storage,
     }
     row_count_limit = request_.limit();
   }
+  size_t byte_limit = std::numeric_limits<std::size_t>::max();
+  if (request_.has_limit_bytes() && request_.limit_bytes() > 0 && request_.return_paging_state()) {
+    byte_limit = request_.limit_bytes();
+  }
 
   // Create the projections of the non-key columns selected by the row block plus any referenced in
   // the WHERE condition. When DocRowwiseIterator::NextRow() populates the value map, it uses this
@@ -1444,21 +1469,44 @@ Status QLReadOperation::Execute(const common::QLStorageIf& ql_storage,
   const bool read_static_columns = !static_projection.columns().empty();
   const bool read_distinct_columns = request_.distinct();
 
-  std::unique_ptr<common::QLRowwiseIteratorIf> iter;
   std::unique_ptr<common::QLScanSpec> spec, static_row_spec;
   HybridTime req_hybrid_time;
   RETURN_NOT_OK(ql_storage.BuildQLScanSpec(request_, hybrid_time, schema, read_static_columns,
                                              static_projection, &spec, &static_row_spec,
                                              &req_hybrid_time));
-  RETURN_NOT_OK(ql_storage.GetIterator(request_, query_schema, schema, txn_op_context_,
-                                       req_hybrid_time, &iter));
-  RETURN_NOT_OK(iter->Init(*spec));
-  if (FLAGS_trace_docdb_calls) {
-    TRACE("Initialized iterator");
+  if (iter_ == nullptr) {
+    RETURN_NOT_OK(ql_storage.GetIterator(request_, query_schema, schema, txn_op_context_,
+                                         req_hybrid_time, &iter_));
+    RETURN_NOT_OK(iter_->Init(*spec));
+    if (FLAGS_trace_docdb_calls) {
+      TRACE("Initialized iterator");
+    }
+  } else if (FLAGS_trace_docdb_calls) {
+    TRACE("Resumed iterator");
   }
+  common::QLRowwiseIteratorIf* const iter = iter_.get();
   QLTableRow static_row, non_static_row;
   QLTableRow& selected_row = read_distinct_columns ? static_row : non_static_row;
 
+  // Evaluate a simple WHERE condition over blocks of regular rows instead of row by row. Rows are
+  // buffered and filtered when the block is full. The block is never larger than the number of
+  // rows still to return so that the iterator never moves past the rows that the paging state
+  // needs to resume from. Blocks are not used when the page is limited in bytes since the number
+  // of rows to return is not known in advance.
+  std::unique_ptr<common::QLBatchCondition> batch_condition;
+  std::vector<QLTableRow> block_rows;
+  std::vector<uint8_t> block_match;
+  if (FLAGS_ql_where_evaluation_block_rows > 1 && !read_distinct_columns &&
+      byte_limit == std::numeric_limits<std::size_t>::max() &&
+      request_.has_where_expr() && request_.where_expr().has_condition()) {
+    batch_condition.reset(new common::QLBatchCondition(request_.where_expr().condition()));
+    if (batch_condition->supported()) {
+      block_rows.reserve(FLAGS_ql_where_evaluation_block_rows);
+    } else {
+      batch_condition.reset();
+    }
+  }
+
   // In case when we are continuing a select with a paging state, the static columns for the next
   // row to fetch are not included in the first iterator and we need to fetch them with a separate
   // spec and iterator before beginning the normal fetch below.
@@ -1473,7 +1521,8 @@ Status QLReadOperation::Execute(const common::QLStorageIf& ql_storage,
   }
 
   // Begin the normal fetch.
-  while (resultset->rsrow_count() < row_count_limit && iter->HasNext()) {
+  while (resultset->rsrow_count() < row_count_limit && resultset_bytes_ < byte_limit &&
+         iter->HasNext()) {
 
     // Note that static columns are sorted before non-static columns in DocDB as follows. This is
     // because "<empty_range_components>" is empty and terminated by kGroupEnd which sorts before
@@ -1519,6 +1568,17 @@ Status QLReadOperation::Execute(const common::QLStorageIf& ql_storage,
       }
     }
 
+    if (batch_condition != nullptr) {
+      block_rows.push_back(std::move(selected_row));
+      const size_t block_size = std::min<size_t>(FLAGS_ql_where_evaluation_block_rows,
+                                                 row_count_limit - resultset->rsrow_count());
+      if (block_rows.size() >= block_size) {
+        RETURN_NOT_OK(PopulateResultSet(batch_condition.get(), &block_rows, &block_match,
+                                        resultset));
+      }
+      continue;
+    }
+
     // Match the row with the where condition before adding to the row block.
     bool match = false;
     RETURN_NOT_OK(spec->Match(selected_row, &match));
@@ -1526,11 +1586,14 @@ Status QLReadOperation::Execute(const common::QLStorageIf& ql_storage,
       RETURN_NOT_OK(PopulateResultSet(selected_row, resultset));
     }
   }
+  if (batch_condition != nullptr) {
+    RETURN_NOT_OK(PopulateResultSet(batch_condition.get(), &block_rows, &block_match, resultset));
+  }
   if (FLAGS_trace_docdb_calls) {
     TRACE("Fetched $0 rows.", resultset->rsrow_count());
   }
 
-  if (resultset->rsrow_count() >= row_count_limit) {
+  if (resultset->rsrow_count() >= row_count_limit || resultset_bytes_ >= byte_limit) {
     RETURN_NOT_OK(iter->SetPagingStateIfNecessary(request_, &response_));
   }
 
@@ -1548,10 +1611,37 @@ CHECKED_STATUS QLReadOperation::PopulateResultSet(const QLTableRow& table_row,
     RETURN_NOT_OK(executor.EvalExpr(expr, table_row, rsrow->rscol(rscol_index)));
     rscol_index++;
   }
+  if (request_.has_limit_bytes()) {
+    for (const QLValueWithPB& rscol : rsrow->rscols()) {
+      resultset_bytes_ += rscol.value().ByteSize();
+    }
+  }
 
   return Status::OK();
 }
 
+CHECKED_STATUS QLReadOperation::PopulateResultSet(common::QLBatchCondition* batch_condition,
+                                                  std::vector<QLTableRow>* rows,
+                                                  std::vector<uint8_t>* match,
+                                                  QLResultSet *resultset) {
+  RETURN_NOT_OK(batch_condition->Evaluate(*rows, match));
+  for (size_t i = 0; i < rows->size(); i++) {
+    if ((*match)[i]) {
+      RETURN_NOT_OK(PopulateResultSet((*rows)[i], resultset));
+    }
+  }
+  rows->clear();
+  return Status::OK();
+}
+
+std::unique_ptr<common::QLRowwiseIteratorIf> QLReadOperation::SuspendScan() {
+  // An iterator of a non blocking read refers to the scope it was created in.
+  if (!response_.has_paging_state() || NonBlockingReadScope::Current() != nullptr) {
+    return nullptr;
+  }
+  return std::move(iter_);
+}
+
 const QLResponsePB& QLReadOperation::response() const { return response_; }
 
 }  // namespace docdb
@@ -19,6 +19,7 @@
 
 #include "yb/rocksdb/db.h"
 
+#include "yb/common/ql_batch_condition.h"
 #include "yb/common/ql_storage_interface.h"
 #include "yb/docdb/doc_key.h"
 #include "yb/docdb/doc_path.h"
@@ -206,12 +207,35 @@ class QLReadOperation {
 
   CHECKED_STATUS PopulateResultSet(const QLTableRow& table_row, QLResultSet *result_set);
 
+  // Evaluate the WHERE condition for a block of rows, add the matching rows to the result set and
+  // clear the block.
+  CHECKED_STATUS PopulateResultSet(common::QLBatchCondition* batch_condition,
+                                   std::vector<QLTableRow>* rows,
+                                   std::vector<uint8_t>* match,
+                                   QLResultSet *result_set);
+
   const QLResponsePB& response() const;
 
+  // Continue the scan of a previous page with the iterator released by SuspendScan() instead of
+  // creating and positioning a new one. Must be called before Execute().
+  void ResumeScan(std::unique_ptr<common::QLRowwiseIteratorIf> iter) { iter_ = std::move(iter); }
+
+  // After Execute(), release the iterator positioned at the first row of the next page if the
+  // paging state was returned, or return null otherwise. The iterator of a non blocking read is
+  // not released, as it cannot outlive its NonBlockingReadScope.
+  std::unique_ptr<common::QLRowwiseIteratorIf> SuspendScan();
+
  private:
   const QLReadRequestPB& request_;
   const TransactionOperationContextOpt txn_op_context_;
   QLResponsePB response_;
+
+  // The iterator that scans the rows.
+  std::unique_ptr<common::QLRowwiseIteratorIf> iter_;
+
+  // Approximate number of bytes of the selected values populated in the result set. Only counted
+  // when the request limits the number of bytes to return.
+  size_t resultset_bytes_ = 0;
 };
 
 }  // namespace docdb
@@ -1001,6 +1001,47 @@ SubDocKey(DocKey([], ["k1"]), ["s3"; HT(p=2000)]) -> "v3"; ttl: 0.000s
       )#");
 }
 
+TEST_F(DocDBTest, DropExpiredFilesTest) {
+  const MonoDelta one_ms = MonoDelta::FromMilliseconds(1);
+  const HybridTime t0 = HybridTime::FromMicros(1000);
+  HybridTime t1 = server::HybridClock::AddPhysicalTimeToHybridTime(t0, one_ms);
+  HybridTime t2 = server::HybridClock::AddPhysicalTimeToHybridTime(t1, one_ms);
+  HybridTime t3 = server::HybridClock::AddPhysicalTimeToHybridTime(t2, one_ms);
+
+  auto num_files = [this] {
+    std::vector<rocksdb::LiveFileMetaData> files;
+    rocksdb()->GetLiveFilesMetaData(&files);
+    return files.size();
+  };
+
+  // File with value level TTL only, that expires at t1.
+  ASSERT_OK(SetPrimitive(DocPath(DocKey(PrimitiveValues("k1")).Encode(), PrimitiveValue("s1")),
+      Value(PrimitiveValue("v1"), one_ms), t0, InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(FlushRocksDB());
+  // File with reset TTL, that never expires.
+  ASSERT_OK(SetPrimitive(DocPath(DocKey(PrimitiveValues("k2")).Encode(), PrimitiveValue("s2")),
+      Value(PrimitiveValue("v2"), MonoDelta::FromMilliseconds(0)), t1,
+      InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(FlushRocksDB());
+  ASSERT_EQ(2U, num_files());
+
+  // Expired file is dropped after the next flush, that schedules compaction.
+  SetHistoryCutoffHybridTime(t3);
+  ASSERT_OK(SetPrimitive(DocPath(DocKey(PrimitiveValues("k3")).Encode(), PrimitiveValue("s3")),
+      Value(PrimitiveValue("v3")), t2, InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(FlushRocksDB());
+  ASSERT_OK(WaitFor([&num_files]() -> Result<bool> { return num_files() == 2U; },
+                    MonoDelta::FromSeconds(10), "Expired file dropped"));
+  ASSERT_EQ(1U, options().statistics->getTickerCount(rocksdb::COMPACTION_FILES_FILTERED));
+  ASSERT_GT(options().statistics->getTickerCount(rocksdb::COMPACTION_FILES_FILTERED_BYTES), 0U);
+  SetHistoryCutoffHybridTime(HybridTime::kMin);
+
+  AssertDocDbDebugDumpStrEq(R"#(
+      SubDocKey(DocKey([], ["k2"]), ["s2"; HT(p=2000)]) -> "v2"; ttl: 0.000s
+      SubDocKey(DocKey([], ["k3"]), ["s3"; HT(p=3000)]) -> "v3"
+      )#");
+}
+
 TEST_F(DocDBTest, BasicTest) {
   // A few points to make it easier to understand the expected binary representations here:
   // - Initial bytes such as 'S' (kString), 'I' (kInt64) correspond to members of the enum
@@ -1687,6 +1728,72 @@ SubDocKey(DocKey(0x0000, ["h1"], ["r2"]), ["c8"; HT(p=1000)]) -> "v82"
       )#");
 }
 
+TEST_F(DocDBTest, CounterDeltas) {
+  const DocKey doc_key(PrimitiveValues("k1"));
+  const KeyBytes encoded_doc_key(doc_key.Encode());
+  const DocPath counter_path(encoded_doc_key, PrimitiveValue(ColumnId(10)));
+
+  const auto read_counter = [this, &doc_key](HybridTime ht) -> int64_t {
+    SubDocument doc;
+    bool doc_found = false;
+    // Read both the whole row and the counter itself.
+    EXPECT_OK(GetSubDocument(
+        rocksdb(), SubDocKey(doc_key), rocksdb::kDefaultQueryId,
+        kNonTransactionalOperationContext, &doc, &doc_found, ht));
+    EXPECT_TRUE(doc_found);
+    const SubDocument* counter = doc.GetChild(PrimitiveValue(ColumnId(10)));
+    EXPECT_NE(nullptr, counter);
+    SubDocument counter_doc;
+    EXPECT_OK(GetSubDocument(
+        rocksdb(), SubDocKey(doc_key, PrimitiveValue(ColumnId(10))), rocksdb::kDefaultQueryId,
+        kNonTransactionalOperationContext, &counter_doc, &doc_found, ht));
+    EXPECT_TRUE(doc_found);
+    EXPECT_EQ(counter->GetInt64(), counter_doc.GetInt64());
+    return counter_doc.GetInt64();
+  };
+
+  ASSERT_OK(SetPrimitive(counter_path, Value(PrimitiveValue(static_cast<int64_t>(10))),
+                         HybridTime::FromMicros(1000), InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(SetPrimitive(counter_path, Value::CounterDelta(5),
+                         HybridTime::FromMicros(2000), InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(SetPrimitive(counter_path, Value::CounterDelta(-3),
+                         HybridTime::FromMicros(3000), InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(SetPrimitive(counter_path, Value::CounterDelta(1),
+                         HybridTime::FromMicros(4000), InitMarkerBehavior::OPTIONAL));
+
+  AssertDocDbDebugDumpStrEq(R"#(
+SubDocKey(DocKey([], ["k1"]), [ColumnId(10); HT(p=4000)]) -> 1; counter_delta
+SubDocKey(DocKey([], ["k1"]), [ColumnId(10); HT(p=3000)]) -> -3; counter_delta
+SubDocKey(DocKey([], ["k1"]), [ColumnId(10); HT(p=2000)]) -> 5; counter_delta
+SubDocKey(DocKey([], ["k1"]), [ColumnId(10); HT(p=1000)]) -> 10
+      )#");
+  ASSERT_EQ(10, read_counter(HybridTime::FromMicros(1500)));
+  ASSERT_EQ(15, read_counter(HybridTime::FromMicros(2500)));
+  ASSERT_EQ(12, read_counter(HybridTime::FromMicros(3500)));
+  ASSERT_EQ(13, read_counter(HybridTime::FromMicros(4500)));
+
+  // The newest delta at or below the history cutoff is rewritten as the counter value, and the
+  // older versions are dropped.
+  CompactHistoryBefore(HybridTime::FromMicros(3500));
+  AssertDocDbDebugDumpStrEq(R"#(
+SubDocKey(DocKey([], ["k1"]), [ColumnId(10); HT(p=4000)]) -> 1; counter_delta
+SubDocKey(DocKey([], ["k1"]), [ColumnId(10); HT(p=3000)]) -> 12
+      )#");
+  ASSERT_EQ(13, read_counter(HybridTime::FromMicros(4500)));
+
+  // A delete resets the counter.
+  ASSERT_OK(SetPrimitive(counter_path, Value(PrimitiveValue(ValueType::kTombstone)),
+                         HybridTime::FromMicros(5000), InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(SetPrimitive(counter_path, Value::CounterDelta(2),
+                         HybridTime::FromMicros(6000), InitMarkerBehavior::OPTIONAL));
+  ASSERT_EQ(2, read_counter(HybridTime::FromMicros(6500)));
+
+  CompactHistoryBefore(HybridTime::FromMicros(6500));
+  AssertDocDbDebugDumpStrEq(R"#(
+SubDocKey(DocKey([], ["k1"]), [ColumnId(10); HT(p=6000)]) -> 2
+      )#");
+}
+
 TEST_F(DocDBTest, TestUserTimestamp) {
   const DocKey doc_key(PrimitiveValues("k1"));
   KeyBytes encoded_doc_key(doc_key.Encode());
@@ -1932,5 +2039,35 @@ TEST_F(DocDBTest, TestBuildSubDocumentBounds) {
   EXPECT_FALSE(subdoc_found);
 }
 
+TEST_F(DocDBTest, CompactionKeySplitter) {
+  auto key = [](DocKeyHash hash, const string& range_key) {
+    return SubDocKey(DocKey(hash, PrimitiveValues("h"), PrimitiveValues(range_key)),
+                     PrimitiveValue("s"), HybridTime(1000)).Encode().data();
+  };
+  DocDBCompactionKeySplitter splitter;
+
+  auto split = splitter.Split(key(0x0000, "a"), key(0xffff, "z"), 4);
+  const std::vector<DocKeyHash> expected_hashes = { 0x4000, 0x8000, 0xc000 };
+  ASSERT_EQ(expected_hashes.size(), split.size());
+  for (size_t i = 0; i != split.size(); ++i) {
+    const auto hash = expected_hashes[i];
+    // All records of a document are on the same side of the boundary.
+    ASSERT_LT(key(hash - 1, "z"), split[i]);
+    ASSERT_LE(split[i], key(hash, "a"));
+    ASSERT_EQ(DocKey(hash, {}, {}).Encode().data().substr(0, split[i].size()), split[i]);
+  }
+
+  // Narrow hash range could not be split into the requested number of ranges.
+  ASSERT_EQ(1U, splitter.Split(key(0x0010, "a"), key(0x0011, "z"), 8).size());
+
+  // Documents with the same hash are never split.
+  ASSERT_TRUE(splitter.Split(key(0x0010, "a"), key(0x0010, "z"), 8).empty());
+
+  // Keys of range partitioned tables are not split.
+  ASSERT_TRUE(splitter.Split(
+      DocKey(PrimitiveValues("a")).Encode().data(),
+      DocKey(PrimitiveValues("z")).Encode().data(), 8).empty());
+}
+
 }  // namespace docdb
 }  // namespace yb
@@ -697,6 +697,59 @@ CHECKED_STATUS SeekToLowerBound(const SubDocKeyBound& lower_bound, const HybridT
   return Status::OK();
 }
 
+// Add the older versions of a counter column to the counter delta read from the version at key.
+// Versions are added up to and including the first full value, and down to the first tombstone,
+// expired value or version older than low_ts. The iterator is left positioned within the versions
+// of the column.
+CHECKED_STATUS ResolveCounterDelta(
+    IntentAwareIterator* iter,
+    const KeyBytes& encoded_key,
+    SubDocKey key,
+    const HybridTime high_ts,
+    const DocHybridTime& low_ts,
+    MonoDelta table_ttl,
+    Value* doc_value) {
+  int64_t sum = doc_value->primitive_value().GetInt64();
+  while (true) {
+    // The versions of a key are sorted in the descending order of their hybrid times, so the next
+    // older version is the first one at or below the hybrid time just before this one.
+    const DocHybridTime write_time = key.doc_hybrid_time();
+    key.set_hybrid_time(write_time.write_id() > 0
+        ? DocHybridTime(write_time.hybrid_time(), write_time.write_id() - 1)
+        : DocHybridTime(write_time.hybrid_time().Decremented(), kMaxWriteId));
+    RETURN_NOT_OK(iter->SeekForward(key));
+    if (!iter->valid()) {
+      break;
+    }
+    bool only_lacks_ht = false;
+    RETURN_NOT_OK(encoded_key.OnlyLacksHybridTimeFrom(iter->key(), &only_lacks_ht));
+    if (!only_lacks_ht) {
+      break;
+    }
+    RETURN_NOT_OK(key.FullyDecodeFrom(iter->key()));
+    if (low_ts > key.doc_hybrid_time()) {
+      break;
+    }
+    Value older_value;
+    RETURN_NOT_OK(older_value.Decode(iter->value()));
+    const MonoDelta ttl = ComputeTTL(older_value.ttl(), table_ttl);
+    if (!ttl.Equals(Value::kMaxTtl) &&
+        high_ts.CompareTo(server::HybridClock::AddPhysicalTimeToHybridTime(
+            key.hybrid_time(), ttl)) > 0) {
+      break;
+    }
+    if (older_value.value_type() != ValueType::kInt64) {
+      break;
+    }
+    sum += older_value.primitive_value().GetInt64();
+    if (!older_value.is_counter_delta()) {
+      break;
+    }
+  }
+  *doc_value->mutable_primitive_value() = PrimitiveValue(sum);
+  return Status::OK();
+}
+
 // This works similar to the ScanSubDocument function, but doesn't assume that object init_markers
 // are present. If no init marker is present, or if a tombstone is found at some level,
 // it still looks for subkeys inside it if they have larger timestamps.
@@ -810,6 +863,10 @@ CHECKED_STATUS BuildSubDocument(
         }
 
         DCHECK_GE(high_ts, write_time.hybrid_time());
+        if (doc_value.is_counter_delta()) {
+          RETURN_NOT_OK(ResolveCounterDelta(iter, encoded_key, found_key, high_ts, low_ts,
+                                            table_ttl, &doc_value));
+        }
         if (ttl.Equals(Value::kMaxTtl)) {
           doc_value.mutable_primitive_value()->SetTtl(-1);
         } else {
@@ -943,8 +1000,13 @@ yb::Status GetSubDocument(
   // subdocument_key.
 
   // Check for init-marker / tombstones at the top level, update max_deleted_ts.
+  const DocHybridTime ancestors_max_deleted_ts = max_deleted_ts;
   Value doc_value = Value(PrimitiveValue(ValueType::kInvalidValueType));
   RETURN_NOT_OK(db_iter->FindLastWriteTime(key_bytes, scan_ht, &max_deleted_ts, &doc_value));
+  if (doc_value.is_counter_delta()) {
+    // A counter delta adds to the older versions of the counter instead of overwriting them.
+    max_deleted_ts = ancestors_max_deleted_ts;
+  }
 
   if (return_type_only) {
     *doc_found = doc_value.value_type() != ValueType::kInvalidValueType;
@@ -13,15 +13,21 @@
 
 #include "yb/docdb/docdb_compaction_filter.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 
 #include <glog/logging.h>
 
 #include "yb/rocksdb/compaction_filter.h"
+#include "yb/rocksdb/db/version_edit.h"
 #include "yb/rocksdb/util/string_util.h"
 
 #include "yb/docdb/doc_key.h"
+#include "yb/docdb/docdb.h"
 #include "yb/docdb/docdb-internal.h"
+#include "yb/docdb/docdb_rocksdb_util.h"
+#include "yb/docdb/key_bytes.h"
 #include "yb/docdb/value.h"
 #include "yb/rocksutil/yb_rocksdb.h"
 
@@ -39,13 +45,15 @@ namespace docdb {
 DocDBCompactionFilter::DocDBCompactionFilter(HybridTime history_cutoff,
                                              ColumnIdsPtr deleted_cols,
                                              bool is_full_compaction,
-                                             MonoDelta table_ttl)
+                                             MonoDelta table_ttl,
+                                             rocksdb::DB* db)
     : history_cutoff_(history_cutoff),
       is_full_compaction_(is_full_compaction),
       is_first_key_value_(true),
       filter_usage_logged_(false),
       table_ttl_(table_ttl),
-      deleted_cols_(deleted_cols) {
+      deleted_cols_(deleted_cols),
+      db_(db) {
 }
 
 DocDBCompactionFilter::~DocDBCompactionFilter() {
@@ -148,12 +156,27 @@ bool DocDBCompactionFilter::Filter(int level,
 
   const bool ht_at_or_below_cutoff = ht.hybrid_time() <= history_cutoff_;
 
+  ValueType value_type;
+  CHECK_OK(Value::DecodePrimitiveValueType(existing_value, &value_type));
+
+  // A counter delta only adds to the older versions of the counter, so it overwrites them once it
+  // is rewritten as the counter value it adds up to.
+  bool overwrites = ht_at_or_below_cutoff;
+  if (ht_at_or_below_cutoff && value_type == ValueType::kInt64) {
+    Value value;
+    CHECK_OK(value.Decode(existing_value));
+    if (value.is_counter_delta()) {
+      overwrites = ResolveCounterDelta(subdoc_key, value, new_value);
+      *value_changed = overwrites;
+    }
+  }
+
   // See if we found a higher hybrid_time not exceeding the history cutoff hybrid_time at which the
   // subdocument (including a primitive value) rooted at the current key was fully overwritten.
   // In case ts > history_cutoff_, we just keep the parent document's highest known overwrite
   // hybrid_time that does not exceed the cutoff hybrid_time. In that case this entry is obviously
   // too new to be garbage-collected.
-  overwrite_ht_.push_back(ht_at_or_below_cutoff ? max(prev_overwrite_ht, ht) : prev_overwrite_ht);
+  overwrite_ht_.push_back(overwrites ? max(prev_overwrite_ht, ht) : prev_overwrite_ht);
 
   CHECK_EQ(new_stack_size, overwrite_ht_.size());
   prev_subdoc_key_ = std::move(subdoc_key);
@@ -168,8 +191,6 @@ bool DocDBCompactionFilter::Filter(int level,
     }
   }
 
-  ValueType value_type;
-  CHECK_OK(Value::DecodePrimitiveValueType(existing_value, &value_type));
   MonoDelta ttl;
 
   // If the value expires by the time of history cutoff, it is treated as deleted and filtered out.
@@ -203,6 +224,37 @@ bool DocDBCompactionFilter::Filter(int level,
   return value_type == ValueType::kTombstone && ht_at_or_below_cutoff && is_full_compaction_;
 }
 
+bool DocDBCompactionFilter::ResolveCounterDelta(const SubDocKey& subdoc_key, const Value& delta,
+                                                std::string* new_value) const {
+  if (db_ == nullptr || subdoc_key.num_subkeys() != 1) {
+    return false;
+  }
+
+  // The compaction has not replaced its input files yet, so the versions the delta adds up to are
+  // still readable.
+  const HybridTime read_ht = subdoc_key.hybrid_time();
+  const KeyBytes encoded_doc_key = subdoc_key.doc_key().Encode();
+  auto iter = CreateIntentAwareIterator(
+      db_, BloomFilterMode::USE_BLOOM_FILTER, encoded_doc_key.AsSlice(), rocksdb::kDefaultQueryId,
+      boost::none /* transaction_context */, read_ht);
+  const std::vector<PrimitiveValue> projection = { subdoc_key.subkeys()[0] };
+  SubDocument doc;
+  bool doc_found = false;
+  const Status s = GetSubDocument(iter.get(), SubDocKey(subdoc_key.doc_key()), &doc, &doc_found,
+                                  read_ht, table_ttl_, &projection);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to read counter " << subdoc_key.ToString() << ": " << s.ToString();
+    return false;
+  }
+  const SubDocument* counter = doc_found ? doc.GetChild(projection[0]) : nullptr;
+  if (counter == nullptr || counter->value_type() != ValueType::kInt64) {
+    return false;
+  }
+  *new_value = Value(PrimitiveValue(counter->GetInt64()), delta.ttl(),
+                     delta.user_timestamp()).Encode();
+  return true;
+}
+
 const char* DocDBCompactionFilter::Name() const {
   return "DocDBCompactionFilter";
 }
@@ -223,12 +275,140 @@ unique_ptr<CompactionFilter> DocDBCompactionFilterFactory::CreateCompactionFilte
   return unique_ptr<DocDBCompactionFilter>(
       new DocDBCompactionFilter(retention_policy_->GetHistoryCutoff(),
                                 retention_policy_->GetDeletedColumns(),
-                                context.is_full_compaction, retention_policy_->GetTableTTL()));
+                                context.is_full_compaction, retention_policy_->GetTableTTL(),
+                                db_.load()));
+}
+
+Status GetDocHybridTime(const rocksdb::UserBoundaryValues& values, DocHybridTime* out);
+
+bool AllValuesExpired(const rocksdb::UserBoundaryValues& smallest,
+                      const rocksdb::UserBoundaryValues& largest,
+                      const MonoDelta& table_ttl,
+                      HybridTime history_cutoff);
+
+std::vector<rocksdb::FileMetaData*> DocDBCompactionFilterFactory::FilesToDelete(
+    const std::vector<rocksdb::FileMetaData*>& files) {
+  const auto history_cutoff = retention_policy_->GetHistoryCutoff();
+  const auto table_ttl = retention_policy_->GetTableTTL();
+
+  struct FileInfo {
+    rocksdb::FileMetaData* file;
+    DocHybridTime min_ht;
+    DocHybridTime max_ht;
+    bool expired;
+  };
+
+  std::vector<FileInfo> infos;
+  infos.reserve(files.size());
+  for (auto* file : files) {
+    FileInfo info = { file, DocHybridTime::kMin, DocHybridTime::kMax, false };
+    // Missing hybrid times are replaced with the most restrictive values.
+    if (!GetDocHybridTime(file->smallest.user_values, &info.min_ht).ok()) {
+      info.min_ht = DocHybridTime::kMin;
+    }
+    if (!GetDocHybridTime(file->largest.user_values, &info.max_ht).ok()) {
+      info.max_ht = DocHybridTime::kMax;
+    }
+    info.expired = !file->being_compacted &&
+                   AllValuesExpired(file->smallest.user_values, file->largest.user_values,
+                                    table_ttl, history_cutoff);
+    infos.push_back(info);
+  }
+  std::sort(infos.begin(), infos.end(), [](const FileInfo& lhs, const FileInfo& rhs) {
+    return lhs.max_ht < rhs.max_ht;
+  });
+
+  // min_ht_after[i] is the minimal hybrid time of files starting from i-th in sorted order.
+  std::vector<DocHybridTime> min_ht_after(infos.size() + 1, DocHybridTime::kMax);
+  for (size_t i = infos.size(); i-- > 0;) {
+    min_ht_after[i] = std::min(min_ht_after[i + 1], infos[i].min_ht);
+  }
+
+  // Pick the longest prefix of expired files, that does not overlap with remaining files by
+  // hybrid time.
+  size_t num_expired = 0;
+  for (size_t i = 0; i != infos.size() && infos[i].expired; ++i) {
+    if (infos[i].max_ht < min_ht_after[i + 1]) {
+      num_expired = i + 1;
+    }
+  }
+  if (num_expired == 0) {
+    return {};
+  }
+
+  std::vector<rocksdb::FileMetaData*> result;
+  for (auto* file : files) {
+    for (size_t i = 0; i != num_expired; ++i) {
+      if (infos[i].file == file) {
+        result.push_back(file);
+        break;
+      }
+    }
+  }
+  return result;
 }
 
 const char* DocDBCompactionFilterFactory::Name() const {
   return "DocDBCompactionFilterFactory";
 }
 
+namespace {
+
+constexpr uint32_t kNumHashValues = std::numeric_limits<DocKeyHash>::max() + 1;
+
+bool HasHash(const rocksdb::Slice& key) {
+  return key.size() >= 1 + sizeof(DocKeyHash) &&
+         key[0] == static_cast<uint8_t>(ValueType::kUInt16Hash);
+}
+
+DocKeyHash DecodeHash(const rocksdb::Slice& key) {
+  return BigEndian::Load16(key.data() + 1);
+}
+
+} // namespace
+
+std::vector<std::string> DocDBCompactionKeySplitter::Split(
+    const rocksdb::Slice& smallest, const rocksdb::Slice& largest, size_t max_ranges) {
+  std::vector<std::string> result;
+  const char hash_prefix_char = static_cast<char>(ValueType::kUInt16Hash);
+  const rocksdb::Slice hash_prefix(&hash_prefix_char, 1);
+
+  // Range of hash values [first_hash, end_hash) covered by the compaction.
+  uint32_t first_hash;
+  if (HasHash(smallest)) {
+    first_hash = DecodeHash(smallest);
+  } else if (smallest.compare(hash_prefix) < 0) {
+    first_hash = 0;
+  } else {
+    return result;
+  }
+  uint32_t end_hash;
+  if (HasHash(largest)) {
+    end_hash = DecodeHash(largest) + 1;
+  } else if (largest.compare(hash_prefix) > 0) {
+    end_hash = kNumHashValues;
+  } else {
+    return result;
+  }
+
+  for (size_t i = 1; i < max_ranges; ++i) {
+    const uint32_t hash = first_hash + (end_hash - first_hash) * i / max_ranges;
+    if (hash <= first_hash || hash >= end_hash) {
+      continue;
+    }
+    KeyBytes key;
+    key.AppendValueType(ValueType::kUInt16Hash);
+    key.AppendUInt16(static_cast<DocKeyHash>(hash));
+    if (result.empty() || result.back() != key.data()) {
+      result.push_back(key.data());
+    }
+  }
+  return result;
+}
+
+const char* DocDBCompactionKeySplitter::Name() const {
+  return "DocDBCompactionKeySplitter";
+}
+
 }  // namespace docdb
 }  // namespace yb
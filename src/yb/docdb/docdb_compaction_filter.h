@@ -23,6 +23,11 @@
 #include "yb/common/schema.h"
 #include "yb/common/hybrid_time.h"
 #include "yb/docdb/doc_key.h"
+#include "yb/docdb/value.h"
+
+namespace rocksdb {
+class DB;
+}
 
 namespace yb {
 namespace docdb {
@@ -32,7 +37,8 @@ class DocDBCompactionFilter : public rocksdb::CompactionFilter {
   DocDBCompactionFilter(HybridTime history_cutoff,
                         ColumnIdsPtr deleted_cols,
                         bool is_full_compaction,
-                        MonoDelta table_ttl);
+                        MonoDelta table_ttl,
+                        rocksdb::DB* db = nullptr);
 
   ~DocDBCompactionFilter() override;
   bool Filter(int level,
@@ -43,6 +49,11 @@ class DocDBCompactionFilter : public rocksdb::CompactionFilter {
   const char* Name() const override;
 
  private:
+  // Rewrite the counter delta at the given key as the value of the counter at the hybrid time of
+  // the key, read from db_. Return false if the value cannot be read.
+  bool ResolveCounterDelta(const SubDocKey& subdoc_key, const Value& delta,
+                           std::string* new_value) const;
+
   // We will not keep history below this hybrid_time. The view of the database at this hybrid_time
   // is preserved, but after the compaction completes, we should not expect to be able to do
   // consistent scans at DocDB hybrid_times lower than this. Those scans will result in missing
@@ -100,6 +111,10 @@ class DocDBCompactionFilter : public rocksdb::CompactionFilter {
   MonoDelta table_ttl_;
 
   ColumnIdsPtr deleted_cols_;
+
+  // The DB being compacted, used to read the values counter deltas add up to. Counter deltas are
+  // kept as they are if not set.
+  rocksdb::DB* db_;
 };
 
 // A strategy for deciding the history cutoff. We may implement this differently in production and
@@ -143,10 +158,32 @@ class DocDBCompactionFilterFactory : public rocksdb::CompactionFilterFactory {
   ~DocDBCompactionFilterFactory() override;
   std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
       const rocksdb::CompactionFilter::Context& context) override;
+
+  // Returns files whose records all have expired TTL at the history cutoff. Only the oldest files
+  // are returned, i.e. records of returned files are older than records of all other files, so
+  // dropping them could not expose records that were shadowed by expired ones.
+  std::vector<rocksdb::FileMetaData*> FilesToDelete(
+      const std::vector<rocksdb::FileMetaData*>& files) override;
+
   const char* Name() const override;
 
+  // Set the DB the filters created compact, once it is open.
+  void SetDB(rocksdb::DB* db) { db_.store(db); }
+
  private:
   std::shared_ptr<HistoryRetentionPolicy> retention_policy_;
+  std::atomic<rocksdb::DB*> db_{nullptr};
+};
+
+// Splits key range of full compactions on hash partition boundaries of DocKeys, so all records of
+// a document are compacted by the same subcompaction, and its DocDBCompactionFilter sees them
+// together. Hash values are uniformly distributed, so hash ranges of equal width contain similar
+// amount of data. Keys without hash, i.e. of range partitioned tables, are not split.
+class DocDBCompactionKeySplitter : public rocksdb::CompactionKeySplitter {
+ public:
+  std::vector<std::string> Split(
+      const rocksdb::Slice& smallest, const rocksdb::Slice& largest, size_t max_ranges) override;
+  const char* Name() const override;
 };
 
 }  // namespace docdb
@@ -20,7 +20,9 @@
 #include "yb/rocksdb/rate_limiter.h"
 #include "yb/rocksdb/table.h"
 
+#include "yb/docdb/docdb_compaction_filter.h"
 #include "yb/docdb/intent_aware_iterator.h"
+#include "yb/docdb/non_blocking_read.h"
 #include "yb/rocksutil/yb_rocksdb.h"
 #include "yb/rocksutil/yb_rocksdb_logger.h"
 #include "yb/server/hybrid_clock.h"
@@ -50,6 +52,9 @@ DEFINE_int64(rocksdb_compact_flush_rate_limit_bytes_per_sec, 100 * 1024 * 1024,
              "Use to control write rate of flush and compaction.");
 DEFINE_uint64(rocksdb_compaction_size_threshold_bytes, 2ULL * 1024 * 1024 * 1024,
              "Threshold beyond which compaction is considered large.");
+DEFINE_int32(rocksdb_max_subcompactions, 1,
+             "Maximal number of parallel subcompactions that a full compaction is split into. "
+             "Compaction is split on hash partition boundaries of document keys.");
 DEFINE_uint64(rocksdb_max_file_size_for_compaction, 0,
              "Maximal allowed file size to participate in RocksDB compaction. 0 - unlimited.");
 
@@ -288,8 +293,8 @@ unique_ptr<rocksdb::Iterator> CreateRocksDBIterator(
     const boost::optional<const Slice>& user_key_for_filter,
     const rocksdb::QueryId query_id,
     std::shared_ptr<rocksdb::ReadFileFilter> file_filter) {
-  return unique_ptr<rocksdb::Iterator>(rocksdb->NewIterator(PrepareReadOptions(rocksdb,
-      bloom_filter_mode, user_key_for_filter, query_id, std::move(file_filter))));
+  return NewDocDBRocksIterator(rocksdb, PrepareReadOptions(rocksdb,
+      bloom_filter_mode, user_key_for_filter, query_id, std::move(file_filter)));
 }
 
 unique_ptr<IntentAwareIterator> CreateIntentAwareIterator(
@@ -367,10 +372,18 @@ void InitRocksDBOptions(
     options->compaction_options_universal.min_merge_width =
         FLAGS_rocksdb_universal_compaction_min_merge_width;
     options->compaction_size_threshold_bytes = FLAGS_rocksdb_compaction_size_threshold_bytes;
-    if (FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec > 0) {
+    if (tablet_options.rate_limiter) {
+      options->rate_limiter = tablet_options.rate_limiter;
+    } else if (FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec > 0) {
       options->rate_limiter.reset(
           rocksdb::NewGenericRateLimiter(FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec));
     }
+    options->priority_thread_pool_for_compactions =
+        tablet_options.priority_thread_pool_for_compactions;
+    if (FLAGS_rocksdb_max_subcompactions > 1) {
+      options->max_subcompactions = FLAGS_rocksdb_max_subcompactions;
+      options->compaction_key_splitter = std::make_shared<DocDBCompactionKeySplitter>();
+    }
   }
 
   uint64_t max_file_size_for_compaction = FLAGS_rocksdb_max_file_size_for_compaction;
@@ -82,10 +82,18 @@ Status DocDBRocksDBUtil::OpenRocksDB() {
     RETURN_NOT_OK(InitRocksDBDir());
   }
 
+  auto* compaction_filter_factory = dynamic_cast<DocDBCompactionFilterFactory*>(
+      rocksdb_options_.compaction_filter_factory.get());
+  if (compaction_filter_factory != nullptr) {
+    compaction_filter_factory->SetDB(nullptr);
+  }
   rocksdb::DB* rocksdb = nullptr;
   RETURN_NOT_OK(rocksdb::DB::Open(rocksdb_options_, rocksdb_dir_, &rocksdb));
   LOG(INFO) << "Opened RocksDB at " << rocksdb_dir_;
   rocksdb_.reset(rocksdb);
+  if (compaction_filter_factory != nullptr) {
+    compaction_filter_factory->SetDB(rocksdb);
+  }
   return Status::OK();
 }
 
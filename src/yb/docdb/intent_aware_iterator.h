@@ -20,6 +20,7 @@
 #include "yb/rocksdb/options.h"
 #include "yb/docdb/doc_key.h"
 #include "yb/docdb/key_bytes.h"
+#include "yb/docdb/non_blocking_read.h"
 
 namespace yb {
 
@@ -47,8 +48,9 @@ class IntentAwareIterator {
       HybridTime high_ht,
       const TransactionOperationContextOpt& txn_op_context)
       : high_ht_(high_ht), txn_op_context_(txn_op_context),
-        iter_(rocksdb->NewIterator(read_opts)),
-        intent_iter_(txn_op_context.is_initialized() ? rocksdb->NewIterator(read_opts) : nullptr) {
+        iter_(NewDocDBRocksIterator(rocksdb, read_opts)),
+        intent_iter_(txn_op_context.is_initialized() ? NewDocDBRocksIterator(rocksdb, read_opts)
+                                                     : nullptr) {
   }
   IntentAwareIterator(const IntentAwareIterator& other) = delete;
   void operator=(const IntentAwareIterator& other) = delete;
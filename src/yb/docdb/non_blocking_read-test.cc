@@ -0,0 +1,193 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "yb/docdb/docdb_rocksdb_util.h"
+#include "yb/docdb/docdb_test_base.h"
+#include "yb/docdb/non_blocking_read.h"
+
+#include "yb/util/countdown_latch.h"
+#include "yb/util/format.h"
+#include "yb/util/random_util.h"
+#include "yb/util/size_literals.h"
+#include "yb/util/test_macros.h"
+#include "yb/util/test_util.h"
+#include "yb/util/threadpool.h"
+
+using namespace yb::size_literals;
+
+DEFINE_int32(non_blocking_read_test_num_keys, 50000, "Number of keys in the benchmark.");
+DEFINE_int32(non_blocking_read_test_num_reads, 20000, "Number of reads in each benchmark run.");
+
+namespace yb {
+namespace docdb {
+
+class NonBlockingReadTest : public DocDBTestBase {
+ protected:
+  // Block cache is much smaller than the data, so most of random reads miss it.
+  size_t block_cache_size() const override { return 256_KB; }
+
+  static std::string KeyName(int index) {
+    return Format("key_$0", index);
+  }
+
+  void WriteKeys(int num_keys) {
+    for (int i = 0; i != num_keys; ++i) {
+      ASSERT_OK(SetPrimitive(
+          DocPath(DocKey(PrimitiveValues(KeyName(i))).Encode(), PrimitiveValue("c")),
+          Value(PrimitiveValue(i)), HybridTime::FromMicros(1000)));
+    }
+  }
+
+  // Reopens RocksDB with empty block cache and table cache.
+  void ResetCaches() {
+    ASSERT_OK(InitRocksDBOptions());
+    ASSERT_OK(ReopenRocksDB());
+  }
+
+  bool ReadKey(int index) {
+    auto iter = CreateRocksDBIterator(
+        rocksdb(), BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId);
+    auto key = DocKey(PrimitiveValues(KeyName(index))).Encode();
+    iter->Seek(key.AsSlice());
+    return iter->Valid() && iter->key().starts_with(key.AsSlice());
+  }
+
+  // Performs random reads using num_threads threads. When io_pool is specified, each read is
+  // performed without IO first, and reads that require IO are continued in io_pool.
+  void RandomReads(int num_threads, ThreadPool* io_pool);
+};
+
+void NonBlockingReadTest::RandomReads(int num_threads, ThreadPool* io_pool) {
+  const int num_reads = FLAGS_non_blocking_read_test_num_reads;
+  const int num_keys = FLAGS_non_blocking_read_test_num_keys;
+  ResetCaches();
+
+  CountDownLatch latch(num_reads);
+  std::atomic<int> found(0);
+  std::atomic<int> suspended(0);
+  std::atomic<int> failed_submits(0);
+  std::vector<std::thread> threads;
+  auto start = MonoTime::Now(MonoTime::FINE);
+  for (int t = 0; t != num_threads; ++t) {
+    threads.emplace_back([this, t, num_threads, num_reads, num_keys, io_pool, &latch, &found,
+                          &suspended, &failed_submits] {
+      for (int i = t; i < num_reads; i += num_threads) {
+        int index = RandomUniformInt(0, num_keys - 1);
+        if (io_pool) {
+          NonBlockingReadScope scope;
+          bool read_found = ReadKey(index);
+          if (scope.incomplete()) {
+            ++suspended;
+            auto status = io_pool->SubmitFunc([this, index, &latch, &found] {
+              found += ReadKey(index);
+              latch.CountDown();
+            });
+            if (!status.ok()) {
+              ++failed_submits;
+              latch.CountDown();
+            }
+            continue;
+          }
+          found += read_found;
+        } else {
+          found += ReadKey(index);
+        }
+        latch.CountDown();
+      }
+    });
+  }
+  latch.Wait();
+  auto passed = MonoTime::Now(MonoTime::FINE).GetDeltaSince(start);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(0, failed_submits.load());
+  ASSERT_EQ(num_reads, found.load());
+  LOG(INFO) << (io_pool ? "Non blocking" : "Blocking") << " reads, threads: " << num_threads
+            << ", suspended: " << suspended.load() << ", time: " << passed.ToMilliseconds()
+            << "ms, reads/s: " << num_reads / passed.ToSeconds();
+}
+
+TEST_F(NonBlockingReadTest, ColdCache) {
+  WriteKeys(1000);
+  ASSERT_OK(FlushRocksDB());
+  ResetCaches();
+
+  {
+    NonBlockingReadScope scope;
+    ReadKey(500);
+    ASSERT_TRUE(scope.incomplete());
+  }
+
+  // Blocking read loads required blocks to the cache.
+  ASSERT_TRUE(ReadKey(500));
+
+  {
+    NonBlockingReadScope scope;
+    ASSERT_TRUE(ReadKey(500));
+    ASSERT_FALSE(scope.incomplete());
+  }
+}
+
+TEST_F(NonBlockingReadTest, Memtable) {
+  WriteKeys(100);
+
+  NonBlockingReadScope scope;
+  for (int i = 0; i != 100; ++i) {
+    ASSERT_TRUE(ReadKey(i));
+  }
+  ASSERT_FALSE(scope.incomplete());
+}
+
+TEST_F(NonBlockingReadTest, NestedScope) {
+  WriteKeys(100);
+  ASSERT_OK(FlushRocksDB());
+  ResetCaches();
+
+  NonBlockingReadScope outer;
+  {
+    NonBlockingReadScope inner;
+    ReadKey(10);
+    ASSERT_TRUE(inner.incomplete());
+  }
+  ASSERT_TRUE(outer.incomplete());
+}
+
+// Compares random reads with cold cache, when reads block on IO in the reading threads, with reads
+// that are continued in the IO thread pool, when they require IO.
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(NonBlockingReadTest, DISABLED_ColdCacheRandomReadBenchmark) {
+  WriteKeys(FLAGS_non_blocking_read_test_num_keys);
+  ASSERT_OK(FlushRocksDB());
+
+  for (int num_threads : {1, 4, 16, 64}) {
+    RandomReads(num_threads, nullptr /* io_pool */);
+  }
+
+  constexpr int kNonBlockingReaders = 4;
+  for (int num_io_threads : {1, 4, 16, 64}) {
+    std::unique_ptr<ThreadPool> io_pool;
+    ASSERT_OK(ThreadPoolBuilder("read-io").set_max_threads(num_io_threads).Build(&io_pool));
+    LOG(INFO) << "IO threads: " << num_io_threads;
+    RandomReads(kNonBlockingReaders, io_pool.get());
+    io_pool->Shutdown();
+  }
+}
+
+} // namespace docdb
+} // namespace yb
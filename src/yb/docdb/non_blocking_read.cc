@@ -0,0 +1,119 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/docdb/non_blocking_read.h"
+
+#include <glog/logging.h>
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+thread_local NonBlockingReadScope* current_non_blocking_read_scope = nullptr;
+
+// RocksDB reports reads that would require IO with the Incomplete status of the iterator, but
+// DocDB does not check iterator status after positioning. So we check it here after each
+// positioning operation, and report it to the scope.
+class NonBlockingIterator : public rocksdb::Iterator {
+ public:
+  NonBlockingIterator(std::unique_ptr<rocksdb::Iterator> iterator, NonBlockingReadScope* scope)
+      : iterator_(std::move(iterator)), scope_(scope) {}
+
+  bool Valid() const override {
+    return iterator_->Valid();
+  }
+
+  void SeekToFirst() override {
+    iterator_->SeekToFirst();
+    CheckIncomplete();
+  }
+
+  void SeekToLast() override {
+    iterator_->SeekToLast();
+    CheckIncomplete();
+  }
+
+  void Seek(const rocksdb::Slice& target) override {
+    iterator_->Seek(target);
+    CheckIncomplete();
+  }
+
+  void Next() override {
+    iterator_->Next();
+    CheckIncomplete();
+  }
+
+  void Prev() override {
+    iterator_->Prev();
+    CheckIncomplete();
+  }
+
+  rocksdb::Slice key() const override {
+    return iterator_->key();
+  }
+
+  rocksdb::Slice value() const override {
+    return iterator_->value();
+  }
+
+  rocksdb::Status status() const override {
+    return iterator_->status();
+  }
+
+  rocksdb::Status GetProperty(std::string prop_name, std::string* prop) override {
+    return iterator_->GetProperty(std::move(prop_name), prop);
+  }
+
+ private:
+  void CheckIncomplete() {
+    if (!iterator_->Valid() && iterator_->status().IsIncomplete()) {
+      scope_->SetIncomplete();
+    }
+  }
+
+  std::unique_ptr<rocksdb::Iterator> iterator_;
+  NonBlockingReadScope* scope_;
+};
+
+} // namespace
+
+NonBlockingReadScope::NonBlockingReadScope() : previous_(current_non_blocking_read_scope) {
+  current_non_blocking_read_scope = this;
+}
+
+NonBlockingReadScope::~NonBlockingReadScope() {
+  DCHECK_EQ(current_non_blocking_read_scope, this);
+  current_non_blocking_read_scope = previous_;
+  if (previous_ && incomplete_) {
+    previous_->SetIncomplete();
+  }
+}
+
+NonBlockingReadScope* NonBlockingReadScope::Current() {
+  return current_non_blocking_read_scope;
+}
+
+std::unique_ptr<rocksdb::Iterator> NewDocDBRocksIterator(
+    rocksdb::DB* rocksdb, rocksdb::ReadOptions read_opts) {
+  auto* scope = NonBlockingReadScope::Current();
+  if (!scope) {
+    return std::unique_ptr<rocksdb::Iterator>(rocksdb->NewIterator(read_opts));
+  }
+  read_opts.read_tier = rocksdb::kBlockCacheTier;
+  std::unique_ptr<rocksdb::Iterator> iterator(rocksdb->NewIterator(read_opts));
+  return std::make_unique<NonBlockingIterator>(std::move(iterator), scope);
+}
+
+} // namespace docdb
+} // namespace yb
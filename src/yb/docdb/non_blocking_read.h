@@ -0,0 +1,65 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_DOCDB_NON_BLOCKING_READ_H
+#define YB_DOCDB_NON_BLOCKING_READ_H
+
+#include <memory>
+
+#include "yb/rocksdb/db.h"
+#include "yb/rocksdb/options.h"
+
+#include "yb/gutil/macros.h"
+
+namespace yb {
+namespace docdb {
+
+// While an instance of this class exists, RocksDB iterators created by DocDB on the current thread
+// read only from memtables and block cache, i.e. never block on disk IO.
+//
+// When some data could not be read without IO, the iterator stops as if there was no more data,
+// and the scope is marked as incomplete. Since the result of such read is not reliable, the caller
+// should discard it and repeat the read without this scope, usually in a thread that could afford
+// blocking on IO. The repeated read fills the block cache, so subsequent non blocking reads of the
+// same data succeed.
+//
+// Iterators created while the scope exists report to it, so they should not outlive the scope.
+class NonBlockingReadScope {
+ public:
+  NonBlockingReadScope();
+  ~NonBlockingReadScope();
+
+  // Whether some read in this scope required IO.
+  bool incomplete() const { return incomplete_; }
+
+  void SetIncomplete() { incomplete_ = true; }
+
+  // Returns the innermost scope of the current thread, or nullptr when reads are allowed to block.
+  static NonBlockingReadScope* Current();
+
+ private:
+  NonBlockingReadScope* previous_;
+  bool incomplete_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(NonBlockingReadScope);
+};
+
+// Creates a RocksDB iterator with the specified options. Should be used by DocDB instead of
+// rocksdb::DB::NewIterator, so the iterator respects NonBlockingReadScope of the current thread.
+std::unique_ptr<rocksdb::Iterator> NewDocDBRocksIterator(
+    rocksdb::DB* rocksdb, rocksdb::ReadOptions read_opts);
+
+} // namespace docdb
+} // namespace yb
+
+#endif // YB_DOCDB_NON_BLOCKING_READ_H
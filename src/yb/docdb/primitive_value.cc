@@ -52,6 +52,7 @@ using yb::util::FastDecodeSignedVarInt;
     case ValueType::kRedisTS: FALLTHROUGH_INTENDED; \
     case ValueType::kTtl: FALLTHROUGH_INTENDED; \
     case ValueType::kUserTimestamp: FALLTHROUGH_INTENDED; \
+    case ValueType::kCounterDelta: FALLTHROUGH_INTENDED; \
     case ValueType::kTombstone: \
       break
 
@@ -169,6 +170,7 @@ string PrimitiveValue::ToString() const {
     case ValueType::kGroupEndDescending: FALLTHROUGH_INTENDED;
     case ValueType::kTtl: FALLTHROUGH_INTENDED;
     case ValueType::kUserTimestamp: FALLTHROUGH_INTENDED;
+    case ValueType::kCounterDelta: FALLTHROUGH_INTENDED;
     case ValueType::kIntentPrefix:
       break;
     case ValueType::kLowest:
@@ -419,6 +421,7 @@ string PrimitiveValue::ToValue() const {
     case ValueType::kIntentPrefix: FALLTHROUGH_INTENDED;
     case ValueType::kTtl: FALLTHROUGH_INTENDED;
     case ValueType::kUserTimestamp: FALLTHROUGH_INTENDED;
+    case ValueType::kCounterDelta: FALLTHROUGH_INTENDED;
     case ValueType::kColumnId: FALLTHROUGH_INTENDED;
     case ValueType::kSystemColumnId: FALLTHROUGH_INTENDED;
     case ValueType::kHybridTime: FALLTHROUGH_INTENDED;
@@ -888,6 +891,7 @@ Status PrimitiveValue::DecodeFromValue(const rocksdb::Slice& rocksdb_slice) {
     case ValueType::kInvalidValueType: FALLTHROUGH_INTENDED;
     case ValueType::kTtl: FALLTHROUGH_INTENDED;
     case ValueType::kUserTimestamp: FALLTHROUGH_INTENDED;
+    case ValueType::kCounterDelta: FALLTHROUGH_INTENDED;
     case ValueType::kColumnId: FALLTHROUGH_INTENDED;
     case ValueType::kSystemColumnId: FALLTHROUGH_INTENDED;
     case ValueType::kHybridTime: FALLTHROUGH_INTENDED;
@@ -54,5 +54,25 @@ TEST_F(ValueTest, TestEncodeDecode) {
   ASSERT_EQ(ValueType::kInt64, value_type);
 }
 
+TEST_F(ValueTest, TestCounterDelta) {
+  Value value = Value::CounterDelta(-5);
+  ASSERT_TRUE(value.is_counter_delta());
+  std::string value_bytes = value.Encode();
+
+  Value decoded_value;
+  ASSERT_OK(decoded_value.Decode(value_bytes));
+  ASSERT_TRUE(decoded_value.is_counter_delta());
+  ASSERT_EQ(-5, decoded_value.primitive_value().GetInt64());
+  ASSERT_EQ("-5; counter_delta", decoded_value.ToString());
+
+  ValueType value_type;
+  ASSERT_OK(Value::DecodePrimitiveValueType(value_bytes, &value_type));
+  ASSERT_EQ(ValueType::kInt64, value_type);
+
+  // A full value is not a delta.
+  ASSERT_OK(decoded_value.Decode(Value(PrimitiveValue(static_cast<int64_t>(5))).Encode()));
+  ASSERT_FALSE(decoded_value.is_counter_delta());
+}
+
 }  // namespace docdb
 }  // namespace yb
@@ -84,6 +84,10 @@ Status Value::Decode(const rocksdb::Slice& rocksdb_value) {
 
   RETURN_NOT_OK(DecodeTTL(&slice, &ttl_));
   RETURN_NOT_OK(DecodeUserTimestamp(&slice, &user_timestamp_));
+  counter_delta_ = DecodeValueType(slice) == ValueType::kCounterDelta;
+  if (counter_delta_) {
+    ConsumeValueType(&slice);
+  }
   return primitive_value_.DecodeFromValue(slice);
 }
 
@@ -95,6 +99,9 @@ string Value::ToString() const {
   if (user_timestamp_ != kInvalidUserTimestamp) {
     to_string += "; user_timestamp: " + std::to_string(user_timestamp_);
   }
+  if (counter_delta_) {
+    to_string += "; counter_delta";
+  }
   return to_string;
 }
 
@@ -113,6 +120,9 @@ void Value::EncodeAndAppend(std::string *value_bytes) const {
     value_bytes->push_back(static_cast<char>(ValueType::kUserTimestamp));
     AppendBigEndianUInt64(user_timestamp_, value_bytes);
   }
+  if (counter_delta_) {
+    value_bytes->push_back(static_cast<char>(ValueType::kCounterDelta));
+  }
   value_bytes->append(primitive_value_.ToValue());
 }
 
@@ -123,6 +133,9 @@ Status Value::DecodePrimitiveValueType(const rocksdb::Slice& rocksdb_value,
   auto slice_copy = rocksdb_value;
   RETURN_NOT_OK(DecodeTTL(&slice_copy, &ttl));
   RETURN_NOT_OK(DecodeUserTimestamp(&slice_copy, &user_timestamp));
+  if (DecodeValueType(slice_copy) == ValueType::kCounterDelta) {
+    ConsumeValueType(&slice_copy);
+  }
   *value_type = DecodeValueType(slice_copy);
   return Status::OK();
 }
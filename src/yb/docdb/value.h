@@ -23,8 +23,9 @@ namespace yb {
 namespace docdb {
 
 // This class represents the data stored in the value portion of rocksdb. It consists of the TTL
-// for the given key, the user specified timestamp and finally the value. These items are encoded
-// into a RocksDB Slice in the order mentioned above. The TTL and user timestamp are optional.
+// for the given key, the user specified timestamp, the counter delta marker and finally the value.
+// These items are encoded into a RocksDB Slice in the order mentioned above. The TTL, user
+// timestamp and counter delta marker are optional.
 class Value {
  public:
   Value() : primitive_value_(),
@@ -40,6 +41,13 @@ class Value {
         user_timestamp_(user_timestamp) {
   }
 
+  // A value that adds the given delta to the older versions of a counter column.
+  static Value CounterDelta(int64_t delta) {
+    Value value = Value(PrimitiveValue(delta));
+    value.counter_delta_ = true;
+    return value;
+  }
+
   static const MonoDelta kMaxTtl;
   static const int64_t kInvalidUserTimestamp;
   static constexpr int kBytesPerInt64 = sizeof(int64_t);
@@ -52,6 +60,10 @@ class Value {
 
   bool has_user_timestamp() const { return user_timestamp_ != kInvalidUserTimestamp; }
 
+  // Whether the value is an int64 delta to be added to the older versions of a counter column
+  // rather than the value of the column itself.
+  bool is_counter_delta() const { return counter_delta_; }
+
   ValueType value_type() const { return primitive_value_.value_type(); }
 
   PrimitiveValue* mutable_primitive_value() { return &primitive_value_; }
@@ -104,6 +116,9 @@ class Value {
 
   // The timestamp provided by the user as part of a 'USING TIMESTAMP' clause in CQL.
   UserTimeMicros user_timestamp_;
+
+  // Whether the value is a counter delta.
+  bool counter_delta_ = false;
 };
 
 }  // namespace docdb
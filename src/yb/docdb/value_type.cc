@@ -60,6 +60,7 @@ string ToString(ValueType value_type) {
     case ValueType::kTombstone: return "Tombstone";
     case ValueType::kTtl: return "Ttl";
     case ValueType::kUserTimestamp: return "UserTimestamp";
+    case ValueType::kCounterDelta: return "CounterDelta";
     case ValueType::kTransactionId: return "TransactionId";
     case ValueType::kIntentType: return "IntentType";
     case ValueType::kColumnId: return "ColumnId";
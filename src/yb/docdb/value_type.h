@@ -90,6 +90,10 @@ enum class ValueType : char {
   kDecimalDescending = 'd',  // ASCII code 100
   kInt32Descending = 'e',  // ASCII code 101
 
+  // Marks a counter column value as a delta to be added to the older versions of the column,
+  // optionally present after the TTL and user timestamp of a value.
+  kCounterDelta = 'k',  // ASCII code 107
+
   // Timestamp value in microseconds
   kTimestamp = 's',  // ASCII code 115
   // TTL value in milliseconds, optionally present at the start of a value.
@@ -50,6 +50,7 @@
 #include "yb/rpc/messenger.h"
 #include "yb/tserver/mini_tablet_server.h"
 #include "yb/tserver/tablet_server.h"
+#include "yb/util/metrics.h"
 #include "yb/util/stopwatch.h"
 #include "yb/util/test_util.h"
 
@@ -73,6 +74,11 @@ DECLARE_bool(enable_remote_bootstrap);
 DECLARE_int32(tserver_unresponsive_timeout_ms);
 
 DEFINE_int32(num_test_tablets, 60, "Number of tablets for stress test");
+DEFINE_int32(num_idle_heartbeat_tablets, 2000,
+             "Number of tablets for the heartbeat batching test");
+
+METRIC_DECLARE_counter(multi_raft_batched_heartbeats);
+METRIC_DECLARE_counter(multi_raft_heartbeat_rpcs_saved);
 
 using std::string;
 using std::vector;
@@ -197,6 +203,46 @@ TEST_F(CreateTableStressTest, CreateAndDeleteBigTable) {
   ASSERT_TRUE(tablet_ids.empty()) << "Tablets remained: " << tablet_ids;
 }
 
+// Checks that heartbeats of idle tablets, whose replicas share the same pair of tablet servers, are
+// folded into batched RPCs.
+TEST_F(CreateTableStressTest, IdleHeartbeatBatching) {
+  DontVerifyClusterBeforeNextTearDown();
+  if (!AllowSlowTests()) {
+    LOG(INFO) << "Skipping slow test";
+    return;
+  }
+  YBTableName table_name("my_keyspace", "test_table");
+  ASSERT_NO_FATALS(CreateBigTable(table_name, FLAGS_num_idle_heartbeat_tablets));
+  master::GetTableLocationsResponsePB resp;
+  ASSERT_OK(WaitForRunningTabletCount(cluster_->mini_master(), table_name,
+                                      FLAGS_num_idle_heartbeat_tablets, &resp));
+
+  auto sum_counters = [this](CounterPrototype* prototype) {
+    int64_t result = 0;
+    for (int i = 0; i < cluster_->num_tablet_servers(); ++i) {
+      result += prototype->Instantiate(
+          cluster_->mini_tablet_server(i)->server()->metric_entity())->value();
+    }
+    return result;
+  };
+
+  // Let leaders get elected and the cluster become idle.
+  SleepFor(MonoDelta::FromSeconds(10));
+  const int64_t heartbeats_before = sum_counters(&METRIC_multi_raft_batched_heartbeats);
+  const int64_t saved_before = sum_counters(&METRIC_multi_raft_heartbeat_rpcs_saved);
+  const MonoDelta kIdlePeriod = MonoDelta::FromSeconds(10);
+  SleepFor(kIdlePeriod);
+  const int64_t heartbeats = sum_counters(&METRIC_multi_raft_batched_heartbeats) -
+                             heartbeats_before;
+  const int64_t saved = sum_counters(&METRIC_multi_raft_heartbeat_rpcs_saved) - saved_before;
+
+  LOG(INFO) << "Batched heartbeats: " << heartbeats / kIdlePeriod.ToSeconds() << "/sec, "
+            << "RPCs saved: " << saved / kIdlePeriod.ToSeconds() << "/sec";
+  ASSERT_GT(saved, 0);
+  // Each batched RPC carries many heartbeats, so almost all of the RPCs are saved.
+  ASSERT_GT(saved * 10, heartbeats * 9);
+}
+
 TEST_F(CreateTableStressTest, RestartMasterDuringCreation) {
   if (!AllowSlowTests()) {
     LOG(INFO) << "Skipping slow test";
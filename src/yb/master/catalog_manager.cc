@@ -64,6 +64,7 @@
 #include <boost/thread/shared_mutex.hpp>
 #include <glog/logging.h>
 #include "yb/cfile/type_encodings.h"
+#include "yb/common/index.h"
 #include "yb/common/partial_row.h"
 #include "yb/common/partition.h"
 #include "yb/common/row_operations.h"
@@ -993,6 +994,20 @@ Status CatalogManager::PrepareSystemTable(const TableName& table_name,
   if (table != nullptr) {
     LOG(INFO) << strings::Substitute("Table $0.$1 already created, skipping initialization",
                                      namespace_name, table_name);
+    // Upgrade the schema of the system table if columns were added to it since it was created.
+    SchemaPB schema_pb;
+    RETURN_NOT_OK(SchemaToPB(schema, &schema_pb));
+    {
+      auto l = table->LockForWrite();
+      if (l->data().pb.schema().SerializeAsString() != schema_pb.SerializeAsString()) {
+        LOG(INFO) << strings::Substitute("Updating schema of table $0.$1",
+                                         namespace_name, table_name);
+        l->mutable_data()->pb.mutable_schema()->Swap(&schema_pb);
+        l->mutable_data()->pb.set_next_column_id(ColumnId(schema.max_col_id() + 1));
+        RETURN_NOT_OK(sys_catalog_->UpdateItem(table.get()));
+        l->Commit();
+      }
+    }
     // Initialize the appropriate system tablet.
     if (vtable != nullptr) {
       vector<scoped_refptr<TabletInfo>> tablets;
@@ -1278,6 +1293,27 @@ Status CatalogManager::CreateTable(const CreateTableRequestPB* orig_req,
     namespace_id = ns->id();
   }
 
+  // For an index table, validate the table it indexes.
+  scoped_refptr<TableInfo> indexed_table;
+  if (req.has_indexed_table_id()) {
+    TRACE("Looking up indexed table");
+    {
+      boost::shared_lock<LockType> l(lock_);
+      indexed_table = FindPtrOrNull(table_ids_map_, req.indexed_table_id());
+    }
+    if (indexed_table == nullptr || indexed_table->LockForRead()->data().started_deleting()) {
+      s = STATUS(NotFound, "The indexed table does not exist", req.indexed_table_id());
+      SetupError(resp->mutable_error(), MasterErrorPB::TABLE_NOT_FOUND, s);
+      return s;
+    }
+    if (indexed_table->namespace_id() != namespace_id) {
+      s = STATUS(InvalidArgument, "Index must be in the namespace of the indexed table",
+                 indexed_table->ToString());
+      SetupError(resp->mutable_error(), MasterErrorPB::INVALID_SCHEMA, s);
+      return s;
+    }
+  }
+
   // Validate schema.
   Schema client_schema;
   RETURN_NOT_OK(SchemaFromPB(req.schema(), &client_schema));
@@ -1515,6 +1551,16 @@ Status CatalogManager::CreateTable(const CreateTableRequestPB* orig_req,
     tablet->mutable_metadata()->CommitMutation();
   }
 
+  // Register the new index table with the table it indexes.
+  if (indexed_table != nullptr) {
+    s = AddIndexInfoToTable(indexed_table, table->id(), schema, resp);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to add index " << table->ToString() << " to table "
+                   << indexed_table->ToString() << ": " << s.ToString();
+      return s;
+    }
+  }
+
   VLOG(1) << "Created table " << table->ToString();
   LOG(INFO) << "Successfully created table " << table->ToString()
             << " per request from " << RequestorString(rpc);
@@ -1612,9 +1658,114 @@ TableInfo *CatalogManager::CreateTableInfo(const CreateTableRequestPB& req,
   // whereas the user request PB does not.
   CHECK_OK(SchemaToPB(schema, metadata->mutable_schema()));
   partition_schema.ToPB(metadata->mutable_partition_schema());
+  if (req.has_indexed_table_id()) {
+    metadata->set_indexed_table_id(req.indexed_table_id());
+  }
   return table;
 }
 
+Status CatalogManager::AddIndexInfoToTable(const scoped_refptr<TableInfo>& indexed_table,
+                                           const TableId& index_table_id,
+                                           const Schema& index_schema,
+                                           CreateTableResponsePB* resp) {
+  TRACE("Locking indexed table");
+  auto l = indexed_table->LockForWrite();
+  if (l->data().started_deleting()) {
+    Status s = STATUS(NotFound, "The indexed table was deleted", l->data().pb.state_msg());
+    SetupError(resp->mutable_error(), MasterErrorPB::TABLE_NOT_FOUND, s);
+    return s;
+  }
+
+  // Map the index columns to the columns of the indexed table they are populated from. The index
+  // columns are named after the indexed table columns.
+  Schema indexed_schema;
+  RETURN_NOT_OK(SchemaFromPB(l->data().pb.schema(), &indexed_schema));
+  IndexInfoPB* index_info = l->mutable_data()->pb.add_indexes();
+  index_info->set_table_id(index_table_id);
+  index_info->set_indexed_table_id(indexed_table->id());
+  for (size_t i = 0; i < index_schema.num_columns(); i++) {
+    const int indexed_idx = indexed_schema.find_column(index_schema.column(i).name());
+    if (indexed_idx == Schema::kColumnNotFound) {
+      Status s = STATUS(InvalidArgument, "Index column not found in the indexed table",
+                        index_schema.column(i).name());
+      SetupError(resp->mutable_error(), MasterErrorPB::INVALID_SCHEMA, s);
+      return s;
+    }
+    IndexInfoPB::IndexColumnPB* column = index_info->add_columns();
+    column->set_column_id(index_schema.column_id(i));
+    column->set_indexed_column_id(indexed_schema.column_id(indexed_idx));
+  }
+  index_info->set_hash_column_count(index_schema.num_hash_key_columns());
+  index_info->set_range_column_count(index_schema.num_range_key_columns());
+
+  // The index is updated together with the indexed table in distributed transactions, so writes
+  // to the indexed table have to be transactional from now on.
+  l->mutable_data()->pb.mutable_schema()->mutable_table_properties()->set_is_transactional(true);
+
+  return UpdateIndexedTable(indexed_table, l.get(), resp);
+}
+
+Status CatalogManager::RemoveIndexInfoFromTable(const TableId& indexed_table_id,
+                                                const TableId& index_table_id,
+                                                DeleteTableResponsePB* resp) {
+  scoped_refptr<TableInfo> indexed_table;
+  {
+    boost::shared_lock<LockType> l(lock_);
+    indexed_table = FindPtrOrNull(table_ids_map_, indexed_table_id);
+  }
+  if (indexed_table == nullptr) {
+    return Status::OK();
+  }
+
+  TRACE("Locking indexed table");
+  auto l = indexed_table->LockForWrite();
+  if (l->data().started_deleting()) {
+    // The index is deleted together with the indexed table.
+    return Status::OK();
+  }
+  auto* indexes = l->mutable_data()->pb.mutable_indexes();
+  for (int i = 0; i < indexes->size(); i++) {
+    if (indexes->Get(i).table_id() == index_table_id) {
+      indexes->DeleteSubrange(i, 1);
+      return UpdateIndexedTable(indexed_table, l.get(), resp);
+    }
+  }
+  return Status::OK();
+}
+
+template <class RespClass>
+Status CatalogManager::UpdateIndexedTable(const scoped_refptr<TableInfo>& indexed_table,
+                                          TableInfo::lock_type* l,
+                                          RespClass* resp) {
+  // Bump the version of the indexed table, so the clients that have cached the table without the
+  // index changes get a schema version mismatch and reload it.
+  if (!l->data().pb.has_fully_applied_schema()) {
+    l->mutable_data()->pb.mutable_fully_applied_schema()->CopyFrom(l->data().pb.schema());
+  }
+  l->mutable_data()->pb.set_version(l->mutable_data()->pb.version() + 1);
+  l->mutable_data()->set_state(SysTablesEntryPB::ALTERING,
+                               Substitute("Alter table version=$0 ts=$1",
+                                          l->mutable_data()->pb.version(),
+                                          LocalTimeAsString()));
+
+  TRACE("Updating indexed table metadata on disk");
+  Status s = sys_catalog_->UpdateItem(indexed_table.get());
+  if (!s.ok()) {
+    s = s.CloneAndPrepend(
+        Substitute("An error occurred while updating sys-catalog tables entry: $0",
+                   s.ToString()));
+    LOG(WARNING) << s.ToString();
+    CheckIfNoLongerLeaderAndSetupError(s, resp);
+    return s;
+  }
+
+  TRACE("Committing in-memory state");
+  l->Commit();
+
+  SendAlterTableRequest(indexed_table);
+  return Status::OK();
+}
+
 TabletInfo* CatalogManager::CreateTabletInfo(TableInfo* table,
                                              const PartitionPB& partition) {
   TabletInfo* tablet = new TabletInfo(table, GenerateId());
@@ -1717,6 +1868,13 @@ Status CatalogManager::DeleteTable(const DeleteTableRequestPB* req,
     return s;
   }
 
+  // Index tables are deleted together with the table they index.
+  const TableId indexed_table_id = l->data().pb.indexed_table_id();
+  vector<TableId> index_table_ids;
+  for (const auto& index : l->data().pb.indexes()) {
+    index_table_ids.push_back(index.table_id());
+  }
+
   TRACE("Updating metadata on disk");
   // Update the metadata for the on-disk state
   l->mutable_data()->set_state(SysTablesEntryPB::DELETING,
@@ -1758,6 +1916,26 @@ Status CatalogManager::DeleteTable(const DeleteTableRequestPB* req,
   // Send a DeleteTablet() request to each tablet replica in the table.
   DeleteTabletsAndSendRequests(table);
 
+  for (const TableId& index_table_id : index_table_ids) {
+    DeleteTableRequestPB index_req;
+    DeleteTableResponsePB index_resp;
+    index_req.mutable_table()->set_table_id(index_table_id);
+    s = DeleteTable(&index_req, &index_resp, rpc);
+    if (!s.ok() && !s.IsNotFound()) {
+      LOG(WARNING) << "Failed to delete index " << index_table_id << " of table "
+                   << table->ToString() << ": " << s.ToString();
+    }
+  }
+
+  if (!indexed_table_id.empty()) {
+    s = RemoveIndexInfoFromTable(indexed_table_id, table->id(), resp);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to remove index " << table->ToString() << " from table "
+                   << indexed_table_id << ": " << s.ToString();
+      return s;
+    }
+  }
+
   LOG(INFO) << "Successfully deleted table " << table->ToString()
             << " per request from " << RequestorString(rpc);
   background_tasks_->Wake();
@@ -1920,6 +2098,17 @@ static Status ApplyAlterSteps(const SysTablesEntryPB& current_pb,
           return STATUS(InvalidArgument, "cannot remove a key column");
         }
 
+        const int col_idx = cur_schema.find_column(step.drop_column().name());
+        if (col_idx != Schema::kColumnNotFound) {
+          const ColumnId col_id = cur_schema.column_id(col_idx);
+          for (const auto& index : current_pb.indexes()) {
+            if (IndexInfo(index).IsColumnCovered(col_id)) {
+              return STATUS(InvalidArgument, "cannot remove a column used by an index",
+                            step.drop_column().name());
+            }
+          }
+        }
+
         RETURN_NOT_OK(builder.RemoveColumn(step.drop_column().name()));
         break;
       }
@@ -2012,6 +2201,24 @@ Status CatalogManager::AlterTable(const AlterTableRequestPB* req,
     has_changes = true;
   }
 
+  if (req->has_backfilled_index_table_id()) {
+    TRACE("Mark index backfilled");
+    IndexInfoPB* index_info = nullptr;
+    for (auto& index : *l->mutable_data()->pb.mutable_indexes()) {
+      if (index.table_id() == req->backfilled_index_table_id()) {
+        index_info = &index;
+        break;
+      }
+    }
+    if (index_info == nullptr) {
+      Status s = STATUS(NotFound, "The index does not exist", req->backfilled_index_table_id());
+      SetupError(resp->mutable_error(), MasterErrorPB::TABLE_NOT_FOUND, s);
+      return s;
+    }
+    index_info->set_is_backfilled(true);
+    has_changes = true;
+  }
+
   // Try to acquire the new table name.
   if (req->has_new_namespace() || req->has_new_table_name()) {
     std::lock_guard<LockType> catalog_lock(lock_);
@@ -2167,6 +2374,10 @@ Status CatalogManager::GetTableSchema(const GetTableSchemaRequestPB* req,
   resp->mutable_identifier()->set_table_id(table->id());
   resp->mutable_identifier()->mutable_namespace_()->set_id(table->namespace_id());
   resp->set_version(l->data().pb.version());
+  resp->mutable_indexes()->CopyFrom(l->data().pb.indexes());
+  if (l->data().pb.has_indexed_table_id()) {
+    resp->set_indexed_table_id(l->data().pb.indexed_table_id());
+  }
 
   // Get namespace name by id.
   boost::shared_lock<LockType> l_map(lock_);
@@ -2327,6 +2538,17 @@ void CatalogManager::NotifyTabletDeleteFinished(const TServerId& tserver_uuid,
   CleanUpDeletedTables();
 }
 
+void CatalogManager::ProcessTabletSizes(
+    const google::protobuf::RepeatedPtrField<TabletSizePB>& tablet_sizes) {
+  boost::shared_lock<LockType> l(lock_);
+  for (const TabletSizePB& tablet_size : tablet_sizes) {
+    scoped_refptr<TabletInfo> tablet;
+    if (FindCopy(tablet_map_, tablet_size.tablet_id(), &tablet)) {
+      tablet->set_estimated_num_rows(tablet_size.estimated_num_rows());
+    }
+  }
+}
+
 Status CatalogManager::ProcessTabletReport(TSDescriptor* ts_desc,
                                            const TabletReportPB& report,
                                            TabletReportUpdatesPB *report_update,
@@ -4053,6 +4275,7 @@ Status CatalogManager::BuildLocationsForTablet(const scoped_refptr<TabletInfo>&
 
   locs_pb->set_tablet_id(tablet->tablet_id());
   locs_pb->set_stale(locs.empty());
+  locs_pb->set_estimated_num_rows(tablet->estimated_num_rows());
 
   // If the locations are cached.
   if (!locs.empty()) {
@@ -4645,6 +4868,16 @@ uint32_t TabletInfo::reported_schema_version() const {
   return reported_schema_version_;
 }
 
+void TabletInfo::set_estimated_num_rows(uint64_t num_rows) {
+  std::lock_guard<simple_spinlock> l(lock_);
+  estimated_num_rows_ = num_rows;
+}
+
+uint64_t TabletInfo::estimated_num_rows() const {
+  std::lock_guard<simple_spinlock> l(lock_);
+  return estimated_num_rows_;
+}
+
 bool TabletInfo::IsSupportedSystemTable(const SystemTableSet& supported_system_tables) const {
   return table_->IsSupportedSystemTable(supported_system_tables);
 }
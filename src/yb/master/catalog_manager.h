@@ -240,6 +240,10 @@ class TabletInfo : public RefCountedThreadSafe<TabletInfo>,
   bool set_reported_schema_version(uint32_t version);
   uint32_t reported_schema_version() const;
 
+  // Accessors for the number of rows in the tablet last estimated by its leader.
+  void set_estimated_num_rows(uint64_t num_rows);
+  uint64_t estimated_num_rows() const;
+
   // No synchronization needed.
   std::string ToString() const override;
 
@@ -279,6 +283,9 @@ class TabletInfo : public RefCountedThreadSafe<TabletInfo>,
   // Reported schema version (in-memory only).
   uint32_t reported_schema_version_ = 0;
 
+  // Number of rows estimated by the tablet leader (in-memory only).
+  uint64_t estimated_num_rows_ = 0;
+
   LeaderStepDownFailureTimes leader_stepdown_failure_times_;
 
   DISALLOW_COPY_AND_ASSIGN(TabletInfo);
@@ -787,6 +794,10 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
                                      TabletReportUpdatesPB *report_update,
                                      rpc::RpcContext* rpc);
 
+  // Record the tablet sizes estimated by the tablet leaders and reported in a heartbeat. Sizes of
+  // unknown tablets are ignored.
+  void ProcessTabletSizes(const google::protobuf::RepeatedPtrField<TabletSizePB>& tablet_sizes);
+
   // Create a new Namespace with the specified attributes.
   //
   // The RPC context is provided for logging/tracing purposes,
@@ -1036,6 +1047,26 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
                              const PartitionSchema& partition_schema,
                              const NamespaceId& namespace_id);
 
+  // Adds the index of the given index table to the indexed table and bumps the indexed table's
+  // schema version.
+  CHECKED_STATUS AddIndexInfoToTable(const scoped_refptr<TableInfo>& indexed_table,
+                                     const TableId& index_table_id,
+                                     const Schema& index_schema,
+                                     CreateTableResponsePB* resp);
+
+  // Removes the index of the given index table from the indexed table, unless the indexed table
+  // is being deleted itself.
+  CHECKED_STATUS RemoveIndexInfoFromTable(const TableId& indexed_table_id,
+                                          const TableId& index_table_id,
+                                          DeleteTableResponsePB* resp);
+
+  // Persists the changed index information of the write-locked indexed table, commits it and
+  // sends the new schema version to the tablets.
+  template <class RespClass>
+  CHECKED_STATUS UpdateIndexedTable(const scoped_refptr<TableInfo>& indexed_table,
+                                    TableInfo::lock_type* l,
+                                    RespClass* resp);
+
   // Helper for creating the initial TabletInfo state.
   // Leaves the tablet "write locked" with the new info in the
   // "dirty" state field.
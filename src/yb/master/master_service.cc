@@ -174,6 +174,10 @@ void MasterServiceImpl::TSHeartbeat(const TSHeartbeatRequestPB* req,
     }
   }
 
+  if (req->tablet_sizes_size() > 0) {
+    server_->catalog_manager()->ProcessTabletSizes(req->tablet_sizes());
+  }
+
   if (!ts_desc->has_tablet_report()) {
     resp->set_needs_full_tablet_report(true);
   }
@@ -68,6 +68,15 @@ template<> struct GetValueHelper<int32_t> {
   }
 };
 
+template<> struct GetValueHelper<int64_t> {
+
+  static QLValuePB Apply(const int64_t intval, const DataType data_type) {
+    QLValuePB value_pb;
+    QLValue::set_int64_value(intval, &value_pb);
+    return value_pb;
+  }
+};
+
 template<> struct GetValueHelper<InetAddress> {
 
   static QLValuePB Apply(const InetAddress& inet_val, const DataType data_type) {
@@ -74,6 +74,10 @@ Status YQLPartitionsVTable::RetrieveData(const QLReadRequestPB& request,
         QLValue::set_string_value(role, QLValue::add_map_value(&replica_addresses));
       }
       RETURN_NOT_OK(SetColumnValue(kReplicaAddresses, replica_addresses, &row));
+
+      // Row count estimated by the tablet leader, for splitting full table scans.
+      RETURN_NOT_OK(SetColumnValue(
+          kEstimatedNumRows, static_cast<int64_t>(tabletLocationsPB.estimated_num_rows()), &row));
     }
   }
 
@@ -89,6 +93,7 @@ Schema YQLPartitionsVTable::CreateSchema() const {
   CHECK_OK(builder.AddColumn(kId, QLType::Create(DataType::UUID)));
   CHECK_OK(builder.AddColumn(kReplicaAddresses,
                              QLType::CreateTypeMap(DataType::INET, DataType::STRING)));
+  CHECK_OK(builder.AddColumn(kEstimatedNumRows, QLType::Create(DataType::INT64)));
   return builder.Build();
 }
 
@@ -35,6 +35,7 @@ class YQLPartitionsVTable : public YQLVirtualTable {
   static constexpr const char* const kEndKey = "end_key";
   static constexpr const char* const kId = "id";
   static constexpr const char* const kReplicaAddresses = "replica_addresses";
+  static constexpr const char* const kEstimatedNumRows = "estimated_num_rows";
 };
 
 }  // namespace master
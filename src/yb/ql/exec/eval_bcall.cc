@@ -14,6 +14,7 @@
 //--------------------------------------------------------------------------------------------------
 
 #include "yb/ql/exec/executor.h"
+#include "yb/common/ql_expr.h"
 
 namespace yb {
 namespace ql {
@@ -21,6 +22,11 @@ namespace ql {
 using yb::bfql::BFOPCODE_NOOP;
 
 CHECKED_STATUS Executor::PTExprToPB(const PTBcall *bcall_pt, QLExpressionPB *expr_pb) {
+  if (bcall_pt->is_foldable()) {
+    // Constant folding: evaluate the call once here and send its result as a value.
+    return FoldBFCallToPB(bcall_pt, expr_pb);
+  }
+
   if (!bcall_pt->is_server_operator()) {
     // Regular builtin function call.
     return BFCallToPB(bcall_pt, expr_pb);
@@ -67,6 +73,25 @@ CHECKED_STATUS Executor::BFCallToPB(const PTBcall *bcall_pt, QLExpressionPB *exp
   return Status::OK();
 }
 
+CHECKED_STATUS Executor::FoldBFCallToPB(const PTBcall *bcall_pt, QLExpressionPB *expr_pb) {
+  // The foldable arguments of the call are folded recursively, so the call is evaluated with
+  // values only. No row is needed to evaluate it.
+  QLExpressionPB bcall_pb;
+  RETURN_NOT_OK(BFCallToPB(bcall_pt, &bcall_pb));
+
+  QLExprExecutor expr_executor;
+  QLValueWithPB result;
+  const Status s = expr_executor.EvalExpr(bcall_pb, QLTableRow(), &result);
+  if (!s.ok()) {
+    // Leave the call to the tablet server, which reports the error as before.
+    VLOG(3) << "Cannot fold builtin call " << bcall_pt->QLName() << ": " << s.ToString();
+    expr_pb->Swap(&bcall_pb);
+    return Status::OK();
+  }
+  *expr_pb->mutable_value() = result.value();
+  return Status::OK();
+}
+
 CHECKED_STATUS Executor::TSCallToPB(const PTBcall *bcall_pt, QLExpressionPB *expr_pb) {
   if (bcall_pt->result_cast_op() != BFOPCODE_NOOP) {
       QLBCallPB *cast_pb = expr_pb->mutable_bfcall();
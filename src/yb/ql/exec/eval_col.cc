@@ -13,7 +13,17 @@
 //
 //--------------------------------------------------------------------------------------------------
 
+#include <limits>
+#include <set>
+
 #include "yb/ql/exec/executor.h"
+#include "yb/util/flag_tags.h"
+
+DEFINE_bool(cql_blind_counter_increments, true,
+            "Write the counter updates \"c = c + n\" and \"c = c - n\" as increments that are "
+            "added up when the counter is read, instead of reading and writing the counter.");
+TAG_FLAG(cql_blind_counter_increments, runtime);
+TAG_FLAG(cql_blind_counter_increments, advanced);
 
 namespace yb {
 namespace ql {
@@ -85,5 +95,69 @@ CHECKED_STATUS Executor::ColumnArgsToPB(const shared_ptr<client::YBTable>& table
   return Status::OK();
 }
 
+CHECKED_STATUS Executor::CounterIncrementsToPB(const std::shared_ptr<client::YBTable>& table,
+                                               const PTDmlStmt *tnode,
+                                               QLWriteRequestPB *req) {
+  // The counter updates are written blindly only when nothing else in the statement needs the
+  // current row. Outside of a transaction only, because just the latest intent of a column is
+  // visible to a read.
+  if (!FLAGS_cql_blind_counter_increments || req->has_if_expr() || req->has_ttl() ||
+      req->has_user_timestamp_usec() || !table->index_map().empty() ||
+      table->InternalSchema().table_properties().is_transactional()) {
+    return Status::OK();
+  }
+
+  std::set<int32> increment_ids;
+  for (const ColumnArg& col : tnode->column_args()) {
+    if (!col.IsInitialized() || !col.desc()->is_counter() ||
+        col.expr()->expr_op() != ExprOperator::kBcall) {
+      continue;
+    }
+    const PTBcall *bcall = static_cast<const PTBcall*>(col.expr().get());
+    const bool increment = *bcall->name() == "+counter";
+    if ((!increment && *bcall->name() != "-counter") || bcall->args().size() != 2) {
+      continue;
+    }
+
+    // Only a delta that is known before the write, i.e. not another column, can be written.
+    QLExpressionPB delta_pb;
+    RETURN_NOT_OK(PTExprToPB(bcall->args().back(), &delta_pb));
+    if (!delta_pb.has_value() || !delta_pb.value().has_int64_value()) {
+      continue;
+    }
+    int64_t delta = delta_pb.value().int64_value();
+    if (!increment) {
+      if (delta == std::numeric_limits<int64_t>::min()) {
+        continue;
+      }
+      delta = -delta;
+    }
+
+    for (QLColumnValuePB& col_pb : *req->mutable_column_values()) {
+      if (col_pb.column_id() == col.desc()->id() && col_pb.subscript_args().empty()) {
+        col_pb.mutable_expr()->mutable_value()->set_int64_value(delta);
+        col_pb.set_is_increment(true);
+        increment_ids.insert(col_pb.column_id());
+        break;
+      }
+    }
+  }
+
+  // The incremented counters need not be read anymore.
+  if (!increment_ids.empty() && req->has_column_refs()) {
+    QLReferencedColumnsPB* column_refs = req->mutable_column_refs();
+    for (auto* ids : {column_refs->mutable_ids(), column_refs->mutable_static_ids()}) {
+      google::protobuf::RepeatedField<int32> read_ids;
+      for (const int32 id : *ids) {
+        if (increment_ids.count(id) == 0) {
+          read_ids.Add(id);
+        }
+      }
+      ids->Swap(&read_ids);
+    }
+  }
+  return Status::OK();
+}
+
 }  // namespace ql
 }  // namespace yb
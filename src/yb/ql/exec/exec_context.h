@@ -57,6 +57,11 @@ class ExecContext : public ProcessContextBase {
     return ql_env_->DeleteTable(name);
   }
 
+  // Remove the table definition from the metadata cache after the table was changed.
+  void RemoveCachedTableDesc(const client::YBTableName& name) {
+    ql_env_->RemoveCachedTableDesc(name);
+  }
+
   // Keyspace related methods.
 
   // Create a new keyspace with the given name.
@@ -0,0 +1,479 @@
+//--------------------------------------------------------------------------------------------------
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//
+// Maintenance of secondary indexes. A write to a table with secondary indexes is executed in a
+// distributed transaction in three steps:
+// 1. Read the current values of the indexed and covered columns of the row being written.
+// 2. Apply the write together with the writes that delete the stale index entries of the row and
+//    insert the new ones.
+// 3. Commit the transaction.
+//
+// An index created on a table with rows is backfilled by CREATE INDEX: the rows are read in pages
+// and their index entries are written, each page in a distributed transaction of its own. Queries
+// use the index only after it is marked backfilled.
+//--------------------------------------------------------------------------------------------------
+
+#include "yb/common/index.h"
+#include "yb/common/ql_rowblock.h"
+#include "yb/ql/exec/executor.h"
+
+namespace yb {
+namespace ql {
+
+using std::shared_ptr;
+using std::vector;
+using client::YBSession;
+using client::YBTable;
+using client::YBTableAlterer;
+using client::YBTableName;
+using client::YBqlReadOp;
+using client::YBqlWriteOp;
+
+namespace {
+
+// Number of rows of the indexed table that are backfilled in one transaction.
+constexpr int kBackfillPageSize = 1000;
+
+// Number of attempts to backfill a page whose transaction conflicts with concurrent writes.
+constexpr int kBackfillPageAttempts = 10;
+
+// Returns the value of the i-th column of the row.
+const QLValuePB& ColumnValue(const QLRow& row, size_t idx) {
+  return static_cast<const QLValueWithPB&>(row.column(idx)).value();
+}
+
+// Is the column stored in any of the indexes?
+bool IsColumnIndexed(const IndexMap& index_map, ColumnId column_id) {
+  for (const auto& index : index_map) {
+    if (index.second.IsColumnCovered(column_id)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ValuesEqual(const QLValuePB& lhs, const QLValuePB& rhs) {
+  if (QLValue::IsNull(lhs) || QLValue::IsNull(rhs)) {
+    return QLValue::IsNull(lhs) && QLValue::IsNull(rhs);
+  }
+  return QLValue::CompareTo(lhs, rhs) == 0;
+}
+
+// Is any of the index key columns null in the row? Such a row has no entry in the index.
+bool HasNullKey(const IndexInfo& index_info, const Schema& schema, const vector<QLValuePB>& row) {
+  for (size_t i = 0; i < index_info.key_column_count(); i++) {
+    const int idx = schema.find_column_by_id(index_info.columns()[i].indexed_column_id);
+    if (QLValue::IsNull(row[idx])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Set the primary key of the index entry of the row in an index write request.
+void IndexKeyToPB(const IndexInfo& index_info, const Schema& schema, const vector<QLValuePB>& row,
+                  QLWriteRequestPB* req) {
+  for (size_t i = 0; i < index_info.key_column_count(); i++) {
+    const int idx = schema.find_column_by_id(index_info.columns()[i].indexed_column_id);
+    QLExpressionPB* expr_pb = i < index_info.hash_column_count() ?
+        req->add_hashed_column_values() : req->add_range_column_values();
+    *expr_pb->mutable_value() = row[idx];
+  }
+}
+
+// Set the primary key and the covering column values of the index entry of the row in an index
+// insert request.
+void IndexEntryToPB(const IndexInfo& index_info, const Schema& schema, const vector<QLValuePB>& row,
+                    QLWriteRequestPB* req) {
+  IndexKeyToPB(index_info, schema, row, req);
+  for (size_t i = index_info.key_column_count(); i < index_info.columns().size(); i++) {
+    const IndexColumn& column = index_info.columns()[i];
+    QLColumnValuePB *column_value = req->add_column_values();
+    column_value->set_column_id(column.column_id);
+    *column_value->mutable_expr()->mutable_value() =
+        row[schema.find_column_by_id(column.indexed_column_id)];
+  }
+}
+
+// Select the column of the table in a read request.
+void SelectColumn(const Schema& schema, size_t idx, QLReadRequestPB* req) {
+  const ColumnId column_id = schema.column_id(idx);
+  const ColumnSchema& column = schema.column(idx);
+  req->add_selected_exprs()->set_column_id(column_id);
+  if (column.is_static()) {
+    req->mutable_column_refs()->add_static_ids(column_id);
+  } else {
+    req->mutable_column_refs()->add_ids(column_id);
+  }
+  QLRSColDescPB *rscol_desc_pb = req->mutable_rsrow_desc()->add_rscol_descs();
+  rscol_desc_pb->set_name(column.name());
+  column.type()->ToQLTypePB(rscol_desc_pb->mutable_ql_type());
+}
+
+// Flush the session and return the first error of its operations if any.
+Status FlushSession(const shared_ptr<YBSession>& session) {
+  Status s = session->Flush();
+  if (s.IsIOError()) {
+    client::CollectedErrors errors;
+    bool overflowed = false;
+    session->GetPendingErrors(&errors, &overflowed);
+    if (!errors.empty()) {
+      return errors.front()->status();
+    }
+  }
+  return s;
+}
+
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+Status Executor::ReadIndexedRow(const PTDmlStmt *tnode, const shared_ptr<YBqlWriteOp>& write_op) {
+  // The IF clause would need to be evaluated before the indexes are updated.
+  if (tnode->if_clause() != nullptr) {
+    return exec_context_->Error("Conditional DML on table with secondary indexes not supported yet",
+                                ErrorCode::FEATURE_NOT_YET_IMPLEMENTED);
+  }
+
+  const shared_ptr<YBTable>& table = tnode->table();
+  const Schema& schema = table->InternalSchema();
+  const QLWriteRequestPB& write_req = write_op->request();
+
+  // Read the row by its primary key.
+  shared_ptr<YBqlReadOp> read_op(table->NewQLSelect());
+  QLReadRequestPB *req = read_op->mutable_request();
+  for (const auto& hashed_value : write_req.hashed_column_values()) {
+    if (!hashed_value.has_value()) {
+      return exec_context_->Error("Primary key of table with secondary indexes must be a value",
+                                  ErrorCode::FEATURE_NOT_YET_IMPLEMENTED);
+    }
+    *req->add_hashed_column_values() = hashed_value;
+  }
+  for (int i = 0; i < write_req.range_column_values_size(); i++) {
+    const QLExpressionPB& range_value = write_req.range_column_values(i);
+    if (!range_value.has_value()) {
+      return exec_context_->Error("Primary key of table with secondary indexes must be a value",
+                                  ErrorCode::FEATURE_NOT_YET_IMPLEMENTED);
+    }
+    QLConditionPB *where_pb = req->mutable_where_expr()->mutable_condition();
+    where_pb->set_op(QL_OP_AND);
+    QLConditionPB *condition = where_pb->add_operands()->mutable_condition();
+    condition->set_op(QL_OP_EQUAL);
+    condition->add_operands()->set_column_id(schema.column_id(schema.num_hash_key_columns() + i));
+    *condition->add_operands() = range_value;
+  }
+
+  // Select the columns stored in any of the indexes.
+  for (size_t idx = 0; idx < schema.num_columns(); idx++) {
+    if (IsColumnIndexed(table->index_map(), schema.column_id(idx))) {
+      SelectColumn(schema, idx, req);
+    }
+  }
+  req->set_limit(1);
+  read_op->set_yb_consistency_level(YBConsistencyLevel::STRONG);
+
+  // The row is read and the indexes are written in the same transaction, so a concurrent write to
+  // the row conflicts with this one instead of leaving the indexes inconsistent.
+  ql_env_->StartTransaction(IsolationLevel::SNAPSHOT_ISOLATION);
+  index_read_op_ = read_op;
+  index_write_op_ = write_op;
+  return ql_env_->ApplyRead(read_op);
+}
+
+Status Executor::ApplyIndexWrites() {
+  // Check the result of the read.
+  Status s = ql_env_->GetOpError(index_read_op_.get());
+  if (PREDICT_FALSE(!s.ok())) {
+    return exec_context_->Error(
+        s, s.IsNotFound() ? ErrorCode::TABLET_NOT_FOUND : ErrorCode::SQL_STATEMENT_INVALID);
+  }
+  if (index_read_op_->response().status() != QLResponsePB::YQL_STATUS_OK) {
+    return ProcessOpResponse(index_read_op_.get(), exec_context_);
+  }
+
+  const YBTable* table = index_write_op_->table();
+  const Schema& schema = table->InternalSchema();
+  const QLWriteRequestPB& write_req = index_write_op_->request();
+
+  // Values of the columns of the row before and after the write, by column index. Only the
+  // columns stored in the indexes are filled in.
+  vector<QLValuePB> old_row(schema.num_columns());
+  vector<QLValuePB> new_row(schema.num_columns());
+  const QLReadRequestPB& read_req = index_read_op_->request();
+  std::unique_ptr<QLRowBlock> row_block = RowsResult(index_read_op_.get()).GetRowBlock();
+  const bool old_exists = row_block->row_count() > 0;
+  if (old_exists) {
+    const QLRow& row = row_block->row(0);
+    for (int i = 0; i < read_req.selected_exprs_size(); i++) {
+      const int idx = schema.find_column_by_id(ColumnId(read_req.selected_exprs(i).column_id()));
+      old_row[idx] = ColumnValue(row, i);
+    }
+    new_row = old_row;
+  }
+
+  bool new_exists = true;
+  switch (write_req.type()) {
+    case QLWriteRequestPB::QL_STMT_INSERT:
+      break;
+    case QLWriteRequestPB::QL_STMT_UPDATE:
+      // An update of a row that does not exist creates the row unless all values are null.
+      new_exists = old_exists;
+      for (const auto& column_value : write_req.column_values()) {
+        if (column_value.expr().has_value() && !QLValue::IsNull(column_value.expr().value())) {
+          new_exists = true;
+        }
+      }
+      break;
+    case QLWriteRequestPB::QL_STMT_DELETE:
+      // A delete without columns deletes the whole row, otherwise it sets the columns to null.
+      new_exists = old_exists && write_req.column_values_size() > 0;
+      break;
+  }
+
+  if (new_exists) {
+    for (int i = 0; i < write_req.hashed_column_values_size(); i++) {
+      new_row[i] = write_req.hashed_column_values(i).value();
+    }
+    for (int i = 0; i < write_req.range_column_values_size(); i++) {
+      new_row[schema.num_hash_key_columns() + i] = write_req.range_column_values(i).value();
+    }
+    for (const auto& column_value : write_req.column_values()) {
+      const ColumnId column_id(column_value.column_id());
+      if (!IsColumnIndexed(table->index_map(), column_id)) {
+        continue;
+      }
+      if (column_value.subscript_args_size() > 0 ||
+          (column_value.has_expr() && !column_value.expr().has_value())) {
+        return exec_context_->Error("Only values can be assigned to indexed columns",
+                                    ErrorCode::FEATURE_NOT_YET_IMPLEMENTED);
+      }
+      if (column_value.has_expr()) {
+        new_row[schema.find_column_by_id(column_id)] = column_value.expr().value();
+      } else {
+        new_row[schema.find_column_by_id(column_id)].Clear();
+      }
+    }
+  }
+
+  // Compute the index writes: delete the stale entry of the row and insert the new one.
+  index_ops_.clear();
+  for (const auto& index : table->index_map()) {
+    const IndexInfo& index_info = index.second;
+    const bool old_entry = old_exists && !HasNullKey(index_info, schema, old_row);
+    const bool new_entry = new_exists && !HasNullKey(index_info, schema, new_row);
+    bool key_changed = false;
+    bool value_changed = false;
+    if (old_entry && new_entry) {
+      for (size_t i = 0; i < index_info.columns().size(); i++) {
+        const int idx = schema.find_column_by_id(index_info.columns()[i].indexed_column_id);
+        if (!ValuesEqual(old_row[idx], new_row[idx])) {
+          (i < index_info.key_column_count() ? key_changed : value_changed) = true;
+        }
+      }
+      if (!key_changed && !value_changed) {
+        // The index entry is up to date.
+        continue;
+      }
+    }
+
+    bool cache_used = false;
+    shared_ptr<YBTable> index_table = ql_env_->GetTableDesc(index_info.table_id(), &cache_used);
+    if (index_table == nullptr) {
+      // The index was dropped after the table was analyzed, so the statement needs to be
+      // re-analyzed.
+      return exec_context_->Error("Index table not found", ErrorCode::INVALID_TABLE_DEFINITION);
+    }
+
+    if (old_entry && (!new_entry || key_changed)) {
+      shared_ptr<YBqlWriteOp> delete_op(index_table->NewQLDelete());
+      QLWriteRequestPB *req = delete_op->mutable_request();
+      IndexKeyToPB(index_info, schema, old_row, req);
+      if (write_req.has_user_timestamp_usec()) {
+        req->set_user_timestamp_usec(write_req.user_timestamp_usec());
+      }
+      index_ops_.push_back(delete_op);
+    }
+
+    if (new_entry) {
+      shared_ptr<YBqlWriteOp> insert_op(index_table->NewQLInsert());
+      QLWriteRequestPB *req = insert_op->mutable_request();
+      IndexEntryToPB(index_info, schema, new_row, req);
+      if (write_req.has_ttl()) {
+        req->set_ttl(write_req.ttl());
+      }
+      if (write_req.has_user_timestamp_usec()) {
+        req->set_user_timestamp_usec(write_req.user_timestamp_usec());
+      }
+      index_ops_.push_back(insert_op);
+    }
+  }
+
+  // Apply the write and the index writes.
+  ql_env_->Reset();
+  index_read_op_ = nullptr;
+  RETURN_NOT_OK(exec_context_->ApplyWrite(index_write_op_));
+  for (const auto& index_op : index_ops_) {
+    RETURN_NOT_OK(ql_env_->ApplyWrite(index_op));
+  }
+  return Status::OK();
+}
+
+Status Executor::ProcessIndexWriteResults() {
+  for (const auto& index_op : index_ops_) {
+    Status s = ql_env_->GetOpError(index_op.get());
+    if (PREDICT_FALSE(!s.ok())) {
+      return exec_context_->Error(
+          s, s.IsNotFound() ? ErrorCode::TABLET_NOT_FOUND : ErrorCode::SQL_STATEMENT_INVALID);
+    }
+    RETURN_NOT_OK(ProcessOpResponse(index_op.get(), exec_context_));
+  }
+  return Status::OK();
+}
+
+void Executor::IndexFlushAsyncDone(const Status& s) {
+  Status ss = s;
+  if (ss.ok() && index_read_op_ != nullptr) {
+    // The row is read, apply the write and the index writes.
+    ss = ProcessStatementStatus(*exec_context_->parse_tree(), ApplyIndexWrites());
+    if (ss.ok()) {
+      if (ql_env_->FlushAsync(&flush_async_cb_)) {
+        return;
+      }
+      ss = STATUS(IllegalState, "No write to flush");
+    }
+  } else if (ss.ok()) {
+    // The writes are done, commit them.
+    ss = ProcessAsyncResults();
+    if (ss.ok()) {
+      ss = ProcessStatementStatus(*exec_context_->parse_tree(), ProcessIndexWriteResults());
+    }
+    if (ss.ok()) {
+      ql_env_->Reset();
+      ql_env_->CommitTransactionAsync(&commit_transaction_cb_);
+      return;
+    }
+  }
+  StatementExecuted(ss);
+}
+
+void Executor::CommitTransactionDone(const Status& s) {
+  StatementExecuted(s.ok() ? s : exec_context_->Error(s, ErrorCode::EXEC_ERROR));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+Status Executor::BackfillIndex(const YBTableName& indexed_table_name,
+                               const TableId& index_table_id) {
+  // Once the tablets of the indexed table run the schema version that has the index, writers that
+  // do not know the index are rejected. The rows written before are read by the backfill below,
+  // and the writes after it update the index themselves.
+  RETURN_NOT_OK(ql_env_->WaitForAlterTableToFinish(indexed_table_name));
+
+  ql_env_->RemoveCachedTableDesc(indexed_table_name);
+  bool cache_used = false;
+  const shared_ptr<YBTable> table = ql_env_->GetTableDesc(indexed_table_name, &cache_used);
+  const shared_ptr<YBTable> index_table = ql_env_->GetTableDesc(index_table_id, &cache_used);
+  if (table == nullptr || index_table == nullptr) {
+    return STATUS(NotFound, "Indexed table or index table not found", index_table_id);
+  }
+  const auto index = table->index_map().find(index_table_id);
+  if (index == table->index_map().end()) {
+    return STATUS(NotFound, "Index not found in the indexed table", index_table_id);
+  }
+
+  QLPagingStatePB paging_state;
+  bool has_more = true;
+  while (has_more) {
+    // A page conflicts with a concurrent write of one of its rows, which both write the index
+    // entry of the row. Retry the page so that it reads the row as written.
+    Status s;
+    for (int attempt = 0; attempt < kBackfillPageAttempts; attempt++) {
+      s = BackfillIndexPage(table, index_table, index->second, &paging_state, &has_more);
+      if (s.ok()) {
+        break;
+      }
+      VLOG(1) << "Failed to backfill index " << index_table_id << ": " << s.ToString();
+    }
+    RETURN_NOT_OK(s);
+  }
+
+  shared_ptr<YBTableAlterer> table_alterer(ql_env_->NewTableAlterer(indexed_table_name));
+  RETURN_NOT_OK(table_alterer->MarkIndexBackfilled(index_table_id)->Alter());
+  ql_env_->RemoveCachedTableDesc(indexed_table_name);
+  return Status::OK();
+}
+
+Status Executor::BackfillIndexPage(const shared_ptr<YBTable>& table,
+                                   const shared_ptr<YBTable>& index_table,
+                                   const IndexInfo& index_info,
+                                   QLPagingStatePB* paging_state,
+                                   bool* has_more) {
+  const Schema& schema = table->InternalSchema();
+  const client::YBTransactionPtr transaction =
+      ql_env_->NewTransaction(IsolationLevel::SNAPSHOT_ISOLATION);
+
+  // Read the columns stored in the index from a page of rows.
+  shared_ptr<YBqlReadOp> read_op(table->NewQLSelect());
+  QLReadRequestPB *req = read_op->mutable_request();
+  for (size_t idx = 0; idx < schema.num_columns(); idx++) {
+    if (index_info.IsColumnCovered(schema.column_id(idx))) {
+      SelectColumn(schema, idx, req);
+    }
+  }
+  req->set_limit(kBackfillPageSize);
+  req->set_return_paging_state(true);
+  if (paging_state->has_next_partition_key() || paging_state->has_next_row_key()) {
+    *req->mutable_paging_state() = *paging_state;
+  }
+  read_op->set_yb_consistency_level(YBConsistencyLevel::STRONG);
+  const shared_ptr<YBSession> read_session = ql_env_->NewSession(true /* read_only */, transaction);
+  RETURN_NOT_OK(read_session->Apply(read_op));
+  RETURN_NOT_OK(FlushSession(read_session));
+  if (read_op->response().status() != QLResponsePB::YQL_STATUS_OK) {
+    return STATUS(RuntimeError, read_op->response().error_message());
+  }
+
+  // Write the index entries of the rows.
+  const shared_ptr<YBSession> write_session =
+      ql_env_->NewSession(false /* read_only */, transaction);
+  bool has_writes = false;
+  std::unique_ptr<QLRowBlock> row_block = RowsResult(read_op.get()).GetRowBlock();
+  vector<QLValuePB> row_values(schema.num_columns());
+  for (const QLRow& row : row_block->rows()) {
+    for (int i = 0; i < req->selected_exprs_size(); i++) {
+      row_values[schema.find_column_by_id(ColumnId(req->selected_exprs(i).column_id()))] =
+          ColumnValue(row, i);
+    }
+    if (HasNullKey(index_info, schema, row_values)) {
+      continue;
+    }
+    shared_ptr<YBqlWriteOp> insert_op(index_table->NewQLInsert());
+    IndexEntryToPB(index_info, schema, row_values, insert_op->mutable_request());
+    RETURN_NOT_OK(write_session->Apply(insert_op));
+    has_writes = true;
+  }
+  if (has_writes) {
+    RETURN_NOT_OK(FlushSession(write_session));
+  }
+  RETURN_NOT_OK(transaction->CommitFuture().get());
+
+  *has_more = read_op->response().has_paging_state();
+  if (*has_more) {
+    *paging_state = read_op->response().paging_state();
+  }
+  return Status::OK();
+}
+
+}  // namespace ql
+}  // namespace yb
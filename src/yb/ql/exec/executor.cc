@@ -18,6 +18,13 @@
 #include "yb/client/callbacks.h"
 #include "yb/ql/ql_processor.h"
 #include "yb/util/decimal.h"
+#include "yb/util/flag_tags.h"
+
+DEFINE_int64(cql_scan_page_limit_bytes, 0,
+             "Approximate maximum number of bytes of the values returned by a tablet for one page "
+             "of a SELECT that scans the whole table. 0 means that pages are limited by the page "
+             "size in rows only.");
+TAG_FLAG(cql_scan_page_limit_bytes, advanced);
 
 namespace yb {
 namespace ql {
@@ -42,7 +49,8 @@ using strings::Substitute;
 Executor::Executor(QLEnv *ql_env, const QLMetrics* ql_metrics)
     : ql_env_(ql_env),
       ql_metrics_(ql_metrics),
-      flush_async_cb_(Bind(&Executor::FlushAsyncDone, Unretained(this))) {
+      flush_async_cb_(Bind(&Executor::FlushAsyncDone, Unretained(this))),
+      commit_transaction_cb_(Bind(&Executor::CommitTransactionDone, Unretained(this))) {
 }
 
 Executor::~Executor() {
@@ -85,10 +93,14 @@ void Executor::ExecuteBatch(const std::string &ql_stmt, const ParseTree &parse_t
       case TreeNodeOpcode::kPTInsertStmt: FALLTHROUGH_INTENDED;
       case TreeNodeOpcode::kPTUpdateStmt: FALLTHROUGH_INTENDED;
       case TreeNodeOpcode::kPTDeleteStmt: {
-        const PTExpr::SharedPtr& if_clause = static_cast<const PTDmlStmt*>(tnode)->if_clause();
-        if (if_clause != nullptr) {
+        const PTDmlStmt* dml_stmt = static_cast<const PTDmlStmt*>(tnode);
+        if (dml_stmt->if_clause() != nullptr) {
           s = ErrorStatus(ErrorCode::CQL_STATEMENT_INVALID,
                           "batch execution of conditional DML statement not supported yet");
+        } else if (!dml_stmt->table()->index_map().empty()) {
+          s = ErrorStatus(ErrorCode::CQL_STATEMENT_INVALID,
+                          "batch execution of DML statement on table with secondary indexes not "
+                          "supported yet");
         }
         break;
       }
@@ -137,7 +149,8 @@ Status Executor::ExecTreeNode(const TreeNode *tnode) {
     return Status::OK();
   }
   switch (tnode->opcode()) {
-    case TreeNodeOpcode::kPTCreateTable:
+    case TreeNodeOpcode::kPTCreateTable: FALLTHROUGH_INTENDED;
+    case TreeNodeOpcode::kPTCreateIndex:
       return ExecPTNode(static_cast<const PTCreateTable *>(tnode));
 
     case TreeNodeOpcode::kPTAlterTable:
@@ -259,6 +272,12 @@ Status Executor::ExecPTNode(const PTCreateTable *tnode) {
     return exec_context_->Error(tnode->columns().front(), s, ErrorCode::INVALID_TABLE_DEFINITION);
   }
 
+  // An index table is written together with its indexed table in distributed transactions.
+  const bool is_index = tnode->opcode() == TreeNodeOpcode::kPTCreateIndex;
+  if (is_index) {
+    table_properties.SetTransactional(true);
+  }
+
   b.SetTableProperties(table_properties);
 
   s = b.Build(&schema);
@@ -268,10 +287,13 @@ Status Executor::ExecPTNode(const PTCreateTable *tnode) {
 
   // Create table.
   shared_ptr<YBTableCreator> table_creator(exec_context_->NewTableCreator());
-  s = table_creator->table_name(table_name)
-                    .table_type(YBTableType::YQL_TABLE_TYPE)
-                    .schema(&schema)
-                    .Create();
+  table_creator->table_name(table_name)
+                .table_type(YBTableType::YQL_TABLE_TYPE)
+                .schema(&schema);
+  if (is_index) {
+    table_creator->indexed_table_id(static_cast<const PTCreateIndex*>(tnode)->indexed_table_id());
+  }
+  s = table_creator->Create();
   if (PREDICT_FALSE(!s.ok())) {
     ErrorCode error_code = ErrorCode::SERVER_ERROR;
     if (s.IsAlreadyPresent()) {
@@ -289,8 +311,26 @@ Status Executor::ExecPTNode(const PTCreateTable *tnode) {
     return exec_context_->Error(tnode->table_name(), s, error_code);
   }
 
-  result_ = std::make_shared<SchemaChangeResult>(
-      "CREATED", "TABLE", table_name.namespace_name(), table_name.table_name());
+  if (is_index) {
+    // Creating an index changes the indexed table, so the cached definition of it is stale now.
+    const YBTableName indexed_table_name =
+        static_cast<const PTCreateIndex*>(tnode)->indexed_table_name();
+    exec_context_->RemoveCachedTableDesc(indexed_table_name);
+
+    // Write the existing rows of the table into the index before queries may read it.
+    bool cache_used = false;
+    const shared_ptr<YBTable> index_table = ql_env_->GetTableDesc(table_name, &cache_used);
+    s = index_table != nullptr ? BackfillIndex(indexed_table_name, index_table->id())
+                               : STATUS(NotFound, "Index table not found", table_name.ToString());
+    if (PREDICT_FALSE(!s.ok())) {
+      return exec_context_->Error(tnode->table_name(), s, ErrorCode::SERVER_ERROR);
+    }
+    result_ = std::make_shared<SchemaChangeResult>(
+        "UPDATED", "TABLE", indexed_table_name.namespace_name(), indexed_table_name.table_name());
+  } else {
+    result_ = std::make_shared<SchemaChangeResult>(
+        "CREATED", "TABLE", table_name.namespace_name(), table_name.table_name());
+  }
   return Status::OK();
 }
 
@@ -434,7 +474,7 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
     QLRowBlock empty_row_block(tnode->table()->InternalSchema(), {});
     faststring buffer;
     empty_row_block.Serialize(select_op->request().client(), &buffer);
-    *select_op->mutable_rows_data() = buffer.ToString();
+    *select_op->mutable_rows_data() = RefCntBuffer(buffer);
     result_ = std::make_shared<RowsResult>(select_op.get());
     return Status::OK();
   }
@@ -471,6 +511,11 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
   req->set_limit(params.page_size());
   req->set_return_paging_state(true);
 
+  // Full table scans may return large pages in rows, so bound them in bytes too.
+  if (FLAGS_cql_scan_page_limit_bytes > 0 && req->hashed_column_values().empty()) {
+    req->set_limit_bytes(FLAGS_cql_scan_page_limit_bytes);
+  }
+
   // Check if there is a limit and compute the new limit based on the number of returned rows.
   if (tnode->has_limit()) {
     QLExpressionPB limit_pb;
@@ -546,8 +591,9 @@ Status Executor::FetchMoreRowsIfNeeded() {
   // Rows read so far: in this fetch, previous fetches (for paging selects), and in total.
   RowsResult::SharedPtr current_result = std::static_pointer_cast<RowsResult>(result_);
   size_t current_fetch_row_count = 0;
+  const auto& rows_data = current_result->rows_data();
   RETURN_NOT_OK(QLRowBlock::GetRowCount(current_result->client(),
-                                        current_result->rows_data(),
+                                        Slice(rows_data.udata(), rows_data.size()),
                                         &current_fetch_row_count));
 
   size_t previous_fetches_row_count = exec_context_->params()->total_num_rows_read();
@@ -665,7 +711,10 @@ Status Executor::ExecPTNode(const PTInsertStmt *tnode) {
     }
   }
 
-  // Apply the operator.
+  // Apply the operator. The indexes of the table are updated in the same transaction.
+  if (!table->index_map().empty()) {
+    return ReadIndexedRow(tnode, insert_op);
+  }
   return exec_context_->ApplyWrite(insert_op);
 }
 
@@ -703,7 +752,10 @@ Status Executor::ExecPTNode(const PTDeleteStmt *tnode) {
     }
   }
 
-  // Apply the operator.
+  // Apply the operator. The indexes of the table are updated in the same transaction.
+  if (!table->index_map().empty()) {
+    return ReadIndexedRow(tnode, delete_op);
+  }
   return exec_context_->ApplyWrite(delete_op);
 }
 
@@ -749,7 +801,16 @@ Status Executor::ExecPTNode(const PTUpdateStmt *tnode) {
     }
   }
 
-  // Apply the operator.
+  // Write the counter updates as increments when possible.
+  s = CounterIncrementsToPB(table, tnode, req);
+  if (PREDICT_FALSE(!s.ok())) {
+    return exec_context_->Error(s, ErrorCode::INVALID_ARGUMENTS);
+  }
+
+  // Apply the operator. The indexes of the table are updated in the same transaction.
+  if (!table->index_map().empty()) {
+    return ReadIndexedRow(tnode, update_op);
+  }
   return exec_context_->ApplyWrite(update_op);
 }
 
@@ -791,6 +852,9 @@ Status Executor::ExecPTNode(const PTUseKeyspace *tnode) {
 }
 
 void Executor::FlushAsyncDone(const Status &s) {
+  if (index_write_op_ != nullptr) {
+    return IndexFlushAsyncDone(s);
+  }
   Status ss = s;
   if (ss.ok()) {
     ss = ProcessAsyncResults();
@@ -931,6 +995,11 @@ void Executor::StatementExecuted(const Status& s) {
 }
 
 void Executor::Reset() {
+  // Drop the transaction of a write to a table with secondary indexes that failed.
+  ql_env_->ResetTransaction();
+  index_read_op_ = nullptr;
+  index_write_op_ = nullptr;
+  index_ops_.clear();
   exec_contexts_.clear();
   exec_context_ = nullptr;
   result_ = nullptr;
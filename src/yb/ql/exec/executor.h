@@ -18,11 +18,13 @@
 #ifndef YB_QL_EXEC_EXECUTOR_H_
 #define YB_QL_EXEC_EXECUTOR_H_
 
+#include "yb/common/index.h"
 #include "yb/common/partial_row.h"
 #include "yb/ql/exec/exec_context.h"
 #include "yb/ql/ptree/pt_create_keyspace.h"
 #include "yb/ql/ptree/pt_use_keyspace.h"
 #include "yb/ql/ptree/pt_create_table.h"
+#include "yb/ql/ptree/pt_create_index.h"
 #include "yb/ql/ptree/pt_alter_table.h"
 #include "yb/ql/ptree/pt_create_type.h"
 #include "yb/ql/ptree/pt_drop.h"
@@ -107,6 +109,41 @@ class Executor {
   // Uses a keyspace.
   CHECKED_STATUS ExecPTNode(const PTUseKeyspace *tnode);
 
+  //------------------------------------------------------------------------------------------------
+  // Secondary index maintenance.
+
+  // Start a write to a table with secondary indexes. The write is executed in a distributed
+  // transaction, which first reads the current values of the columns that are stored in the
+  // indexes.
+  CHECKED_STATUS ReadIndexedRow(const PTDmlStmt *tnode,
+                                const std::shared_ptr<client::YBqlWriteOp>& write_op);
+
+  // Apply the pending write together with the writes to the index tables that keep the indexes
+  // consistent with the row read by ReadIndexedRow().
+  CHECKED_STATUS ApplyIndexWrites();
+
+  // Process the responses of the index table writes.
+  CHECKED_STATUS ProcessIndexWriteResults();
+
+  // Callback for FlushAsync of the reads and writes of a write to a table with secondary indexes.
+  void IndexFlushAsyncDone(const Status& s);
+
+  // Callback for the commit of the transaction of a write to a table with secondary indexes.
+  void CommitTransactionDone(const Status& s);
+
+  // Write the entries of the existing rows of the indexed table into a newly created index, then
+  // mark the index backfilled so that queries may read it. Runs synchronously like other DDLs.
+  CHECKED_STATUS BackfillIndex(const client::YBTableName& indexed_table_name,
+                               const TableId& index_table_id);
+
+  // Read a page of rows of the indexed table from the paging state and write their index entries
+  // in one transaction. Set *has_more and the paging state of the next page.
+  CHECKED_STATUS BackfillIndexPage(const std::shared_ptr<client::YBTable>& table,
+                                   const std::shared_ptr<client::YBTable>& index_table,
+                                   const IndexInfo& index_info,
+                                   QLPagingStatePB* paging_state,
+                                   bool* has_more);
+
   //------------------------------------------------------------------------------------------------
   // Result processing.
 
@@ -172,6 +209,9 @@ class Executor {
   CHECKED_STATUS BFCallToPB(const PTBcall *bcall_pt, QLExpressionPB *expr_pb);
   CHECKED_STATUS TSCallToPB(const PTBcall *bcall_pt, QLExpressionPB *expr_pb);
 
+  // Evaluate a foldable builtin call and convert its result to a value expression.
+  CHECKED_STATUS FoldBFCallToPB(const PTBcall *bcall_pt, QLExpressionPB *expr_pb);
+
   // Logic expressions.
   CHECKED_STATUS PTExprToPB(const PTLogic1 *logic_pt, QLExpressionPB *logic_pb);
   CHECKED_STATUS PTExprToPB(const PTLogic2 *logic_pt, QLExpressionPB *logic_pb);
@@ -204,6 +244,12 @@ class Executor {
                                 const PTDmlStmt *tnode,
                                 QLWriteRequestPB *req);
 
+  // Turn the counter updates "c = c + n" and "c = c - n" of the request into blind increments
+  // when the current values are not needed otherwise.
+  CHECKED_STATUS CounterIncrementsToPB(const std::shared_ptr<client::YBTable>& table,
+                                       const PTDmlStmt *tnode,
+                                       QLWriteRequestPB *req);
+
   //------------------------------------------------------------------------------------------------
   // Where clause evaluation.
 
@@ -249,6 +295,15 @@ class Executor {
 
   // FlushAsync callback.
   Callback<void(const Status&)> flush_async_cb_;
+
+  // CommitTransactionAsync callback.
+  Callback<void(const Status&)> commit_transaction_cb_;
+
+  // State of a write to a table with secondary indexes: the read of the current row, the write
+  // that is pending until the row is read, and the writes to the index tables.
+  std::shared_ptr<client::YBqlReadOp> index_read_op_;
+  std::shared_ptr<client::YBqlWriteOp> index_write_op_;
+  std::vector<std::shared_ptr<client::YBqlWriteOp>> index_ops_;
 };
 
 }  // namespace ql
@@ -270,6 +270,19 @@ CHECKED_STATUS PTBcall::Analyze(SemContext *sem_context) {
     ql_type_ = pt_result->ql_type();
   }
 
+  // Check if the call can be folded. The arguments of token() are analyzed again by PTToken against
+  // the hash columns, so it is never folded.
+  is_foldable_ = !is_server_operator_ && strcmp(name_->c_str(), "token") != 0;
+  for (const auto &expr : exprs) {
+    if (!is_foldable_) {
+      break;
+    }
+    is_foldable_ = expr->is_constant() ||
+                   expr->expr_op() == ExprOperator::kBindVar ||
+                   (expr->expr_op() == ExprOperator::kBcall &&
+                    static_cast<const PTBcall *>(expr.get())->is_foldable());
+  }
+
   internal_type_ = yb::client::YBColumnSchema::ToInternalDataType(ql_type_);
   return CheckExpectedTypeCompatibility(sem_context);
 }
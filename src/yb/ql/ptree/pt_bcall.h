@@ -70,6 +70,13 @@ class PTBcall : public PTExpr {
     return result_cast_op_;
   }
 
+  // Whether the call is a regular builtin call whose arguments are all known before execution
+  // (literals, bind variables or other foldable calls). Such a call is evaluated once per
+  // statement by the executor instead of once per row by the tablet server.
+  bool is_foldable() const {
+    return is_foldable_;
+  }
+
   const MCSharedPtr<MCString>& name() const {
     return name_;
   }
@@ -106,6 +113,9 @@ class PTBcall : public PTExpr {
 
   // Casting the returned result to expected type is also needed.
   yb::bfql::BFOpcode result_cast_op_;
+
+  // Whether the call can be folded into a constant at execution time.
+  bool is_foldable_ = false;
 };
 
 class PTToken : public PTBcall {
@@ -46,6 +46,14 @@ CHECKED_STATUS PTCreateIndex::Analyze(SemContext *sem_context) {
                                          true /* write only */, relation_->loc(),
                                          true /* with_column_definitions */, &column_definitions_));
   DCHECK(!is_system);
+  if (table_->IsIndex()) {
+    return sem_context->Error(relation_, "Cannot create an index on an index",
+                              ErrorCode::FEATURE_NOT_SUPPORTED);
+  }
+  if (table_->InternalSchema().table_properties().contain_counters()) {
+    return sem_context->Error(relation_, "Index on a table with counter columns not supported",
+                              ErrorCode::FEATURE_NOT_SUPPORTED);
+  }
 
   // Save context state, and set "this" as current create-table statement in the context.
   SymbolEntry cached_entry = *sem_context->current_processing_id();
@@ -79,6 +87,10 @@ CHECKED_STATUS PTCreateIndex::Analyze(SemContext *sem_context) {
   return Status::OK();
 }
 
+const std::string& PTCreateIndex::indexed_table_id() const {
+  return table_->id();
+}
+
 void PTCreateIndex::PrintSemanticAnalysisResult(SemContext *sem_context) {
   PTCreateTable::PrintSemanticAnalysisResult(sem_context);
 }
@@ -53,6 +53,17 @@ class PTCreateIndex : public PTCreateTable {
     return covering_;
   }
 
+  // Index table name. The index is created in the keyspace of the indexed table.
+  virtual client::YBTableName yb_table_name() const override {
+    return client::YBTableName(PTCreateTable::yb_table_name().namespace_name(), name_->c_str());
+  }
+
+  // Indexed table name and id.
+  client::YBTableName indexed_table_name() const {
+    return PTCreateTable::yb_table_name();
+  }
+  const std::string& indexed_table_id() const;
+
   // Node semantics analysis.
   virtual CHECKED_STATUS Analyze(SemContext *sem_context) override;
   void PrintSemanticAnalysisResult(SemContext *sem_context);
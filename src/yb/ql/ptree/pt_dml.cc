@@ -66,8 +66,16 @@ PTDmlStmt::~PTDmlStmt() {
 CHECKED_STATUS PTDmlStmt::LookupTable(SemContext *sem_context) {
   YBTableName name = table_name();
 
-  return sem_context->LookupTable(name, &table_, &table_columns_, &num_key_columns_,
-                                  &num_hash_key_columns_, &is_system_, write_only_, table_loc());
+  RETURN_NOT_OK(sem_context->LookupTable(name, &table_, &table_columns_, &num_key_columns_,
+                                         &num_hash_key_columns_, &is_system_, write_only_,
+                                         table_loc()));
+
+  // Index tables are written only together with their indexed tables.
+  if (write_only_ && table_->IsIndex()) {
+    return sem_context->Error(table_loc(), "Cannot write to an index table directly",
+                              ErrorCode::FEATURE_NOT_SUPPORTED);
+  }
+  return Status::OK();
 }
 
 // Node semantics analysis.
@@ -18,6 +18,7 @@
 #include "yb/ql/ptree/pt_select.h"
 
 #include <functional>
+#include <set>
 
 #include "yb/ql/ptree/sem_context.h"
 
@@ -100,6 +101,9 @@ CHECKED_STATUS PTSelectStmt::Analyze(SemContext *sem_context) {
   }
   RETURN_NOT_OK(from_clause_->Analyze(sem_context));
 
+  // Query a secondary index instead of the table when it is more efficient.
+  RETURN_NOT_OK(AnalyzeIndexes(sem_context));
+
   // Collect table's schema for semantic analysis.
   Status s = LookupTable(sem_context);
   if (PREDICT_FALSE(!s.ok())) {
@@ -128,6 +132,107 @@ CHECKED_STATUS PTSelectStmt::Analyze(SemContext *sem_context) {
   return Status::OK();
 }
 
+namespace {
+
+// Collects the names of the columns in a WHERE clause that is a conjunction of relations between
+// columns and expressions. The columns with '=' and 'IN' conditions are also collected into
+// "restricted". Returns false if the clause has other kinds of conditions.
+bool CollectWhereColumns(const PTExpr* expr, std::set<std::string>* referenced,
+                         std::set<std::string>* restricted) {
+  switch (expr->expr_op()) {
+    case ExprOperator::kLogic2:
+      return expr->ql_op() == QL_OP_AND &&
+             CollectWhereColumns(expr->op1().get(), referenced, restricted) &&
+             CollectWhereColumns(expr->op2().get(), referenced, restricted);
+    case ExprOperator::kRelation2: FALLTHROUGH_INTENDED;
+    case ExprOperator::kRelation3: {
+      if (expr->op1()->expr_op() != ExprOperator::kRef) {
+        return false;
+      }
+      const PTRef* ref = static_cast<const PTRef*>(expr->op1().get());
+      const std::string name(ref->name()->last_name().c_str());
+      referenced->insert(name);
+      if (expr->ql_op() == QL_OP_EQUAL || expr->ql_op() == QL_OP_IN) {
+        restricted->insert(name);
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+} // namespace
+
+CHECKED_STATUS PTSelectStmt::AnalyzeIndexes(SemContext *sem_context) {
+  // A query that does not restrict the partition key of the table scans all tablets of it. When
+  // a secondary index stores all columns referenced by the query and the query restricts the
+  // partition key of the index, the query reads the index table instead.
+  index_table_name_ = client::YBTableName();
+  if (distinct_ || where_clause_ == nullptr || table_name().is_system()) {
+    return Status::OK();
+  }
+  const std::shared_ptr<YBTable> table = sem_context->GetTableDesc(table_name());
+  if (table == nullptr || table->index_map().empty()) {
+    return Status::OK();
+  }
+
+  // Only the selection of plain columns is supported, which have the same names in the index.
+  std::set<std::string> referenced, restricted;
+  for (const auto& expr : selected_exprs_->node_list()) {
+    if (expr->opcode() != TreeNodeOpcode::kPTRef) {
+      return Status::OK();
+    }
+    referenced.insert(static_cast<const PTRef*>(expr.get())->name()->last_name().c_str());
+  }
+  if (!CollectWhereColumns(where_clause_.get(), &referenced, &restricted)) {
+    return Status::OK();
+  }
+
+  const Schema& schema = table->InternalSchema();
+  bool table_key_restricted = true;
+  for (size_t idx = 0; idx < schema.num_hash_key_columns(); idx++) {
+    if (restricted.count(schema.column(idx).name()) == 0) {
+      table_key_restricted = false;
+      break;
+    }
+  }
+  if (table_key_restricted) {
+    return Status::OK();
+  }
+
+  for (const auto& index : table->index_map()) {
+    const IndexInfo& index_info = index.second;
+    // An index that is being backfilled misses the entries of some rows.
+    if (!index_info.is_backfilled()) {
+      continue;
+    }
+    bool usable = true;
+    for (const auto& name : referenced) {
+      const int idx = schema.find_column(name);
+      if (idx == Schema::kColumnNotFound || !index_info.IsColumnCovered(schema.column_id(idx))) {
+        usable = false;
+        break;
+      }
+    }
+    for (size_t i = 0; usable && i < index_info.hash_column_count(); i++) {
+      const ColumnId column_id = index_info.columns()[i].indexed_column_id;
+      usable = restricted.count(schema.column_by_id(column_id).name()) > 0;
+    }
+    if (!usable) {
+      continue;
+    }
+    const std::shared_ptr<YBTable> index_table = sem_context->GetTableDesc(index_info.table_id());
+    if (index_table != nullptr) {
+      VLOG(3) << "Selecting from index " << index_table->name().ToString() << " of table "
+              << table->name().ToString();
+      index_table_name_ = index_table->name();
+      return Status::OK();
+    }
+  }
+  return Status::OK();
+}
+
 void PTSelectStmt::PrintSemanticAnalysisResult(SemContext *sem_context) {
   VLOG(3) << "SEMANTIC ANALYSIS RESULT (" << *loc_ << "):\n" << "Not yet avail";
 }
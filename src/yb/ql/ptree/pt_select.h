@@ -181,6 +181,7 @@ class PTSelectStmt : public PTDmlStmt {
 
   // Node semantics analysis.
   virtual CHECKED_STATUS Analyze(SemContext *sem_context) override;
+  CHECKED_STATUS AnalyzeIndexes(SemContext *sem_context);
   CHECKED_STATUS AnalyzeDistinctClause(SemContext *sem_context);
   CHECKED_STATUS AnalyzeLimitClause(SemContext *sem_context);
   CHECKED_STATUS ConstructSelectedSchema();
@@ -218,8 +219,11 @@ class PTSelectStmt : public PTDmlStmt {
     return selected_exprs_->node_list();
   }
 
-  // Returns table name.
+  // Returns table name, or the name of the index table when the statement queries an index.
   virtual client::YBTableName table_name() const override {
+    if (!index_table_name_.table_name().empty()) {
+      return index_table_name_;
+    }
     // CQL only allows one table at a time.
     return from_clause_->element(0)->table_name();
   }
@@ -246,6 +250,9 @@ class PTSelectStmt : public PTDmlStmt {
   PTListNode::SharedPtr having_clause_;
   PTListNode::SharedPtr order_by_clause_;
   PTExpr::SharedPtr limit_clause_;
+
+  // Name of the index table to query instead of the table.
+  client::YBTableName index_table_name_;
 };
 
 }  // namespace ql
@@ -108,8 +108,9 @@ QLMetrics::QLMetrics(const scoped_refptr<yb::MetricEntity> &metric_entity) {
 
 QLProcessor::QLProcessor(std::weak_ptr<rpc::Messenger> messenger, shared_ptr<YBClient> client,
                            shared_ptr<YBMetaDataCache> cache, QLMetrics* ql_metrics,
-                           cqlserver::CQLRpcServerEnv* cql_rpcserver_env)
-    : ql_env_(messenger, client, cache, cql_rpcserver_env),
+                           cqlserver::CQLRpcServerEnv* cql_rpcserver_env,
+                           client::TransactionManager* transaction_manager)
+    : ql_env_(messenger, client, cache, cql_rpcserver_env, transaction_manager),
       analyzer_(&ql_env_),
       executor_(&ql_env_, ql_metrics),
       ql_metrics_(ql_metrics) {
@@ -61,7 +61,8 @@ class QLProcessor {
   explicit QLProcessor(std::weak_ptr<rpc::Messenger> messenger,
                         std::shared_ptr<client::YBClient> client,
                         std::shared_ptr<client::YBMetaDataCache> cache, QLMetrics* ql_metrics,
-                        cqlserver::CQLRpcServerEnv* cql_rpcserver_env = nullptr);
+                        cqlserver::CQLRpcServerEnv* cql_rpcserver_env = nullptr,
+                        client::TransactionManager* transaction_manager = nullptr);
   virtual ~QLProcessor();
 
   // Prepare a SQL statement (parse and analyze).
@@ -18,6 +18,9 @@
 
 #include "yb/ql/test/ql-test-base.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/util/stopwatch.h"
+
+DECLARE_bool(cql_blind_counter_increments);
 
 using std::string;
 using std::unique_ptr;
@@ -31,6 +34,52 @@ class TestQLArith : public QLTestBase {
  public:
   TestQLArith() : QLTestBase() {
   }
+
+  // Several clients update the same counters concurrently, num_updates times each, with the
+  // counter updates written as blind increments and as read-modify-writes. Verifies the final
+  // counter values and logs the time taken.
+  void UpdateHotCounter(int num_updates) {
+    // Init the simulated cluster.
+    ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+    constexpr int kNumThreads = 8;
+    std::vector<TestQLProcessor*> processors;
+    for (int i = 0; i < kNumThreads; i++) {
+      processors.push_back(GetQLProcessor());
+    }
+    TestQLProcessor *processor = processors[0];
+    CHECK_VALID_STMT("CREATE TABLE test_counter(h1 int primary key, c1 counter, c2 counter);");
+
+    for (const bool blind : {true, false}) {
+      FLAGS_cql_blind_counter_increments = blind;
+      const int key = blind ? 1 : 2;
+      Stopwatch sw;
+      sw.start();
+      std::vector<std::thread> threads;
+      for (TestQLProcessor* thread_processor : processors) {
+        threads.emplace_back([thread_processor, key, num_updates] {
+          for (int i = 0; i < num_updates; i++) {
+            ASSERT_OK(thread_processor->Run(Substitute(
+                "UPDATE test_counter SET c1 = c1 + 3, c2 = c2 - 1 WHERE h1 = $0;", key)));
+          }
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      sw.stop();
+
+      CHECK_VALID_STMT(Substitute("SELECT c1, c2 FROM test_counter WHERE h1 = $0", key));
+      std::shared_ptr<QLRowBlock> row_block = processor->row_block();
+      ASSERT_EQ(row_block->row_count(), 1);
+      const QLRow& row = row_block->row(0);
+      ASSERT_EQ(row.column(0).int64_value(), 3 * kNumThreads * num_updates);
+      ASSERT_EQ(row.column(1).int64_value(), -kNumThreads * num_updates);
+      LOG(INFO) << (blind ? "Blind increments" : "Read-modify-writes") << ": "
+                << kNumThreads * num_updates << " updates of a hot counter in "
+                << sw.elapsed().wall_millis() << "ms";
+    }
+  }
 };
 
 TEST_F(TestQLArith, TestQLArithBigint) {
@@ -149,6 +198,15 @@ TEST_F(TestQLArith, TestQLArithCounter) {
   CHECK_EQ(new_row.column(1).int64_value(), 87);
 }
 
+TEST_F(TestQLArith, TestQLConcurrentCounterUpdates) {
+  ASSERT_NO_FATALS(UpdateHotCounter(20 /* num_updates */));
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(TestQLArith, DISABLED_BenchmarkHotCounter) {
+  ASSERT_NO_FATALS(UpdateHotCounter(200 /* num_updates */));
+}
+
 TEST_F(TestQLArith, TestQLErrorArithCounter) {
   // Init the simulated cluster.
   ASSERT_NO_FATALS(CreateSimulatedCluster());
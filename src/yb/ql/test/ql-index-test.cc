@@ -0,0 +1,274 @@
+//--------------------------------------------------------------------------------------------------
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//--------------------------------------------------------------------------------------------------
+
+#include "yb/ql/test/ql-test-base.h"
+
+#include "yb/gutil/strings/substitute.h"
+
+DECLARE_int32(transaction_table_default_num_tablets);
+
+using std::string;
+using strings::Substitute;
+
+namespace yb {
+namespace ql {
+
+class TestQLIndex : public QLTestBase {
+ public:
+  TestQLIndex() : QLTestBase() {
+  }
+
+  virtual void SetUp() override {
+    QLTestBase::SetUp();
+    FLAGS_transaction_table_default_num_tablets = 1;
+  }
+
+  // Create a table with an index on the regular column v, which covers column c.
+  void CreateTableAndIndex(TestQLProcessor *processor) {
+    CHECK_VALID_STMT("CREATE TABLE t (h int, r int, v int, c varchar, PRIMARY KEY ((h), r));");
+    CHECK_VALID_STMT("CREATE INDEX i ON t (v) COVERING (c);");
+  }
+
+  // Read the entries of the index table.
+  std::shared_ptr<QLRowBlock> ReadIndex(TestQLProcessor *processor) {
+    CHECK_OK(processor->Run("SELECT v, h, r, c FROM i;"));
+    return processor->row_block();
+  }
+};
+
+TEST_F(TestQLIndex, TestCreateIndex) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CreateTableAndIndex(processor);
+
+  // Index of a missing table, of an index, and of a missing column.
+  EXEC_INVALID_STMT("CREATE INDEX i2 ON missing_table (v);");
+  EXEC_INVALID_STMT("CREATE INDEX i2 ON i (c);");
+  EXEC_INVALID_STMT("CREATE INDEX i2 ON t (missing_column);");
+
+  // An index table cannot be written directly.
+  EXEC_INVALID_STMT("INSERT INTO i (v, h, r, c) VALUES (1, 1, 1, 'a');");
+
+  // An indexed column cannot be dropped.
+  EXEC_INVALID_STMT("ALTER TABLE t DROP v;");
+  EXEC_VALID_STMT("ALTER TABLE t ADD x int;");
+  EXEC_VALID_STMT("ALTER TABLE t DROP x;");
+
+  // Dropping the table drops its index.
+  EXEC_VALID_STMT("DROP TABLE t;");
+  EXEC_INVALID_STMT("SELECT v FROM i;");
+}
+
+TEST_F(TestQLIndex, TestIndexMaintenance) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CreateTableAndIndex(processor);
+
+  // Insert rows.
+  CHECK_VALID_STMT("INSERT INTO t (h, r, v, c) VALUES (1, 1, 10, 'a');");
+  CHECK_VALID_STMT("INSERT INTO t (h, r, v, c) VALUES (1, 2, 20, 'b');");
+  CHECK_VALID_STMT("INSERT INTO t (h, r, c) VALUES (2, 1, 'c');");
+  {
+    auto row_block = ReadIndex(processor);
+    ASSERT_EQ(row_block->row_count(), 2);
+  }
+
+  // Update the indexed column and the covered column.
+  CHECK_VALID_STMT("UPDATE t SET v = 30 WHERE h = 1 AND r = 1;");
+  CHECK_VALID_STMT("UPDATE t SET c = 'd' WHERE h = 1 AND r = 2;");
+  CHECK_VALID_STMT("UPDATE t SET v = 40 WHERE h = 2 AND r = 1;");
+  {
+    CHECK_VALID_STMT("SELECT v, h, r, c FROM i WHERE v = 30;");
+    auto row_block = processor->row_block();
+    ASSERT_EQ(row_block->row_count(), 1);
+    const QLRow& row = row_block->row(0);
+    EXPECT_EQ(row.column(1).int32_value(), 1);
+    EXPECT_EQ(row.column(2).int32_value(), 1);
+    EXPECT_EQ(row.column(3).string_value(), "a");
+
+    CHECK_VALID_STMT("SELECT c FROM i WHERE v = 20;");
+    row_block = processor->row_block();
+    ASSERT_EQ(row_block->row_count(), 1);
+    EXPECT_EQ(row_block->row(0).column(0).string_value(), "d");
+
+    CHECK_VALID_STMT("SELECT c FROM i WHERE v = 40;");
+    row_block = processor->row_block();
+    ASSERT_EQ(row_block->row_count(), 1);
+    EXPECT_EQ(row_block->row(0).column(0).string_value(), "c");
+
+    CHECK_VALID_STMT("SELECT c FROM i WHERE v = 10;");
+    EXPECT_EQ(processor->row_block()->row_count(), 0);
+  }
+
+  // Delete the indexed column and a whole row.
+  CHECK_VALID_STMT("DELETE v FROM t WHERE h = 1 AND r = 1;");
+  CHECK_VALID_STMT("DELETE FROM t WHERE h = 1 AND r = 2;");
+  {
+    auto row_block = ReadIndex(processor);
+    ASSERT_EQ(row_block->row_count(), 1);
+    EXPECT_EQ(row_block->row(0).column(0).int32_value(), 40);
+  }
+
+  // Conditional DML on an indexed table is not supported yet.
+  EXEC_INVALID_STMT("UPDATE t SET v = 50 WHERE h = 2 AND r = 1 IF v = 40;");
+}
+
+TEST_F(TestQLIndex, TestSelectFromIndex) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CreateTableAndIndex(processor);
+
+  for (int i = 0; i < 10; i++) {
+    CHECK_VALID_STMT(Substitute("INSERT INTO t (h, r, v, c) VALUES ($0, $1, $2, 'c$0');",
+                                i, i % 2, i / 2));
+  }
+
+  // The query on the indexed column reads the index.
+  CHECK_VALID_STMT("SELECT h, r, c FROM t WHERE v = 3;");
+  ASSERT_EQ(processor->rows_result()->table_name().table_name(), "i");
+  std::shared_ptr<QLRowBlock> row_block = processor->row_block();
+  ASSERT_EQ(row_block->row_count(), 2);
+  for (const auto& row : row_block->rows()) {
+    EXPECT_EQ(row.column(0).int32_value() / 2, 3);
+    EXPECT_EQ(row.column(1).int32_value(), row.column(0).int32_value() % 2);
+    EXPECT_EQ(row.column(2).string_value(), Substitute("c$0", row.column(0).int32_value()));
+  }
+
+  // Additional conditions on the columns stored in the index.
+  CHECK_VALID_STMT("SELECT h FROM t WHERE v = 3 AND r = 1;");
+  ASSERT_EQ(processor->rows_result()->table_name().table_name(), "i");
+  row_block = processor->row_block();
+  ASSERT_EQ(row_block->row_count(), 1);
+  EXPECT_EQ(row_block->row(0).column(0).int32_value(), 7);
+
+  // The query that restricts the partition key of the table reads the table.
+  CHECK_VALID_STMT("SELECT h, r, c FROM t WHERE h = 6 AND v = 3;");
+  ASSERT_EQ(processor->rows_result()->table_name().table_name(), "t");
+  ASSERT_EQ(processor->row_block()->row_count(), 1);
+
+  // The index does not store all columns referenced by these queries, so they read the table.
+  EXEC_VALID_STMT("ALTER TABLE t ADD x int;");
+  CHECK_VALID_STMT("SELECT h, x FROM t WHERE v = 3;");
+  ASSERT_EQ(processor->rows_result()->table_name().table_name(), "t");
+  ASSERT_EQ(processor->row_block()->row_count(), 2);
+  CHECK_VALID_STMT("SELECT * FROM t WHERE v = 3;");
+  ASSERT_EQ(processor->rows_result()->table_name().table_name(), "t");
+  ASSERT_EQ(processor->row_block()->row_count(), 2);
+}
+
+TEST_F(TestQLIndex, TestBackfillIndex) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CHECK_VALID_STMT("CREATE TABLE t (h int, r int, v int, c varchar, PRIMARY KEY ((h), r));");
+
+  // Insert rows into all tablets before the index is created. The rows without v have no entry.
+  constexpr int kNumRows = 100;
+  for (int i = 0; i < kNumRows; i++) {
+    if (i % 10 == 0) {
+      CHECK_VALID_STMT(Substitute("INSERT INTO t (h, r, c) VALUES ($0, $1, 'c$0');", i, i % 2));
+    } else {
+      CHECK_VALID_STMT(Substitute("INSERT INTO t (h, r, v, c) VALUES ($0, $1, $2, 'c$0');",
+                                  i, i % 2, i / 2));
+    }
+  }
+  CHECK_VALID_STMT("CREATE INDEX i ON t (v) COVERING (c);");
+
+  // The index has the entries of the existing rows.
+  {
+    auto row_block = ReadIndex(processor);
+    ASSERT_EQ(row_block->row_count(), kNumRows - kNumRows / 10);
+    for (const auto& row : row_block->rows()) {
+      const int h = row.column(1).int32_value();
+      EXPECT_EQ(row.column(0).int32_value(), h / 2);
+      EXPECT_EQ(row.column(2).int32_value(), h % 2);
+      EXPECT_EQ(row.column(3).string_value(), Substitute("c$0", h));
+    }
+  }
+
+  // The backfilled index is used by queries and maintained by later writes.
+  CHECK_VALID_STMT("SELECT h, r, c FROM t WHERE v = 3;");
+  ASSERT_EQ(processor->rows_result()->table_name().table_name(), "i");
+  ASSERT_EQ(processor->row_block()->row_count(), 2);
+  CHECK_VALID_STMT("UPDATE t SET v = 3 WHERE h = 20 AND r = 0;");
+  CHECK_VALID_STMT("SELECT h, r, c FROM t WHERE v = 3;");
+  ASSERT_EQ(processor->rows_result()->table_name().table_name(), "i");
+  ASSERT_EQ(processor->row_block()->row_count(), 3);
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(TestQLIndex, DISABLED_BenchmarkIndex) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CHECK_VALID_STMT("CREATE TABLE plain (h int, v int, c varchar, PRIMARY KEY ((h)));");
+  CHECK_VALID_STMT("CREATE TABLE t (h int, v int, c varchar, PRIMARY KEY ((h)));");
+  CHECK_VALID_STMT("CREATE INDEX i ON t (v) COVERING (c);");
+
+  // Write amplification: every write to the indexed table also reads the row and writes the
+  // index in a distributed transaction.
+  constexpr int kNumRows = 200;
+  MonoDelta plain_write_time = MonoDelta::FromNanoseconds(0);
+  MonoDelta indexed_write_time = MonoDelta::FromNanoseconds(0);
+  for (int i = 0; i < kNumRows; i++) {
+    const string values = Substitute("VALUES ($0, $1, 'c$0');", i, i);
+    MonoTime start = MonoTime::Now(MonoTime::FINE);
+    CHECK_VALID_STMT("INSERT INTO plain (h, v, c) " + values);
+    MonoTime middle = MonoTime::Now(MonoTime::FINE);
+    CHECK_VALID_STMT("INSERT INTO t (h, v, c) " + values);
+    MonoTime end = MonoTime::Now(MonoTime::FINE);
+    plain_write_time.AddDelta(middle.GetDeltaSince(start));
+    indexed_write_time.AddDelta(end.GetDeltaSince(middle));
+  }
+  LOG(INFO) << "Average insert latency: without index "
+            << plain_write_time.ToMicroseconds() / kNumRows << "us, with index "
+            << indexed_write_time.ToMicroseconds() / kNumRows << "us";
+
+  // Lookup latency: the query on the indexed column reads one tablet of the index instead of
+  // scanning all tablets of the table.
+  constexpr int kNumLookups = 50;
+  MonoDelta scan_time = MonoDelta::FromNanoseconds(0);
+  MonoDelta lookup_time = MonoDelta::FromNanoseconds(0);
+  for (int i = 0; i < kNumLookups; i++) {
+    const int v = i * kNumRows / kNumLookups;
+    MonoTime start = MonoTime::Now(MonoTime::FINE);
+    CHECK_VALID_STMT(Substitute("SELECT h, c FROM plain WHERE v = $0;", v));
+    ASSERT_EQ(processor->row_block()->row_count(), 1);
+    MonoTime middle = MonoTime::Now(MonoTime::FINE);
+    CHECK_VALID_STMT(Substitute("SELECT h, c FROM t WHERE v = $0;", v));
+    ASSERT_EQ(processor->row_block()->row_count(), 1);
+    MonoTime end = MonoTime::Now(MonoTime::FINE);
+    scan_time.AddDelta(middle.GetDeltaSince(start));
+    lookup_time.AddDelta(end.GetDeltaSince(middle));
+  }
+  LOG(INFO) << "Average select latency: full scan " << scan_time.ToMicroseconds() / kNumLookups
+            << "us, index lookup " << lookup_time.ToMicroseconds() / kNumLookups << "us";
+}
+
+} // namespace ql
+} // namespace yb
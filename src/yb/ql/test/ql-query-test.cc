@@ -13,6 +13,7 @@
 //
 //--------------------------------------------------------------------------------------------------
 
+#include <algorithm>
 #include <thread>
 #include <cmath>
 
@@ -20,6 +21,10 @@
 #include "yb/ql/test/ql-test-base.h"
 #include "yb/gutil/strings/substitute.h"
 
+DECLARE_int32(ql_scan_cache_ttl_ms);
+DECLARE_bool(ql_scan_prefetch_next_page);
+DECLARE_bool(tserver_non_blocking_reads);
+
 using std::string;
 using std::unique_ptr;
 using std::shared_ptr;
@@ -33,6 +38,25 @@ class TestQLQuery : public QLTestBase {
   TestQLQuery() : QLTestBase() {
   }
 
+  // Read "SELECT h, r, v FROM t" in pages of the given size and return the (h, r) of the rows.
+  void ScanInPages(TestQLProcessor *processor, int page_size,
+                   std::vector<std::pair<int32_t, int32_t>>* rows) {
+    rows->clear();
+    StatementParameters params;
+    params.set_page_size(page_size);
+    do {
+      CHECK_OK(processor->Run("SELECT h, r, v FROM t;", params));
+      for (const auto& row : processor->row_block()->rows()) {
+        rows->emplace_back(row.column(0).int32_value(), row.column(1).int32_value());
+        ASSERT_EQ(row.column(2).string_value(), Substitute("v$0", row.column(1).int32_value()));
+      }
+      if (processor->rows_result()->paging_state().empty()) {
+        break;
+      }
+      CHECK_OK(params.set_paging_state(processor->rows_result()->paging_state()));
+    } while (true);
+  }
+
   std::shared_ptr<QLRowBlock> ExecSelect(TestQLProcessor *processor, int expected_rows = 1) {
     auto select = "SELECT c1, c2, c3 FROM test_table WHERE c1 = 1";
     Status s = processor->Run(select);
@@ -1851,5 +1875,151 @@ TEST_F(TestQLQuery, TestDoublePrimaryKey) {
   }
 }
 
+TEST_F(TestQLQuery, TestPagedScanCache) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CHECK_VALID_STMT("CREATE TABLE t (h int, r int, v varchar, primary key((h), r));");
+
+  // Insert rows of a few hash keys so that every tablet is read in many pages.
+  constexpr int kNumHashKeys = 4;
+  constexpr int kNumRowsPerKey = 100;
+  for (int h = 0; h < kNumHashKeys; h++) {
+    for (int r = 0; r < kNumRowsPerKey; r++) {
+      CHECK_VALID_STMT(Substitute("INSERT INTO t (h, r, v) VALUES ($0, $1, 'v$1');", h, r));
+    }
+  }
+
+  // Scan the table in pages without the scan cache, with the scan cache, and with the next page
+  // prefetched. All must return the same rows in the same order.
+  std::vector<std::pair<int32_t, int32_t>> expected_rows;
+  for (int mode = 0; mode < 3; mode++) {
+    FLAGS_ql_scan_cache_ttl_ms = mode == 0 ? 0 : 10000;
+    FLAGS_ql_scan_prefetch_next_page = mode == 2;
+    for (int n = 0; n < 2; n++) {
+      std::vector<std::pair<int32_t, int32_t>> rows;
+      ASSERT_NO_FATALS(ScanInPages(processor, 20 /* page_size */, &rows));
+      ASSERT_EQ(rows.size(), static_cast<size_t>(kNumHashKeys * kNumRowsPerKey));
+      if (expected_rows.empty()) {
+        expected_rows = rows;
+      } else {
+        ASSERT_EQ(expected_rows, rows);
+      }
+    }
+  }
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(TestQLQuery, DISABLED_BenchmarkPagedScan) {
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+  TestQLProcessor *processor = GetQLProcessor();
+  CHECK_VALID_STMT("CREATE TABLE t (h int, r int, v varchar, primary key((h), r));");
+
+  constexpr int kNumHashKeys = 4;
+  constexpr int kNumRowsPerKey = 500;
+  for (int h = 0; h < kNumHashKeys; h++) {
+    for (int r = 0; r < kNumRowsPerKey; r++) {
+      CHECK_VALID_STMT(Substitute("INSERT INTO t (h, r, v) VALUES ($0, $1, 'v$1');", h, r));
+    }
+  }
+
+  constexpr int kNumScans = 5;
+  static const char* const kModeNames[] = {"without scan cache", "with scan cache",
+                                           "with prefetch"};
+  for (int mode = 0; mode < 3; mode++) {
+    FLAGS_ql_scan_cache_ttl_ms = mode == 0 ? 0 : 10000;
+    FLAGS_ql_scan_prefetch_next_page = mode == 2;
+    MonoTime start = MonoTime::Now(MonoTime::FINE);
+    for (int n = 0; n < kNumScans; n++) {
+      std::vector<std::pair<int32_t, int32_t>> rows;
+      ASSERT_NO_FATALS(ScanInPages(processor, 20 /* page_size */, &rows));
+    }
+    LOG(INFO) << "Average paged scan time " << kModeNames[mode] << ": "
+              << MonoTime::Now(MonoTime::FINE).GetDeltaSince(start).ToMicroseconds() / kNumScans
+              << "us";
+  }
+}
+
+TEST_F(TestQLQuery, TestPagedScanWithNonBlockingReads) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CHECK_VALID_STMT("CREATE TABLE t (h int, r int, v varchar, primary key((h), r));");
+
+  constexpr int kNumHashKeys = 4;
+  constexpr int kNumRowsPerKey = 200;
+  for (int h = 0; h < kNumHashKeys; h++) {
+    for (int r = 0; r < kNumRowsPerKey; r++) {
+      CHECK_VALID_STMT(Substitute("INSERT INTO t (h, r, v) VALUES ($0, $1, 'v$1');", h, r));
+    }
+  }
+  // Flush the rows, so that the first non blocking reads miss the block cache and are retried.
+  cluster_->FlushTablets();
+
+  // Paged scans with the scan cache and prefetch must return all rows whether the page was read
+  // in a non blocking read or in its blocking retry.
+  FLAGS_tserver_non_blocking_reads = true;
+  FLAGS_ql_scan_cache_ttl_ms = 10000;
+  FLAGS_ql_scan_prefetch_next_page = true;
+  for (int n = 0; n < 3; n++) {
+    std::vector<std::pair<int32_t, int32_t>> rows;
+    ASSERT_NO_FATALS(ScanInPages(processor, 20 /* page_size */, &rows));
+    ASSERT_EQ(rows.size(), static_cast<size_t>(kNumHashKeys * kNumRowsPerKey));
+    std::sort(rows.begin(), rows.end());
+    for (size_t i = 0; i < rows.size(); i++) {
+      ASSERT_EQ(rows[i], std::make_pair(static_cast<int32_t>(i / kNumRowsPerKey),
+                                        static_cast<int32_t>(i % kNumRowsPerKey)));
+    }
+  }
+}
+
+TEST_F(TestQLQuery, TestPagedScanAcrossFlush) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CHECK_VALID_STMT("CREATE TABLE t (h int, r int, v varchar, primary key((h), r));");
+
+  constexpr int kNumHashKeys = 4;
+  constexpr int kNumRowsPerKey = 100;
+  for (int h = 0; h < kNumHashKeys; h++) {
+    for (int r = 0; r < kNumRowsPerKey; r++) {
+      CHECK_VALID_STMT(Substitute("INSERT INTO t (h, r, v) VALUES ($0, $1, 'v$1');", h, r));
+    }
+  }
+
+  // The suspended scans are dropped when the tablets are flushed in the middle of the scan, the
+  // next pages must still return the remaining rows.
+  FLAGS_ql_scan_cache_ttl_ms = 10000;
+  FLAGS_ql_scan_prefetch_next_page = true;
+  std::vector<std::pair<int32_t, int32_t>> rows;
+  StatementParameters params;
+  params.set_page_size(20);
+  for (int page = 0;; page++) {
+    if (page == 2) {
+      cluster_->FlushTablets();
+    }
+    CHECK_OK(processor->Run("SELECT h, r, v FROM t;", params));
+    for (const auto& row : processor->row_block()->rows()) {
+      rows.emplace_back(row.column(0).int32_value(), row.column(1).int32_value());
+    }
+    if (processor->rows_result()->paging_state().empty()) {
+      break;
+    }
+    CHECK_OK(params.set_paging_state(processor->rows_result()->paging_state()));
+  }
+  ASSERT_EQ(rows.size(), static_cast<size_t>(kNumHashKeys * kNumRowsPerKey));
+  std::sort(rows.begin(), rows.end());
+  for (size_t i = 0; i < rows.size(); i++) {
+    ASSERT_EQ(rows[i], std::make_pair(static_cast<int32_t>(i / kNumRowsPerKey),
+                                      static_cast<int32_t>(i % kNumRowsPerKey)));
+  }
+}
+
 } // namespace ql
 } // namespace yb
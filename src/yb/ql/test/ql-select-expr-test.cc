@@ -83,5 +83,68 @@ TEST_F(QLTestSelectedExpr, TestQLSelectNumericExpr) {
   CHECK(expr_alias_row.column(1).IsNull());
 }
 
+TEST_F(QLTestSelectedExpr, TestQLFoldedBuiltinCalls) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CHECK_VALID_STMT("CREATE TABLE test_folded_expr(h1 int primary key, v1 bigint, v2 timeuuid);");
+
+  // Calls with literal arguments are evaluated by the executor before the request is sent.
+  CHECK_VALID_STMT("INSERT INTO test_folded_expr(h1, v1, v2) VALUES(1, 10 + 1, now());");
+  CHECK_VALID_STMT("SELECT v1, v2, v1 + (1 + 2), v1 - (4 - 1) FROM test_folded_expr "
+                   "WHERE h1 = 1;");
+  std::shared_ptr<QLRowBlock> row_block = processor->row_block();
+  ASSERT_EQ(row_block->row_count(), 1);
+  const QLRow& row = row_block->row(0);
+  EXPECT_EQ(row.column(0).int64_value(), 11);
+  EXPECT_FALSE(row.column(1).IsNull());
+  EXPECT_EQ(row.column(2).int64_value(), 14);
+  EXPECT_EQ(row.column(3).int64_value(), 8);
+
+  // Nested calls are folded as a whole.
+  CHECK_VALID_STMT("INSERT INTO test_folded_expr(h1, v1, v2) VALUES(2, 1 + 2 + 3 + 4, now());");
+  CHECK_VALID_STMT("SELECT v1 + (1 + 2 + 3), v1 - (1 + 2 + 3) FROM test_folded_expr "
+                   "WHERE h1 = 2;");
+  row_block = processor->row_block();
+  ASSERT_EQ(row_block->row_count(), 1);
+  EXPECT_EQ(row_block->row(0).column(0).int64_value(), 16);
+  EXPECT_EQ(row_block->row(0).column(1).int64_value(), 4);
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(QLTestSelectedExpr, DISABLED_BenchmarkFoldedBuiltinCalls) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CHECK_VALID_STMT("CREATE TABLE test_folded_expr(h1 int primary key, v1 bigint, v2 bigint);");
+
+  // Compare statements with expression-heavy arguments with the same statements with literals.
+  // The expressions are folded once per statement, so the latencies should be close.
+  constexpr int kNumStmts = 200;
+  MonoDelta literal_time = MonoDelta::FromNanoseconds(0);
+  MonoDelta expr_time = MonoDelta::FromNanoseconds(0);
+  for (int i = 0; i < kNumStmts; i++) {
+    MonoTime start = MonoTime::Now(MonoTime::FINE);
+    CHECK_VALID_STMT(Substitute("INSERT INTO test_folded_expr(h1, v1, v2) VALUES($0, 10, 20);",
+                                i));
+    CHECK_VALID_STMT(Substitute("SELECT v1 + 6, v2 - 6 FROM test_folded_expr WHERE h1 = $0;", i));
+    MonoTime middle = MonoTime::Now(MonoTime::FINE);
+    CHECK_VALID_STMT(Substitute("INSERT INTO test_folded_expr(h1, v1, v2) "
+                                "VALUES($0, 1 + 2 + 3 + 4, (5 + 5) + (5 + 5));", i));
+    CHECK_VALID_STMT(Substitute("SELECT v1 + (1 + 2 + 3), v2 - (1 + 2 + 3) FROM test_folded_expr "
+                                "WHERE h1 = $0;", i));
+    MonoTime end = MonoTime::Now(MonoTime::FINE);
+    literal_time.AddDelta(middle.GetDeltaSince(start));
+    expr_time.AddDelta(end.GetDeltaSince(middle));
+  }
+  LOG(INFO) << "Average INSERT + SELECT latency: literals "
+            << literal_time.ToMicroseconds() / kNumStmts << "us, expressions "
+            << expr_time.ToMicroseconds() / kNumStmts << "us";
+}
+
 } // namespace ql
 } // namespace yb
@@ -29,6 +29,33 @@ using strings::Substitute;
 namespace yb {
 namespace ql {
 
+namespace {
+
+// Number of statements in a batch of the batch workload.
+constexpr int kBatchSize = 100;
+
+// Positional int bind values of a statement.
+class IntStatementParameters : public StatementParameters {
+ public:
+  explicit IntStatementParameters(std::vector<int32_t> values) : values_(std::move(values)) {}
+
+  CHECKED_STATUS GetBindVariable(const std::string& name,
+                                 int64_t pos,
+                                 const std::shared_ptr<QLType>& type,
+                                 QLValue* value) const override {
+    if (pos < 0 || static_cast<size_t>(pos) >= values_.size()) {
+      return STATUS_SUBSTITUTE(RuntimeError, "Bind variable at position $0 not found", pos + 1);
+    }
+    value->set_int32_value(values_[pos]);
+    return Status::OK();
+  }
+
+ private:
+  const std::vector<int32_t> values_;
+};
+
+} // namespace
+
 class TestQLStatement : public QLTestBase {
  public:
   TestQLStatement() : QLTestBase() {
@@ -44,6 +71,86 @@ class TestQLStatement : public QLTestBase {
                               Bind(&TestQLStatement::ExecuteAsyncDone, Unretained(this), cb));
   }
 
+  // Inserts num_batches batches of kBatchSize statements with a prepared statement over a few hash
+  // keys, so that every batch writes to several tablets, and then kBatchSize statements one at a
+  // time. Verifies the rows written. If not null, batch_time and single_time receive the total
+  // time of the batches and of the single statements.
+  void RunBatchWorkload(int num_batches, MonoDelta* batch_time, MonoDelta* single_time) {
+    constexpr int kNumHashKeys = 10;
+
+    // Init the simulated cluster.
+    ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+    // Get a processor.
+    TestQLProcessor *processor = GetQLProcessor();
+    EXEC_VALID_STMT("create table t (h int, r int, v int, primary key ((h), r));");
+
+    Statement stmt(processor->CurrentKeyspace(), "insert into t (h, r, v) values (?, ?, ?);");
+    ASSERT_OK(stmt.Prepare(processor));
+
+    MonoDelta total_batch_time = MonoDelta::FromNanoseconds(0);
+    for (int n = 0; n < num_batches; n++) {
+      std::vector<IntStatementParameters> params;
+      for (int i = 0; i < kBatchSize; i++) {
+        params.emplace_back(std::vector<int32_t>{i % kNumHashKeys, n * kBatchSize + i, n});
+      }
+      MonoTime start = MonoTime::Now(MonoTime::FINE);
+      ASSERT_OK(ExecuteBatch(&stmt, processor, params));
+      total_batch_time.AddDelta(MonoTime::Now(MonoTime::FINE).GetDeltaSince(start));
+    }
+
+    MonoDelta total_single_time = MonoDelta::FromNanoseconds(0);
+    for (int i = 0; i < kBatchSize; i++) {
+      IntStatementParameters params({i % kNumHashKeys, i, -1});
+      Synchronizer sync;
+      MonoTime start = MonoTime::Now(MonoTime::FINE);
+      ASSERT_OK(stmt.ExecuteAsync(processor, params,
+                                  Bind(&TestQLStatement::ExecuteAsyncDone, Unretained(this),
+                                       Bind(&Synchronizer::StatusCB, Unretained(&sync)))));
+      ASSERT_OK(sync.Wait());
+      total_single_time.AddDelta(MonoTime::Now(MonoTime::FINE).GetDeltaSince(start));
+    }
+
+    // Verify the rows written.
+    size_t row_count = 0;
+    StatementParameters select_params;
+    do {
+      ASSERT_OK(processor->Run("select h, r, v from t;", select_params));
+      for (const auto& row : processor->row_block()->rows()) {
+        const int32_t r = row.column(1).int32_value();
+        ASSERT_EQ(row.column(0).int32_value(), r % kNumHashKeys);
+        ASSERT_EQ(row.column(2).int32_value(), r < kBatchSize ? -1 : r / kBatchSize);
+        row_count++;
+      }
+      if (processor->rows_result()->paging_state().empty()) {
+        break;
+      }
+      ASSERT_OK(select_params.set_paging_state(processor->rows_result()->paging_state()));
+    } while (true);
+    ASSERT_EQ(row_count, static_cast<size_t>(num_batches * kBatchSize));
+
+    if (batch_time) {
+      *batch_time = total_batch_time;
+    }
+    if (single_time) {
+      *single_time = total_single_time;
+    }
+  }
+
+
+  // Execute the statement once per set of parameters in a batch.
+  Status ExecuteBatch(Statement *stmt, QLProcessor *processor,
+                      const std::vector<IntStatementParameters>& params) {
+    Synchronizer sync;
+    processor->BeginBatch(Bind(&TestQLStatement::ExecuteAsyncDone, Unretained(this),
+                               Bind(&Synchronizer::StatusCB, Unretained(&sync))));
+    for (const auto& stmt_params : params) {
+      RETURN_NOT_OK(stmt->ExecuteBatch(processor, stmt_params));
+    }
+    processor->ApplyBatch();
+    return sync.Wait();
+  }
+
 };
 
 TEST_F(TestQLStatement, TestExecutePrepareAfterTableDrop) {
@@ -103,5 +210,19 @@ TEST_F(TestQLStatement, TestPKIndices) {
   LOG(INFO) << "Done.";
 }
 
+TEST_F(TestQLStatement, TestBatch) {
+  ASSERT_NO_FATALS(RunBatchWorkload(5 /* num_batches */, nullptr, nullptr));
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(TestQLStatement, DISABLED_BenchmarkBatch) {
+  constexpr int kNumBatches = 50;
+  MonoDelta batch_time, single_time;
+  ASSERT_NO_FATALS(RunBatchWorkload(kNumBatches, &batch_time, &single_time));
+  LOG(INFO) << "Average time of a batch of " << kBatchSize << " statements: "
+            << batch_time.ToMicroseconds() / kNumBatches << "us, of " << kBatchSize
+            << " single statements: " << single_time.ToMicroseconds() << "us";
+}
+
 } // namespace ql
 } // namespace yb
@@ -19,6 +19,7 @@
 #include "yb/ql/util/ql_env.h"
 #include "yb/client/callbacks.h"
 #include "yb/master/catalog_manager.h"
+#include "yb/server/hybrid_clock.h"
 
 namespace yb {
 namespace ql {
@@ -39,6 +40,9 @@ using client::YBTableAlterer;
 using client::YBTableName;
 using client::YBqlReadOp;
 using client::YBqlWriteOp;
+using client::YBTransaction;
+using client::YBTransactionPtr;
+using client::TransactionManager;
 
 // Runs the callback (cb) and returns if the status s is not OK.
 #define CB_RETURN_NOT_OK(cb, s)    \
@@ -52,12 +56,14 @@ using client::YBqlWriteOp;
 
 QLEnv::QLEnv(
     weak_ptr<rpc::Messenger> messenger, shared_ptr<YBClient> client,
-    shared_ptr<YBMetaDataCache> cache, cqlserver::CQLRpcServerEnv* cql_rpcserver_env)
+    shared_ptr<YBMetaDataCache> cache, cqlserver::CQLRpcServerEnv* cql_rpcserver_env,
+    TransactionManager* transaction_manager)
     : client_(client),
       metadata_cache_(cache),
       write_session_(client_->NewSession(false /* read_only */)),
       read_session_(client->NewSession(true /* read_only */)),
       messenger_(messenger),
+      transaction_manager_(transaction_manager),
       flush_done_cb_(this, &QLEnv::FlushAsyncDone),
       cql_rpcserver_env_(cql_rpcserver_env) {
   write_session_->SetTimeoutMillis(kSessionTimeoutMs);
@@ -81,6 +87,25 @@ CHECKED_STATUS QLEnv::DeleteTable(const YBTableName& name) {
   return client_->DeleteTable(name);
 }
 
+Status QLEnv::WaitForAlterTableToFinish(const YBTableName& table_name) {
+  MonoTime deadline = MonoTime::Now(MonoTime::FINE);
+  deadline.AddDelta(MonoDelta::FromMilliseconds(kSessionTimeoutMs));
+  int wait_ms = 10;
+  while (true) {
+    bool alter_in_progress = false;
+    RETURN_NOT_OK(client_->IsAlterTableInProgress(table_name, &alter_in_progress));
+    if (!alter_in_progress) {
+      return Status::OK();
+    }
+    if (!MonoTime::Now(MonoTime::FINE).ComesBefore(deadline)) {
+      return STATUS(TimedOut, "Timed out waiting for the table to be altered",
+                    table_name.ToString());
+    }
+    SleepFor(MonoDelta::FromMilliseconds(wait_ms));
+    wait_ms = std::min(wait_ms * 2, 1000);
+  }
+}
+
 void QLEnv::SetCurrentCall(rpc::InboundCallPtr cql_call) {
   DCHECK(cql_call == nullptr || current_call_ == nullptr)
       << this << " Tried updating current call. Current call is " << current_call_;
@@ -88,20 +113,24 @@ void QLEnv::SetCurrentCall(rpc::InboundCallPtr cql_call) {
 }
 
 CHECKED_STATUS QLEnv::ApplyWrite(std::shared_ptr<YBqlWriteOp> op) {
-  CHECK(batch_session_ != read_session_) << "Mix read/write batch operations not supported";
+  const auto& session = current_write_session();
+  CHECK(batch_session_ == nullptr || batch_session_ == session)
+      << "Mix read/write batch operations not supported";
   // Apply the write.
   TRACE("Apply Write");
-  RETURN_NOT_OK(write_session_->Apply(op));
-  batch_session_ = write_session_;
+  RETURN_NOT_OK(session->Apply(op));
+  batch_session_ = session;
   return Status::OK();
 }
 
 CHECKED_STATUS QLEnv::ApplyRead(std::shared_ptr<YBqlReadOp> op) {
-  CHECK(batch_session_ != write_session_) << "Mix read/write batch operations not supported";
+  const auto& session = current_read_session();
+  CHECK(batch_session_ == nullptr || batch_session_ == session)
+      << "Mix read/write batch operations not supported";
   // Apply the read.
   TRACE("Apply Read");
-  RETURN_NOT_OK(read_session_->Apply(op));
-  batch_session_ = read_session_;
+  RETURN_NOT_OK(session->Apply(op));
+  batch_session_ = session;
   return Status::OK();
 }
 
@@ -123,6 +152,56 @@ Status QLEnv::GetOpError(const client::YBqlOp* op) const {
 
 void QLEnv::AbortOps() {
   write_session_->Abort();
+  if (transaction_write_session_ != nullptr) {
+    transaction_write_session_->Abort();
+  }
+}
+
+void QLEnv::StartTransaction(IsolationLevel isolation_level) {
+  DCHECK(transaction_ == nullptr) << "Another transaction is in progress";
+  transaction_ = NewTransaction(isolation_level);
+  transaction_write_session_ = NewSession(false /* read_only */, transaction_);
+  transaction_read_session_ = NewSession(true /* read_only */, transaction_);
+}
+
+YBTransactionPtr QLEnv::NewTransaction(IsolationLevel isolation_level) {
+  if (transaction_manager_ == nullptr) {
+    scoped_refptr<server::Clock> clock(new server::HybridClock());
+    CHECK_OK(clock->Init());
+    own_transaction_manager_.reset(new TransactionManager(client_, clock));
+    transaction_manager_ = own_transaction_manager_.get();
+  }
+  return std::make_shared<YBTransaction>(transaction_manager_, isolation_level);
+}
+
+shared_ptr<YBSession> QLEnv::NewSession(bool read_only, const YBTransactionPtr& transaction) {
+  auto session = std::make_shared<YBSession>(client_, read_only, transaction);
+  session->SetTimeoutMillis(kSessionTimeoutMs);
+  CHECK_OK(session->SetFlushMode(YBSession::MANUAL_FLUSH));
+  return session;
+}
+
+void QLEnv::CommitTransactionAsync(Callback<void(const Status &)>* cb) {
+  DCHECK(transaction_ != nullptr);
+  DCHECK(requested_callback_ == nullptr);
+  requested_callback_ = cb;
+  // The transaction keeps itself alive until the commit is done.
+  auto transaction = transaction_;
+  ResetTransaction();
+  TRACE("Commit Transaction");
+  transaction->Commit(std::bind(&QLEnv::CommitTransactionDone, this, std::placeholders::_1));
+}
+
+void QLEnv::ResetTransaction() {
+  transaction_ = nullptr;
+  transaction_write_session_ = nullptr;
+  transaction_read_session_ = nullptr;
+}
+
+void QLEnv::CommitTransactionDone(const Status &s) {
+  flush_status_ = s;
+  TRACE("Commit Transaction Done");
+  ScheduleResumeCQLCall();
 }
 
 void QLEnv::FlushAsyncDone(const Status &s) {
@@ -147,6 +226,10 @@ void QLEnv::FlushAsyncDone(const Status &s) {
   batch_session_ = nullptr;
 
   TRACE("Flush Async Done");
+  ScheduleResumeCQLCall();
+}
+
+void QLEnv::ScheduleResumeCQLCall() {
   if (current_call_ == nullptr) {
     // For unit tests. Run the callback in the current (reactor) thread and allow wait for the case
     // when a statement needs to be reprepared and we need to fetch table metadata synchronously.
@@ -186,6 +269,18 @@ shared_ptr<YBTable> QLEnv::GetTableDesc(const YBTableName& table_name, bool* cac
   return yb_table;
 }
 
+shared_ptr<YBTable> QLEnv::GetTableDesc(const TableId& table_id, bool* cache_used) {
+  shared_ptr<YBTable> yb_table;
+  Status s = metadata_cache_->GetTable(table_id, &yb_table, cache_used);
+
+  if (!s.ok()) {
+    VLOG(3) << "GetTableDesc: Server returns an error: " << s.ToString();
+    return nullptr;
+  }
+
+  return yb_table;
+}
+
 shared_ptr<QLType> QLEnv::GetUDType(const std::string &keyspace_name,
                                       const std::string &type_name,
                                       bool *cache_used) {
@@ -23,6 +23,8 @@
 
 #include "yb/client/client.h"
 #include "yb/client/callbacks.h"
+#include "yb/client/transaction.h"
+#include "yb/client/transaction_manager.h"
 #include "yb/ql/ql_session.h"
 #include "yb/rpc/messenger.h"
 
@@ -45,7 +47,8 @@ class QLEnv {
   QLEnv(
       std::weak_ptr<rpc::Messenger> messenger, std::shared_ptr<client::YBClient> client,
       std::shared_ptr<client::YBMetaDataCache> cache,
-      cqlserver::CQLRpcServerEnv* cql_rpcserver_env = nullptr);
+      cqlserver::CQLRpcServerEnv* cql_rpcserver_env = nullptr,
+      client::TransactionManager* transaction_manager = nullptr);
   virtual ~QLEnv();
 
   virtual client::YBTableCreator *NewTableCreator();
@@ -54,6 +57,9 @@ class QLEnv {
 
   virtual CHECKED_STATUS DeleteTable(const client::YBTableName& name);
 
+  // Wait until the tablets of the table have applied its latest schema version.
+  CHECKED_STATUS WaitForAlterTableToFinish(const client::YBTableName& table_name);
+
   // Read/write related methods.
 
   // Apply a read/write operation. The operation is batched and needs to be flushed with FlushAsync.
@@ -70,8 +76,29 @@ class QLEnv {
   // Abort the batched ops.
   virtual void AbortOps();
 
+  // Start a distributed transaction. Reads and writes applied afterwards are executed in this
+  // transaction until it is committed or reset.
+  void StartTransaction(IsolationLevel isolation_level);
+
+  // Commit the current transaction. The callback is invoked in the same way as for FlushAsync.
+  void CommitTransactionAsync(Callback<void(const Status &)>* cb);
+
+  // Drop the current transaction without committing it. Transactions cannot be aborted explicitly
+  // yet, so the provisional records of a dropped transaction are cleaned up after it expires.
+  void ResetTransaction();
+
+  bool has_transaction() const { return transaction_ != nullptr; }
+
+  // Create a distributed transaction and a session in it that are independent of the statement
+  // being executed. The caller flushes the session and commits the transaction synchronously.
+  client::YBTransactionPtr NewTransaction(IsolationLevel isolation_level);
+  std::shared_ptr<client::YBSession> NewSession(bool read_only,
+                                                const client::YBTransactionPtr& transaction);
+
   virtual std::shared_ptr<client::YBTable> GetTableDesc(
       const client::YBTableName& table_name, bool *cache_used);
+  virtual std::shared_ptr<client::YBTable> GetTableDesc(
+      const TableId& table_id, bool *cache_used);
 
   virtual void RemoveCachedTableDesc(const client::YBTableName& table_name);
 
@@ -125,8 +152,18 @@ class QLEnv {
  private:
   // Helpers to process the asynchronously received response from ybclient.
   void FlushAsyncDone(const Status &s);
+  void CommitTransactionDone(const Status &s);
+  void ScheduleResumeCQLCall();
   void ResumeCQLCall();
 
+  // The sessions to apply write and read operations, in the current transaction if any.
+  const std::shared_ptr<client::YBSession>& current_write_session() const {
+    return transaction_ != nullptr ? transaction_write_session_ : write_session_;
+  }
+  const std::shared_ptr<client::YBSession>& current_read_session() const {
+    return transaction_ != nullptr ? transaction_read_session_ : read_session_;
+  }
+
   cqlserver::CQLInboundCall* current_cql_call() const {
     return static_cast<cqlserver::CQLInboundCall*>(current_call_.get());
   }
@@ -151,6 +188,16 @@ class QLEnv {
   // Messenger used to requeue the CQL call upon callback.
   std::weak_ptr<rpc::Messenger> messenger_;
 
+  // Transaction manager to create distributed transactions. Owned by the server, or created on
+  // demand when the server does not provide one.
+  client::TransactionManager* transaction_manager_;
+  std::unique_ptr<client::TransactionManager> own_transaction_manager_;
+
+  // The current distributed transaction and the sessions to apply operations in it.
+  client::YBTransactionPtr transaction_;
+  std::shared_ptr<client::YBSession> transaction_write_session_;
+  std::shared_ptr<client::YBSession> transaction_read_session_;
+
   client::YBStatusMemberCallback<QLEnv> flush_done_cb_;
 
   // Transient attributes.
@@ -153,7 +153,7 @@ RowsResult::RowsResult(YBqlOp *op, const PTDmlStmt *tnode)
 
 RowsResult::RowsResult(const client::YBTableName& table_name,
                        const shared_ptr<vector<ColumnSchema>>& column_schemas,
-                       const std::string& rows_data)
+                       const RefCntBuffer& rows_data)
     : table_name_(table_name),
       column_schemas_(column_schemas),
       client_(QLClient::YQL_CLIENT_CQL),
@@ -176,7 +176,7 @@ Status RowsResult::Append(const RowsResult& other) {
 std::unique_ptr<QLRowBlock> RowsResult::GetRowBlock() const {
   Schema schema(*column_schemas_, 0);
   unique_ptr<QLRowBlock> rowblock(new QLRowBlock(schema));
-  Slice data(rows_data_);
+  Slice data(rows_data_.udata(), rows_data_.size());
   if (!data.empty()) {
     // TODO: a better way to handle errors here?
     CHECK_OK(rowblock->Deserialize(client_, &data));
@@ -119,7 +119,7 @@ class RowsResult : public ExecutedResult {
   explicit RowsResult(client::YBqlOp *op, const PTDmlStmt *tnode = nullptr);
   RowsResult(const client::YBTableName& table_name,
              const std::shared_ptr<std::vector<ColumnSchema>>& column_schemas,
-             const std::string& rows_data);
+             const RefCntBuffer& rows_data);
   virtual ~RowsResult() override;
 
   // Result type.
@@ -128,7 +128,8 @@ class RowsResult : public ExecutedResult {
   // Accessor functions.
   const client::YBTableName& table_name() const { return table_name_; }
   const std::vector<ColumnSchema>& column_schemas() const { return *column_schemas_; }
-  const std::string& rows_data() const { return rows_data_; }
+  // Rows data in CQL wire format. It is shared with the read operation that fetched the rows.
+  const RefCntBuffer& rows_data() const { return rows_data_; }
   const std::string& paging_state() const { return paging_state_; }
   QLClient client() const { return client_; }
 
@@ -146,7 +147,7 @@ class RowsResult : public ExecutedResult {
   const client::YBTableName table_name_;
   std::shared_ptr<std::vector<ColumnSchema>> column_schemas_;
   const QLClient client_;
-  std::string rows_data_;
+  RefCntBuffer rows_data_;
   std::string paging_state_;
 };
 
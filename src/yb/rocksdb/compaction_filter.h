@@ -33,6 +33,7 @@
 namespace rocksdb {
 
 class SliceTransform;
+struct FileMetaData;
 
 // Context information of a compaction run
 struct CompactionFilterContext {
@@ -144,10 +145,37 @@ class CompactionFilterFactory {
   virtual std::unique_ptr<CompactionFilter> CreateCompactionFilter(
       const CompactionFilter::Context& context) = 0;
 
+  // Returns files that contain only records which compaction filter would remove during a full
+  // compaction, so they could be deleted without being compacted. Used by universal compaction
+  // with a single level. Files are passed from the newest to the oldest, returned files should
+  // keep this order and should not include files that are being compacted.
+  virtual std::vector<FileMetaData*> FilesToDelete(const std::vector<FileMetaData*>& files) {
+    return {};
+  }
+
   // Returns a name that identifies this compaction filter factory.
   virtual const char* Name() const = 0;
 };
 
+// Splits the key range of a compaction into subranges that are compacted in parallel by
+// subcompactions. Each subcompaction uses its own CompactionFilter, so split keys should never
+// separate keys that the compaction filter has to see together.
+//
+// Used for full compactions of universal style with a single level, where all input files usually
+// cover the whole key range, so boundaries of files could not be used to split the compaction.
+class CompactionKeySplitter {
+ public:
+  virtual ~CompactionKeySplitter() {}
+
+  // Returns sorted user keys that split [smallest, largest] into at most max_ranges ranges of
+  // similar size. Each returned key is the inclusive start of the next range.
+  virtual std::vector<std::string> Split(
+      const Slice& smallest, const Slice& largest, size_t max_ranges) = 0;
+
+  // Returns a name that identifies this key splitter.
+  virtual const char* Name() const = 0;
+};
+
 }  // namespace rocksdb
 
 #endif // ROCKSDB_INCLUDE_ROCKSDB_COMPACTION_FILTER_H
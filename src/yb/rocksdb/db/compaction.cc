@@ -504,7 +504,12 @@ bool Compaction::ShouldFormSubcompactions() const {
   if (cfd_->ioptions()->compaction_style == kCompactionStyleLevel) {
     return start_level_ == 0 && !IsOutputLevelEmpty();
   } else if (cfd_->ioptions()->compaction_style == kCompactionStyleUniversal) {
-    return number_levels_ > 1 && output_level_ > 0;
+    // With a single level, outputs of subcompactions are placed to level 0 as files with disjoint
+    // key ranges, that are counted as a single sorted run. It is safe only when all files are
+    // compacted, because then this run is the oldest one. CompactionJob also requires the
+    // compaction to be bottommost without snapshots and merge operands.
+    return (number_levels_ > 1 && output_level_ > 0) ||
+           (number_levels_ == 1 && is_full_compaction_);
   } else {
     return false;
   }
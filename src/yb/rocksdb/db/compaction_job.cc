@@ -51,6 +51,7 @@
 #include "yb/rocksdb/db/version_set.h"
 #include "yb/rocksdb/port/likely.h"
 #include "yb/rocksdb/port/port.h"
+#include "yb/rocksdb/compaction_filter.h"
 #include "yb/rocksdb/db.h"
 #include "yb/rocksdb/env.h"
 #include "yb/rocksdb/statistics.h"
@@ -330,7 +331,16 @@ void CompactionJob::Prepare() {
   // Is this compaction producing files at the bottommost level?
   bottommost_level_ = c->bottommost_level();
 
-  if (c->ShouldFormSubcompactions()) {
+  // With a single level, the outputs of subcompactions become level 0 files with the sequence
+  // number range of all inputs and disjoint key ranges, that form a single sorted run, see
+  // VersionStorageInfo::ContinuesSortedRun. The split is limited to bottommost compactions without
+  // snapshots and merge operands, so each output keeps only the latest version of its keys.
+  const bool outputs_ordered_by_seqno =
+      c->number_levels() > 1 ||
+      (bottommost_level_ && existing_snapshots_.empty() &&
+       c->column_family_data()->ioptions()->merge_operator == nullptr);
+
+  if (c->ShouldFormSubcompactions() && outputs_ordered_by_seqno) {
     const uint64_t start_micros = env_->NowMicros();
     GenSubcompactionBoundaries();
     MeasureTime(stats_, SUBCOMPACTION_SETUP_TIME,
@@ -371,6 +381,11 @@ void CompactionJob::GenSubcompactionBoundaries() {
   int start_lvl = c->start_level();
   int out_lvl = c->output_level();
 
+  if (c->number_levels() == 1) {
+    GenSubcompactionBoundariesUsingSplitter();
+    return;
+  }
+
   // Add the starting and/or ending key of certain input files as a potential
   // boundary
   for (size_t lvl_idx = 0; lvl_idx < c->num_input_levels(); lvl_idx++) {
@@ -475,6 +490,58 @@ void CompactionJob::GenSubcompactionBoundaries() {
   }
 }
 
+// Files of universal compaction with a single level usually cover the whole key range, so their
+// boundaries are useless for splitting. Instead key range of the compaction is split by the
+// user provided key splitter, and data is assumed to be evenly distributed between ranges.
+void CompactionJob::GenSubcompactionBoundariesUsingSplitter() {
+  auto* c = compact_->compaction;
+  const Comparator* ucmp = c->column_family_data()->user_comparator();
+
+  Slice smallest;
+  Slice largest;
+  bool first_file = true;
+  uint64_t sum = 0;
+  for (size_t lvl_idx = 0; lvl_idx < c->num_input_levels(); lvl_idx++) {
+    const LevelFilesBrief* flevel = c->input_levels(lvl_idx);
+    for (size_t i = 0; i < flevel->num_files; i++) {
+      const auto& file = flevel->files[i];
+      Slice file_smallest = ExtractUserKey(file.smallest.key);
+      Slice file_largest = ExtractUserKey(file.largest.key);
+      if (first_file || ucmp->Compare(file_smallest, smallest) < 0) {
+        smallest = file_smallest;
+      }
+      if (first_file || ucmp->Compare(file_largest, largest) > 0) {
+        largest = file_largest;
+      }
+      first_file = false;
+      sum += file.fd.GetTotalFileSize();
+    }
+  }
+
+  auto& splitter = db_options_.compaction_key_splitter;
+  if (splitter && db_options_.max_subcompactions > 1 && ucmp->Compare(smallest, largest) < 0) {
+    auto keys = splitter->Split(smallest, largest, db_options_.max_subcompactions);
+    for (auto& key : keys) {
+      // Each subcompaction should get a non empty range.
+      Slice prev = split_keys_.empty() ? smallest : Slice(split_keys_.back());
+      if (ucmp->Compare(key, prev) <= 0 || ucmp->Compare(key, largest) > 0) {
+        continue;
+      }
+      split_keys_.push_back(std::move(key));
+      if (split_keys_.size() + 1 >= db_options_.max_subcompactions) {
+        break;
+      }
+    }
+  }
+
+  const uint64_t size = sum / (split_keys_.size() + 1);
+  for (const auto& key : split_keys_) {
+    boundaries_.emplace_back(key);
+    sizes_.push_back(size);
+  }
+  sizes_.push_back(sum - size * split_keys_.size());
+}
+
 Status CompactionJob::Run() {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_RUN);
@@ -99,6 +99,7 @@ class CompactionJob {
 
   void AggregateStatistics();
   void GenSubcompactionBoundaries();
+  void GenSubcompactionBoundariesUsingSplitter();
 
   // update the thread status for starting a compaction.
   void ReportStartedCompaction(Compaction* compaction);
@@ -170,6 +171,8 @@ class CompactionJob {
   bool measure_io_stats_;
   // Stores the Slices that designate the boundaries for each subcompaction
   std::vector<Slice> boundaries_;
+  // Holds keys referenced by boundaries_ when they are provided by compaction_key_splitter
+  std::vector<std::string> split_keys_;
   // Stores the approx size of keys covered in the range of each subcompaction
   std::vector<uint64_t> sizes_;
 };
@@ -20,9 +20,12 @@
 
 #ifndef ROCKSDB_LITE
 
+#include <inttypes.h>
+
 #include <algorithm>
 #include <map>
 #include <string>
+#include <thread>
 #include <tuple>
 
 #include "yb/rocksdb/db/compaction_job.h"
@@ -30,6 +33,7 @@
 #include "yb/rocksdb/db/version_set.h"
 #include "yb/rocksdb/db/writebuffer.h"
 #include "yb/rocksdb/cache.h"
+#include "yb/rocksdb/compaction_filter.h"
 #include "yb/rocksdb/db.h"
 #include "yb/rocksdb/options.h"
 #include "yb/rocksdb/table/mock_table.h"
@@ -75,6 +79,29 @@ void VerifyInitializationOfCompactionJobStats(
 #endif  // !defined(IOS_CROSS_COMPILE)
 }
 
+std::string UniversalKey(int k) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%08d", k);
+  return buf;
+}
+
+// Splits range of keys produced by UniversalKey into ranges with equal number of keys.
+class UniversalKeySplitter : public CompactionKeySplitter {
+ public:
+  std::vector<std::string> Split(
+      const Slice& smallest, const Slice& largest, size_t max_ranges) override {
+    const int first = std::stoi(smallest.ToBuffer());
+    const int last = std::stoi(largest.ToBuffer());
+    std::vector<std::string> result;
+    for (size_t i = 1; i < max_ranges; ++i) {
+      result.push_back(UniversalKey(first + static_cast<int>((last - first) * i / max_ranges)));
+    }
+    return result;
+  }
+
+  const char* Name() const override { return "UniversalKeySplitter"; }
+};
+
 }  // namespace
 
 // TODO(icanadi) Make it simpler once we mock out VersionSet
@@ -246,11 +273,72 @@ class CompactionJobTest : public testing::Test {
     cfd_ = versions_->GetColumnFamilySet()->GetDefault();
   }
 
+  // Universal compaction with a single level, like in DocDB.
+  void NewUniversalDB(uint32_t max_subcompactions) {
+    cf_options_.compaction_style = kCompactionStyleUniversal;
+    cf_options_.num_levels = 1;
+    db_options_.max_subcompactions = max_subcompactions;
+    db_options_.compaction_key_splitter = std::make_shared<UniversalKeySplitter>();
+    NewDB();
+  }
+
+  // Drops all files, so NewDB could be called again.
+  void ResetDB() {
+    cfd_ = nullptr;
+    versions_.reset();
+    table_cache_ = NewLRUCache(50000, 16);
+    versions_.reset(new VersionSet(dbname_, &db_options_, env_options_, table_cache_.get(),
+                                   &write_buffer_, &write_controller_));
+    mock_table_factory_ = std::make_shared<mock::MockTableFactory>();
+  }
+
+  // Creates num_files files, each of them covers the whole key range, like files of universal
+  // compaction. Returns expected result of full compaction with the given earliest snapshot.
+  stl_wrappers::KVMap CreateUniversalFiles(
+      int num_files, int keys_per_file, SequenceNumber earliest_snapshot = kMaxSequenceNumber) {
+    auto expected_results = mock::MakeMockFile();
+    const int num_keys = num_files * keys_per_file;
+    SequenceNumber sequence_number = 0;
+    for (int i = 0; i < num_files; ++i) {
+      auto contents = mock::MakeMockFile();
+      for (int k = i; k < num_keys; k += num_files) {
+        auto key = UniversalKey(k);
+        auto value = ToString(k);
+        ++sequence_number;
+        contents.insert({ KeyStr(key, sequence_number, kTypeValue), value });
+        // Sequence number of the largest key and of the keys written after the earliest snapshot
+        // is preserved in bottommost file.
+        const bool keep_sequence = k == num_keys - 1 || sequence_number >= earliest_snapshot;
+        expected_results.insert(
+            { KeyStr(key, keep_sequence ? sequence_number : 0, kTypeValue), value });
+      }
+      AddMockFile(contents);
+    }
+
+    SetLastSequence(sequence_number);
+
+    return expected_results;
+  }
+
+  void CheckOutputFilesDoNotOverlap() {
+    auto files = cfd_->current()->storage_info()->LevelFiles(0);
+    std::sort(files.begin(), files.end(), [this](FileMetaData* lhs, FileMetaData* rhs) {
+      return cfd_->internal_comparator().Compare(lhs->smallest.key, rhs->smallest.key) < 0;
+    });
+    for (size_t i = 1; i < files.size(); ++i) {
+      ASSERT_LT(cfd_->user_comparator()->Compare(
+                    files[i - 1]->largest.key.user_key(), files[i]->smallest.key.user_key()),
+                0);
+    }
+  }
+
   void RunCompaction(
       const std::vector<std::vector<FileMetaData*>>& input_files,
       const stl_wrappers::KVMap& expected_results,
       const std::vector<SequenceNumber>& snapshots = {},
-      SequenceNumber earliest_write_conflict_snapshot = kMaxSequenceNumber) {
+      SequenceNumber earliest_write_conflict_snapshot = kMaxSequenceNumber,
+      int output_level = 1,
+      size_t expected_output_files = 1) {
     auto cfd = versions_->GetColumnFamilySet()->GetDefault();
 
     size_t num_input_files = 0;
@@ -267,7 +355,7 @@ class CompactionJobTest : public testing::Test {
 
     Compaction compaction(cfd->current()->storage_info(),
                           *cfd->GetLatestMutableCFOptions(),
-                          compaction_input_files, 1, 1024 * 1024, 10, 0,
+                          compaction_input_files, output_level, 1024 * 1024, 10, 0,
                           kNoCompression, {}, true);
     compaction.SetInputVersion(cfd->current());
 
@@ -298,8 +386,12 @@ class CompactionJobTest : public testing::Test {
     } else {
       ASSERT_GE(compaction_job_stats_.elapsed_micros, 0U);
       ASSERT_EQ(compaction_job_stats_.num_input_files, num_input_files);
-      ASSERT_EQ(compaction_job_stats_.num_output_files, 1U);
-      mock_table_factory_->AssertLatestFile(expected_results);
+      ASSERT_EQ(compaction_job_stats_.num_output_files, expected_output_files);
+      if (expected_output_files == 1) {
+        mock_table_factory_->AssertLatestFile(expected_results);
+      } else {
+        mock_table_factory_->AssertLatestFiles(expected_results, expected_output_files);
+      }
     }
   }
 
@@ -1018,6 +1110,82 @@ TEST_F(CompactionJobTest, CorruptionAfterDeletion) {
   RunCompaction({files}, expected_results);
 }
 
+TEST_F(CompactionJobTest, UniversalSubcompactions) {
+  constexpr uint32_t kMaxSubcompactions = 4;
+  NewUniversalDB(kMaxSubcompactions);
+
+  auto expected_results = CreateUniversalFiles(4, 1000);
+  auto files = cfd_->current()->storage_info()->LevelFiles(0);
+  ASSERT_EQ(4U, files.size());
+  RunCompaction({ files }, expected_results, {}, kMaxSequenceNumber, 0 /* output_level */,
+                kMaxSubcompactions);
+  ASSERT_EQ(kMaxSubcompactions, cfd_->current()->storage_info()->LevelFiles(0).size());
+  CheckOutputFilesDoNotOverlap();
+}
+
+TEST_F(CompactionJobTest, UniversalSubcompactionsNotFullCompaction) {
+  NewUniversalDB(4 /* max_subcompactions */);
+
+  CreateUniversalFiles(4, 1000);
+  auto files = cfd_->current()->storage_info()->LevelFiles(0);
+  ASSERT_EQ(4U, files.size());
+  // Drop the oldest file, outputs of subcompactions would be placed between it and newer files.
+  files.pop_back();
+
+  CompactionInputFiles compaction_level;
+  compaction_level.level = 0;
+  compaction_level.files = files;
+  Compaction compaction(cfd_->current()->storage_info(), *cfd_->GetLatestMutableCFOptions(),
+                        { compaction_level }, 0 /* output_level */, 1024 * 1024, 10, 0,
+                        kNoCompression, {}, true);
+  compaction.SetInputVersion(cfd_->current());
+  ASSERT_FALSE(compaction.is_full_compaction());
+  ASSERT_FALSE(compaction.ShouldFormSubcompactions());
+}
+
+TEST_F(CompactionJobTest, UniversalSubcompactionsWithSnapshot) {
+  NewUniversalDB(4 /* max_subcompactions */);
+
+  // The snapshot keeps the sequence numbers of later writes, so outputs of subcompactions would
+  // have overlapping sequence number ranges in level 0. The compaction is not split.
+  constexpr SequenceNumber kSnapshot = 2000;
+  auto expected_results = CreateUniversalFiles(4, 1000, kSnapshot);
+  auto files = cfd_->current()->storage_info()->LevelFiles(0);
+  ASSERT_EQ(4U, files.size());
+  RunCompaction({ files }, expected_results, { kSnapshot }, kMaxSequenceNumber,
+                0 /* output_level */, 1 /* expected_output_files */);
+  ASSERT_EQ(1U, cfd_->current()->storage_info()->LevelFiles(0).size());
+}
+
+// Compares wall clock time of a full universal compaction with and without subcompactions.
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(CompactionJobTest, DISABLED_UniversalSubcompactionsSpeedup) {
+  constexpr int kNumFiles = 8;
+  constexpr int kKeysPerFile = 100000;
+  const uint32_t kMaxSubcompactions[] = { 1, 8 };
+  uint64_t elapsed_micros[2];
+
+  for (size_t i = 0; i != 2; ++i) {
+    if (i != 0) {
+      ResetDB();
+    }
+    NewUniversalDB(kMaxSubcompactions[i]);
+    auto expected_results = CreateUniversalFiles(kNumFiles, kKeysPerFile);
+    auto files = cfd_->current()->storage_info()->LevelFiles(0);
+    const auto start_micros = env_->NowMicros();
+    RunCompaction({ files }, expected_results, {}, kMaxSequenceNumber, 0 /* output_level */,
+                  kMaxSubcompactions[i]);
+    elapsed_micros[i] = env_->NowMicros() - start_micros;
+    CheckOutputFilesDoNotOverlap();
+  }
+
+  fprintf(stderr, "Full compaction of %d keys: %" PRIu64 "us with 1 thread, %" PRIu64
+          "us with %" PRIu32 " subcompactions, speedup: %.2f, hardware concurrency: %u\n",
+          kNumFiles * kKeysPerFile, elapsed_micros[0], elapsed_micros[1], kMaxSubcompactions[1],
+          elapsed_micros[0] * 1.0 / std::max<uint64_t>(elapsed_micros[1], 1),
+          std::thread::hardware_concurrency());
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -37,6 +37,7 @@
 
 #include "yb/rocksdb/db/column_family.h"
 #include "yb/rocksdb/db/filename.h"
+#include "yb/rocksdb/compaction_filter.h"
 #include "yb/rocksdb/util/log_buffer.h"
 #include "yb/rocksdb/util/random.h"
 #include "yb/rocksdb/util/statistics.h"
@@ -1146,20 +1147,69 @@ bool LevelCompactionPicker::PickCompactionBySize(VersionStorageInfo* vstorage,
 bool UniversalCompactionPicker::NeedsCompaction(
     const VersionStorageInfo* vstorage) const {
   const int kLevel0 = 0;
-  return vstorage->CompactionScore(kLevel0) >= 1;
+  return vstorage->CompactionScore(kLevel0) >= 1 || !FilesToDelete(vstorage).empty();
+}
+
+std::vector<FileMetaData*> UniversalCompactionPicker::FilesToDelete(
+    const VersionStorageInfo* vstorage) const {
+  if (vstorage->num_levels() != 1 || ioptions_.compaction_filter_factory == nullptr) {
+    return {};
+  }
+  return ioptions_.compaction_filter_factory->FilesToDelete(vstorage->LevelFiles(0));
+}
+
+Compaction* UniversalCompactionPicker::PickDeletionCompaction(
+    const std::string& cf_name,
+    const MutableCFOptions& mutable_cf_options,
+    VersionStorageInfo* vstorage,
+    LogBuffer* log_buffer) {
+  auto files = FilesToDelete(vstorage);
+  if (files.empty()) {
+    return nullptr;
+  }
+
+  std::vector<CompactionInputFiles> inputs(1);
+  inputs[0].level = 0;
+  for (auto* f : files) {
+    assert(!f->being_compacted);
+    char tmp_fsize[16];
+    AppendHumanBytes(f->fd.GetTotalFileSize(), tmp_fsize, sizeof(tmp_fsize));
+    LOG_TO_BUFFER(log_buffer, "[%s] Universal: picking file %" PRIu64
+                            " with size %s for deletion, all its records are filtered",
+                cf_name.c_str(), f->fd.GetNumber(), tmp_fsize);
+  }
+  inputs[0].files = std::move(files);
+  Compaction* c = new Compaction(
+      vstorage, mutable_cf_options, std::move(inputs), 0, 0, 0, 0,
+      kNoCompression, {}, /* is manual */ false, vstorage->CompactionScore(0),
+      /* is deletion compaction */ true, CompactionReason::kUniversalFilesFiltered);
+  level0_compactions_in_progress_.insert(c);
+  return c;
 }
 
 struct UniversalCompactionPicker::SortedRun {
   SortedRun(int _level, FileMetaData* _file, uint64_t _size,
             uint64_t _compensated_file_size, bool _being_compacted)
       : level(_level),
-        file(_file),
         size(_size),
         compensated_file_size(_compensated_file_size),
         being_compacted(_being_compacted) {
     assert(compensated_file_size > 0);
     // Allowed either one of level and file.
-    assert((level != 0) != (file != nullptr));
+    assert((level != 0) != (_file != nullptr));
+    if (_file != nullptr) {
+      files.push_back(_file);
+    }
+  }
+
+  // Adds level 0 file, that belongs to the same sorted run, see
+  // VersionStorageInfo::ContinuesSortedRun.
+  void AddFile(FileMetaData* file) {
+    assert(level == 0);
+    files.push_back(file);
+    size += file->fd.GetTotalFileSize();
+    compensated_file_size += file->compensated_file_size;
+    being_compacted = being_compacted || file->being_compacted;
   }
 
   void Dump(char* out_buf, size_t out_buf_size,
@@ -1170,9 +1220,10 @@ struct UniversalCompactionPicker::SortedRun {
                     size_t sorted_run_count) const;
 
   int level;
-  // `file` Will be null for level > 0. For level = 0, the sorted run is
-  // for this file.
-  FileMetaData* file;
+  // `files` Will be empty for level > 0. For level = 0, the sorted run is
+  // for these files. Usually it is a single file, several files only when they are
+  // non overlapping outputs of the same compaction.
+  std::vector<FileMetaData*> files;
   // For level > 0, `size` and `compensated_file_size` are sum of sizes all
   // files in the level. `being_compacted` should be the same for all files
   // in a non-zero level. Use the value here.
@@ -1185,8 +1236,12 @@ void UniversalCompactionPicker::SortedRun::Dump(char* out_buf,
                                                 size_t out_buf_size,
                                                 bool print_path) const {
   if (level == 0) {
-    assert(file != nullptr);
-    if (file->fd.GetPathId() == 0 || !print_path) {
+    assert(!files.empty());
+    const FileMetaData* file = files.front();
+    if (files.size() > 1) {
+      snprintf(out_buf, out_buf_size, "file %" PRIu64 " and %" ROCKSDB_PRIszt " more",
+               file->fd.GetNumber(), files.size() - 1);
+    } else if (file->fd.GetPathId() == 0 || !print_path) {
       snprintf(out_buf, out_buf_size, "file %" PRIu64, file->fd.GetNumber());
     } else {
       snprintf(out_buf, out_buf_size, "file %" PRIu64
@@ -1202,13 +1257,12 @@ void UniversalCompactionPicker::SortedRun::Dump(char* out_buf,
 void UniversalCompactionPicker::SortedRun::DumpSizeInfo(
     char* out_buf, size_t out_buf_size, size_t sorted_run_count) const {
   if (level == 0) {
-    assert(file != nullptr);
+    assert(!files.empty());
     snprintf(out_buf, out_buf_size,
              "file %" PRIu64 "[%" ROCKSDB_PRIszt
              "] "
              "with size %" PRIu64 " (compensated size %" PRIu64 ")",
-             file->fd.GetNumber(), sorted_run_count, file->fd.GetTotalFileSize(),
-             file->compensated_file_size);
+             files.front()->fd.GetNumber(), sorted_run_count, size, compensated_file_size);
   } else {
     snprintf(out_buf, out_buf_size,
              "level %d[%" ROCKSDB_PRIszt
@@ -1225,6 +1279,11 @@ std::vector<std::vector<UniversalCompactionPicker::SortedRun>>
   std::vector<std::vector<SortedRun>> ret(1);
   for (FileMetaData* f : vstorage.LevelFiles(0)) {
     if (f->fd.GetTotalFileSize() <= max_file_size) {
+      if (!ret.back().empty() &&
+          vstorage.ContinuesSortedRun(ret.back().back().files, *f)) {
+        ret.back().back().AddFile(f);
+        continue;
+      }
       ret.back().emplace_back(0, f, f->fd.GetTotalFileSize(), f->compensated_file_size,
           f->being_compacted);
     // If last sequence is empty it means that there are multiple too-large-to-compact files in
@@ -1351,6 +1410,12 @@ Compaction* UniversalCompactionPicker::PickCompaction(
     const MutableCFOptions& mutable_cf_options,
     VersionStorageInfo* vstorage,
     LogBuffer* log_buffer) {
+  // Dropping whole files is much cheaper than any compaction, so it is checked first.
+  Compaction* deletion = PickDeletionCompaction(cf_name, mutable_cf_options, vstorage, log_buffer);
+  if (deletion != nullptr) {
+    return deletion;
+  }
+
   std::vector<std::vector<SortedRun>> sorted_runs = CalculateSortedRuns(
       *vstorage,
       ioptions_,
@@ -1686,8 +1751,8 @@ Compaction* UniversalCompactionPicker::PickCompactionUniversalReadAmp(
   for (size_t i = start_index; i < first_index_after; i++) {
     auto& picking_sr = sorted_runs[i];
     if (picking_sr.level == 0) {
-      FileMetaData* picking_file = picking_sr.file;
-      inputs[0].files.push_back(picking_file);
+      inputs[0].files.insert(
+          inputs[0].files.end(), picking_sr.files.begin(), picking_sr.files.end());
     } else {
       auto& files = inputs[picking_sr.level - start_level].files;
       for (auto* f : vstorage->LevelFiles(picking_sr.level)) {
@@ -1812,8 +1877,8 @@ Compaction* UniversalCompactionPicker::PickCompactionUniversalSizeAmp(
   for (size_t loop = start_index; loop < sorted_runs.size(); loop++) {
     auto& picking_sr = sorted_runs[loop];
     if (picking_sr.level == 0) {
-      FileMetaData* f = picking_sr.file;
-      inputs[0].files.push_back(f);
+      inputs[0].files.insert(
+          inputs[0].files.end(), picking_sr.files.begin(), picking_sr.files.end());
     } else {
       auto& files = inputs[picking_sr.level - start_level].files;
       for (auto* f : vstorage->LevelFiles(picking_sr.level)) {
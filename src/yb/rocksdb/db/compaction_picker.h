@@ -259,6 +259,17 @@ class UniversalCompactionPicker : public CompactionPicker {
  private:
   struct SortedRun;
 
+  // Returns files that could be deleted without compaction, as decided by compaction filter
+  // factory. Supported only with a single level.
+  std::vector<FileMetaData*> FilesToDelete(const VersionStorageInfo* vstorage) const;
+
+  // Pick deletion compaction for files returned by FilesToDelete.
+  Compaction* PickDeletionCompaction(
+      const std::string& cf_name,
+      const MutableCFOptions& mutable_cf_options,
+      VersionStorageInfo* vstorage,
+      LogBuffer* log_buffer);
+
   Compaction* DoPickCompaction(
       const std::string& cf_name,
       const MutableCFOptions& mutable_cf_options,
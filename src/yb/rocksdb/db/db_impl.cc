@@ -116,6 +116,7 @@
 #include "yb/rocksdb/util/xfunc.h"
 
 #include "yb/util/debug-util.h"
+#include "yb/util/priority_thread_pool.h"
 
 DEFINE_bool(dump_dbimpl_info, false, "Dump RocksDB info during constructor.");
 DEFINE_bool(flush_rocksdb_on_shutdown, true,
@@ -376,6 +377,10 @@ DBImpl::~DBImpl() {
   // marker. After this we do a variant of the waiting and unschedule work
   // (to consider: moving all the waiting into CancelAllBackgroundWork(true))
   CancelAllBackgroundWork(false);
+  if (db_options_.priority_thread_pool_for_compactions) {
+    // Removed compactions are rescheduled to env, so they are unscheduled below.
+    db_options_.priority_thread_pool_for_compactions->Remove(this);
+  }
   int compactions_unscheduled = env_->UnSchedule(this, Env::Priority::LOW);
   int flushes_unscheduled = env_->UnSchedule(this, Env::Priority::HIGH);
   mutex_.Lock();
@@ -2480,8 +2485,7 @@ Status DBImpl::RunManualCompaction(ColumnFamilyData* cfd, int input_level,
       ca->m = &manual;
       manual.incomplete = false;
       bg_compaction_scheduled_++;
-      env_->Schedule(&DBImpl::BGWorkCompaction, ca, Env::Priority::LOW, this,
-                     &DBImpl::UnscheduleCallback);
+      ScheduleCompaction(ca);
       scheduled = true;
     }
   }
@@ -2626,11 +2630,65 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     ca->m = nullptr;
     bg_compaction_scheduled_++;
     unscheduled_compactions_--;
-    env_->Schedule(&DBImpl::BGWorkCompaction, ca, Env::Priority::LOW, this,
-                   &DBImpl::UnscheduleCallback);
+    ScheduleCompaction(ca);
   }
 }
 
+class DBImpl::CompactionTask : public yb::PriorityThreadPoolTask {
+ public:
+  explicit CompactionTask(CompactionArg* arg) : arg_(arg) {}
+
+  void Run(const Status& status) override {
+    if (status.ok()) {
+      BGWorkCompaction(arg_);
+    } else {
+      // Thread pool is shutting down or task was removed. Fallback to env, so compaction is
+      // accounted in the same way as other scheduled compactions.
+      DBImpl* db = arg_->db;
+      db->env_->Schedule(&DBImpl::BGWorkCompaction, arg_, Env::Priority::LOW, db,
+                         &DBImpl::UnscheduleCallback);
+    }
+  }
+
+ private:
+  CompactionArg* arg_;
+};
+
+void DBImpl::ScheduleCompaction(CompactionArg* arg) {
+  mutex_.AssertHeld();
+  auto& pool = db_options_.priority_thread_pool_for_compactions;
+  if (pool) {
+    auto status = pool->Submit(
+        CompactionPriority(), std::make_unique<CompactionTask>(arg), this);
+    if (status.ok()) {
+      return;
+    }
+    RLOG(InfoLogLevel::WARN_LEVEL, db_options_.info_log,
+        "Failed to submit compaction to priority thread pool: %s", status.ToString().c_str());
+  }
+  env_->Schedule(&DBImpl::BGWorkCompaction, arg, Env::Priority::LOW, this,
+                 &DBImpl::UnscheduleCallback);
+}
+
+int DBImpl::CompactionPriority() {
+  mutex_.AssertHeld();
+  if (!default_cf_handle_) {
+    return 0;
+  }
+  auto cfd = default_cf_handle_->cfd();
+  const auto* mutable_cf_options = cfd->GetLatestMutableCFOptions();
+  // The more files we have in level0, the more important compaction is.
+  int result = cfd->current()->storage_info()->NumLevelFiles(0);
+  // Writes are slowed down or stopped, so this DB should be compacted before others.
+  if (write_controller_.NeedsDelay()) {
+    result += mutable_cf_options->level0_slowdown_writes_trigger;
+  }
+  if (write_controller_.IsStopped()) {
+    result += mutable_cf_options->level0_stop_writes_trigger;
+  }
+  return result;
+}
+
 int DBImpl::BGCompactionsAllowed() const {
   if (write_controller_.NeedSpeedupCompaction()) {
     return db_options_.max_background_compactions;
@@ -3081,12 +3139,20 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
     assert(c->num_input_files(1) == 0);
     assert(c->level() == 0);
     assert(c->column_family_data()->ioptions()->compaction_style ==
-           kCompactionStyleFIFO);
+           kCompactionStyleFIFO ||
+           c->column_family_data()->ioptions()->compaction_style ==
+           kCompactionStyleUniversal);
 
     compaction_job_stats.num_input_files = c->num_input_files(0);
 
+    uint64_t deleted_bytes = 0;
     for (const auto& f : *c->inputs(0)) {
       c->edit()->DeleteFile(c->level(), f->fd.GetNumber());
+      deleted_bytes += f->fd.GetTotalFileSize();
+    }
+    if (c->compaction_reason() == CompactionReason::kUniversalFilesFiltered) {
+      RecordTick(stats_, COMPACTION_FILES_FILTERED, c->num_input_files(0));
+      RecordTick(stats_, COMPACTION_FILES_FILTERED_BYTES, deleted_bytes);
     }
     status = versions_->LogAndApply(c->column_family_data(),
                                     *c->mutable_cf_options(), c->edit(),
@@ -3801,6 +3867,8 @@ Status DBImpl::AddFile(ColumnFamilyHandle* column_family,
   }
   meta.smallest.seqno = file_info->sequence_number;
   meta.largest.seqno = file_info->sequence_number;
+  meta.smallest.user_values = file_info->smallest_values.user_values;
+  meta.largest.user_values = file_info->largest_values.user_values;
   if (meta.smallest.seqno != 0 || meta.largest.seqno != 0) {
     return STATUS(InvalidArgument,
         "Non zero sequence numbers are not supported");
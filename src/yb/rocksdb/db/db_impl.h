@@ -594,6 +594,11 @@ class DBImpl : public DB {
   static void BGWorkCompaction(void* arg);
   static void BGWorkFlush(void* db);
   static void UnscheduleCallback(void* arg);
+  // Schedules compaction either to priority_thread_pool_for_compactions or to LOW priority pool
+  // of env.
+  void ScheduleCompaction(CompactionArg* arg);
+  // Priority of compactions of this DB in priority_thread_pool_for_compactions.
+  int CompactionPriority();
   void BackgroundCallCompaction(void* arg);
   void BackgroundCallFlush();
   Status BackgroundCompaction(bool* madeProgress, JobContext* job_context,
@@ -857,6 +862,8 @@ class DBImpl : public DB {
     ManualCompaction* m;
   };
 
+  class CompactionTask;
+
   // Have we encountered a background error in paranoid mode?
   Status bg_error_;
 
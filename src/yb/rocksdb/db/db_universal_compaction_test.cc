@@ -26,6 +26,8 @@
 #if !defined(ROCKSDB_LITE)
 #include "yb/rocksdb/util/sync_point.h"
 
+#include "yb/util/priority_thread_pool.h"
+
 namespace rocksdb {
 
 static std::string CompressibleString(Random* rnd, int len) {
@@ -1345,6 +1347,154 @@ INSTANTIATE_TEST_CASE_P(DBTestUniversalManualCompactionOutputPathId,
                         ::testing::Combine(::testing::Values(1, 8),
                                            ::testing::Bool()));
 
+class DBTestUniversalCompactionPriorityThreadPool : public DBTestBase {
+ public:
+  DBTestUniversalCompactionPriorityThreadPool()
+      : DBTestBase("/db_universal_compaction_priority_thread_pool_test") {}
+};
+
+// Many RocksDB instances trigger compactions at the same time, while all compactions are run by
+// a single shared pool.
+TEST_F(DBTestUniversalCompactionPriorityThreadPool, ManyConcurrentTriggers) {
+  constexpr int kNumDbs = 32;
+  constexpr int kNumFlushes = 6;
+  constexpr int kKeysPerFlush = 100;
+  constexpr int kCompactionTrigger = 2;
+
+  auto pool = std::make_shared<yb::PriorityThreadPool>("compaction", 2);
+
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.compaction_style = kCompactionStyleUniversal;
+  options.num_levels = 1;
+  options.level0_file_num_compaction_trigger = kCompactionTrigger;
+  options.max_background_compactions = 4;
+  options.base_background_compactions = 4;
+  options.priority_thread_pool_for_compactions = pool;
+
+  std::vector<std::unique_ptr<DB>> dbs;
+  for (int i = 0; i != kNumDbs; ++i) {
+    const auto path = dbname_ + "/db_" + ToString(i);
+    ASSERT_OK(DestroyDB(path, options));
+    DB* db = nullptr;
+    ASSERT_OK(DB::Open(options, path, &db));
+    dbs.emplace_back(db);
+  }
+
+  // Interleave flushes of all instances, so compactions are triggered concurrently.
+  Random rnd(301);
+  for (int flush = 0; flush != kNumFlushes; ++flush) {
+    for (auto& db : dbs) {
+      for (int key = 0; key != kKeysPerFlush; ++key) {
+        ASSERT_OK(db->Put(WriteOptions(), Key(flush * kKeysPerFlush + key),
+                          RandomString(&rnd, 100)));
+      }
+      ASSERT_OK(db->Flush(FlushOptions()));
+    }
+  }
+
+  for (auto& db : dbs) {
+    ASSERT_OK(static_cast<DBImpl*>(db.get())->TEST_WaitForCompact());
+    std::string num_files;
+    ASSERT_TRUE(db->GetProperty("rocksdb.num-files-at-level0", &num_files));
+    ASSERT_LT(std::stoi(num_files), kCompactionTrigger + 1);
+    for (int key = 0; key != kNumFlushes * kKeysPerFlush; ++key) {
+      std::string value;
+      ASSERT_OK(db->Get(ReadOptions(), Key(key), &value));
+    }
+  }
+
+  ASSERT_EQ(0U, pool->num_queued_tasks());
+  ASSERT_EQ(0U, pool->num_running_tasks());
+
+  dbs.clear();
+  pool->Shutdown();
+}
+
+namespace {
+
+// Splits range of keys produced by DBTestBase::Key into ranges with equal number of keys.
+class TestKeySplitter : public CompactionKeySplitter {
+ public:
+  std::vector<std::string> Split(
+      const Slice& smallest, const Slice& largest, size_t max_ranges) override {
+    const int first = KeyIndex(smallest);
+    const int last = KeyIndex(largest);
+    std::vector<std::string> result;
+    for (size_t i = 1; i < max_ranges; ++i) {
+      result.push_back(
+          DBTestBase::Key(first + static_cast<int>((last - first) * i / max_ranges)));
+    }
+    return result;
+  }
+
+  const char* Name() const override { return "TestKeySplitter"; }
+
+ private:
+  static int KeyIndex(const Slice& key) {
+    // Skip "key" prefix.
+    return std::stoi(key.ToBuffer().substr(3));
+  }
+};
+
+} // namespace
+
+class DBTestUniversalSubcompactions : public DBTestBase {
+ public:
+  DBTestUniversalSubcompactions() : DBTestBase("/db_universal_subcompactions_test") {}
+};
+
+// Outputs of a full compaction split into subcompactions are counted as a single sorted run, so
+// they do not trigger another compaction, even when there are as many of them as the trigger.
+TEST_F(DBTestUniversalSubcompactions, SplitFullCompactionIsSingleSortedRun) {
+  constexpr int kNumKeys = 1000;
+  constexpr int kCompactionTrigger = 4;
+  constexpr int kNumSubcompactions = kCompactionTrigger;
+
+  Options options = CurrentOptions();
+  options.compaction_style = kCompactionStyleUniversal;
+  options.num_levels = 1;
+  options.level0_file_num_compaction_trigger = kCompactionTrigger;
+  options.max_subcompactions = kNumSubcompactions;
+  options.compaction_key_splitter = std::make_shared<TestKeySplitter>();
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  for (int flush = 0; flush != kCompactionTrigger; ++flush) {
+    for (int key = 0; key != kNumKeys; ++key) {
+      ASSERT_OK(Put(Key(key), RandomString(&rnd, 100)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+
+  // The full compaction was split into level 0 files with disjoint key ranges.
+  ColumnFamilyMetaData cf_meta;
+  db_->GetColumnFamilyMetaData(&cf_meta);
+  ASSERT_EQ(static_cast<size_t>(kNumSubcompactions), cf_meta.levels[0].files.size());
+  std::set<std::string> split_files;
+  for (const auto& file : cf_meta.levels[0].files) {
+    split_files.insert(file.name);
+  }
+
+  // One more flush gives 2 sorted runs, below the trigger, so the split files stay as is.
+  for (int key = 0; key != kNumKeys; key += 10) {
+    ASSERT_OK(Put(Key(key), RandomString(&rnd, 100)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  db_->GetColumnFamilyMetaData(&cf_meta);
+  ASSERT_EQ(static_cast<size_t>(kNumSubcompactions + 1), cf_meta.levels[0].files.size());
+  for (const auto& file : cf_meta.levels[0].files) {
+    split_files.erase(file.name);
+  }
+  ASSERT_TRUE(split_files.empty());
+
+  for (int key = 0; key != kNumKeys; ++key) {
+    ASSERT_NE("NOT_FOUND", Get(Key(key)));
+  }
+}
+
 }  // namespace rocksdb
 
 #endif  // !defined(ROCKSDB_LITE)
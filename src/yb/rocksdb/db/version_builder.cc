@@ -153,7 +153,11 @@ class VersionBuilder::Rep {
           assert(f1->largest.seqno > f2->largest.seqno ||
                  // We can have multiple files with seqno = 0 as a result of
                  // using DB::AddFile()
-                 (f1->largest.seqno == 0 && f2->largest.seqno == 0));
+                 (f1->largest.seqno == 0 && f2->largest.seqno == 0) ||
+                 // Outputs of the same compaction get the sequence number range of all its
+                 // inputs, see VersionStorageInfo::ContinuesSortedRun.
+                 (f1->smallest.seqno == f2->smallest.seqno &&
+                  f1->largest.seqno == f2->largest.seqno));
         } else {
           assert(level_nonzero_cmp_(f1, f2));
 
@@ -1235,9 +1235,17 @@ void VersionStorageInfo::ComputeCompactionScore(
       // overwrites/deletions).
       int num_sorted_runs = 0;
       uint64_t total_size = 0;
+      std::vector<FileMetaData*> sorted_run;
       for (auto* f : files_[level]) {
         if (!f->being_compacted) {
           total_size += f->compensated_file_size;
+          if (compaction_style_ == kCompactionStyleUniversal) {
+            if (ContinuesSortedRun(sorted_run, *f)) {
+              sorted_run.push_back(f);
+              continue;
+            }
+            sorted_run.assign(1, f);
+          }
           num_sorted_runs++;
         }
       }
@@ -1859,6 +1867,23 @@ int64_t VersionStorageInfo::MaxNextLevelOverlappingBytes() {
   return result;
 }
 
+bool VersionStorageInfo::ContinuesSortedRun(const std::vector<FileMetaData*>& run,
+                                            const FileMetaData& f) const {
+  if (run.empty()) {
+    return false;
+  }
+  for (const auto* file : run) {
+    if (file->smallest.seqno != f.smallest.seqno || file->largest.seqno != f.largest.seqno) {
+      return false;
+    }
+    if (user_comparator_->Compare(f.smallest.key.user_key(), file->largest.key.user_key()) <= 0 &&
+        user_comparator_->Compare(file->smallest.key.user_key(), f.largest.key.user_key()) <= 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 uint64_t VersionStorageInfo::MaxBytesForLevel(int level) const {
   // Note: the result for level zero is not really used since we set
   // the level-0 compaction threshold based on number of files.
@@ -1872,14 +1897,19 @@ void VersionStorageInfo::CalculateBaseBytes(const ImmutableCFOptions& ioptions,
   // Special logic to set number of sorted runs.
   // It is to match the previous behavior when all files are in L0.
   int num_l0_count = 0;
-  if (options.max_file_size_for_compaction == std::numeric_limits<uint64_t>::max()) {
-    num_l0_count = static_cast<int>(files_[0].size());
-  } else {
-    for (const auto& file : files_[0]) {
-      if (file->fd.GetTotalFileSize() <= options.max_file_size_for_compaction) {
-        ++num_l0_count;
+  std::vector<FileMetaData*> sorted_run;
+  for (const auto& file : files_[0]) {
+    if (file->fd.GetTotalFileSize() > options.max_file_size_for_compaction) {
+      continue;
+    }
+    if (compaction_style_ == kCompactionStyleUniversal) {
+      if (ContinuesSortedRun(sorted_run, *file)) {
+        sorted_run.push_back(file);
+        continue;
       }
+      sorted_run.assign(1, file);
     }
+    ++num_l0_count;
   }
   if (compaction_style_ == kCompactionStyleUniversal) {
     // For universal compaction, we use level0 score to indicate
@@ -2808,7 +2838,11 @@ Status VersionSet::Import(const std::string& source_dir,
                              seqno);
       }
       files.push_back(filemeta);
-      segments.emplace_back(filemeta.smallest.seqno, filemeta.largest.seqno);
+      // Files created by SstFileWriter and added with AddFile have zero sequence numbers and
+      // non overlapping key ranges, so they don't need a seqno range of their own.
+      if (filemeta.largest.seqno != 0) {
+        segments.emplace_back(filemeta.smallest.seqno, filemeta.largest.seqno);
+      }
     }
   }
   if (!status.IsEndOfFile()) {
@@ -2822,14 +2856,16 @@ Status VersionSet::Import(const std::string& source_dir,
   std::vector<LiveFileMetaData> live_files;
   GetLiveFilesMetaData(&live_files);
   for (const auto& file : live_files) {
-    segments.emplace_back(file.smallest.seqno, file.largest.seqno);
+    if (file.largest.seqno != 0) {
+      segments.emplace_back(file.smallest.seqno, file.largest.seqno);
+    }
   }
 
   std::sort(segments.begin(), segments.end(), [](const auto& lhs, const auto& rhs) {
     return lhs.first < rhs.first;
   });
-  auto prev = segments.front();
-  for (size_t i = 1; i != segments.size(); ++i) {
+  for (size_t i = 1; i < segments.size(); ++i) {
+    const auto& prev = segments[i - 1];
     const auto& segment = segments[i];
     if (segment.first <= prev.second) {
       return STATUS_FORMAT(Corruption,
@@ -2839,7 +2875,6 @@ Status VersionSet::Import(const std::string& source_dir,
                            segment.first,
                            segment.second);
     }
-    prev = segment;
   }
 
   std::vector<std::string> revert_list;
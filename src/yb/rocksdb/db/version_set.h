@@ -330,6 +330,14 @@ class VersionStorageInfo {
   // Returns maximum total bytes of data on a given level.
   uint64_t MaxBytesForLevel(int level) const;
 
+  // With universal compaction style, level 0 files with the same sequence number range and non
+  // overlapping key ranges form a single sorted run. Those are the outputs of one compaction, e.g.
+  // of a full compaction split into subcompactions, since each output gets the sequence number
+  // range of all compaction inputs. Reads and the compaction picker should not treat them as
+  // separate runs.
+  // Returns true if level 0 file f continues such a run, whose files are listed in run.
+  bool ContinuesSortedRun(const std::vector<FileMetaData*>& run, const FileMetaData& f) const;
+
   // Must be called after any change to MutableCFOptions.
   void CalculateBaseBytes(const ImmutableCFOptions& ioptions,
                           const MutableCFOptions& options);
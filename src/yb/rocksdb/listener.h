@@ -74,6 +74,8 @@ enum class CompactionReason {
   kManualCompaction,
   // DB::SuggestCompactRange() marked files for compaction
   kFilesMarkedForCompaction,
+  // [Universal] files contain only records that compaction filter would remove
+  kUniversalFilesFiltered,
 };
 
 #ifndef ROCKSDB_LITE
@@ -42,12 +42,17 @@
 #undef max
 #endif
 
+namespace yb {
+class PriorityThreadPool;
+}
+
 namespace rocksdb {
 
 class BoundaryValuesExtractor;
 class Cache;
 class CompactionFilter;
 class CompactionFilterFactory;
+class CompactionKeySplitter;
 class Comparator;
 class Env;
 enum InfoLogLevel : unsigned char;
@@ -1307,6 +1312,19 @@ struct DBOptions {
 
   // Max file size for compaction. Supported only for level0 of universal style compactions.
   uint64_t max_file_size_for_compaction = std::numeric_limits<uint64_t>::max();
+
+  // Thread pool, usually shared by several RocksDB instances, that is used to run compactions
+  // instead of the LOW priority pool of env. Compactions of instances with larger level0 backlog
+  // and instances that are close to stopping writes are started first.
+  //
+  // Default: nullptr (compactions are run by env)
+  std::shared_ptr<yb::PriorityThreadPool> priority_thread_pool_for_compactions;
+
+  // Used to split full compactions of universal style with a single level into
+  // max_subcompactions key ranges that are compacted in parallel.
+  //
+  // Default: nullptr (such compactions are not split)
+  std::shared_ptr<CompactionKeySplitter> compaction_key_splitter;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
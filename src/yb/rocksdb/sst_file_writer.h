@@ -24,10 +24,12 @@
 #include <string>
 #include "yb/rocksdb/env.h"
 #include "yb/rocksdb/immutable_options.h"
+#include "yb/rocksdb/metadata.h"
 #include "yb/rocksdb/types.h"
 
 namespace rocksdb {
 
+class BoundaryValuesExtractor;
 class Comparator;
 
 // Table Properties that are specific to tables created by SstFileWriter.
@@ -65,15 +67,22 @@ struct ExternalSstFileInfo {
   bool is_split_sst;               // is SST split into metadata and data file(s)
   uint64_t num_entries;            // number of entries in file
   int32_t version;                 // file version
+  // Smallest and largest user boundary values of keys in file, filled only when SstFileWriter
+  // was created with boundary values extractor.
+  FileBoundaryValuesBase smallest_values;
+  FileBoundaryValuesBase largest_values;
 };
 
 // SstFileWriter is used to create sst files that can be added to database later
 // All keys in files generated by SstFileWriter will have sequence number = 0
 class SstFileWriter {
  public:
+  // When boundary_extractor is specified, user boundary values of added keys are collected, so
+  // they are available in ExternalSstFileInfo and are stored in DB by AddFile.
   SstFileWriter(const EnvOptions& env_options,
                 const ImmutableCFOptions& ioptions,
-                const Comparator* user_comparator);
+                const Comparator* user_comparator,
+                BoundaryValuesExtractor* boundary_extractor = nullptr);
 
   ~SstFileWriter();
 
@@ -205,6 +205,11 @@ enum Tickers : uint32_t {
   BLOCK_CACHE_MULTI_TOUCH_BYTES_READ,
   BLOCK_CACHE_MULTI_TOUCH_BYTES_WRITE,
 
+  // Files deleted without compaction, because they contain only records that compaction filter
+  // would remove.
+  COMPACTION_FILES_FILTERED,
+  COMPACTION_FILES_FILTERED_BYTES,
+
   // End of ticker enum.
   TICKER_ENUM_MAX,
 };
@@ -298,7 +303,9 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {BLOCK_CACHE_MULTI_TOUCH_HIT, "rocksdb_block_cache_multi_touch_hit"},
     {BLOCK_CACHE_MULTI_TOUCH_ADD, "rocksdb_block_cache_multi_touch_add"},
     {BLOCK_CACHE_MULTI_TOUCH_BYTES_READ, "rocksdb_block_cache_multi_touch_bytes_read"},
-    {BLOCK_CACHE_MULTI_TOUCH_BYTES_WRITE, "rocksdb_block_cache_multi_touch_bytes_write"}
+    {BLOCK_CACHE_MULTI_TOUCH_BYTES_WRITE, "rocksdb_block_cache_multi_touch_bytes_write"},
+    {COMPACTION_FILES_FILTERED, "rocksdb_compaction_files_filtered"},
+    {COMPACTION_FILES_FILTERED_BYTES, "rocksdb_compaction_files_filtered_bytes"},
 };
 
 /**
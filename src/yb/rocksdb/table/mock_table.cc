@@ -22,6 +22,8 @@
 
 #include "yb/rocksdb/table/mock_table.h"
 
+#include <iterator>
+
 #include "yb/rocksdb/db/dbformat.h"
 #include "yb/rocksdb/port/port.h"
 #include "yb/rocksdb/table_properties.h"
@@ -158,5 +160,20 @@ void MockTableFactory::AssertLatestFile(
   }
 }
 
+void MockTableFactory::AssertLatestFiles(
+    const stl_wrappers::KVMap& file_contents, size_t num_files) {
+  ASSERT_GE(file_system_.files.size(), num_files);
+  auto it = std::prev(file_system_.files.end(), num_files);
+  size_t num_entries = 0;
+  stl_wrappers::KVMap contents = MakeMockFile();
+  for (; it != file_system_.files.end(); ++it) {
+    num_entries += it->second.size();
+    contents.insert(it->second.begin(), it->second.end());
+  }
+  // Files should not contain the same entries.
+  ASSERT_EQ(num_entries, contents.size());
+  ASSERT_TRUE(file_contents == contents);
+}
+
 }  // namespace mock
 }  // namespace rocksdb
@@ -200,6 +200,8 @@ class MockTableFactory : public TableFactory {
   // contents are equal to file_contents
   void AssertSingleFile(const stl_wrappers::KVMap& file_contents);
   void AssertLatestFile(const stl_wrappers::KVMap& file_contents);
+  // This function will assert that union of num_files latest files is equal to file_contents
+  void AssertLatestFiles(const stl_wrappers::KVMap& file_contents, size_t num_files);
 
  private:
   uint32_t GetAndWriteNextID(WritableFileWriter* file) const;
@@ -88,10 +88,11 @@ class SstFileWriter::SstFileWriterPropertiesCollectorFactory
 
 struct SstFileWriter::Rep {
   Rep(const EnvOptions& _env_options, const ImmutableCFOptions& _ioptions,
-      const Comparator* _user_comparator)
+      const Comparator* _user_comparator, BoundaryValuesExtractor* _boundary_extractor)
       : env_options(_env_options),
         ioptions(_ioptions),
-        internal_comparator(_user_comparator) {}
+        internal_comparator(_user_comparator),
+        boundary_extractor(_boundary_extractor) {}
 
   std::unique_ptr<WritableFileWriter> base_file_writer;
   std::unique_ptr<WritableFileWriter> data_file_writer;
@@ -99,13 +100,15 @@ struct SstFileWriter::Rep {
   EnvOptions env_options;
   ImmutableCFOptions ioptions;
   InternalKeyComparator internal_comparator;
+  BoundaryValuesExtractor* boundary_extractor;
   ExternalSstFileInfo file_info;
 };
 
 SstFileWriter::SstFileWriter(const EnvOptions& env_options,
                              const ImmutableCFOptions& ioptions,
-                             const Comparator* user_comparator)
-    : rep_(new Rep(env_options, ioptions, user_comparator)) {}
+                             const Comparator* user_comparator,
+                             BoundaryValuesExtractor* boundary_extractor)
+    : rep_(new Rep(env_options, ioptions, user_comparator, boundary_extractor)) {}
 
 SstFileWriter::~SstFileWriter() { delete rep_; }
 
@@ -161,6 +164,8 @@ Status SstFileWriter::Open(const std::string& file_path) {
   r->file_info.num_entries = 0;
   r->file_info.sequence_number = 0;
   r->file_info.version = 1;
+  r->file_info.smallest_values = FileBoundaryValuesBase();
+  r->file_info.largest_values = FileBoundaryValuesBase();
   return s;
 }
 
@@ -180,13 +185,26 @@ Status SstFileWriter::Add(const Slice& user_key, const Slice& value) {
     }
   }
 
+  InternalKey ikey(user_key, 0 /* Sequence Number */,
+                   ValueType::kTypeValue /* Put */);
+  if (r->boundary_extractor != nullptr) {
+    auto boundaries = MakeFileBoundaryValues(r->boundary_extractor, ikey.Encode(), value);
+    if (!boundaries) {
+      return std::move(boundaries.status());
+    }
+    for (const auto& user_value : boundaries->user_values) {
+      UpdateUserValue(&r->file_info.smallest_values.user_values, user_value,
+                      UpdateUserValueType::SMALLEST);
+      UpdateUserValue(&r->file_info.largest_values.user_values, user_value,
+                      UpdateUserValueType::LARGEST);
+    }
+  }
+
   // update file info
   r->file_info.num_entries++;
   r->file_info.largest_key = user_key.ToString();
   r->file_info.file_size = r->builder->TotalFileSize();
 
-  InternalKey ikey(user_key, 0 /* Sequence Number */,
-                   ValueType::kTypeValue /* Put */);
   r->builder->Add(ikey.Encode(), value);
 
   return Status::OK();
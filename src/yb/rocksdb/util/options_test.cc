@@ -1920,6 +1920,8 @@ TEST_F(OptionsParserTest, DBOptionsAllFieldsSettable) {
       BLACKLIST_ENTRY(DBOptions, row_cache),
       BLACKLIST_ENTRY(DBOptions, wal_filter),
       BLACKLIST_ENTRY(DBOptions, boundary_extractor),
+      BLACKLIST_ENTRY(DBOptions, priority_thread_pool_for_compactions),
+      BLACKLIST_ENTRY(DBOptions, compaction_key_splitter),
   };
 
   TestAllFieldsSettable<DBOptions>(kDBOptionsBlacklist);
@@ -60,6 +60,16 @@ Status LocalOutboundCall::GetSidecar(int idx, Slice* sidecar) const {
   return Status::OK();
 }
 
+Status LocalOutboundCall::GetSidecarBuffer(int idx, RefCntBuffer* sidecar) const {
+  if (idx < 0 || idx >= inbound_call_->sidecars().size()) {
+    return STATUS(InvalidArgument, strings::Substitute(
+        "Index $0 does not reference a valid sidecar", idx));
+  }
+  // The sidecar is shared with the inbound call, so it is passed to the caller without copying.
+  *sidecar = inbound_call_->sidecars()[idx];
+  return Status::OK();
+}
+
 LocalYBInboundCall::LocalYBInboundCall(
     const RemoteMethod& remote_method, std::weak_ptr<LocalOutboundCall> outbound_call,
     const MonoTime& deadline)
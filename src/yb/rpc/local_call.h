@@ -41,6 +41,8 @@ class LocalOutboundCall : public OutboundCall {
 
   CHECKED_STATUS GetSidecar(int idx, Slice* sidecar) const override;
 
+  CHECKED_STATUS GetSidecarBuffer(int idx, RefCntBuffer* sidecar) const override;
+
  private:
   friend class LocalYBInboundCall;
 
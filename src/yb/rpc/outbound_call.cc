@@ -425,6 +425,10 @@ Status OutboundCall::GetSidecar(int idx, Slice* sidecar) const {
   return call_response_.GetSidecar(idx, sidecar);
 }
 
+Status OutboundCall::GetSidecarBuffer(int idx, RefCntBuffer* sidecar) const {
+  return call_response_.GetSidecarBuffer(idx, sidecar);
+}
+
 string OutboundCall::ToString() const {
   return Substitute("RPC call $0 -> $1 , state=$2.",
                     remote_method_.ToString(), conn_id_.ToString(), StateName(state_));
@@ -579,7 +583,7 @@ CallResponse::CallResponse(CallResponse&& rhs) {
   parsed_ = rhs.parsed_;
   header_.Swap(&rhs.header_);
   serialized_response_ = rhs.serialized_response_;
-  sidecar_slices_ = rhs.sidecar_slices_;
+  sidecar_buffers_ = std::move(rhs.sidecar_buffers_);
   response_data_ = std::move(rhs.response_data_);
 }
 
@@ -589,7 +593,7 @@ void CallResponse::operator=(CallResponse&& rhs) {
   parsed_ = rhs.parsed_;
   header_.Swap(&rhs.header_);
   serialized_response_ = rhs.serialized_response_;
-  sidecar_slices_ = rhs.sidecar_slices_;
+  sidecar_buffers_ = std::move(rhs.sidecar_buffers_);
   response_data_ = std::move(rhs.response_data_);
 }
 
@@ -599,7 +603,18 @@ Status CallResponse::GetSidecar(int idx, Slice* sidecar) const {
     return STATUS(InvalidArgument, strings::Substitute(
         "Index $0 does not reference a valid sidecar", idx));
   }
-  *sidecar = sidecar_slices_[idx];
+  const auto& buffer = sidecar_buffers_[idx];
+  *sidecar = Slice(buffer.udata(), buffer.size());
+  return Status::OK();
+}
+
+Status CallResponse::GetSidecarBuffer(int idx, RefCntBuffer* sidecar) const {
+  DCHECK(parsed_);
+  if (idx < 0 || idx >= header_.sidecar_offsets_size()) {
+    return STATUS(InvalidArgument, strings::Substitute(
+        "Index $0 does not reference a valid sidecar", idx));
+  }
+  *sidecar = sidecar_buffers_[idx];
   return Status::OK();
 }
 
@@ -607,8 +622,6 @@ Status CallResponse::ParseFrom(Slice source) {
   CHECK(!parsed_);
   Slice entire_message;
 
-  response_data_.assign(source.data(), source.end());
-  source = Slice(response_data_.data(), response_data_.size());
   RETURN_NOT_OK(serialization::ParseYBMessage(source, &header_, &entire_message));
 
   // Use information from header to extract the payload slices.
@@ -620,9 +633,9 @@ Status CallResponse::ParseFrom(Slice source) {
         sidecars, kMaxSidecarSlices));
   }
 
+  size_t response_size = entire_message.size();
   if (sidecars > 0) {
-    serialized_response_ = Slice(entire_message.data(),
-                                 header_.sidecar_offsets(0));
+    response_size = header_.sidecar_offsets(0);
     for (size_t i = 0; i < sidecars; ++i) {
       size_t begin_offset = header_.sidecar_offsets(i);
       size_t end_offset = i + 1 == sidecars ? entire_message.size()
@@ -633,13 +646,15 @@ Status CallResponse::ParseFrom(Slice source) {
             " ends at $2, but the entire message has length $3",
             i, begin_offset, end_offset, entire_message.size()));
       }
-      sidecar_slices_[i] = Slice(entire_message.data() + begin_offset,
-                                 entire_message.data() + end_offset);
+      sidecar_buffers_[i] = RefCntBuffer(entire_message.data() + begin_offset,
+                                         end_offset - begin_offset);
     }
-  } else {
-    serialized_response_ = entire_message;
   }
 
+  // Source refers to the memory of the transfer, so data that is used after parsing is copied.
+  response_data_.assign(entire_message.data(), entire_message.data() + response_size);
+  serialized_response_ = Slice(response_data_.data(), response_data_.size());
+
   parsed_ = true;
   return Status::OK();
 }
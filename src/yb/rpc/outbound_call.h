@@ -224,6 +224,9 @@ class CallResponse {
   // See RpcController::GetSidecar()
   CHECKED_STATUS GetSidecar(int idx, Slice* sidecar) const;
 
+  // See RpcController::GetSidecarBuffer()
+  CHECKED_STATUS GetSidecarBuffer(int idx, RefCntBuffer* sidecar) const;
+
  private:
   // True once ParseFrom() is called.
   bool parsed_;
@@ -232,15 +235,16 @@ class CallResponse {
   ResponseHeader header_;
 
   // The slice of data for the encoded protobuf response.
-  // This slice refers to memory allocated by transfer_
+  // This slice refers to memory owned by response_data_.
   Slice serialized_response_;
 
-  // Slices of data for rpc sidecars. They point into memory owned by transfer_.
+  // Data of rpc sidecars. Every sidecar is copied to its own buffer, so it could be passed
+  // further without copying, after the response is destroyed.
   // Number of sidecars chould be obtained from header_.
-  std::array<Slice, kMaxSidecarSlices> sidecar_slices_;
+  std::array<RefCntBuffer, kMaxSidecarSlices> sidecar_buffers_;
 
-  // The incoming transfer data - retained because serialized_response_
-  // and sidecar_slices_ refer into its data.
+  // The incoming encoded protobuf response - retained because serialized_response_ refers into
+  // its data.
   std::vector<uint8_t> response_data_;
 
   DISALLOW_COPY_AND_ASSIGN(CallResponse);
@@ -341,6 +345,8 @@ class OutboundCall : public RpcCall {
 
   virtual CHECKED_STATUS GetSidecar(int idx, Slice* sidecar) const;
 
+  virtual CHECKED_STATUS GetSidecarBuffer(int idx, RefCntBuffer* sidecar) const;
+
   const ConnectionId conn_id_;
   MonoTime start_;
   RpcController* const controller_;
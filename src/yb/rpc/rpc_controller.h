@@ -44,6 +44,8 @@
 
 namespace yb {
 
+class RefCntBuffer;
+
 namespace rpc {
 
 class ErrorStatusPB;
@@ -133,6 +135,10 @@ class RpcController {
   // May fail if index is invalid.
   CHECKED_STATUS GetSidecar(int idx, Slice* sidecar) const;
 
+  // Same as GetSidecar(), but shares the buffer that holds the i-th sidecar, so its data
+  // could be used after the controller is Reset() or destroyed.
+  CHECKED_STATUS GetSidecarBuffer(int idx, RefCntBuffer* sidecar) const;
+
  private:
   friend class OutboundCall;
   friend class Proxy;
@@ -22,6 +22,7 @@
 
 #include "yb/util/test_util.h"
 #include "yb/util/countdown_latch.h"
+#include "yb/util/monotime.h"
 
 namespace yb {
 namespace rpc {
@@ -208,5 +209,93 @@ TEST_F(ThreadPoolTest, TestShutdown) {
   }
 }
 
+namespace {
+
+const std::initializer_list<size_t> kBenchmarkWorkers = {1, 2, 4, 8, 16, 32, 64};
+
+// Task that enqueues the next task of its chain from the worker thread, so the work stealing
+// scheduler keeps it in the LIFO slot of the worker.
+class ChainTask final : public ThreadPoolTask {
+ public:
+  ChainTask(ThreadPool* pool, size_t length, CountDownLatch* latch)
+      : pool_(pool), left_(length), latch_(latch) {}
+
+ private:
+  void Run() override {}
+
+  void Done(const Status& status) override {
+    // The task could be destroyed right after the last count down, so don't touch it after that.
+    auto* latch = latch_;
+    if (status.ok() && --left_ != 0) {
+      pool_->Enqueue(this);
+    }
+    latch->CountDown();
+  }
+
+  ThreadPool* pool_;
+  size_t left_;
+  CountDownLatch* latch_;
+};
+
+void LogThroughput(const char* name, size_t workers, size_t tasks, MonoTime start) {
+  auto passed = MonoTime::Now(MonoTime::FINE).GetDeltaSince(start);
+  LOG(INFO) << name << ", workers: " << workers << ", time: " << passed.ToMilliseconds()
+            << "ms, tasks/s: " << tasks / passed.ToSeconds();
+}
+
+} // namespace
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(ThreadPoolTest, DISABLED_BenchmarkProducers) {
+  constexpr size_t kTotalTasks = 200000;
+  constexpr size_t kProducers = 4;
+  for (size_t workers : kBenchmarkWorkers) {
+    ThreadPool pool("bench", kTotalTasks, workers);
+    CountDownLatch latch(kTotalTasks);
+    std::vector<TestTask> tasks(kTotalTasks);
+    std::vector<std::thread> threads;
+    // Rejected tasks are counted down by Done, so the latch is released anyway.
+    std::atomic<size_t> rejected(0);
+    auto start = MonoTime::Now(MonoTime::FINE);
+    size_t begin = 0;
+    for (size_t i = 0; i != kProducers; ++i) {
+      size_t end = kTotalTasks * (i + 1) / kProducers;
+      threads.emplace_back([&pool, &latch, &tasks, &rejected, begin, end] {
+        for (size_t i = begin; i != end; ++i) {
+          tasks[i].SetLatch(&latch);
+          if (!pool.Enqueue(&tasks[i])) {
+            ++rejected;
+          }
+        }
+      });
+      begin = end;
+    }
+    latch.Wait();
+    LogThroughput("Producers", workers, kTotalTasks, start);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    ASSERT_EQ(0U, rejected.load());
+  }
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(ThreadPoolTest, DISABLED_BenchmarkChains) {
+  constexpr size_t kChains = 256;
+  constexpr size_t kChainLength = 1000;
+  for (size_t workers : kBenchmarkWorkers) {
+    ThreadPool pool("bench", kChains, workers);
+    CountDownLatch latch(kChains * kChainLength);
+    std::vector<std::unique_ptr<ChainTask>> chains;
+    auto start = MonoTime::Now(MonoTime::FINE);
+    for (size_t i = 0; i != kChains; ++i) {
+      chains.emplace_back(new ChainTask(&pool, kChainLength, &latch));
+      ASSERT_TRUE(pool.Enqueue(chains.back().get()));
+    }
+    latch.Wait();
+    LogThroughput("Chains", workers, kChains * kChainLength, start);
+  }
+}
+
 } // namespace rpc
 } // namespace yb
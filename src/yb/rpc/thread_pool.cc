@@ -15,46 +15,26 @@
 
 #include "yb/rpc/thread_pool.h"
 
-#include <condition_variable>
 #include <mutex>
 #include <thread>
 
-#include <boost/lockfree/queue.hpp>
-#include <boost/scope_exit.hpp>
-
 #include "yb/util/thread.h"
+#include "yb/util/work_stealing_scheduler.h"
 
 namespace yb {
 namespace rpc {
 
 namespace {
 
-class Worker;
-
-typedef boost::lockfree::queue<ThreadPoolTask*> TaskQueue;
-typedef boost::lockfree::queue<Worker*> WaitingWorkers;
-
-struct ThreadPoolShare {
-  ThreadPoolOptions options;
-  TaskQueue task_queue;
-  WaitingWorkers waiting_workers;
-
-  explicit ThreadPoolShare(ThreadPoolOptions o)
-      : options(std::move(o)),
-        task_queue(options.queue_limit),
-        waiting_workers(options.max_workers) {
-  }
-};
+typedef WorkStealingScheduler<ThreadPoolTask> Scheduler;
 
-namespace {
 const std::string kRpcThreadCategory = "rpc_thread_pool";
-} // namespace
 
 class Worker {
  public:
-  explicit Worker(ThreadPoolShare* share, size_t index)
-      : share_(share) {
-    auto name = strings::Substitute("rpc_tp_$0_$1", share_->options.name, index);
+  explicit Worker(const ThreadPoolOptions& options, Scheduler* scheduler, size_t index)
+      : scheduler_(scheduler), index_(index) {
+    auto name = strings::Substitute("rpc_tp_$0_$1", options.name, index);
     CHECK_OK(yb::Thread::Create(kRpcThreadCategory, name, &Worker::Execute, this, &thread_));
   }
 
@@ -65,91 +45,20 @@ class Worker {
   Worker(const Worker& worker) = delete;
   void operator=(const Worker& worker) = delete;
 
-  void Stop() {
-    stop_requested_ = true;
-    std::lock_guard<std::mutex> lock(mutex_);
-    cond_.notify_one();
-  }
-
-  bool Notify() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    added_to_waiting_workers_ = false;
-    // There could be cases when we popped task after adding ourselves to worker queue (see below).
-    // So we are already processing task, but reside in worker queue.
-    // To handle this case we use waiting_task_ flag.
-    // If we don't wait task, we return false here, and next worker would be popped from queue
-    // and notified.
-    if (!waiting_task_) {
-      return false;
-    }
-    cond_.notify_one();
-    return true;
-  }
-
  private:
-  // Our main invariant is empty task queue or empty worker queue.
-  // In other words, one of those queues should be empty.
-  // Meaning that we does not have work (task queue empty) or
-  // does not have free hands (worker queue empty)
   void Execute() {
-    while (!stop_requested_) {
-      ThreadPoolTask* task = nullptr;
-      if (PopTask(&task)) {
-        task->Run();
-        task->Done(Status::OK());
-      }
-    }
-  }
-
-  bool PopTask(ThreadPoolTask** task) {
-    // First of all we try to get already queued task, w/o locking.
-    // If there is no task, so we could go to waiting state.
-    if (share_->task_queue.pop(*task)) {
-      return true;
-    }
-    std::unique_lock<std::mutex> lock(mutex_);
-    waiting_task_ = true;
-    BOOST_SCOPE_EXIT(&waiting_task_) {
-        waiting_task_ = false;
-    } BOOST_SCOPE_EXIT_END;
-
-    while (!stop_requested_) {
-      AddToWaitingWorkers();
-
-      // There could be situation, when task was queued before we added ourselves to
-      // the worker queue. So worker queue could be empty in this case, and nobody was notified
-      // about new task. So we check there for this case. This technique is similar to
-      // double check.
-      if (share_->task_queue.pop(*task)) {
-        return true;
-      }
-
-      cond_.wait(lock);
-
-      // Sometimes another worker could steal task before we wake up. In this case we will
-      // just enqueue ourselves back.
-      if (share_->task_queue.pop(*task)) {
-        return true;
-      }
-    }
-    return false;
-  }
-
-  void AddToWaitingWorkers() {
-    if (!added_to_waiting_workers_) {
-      auto pushed = share_->waiting_workers.bounded_push(this);
-      CHECK(pushed);
-      added_to_waiting_workers_ = true;
+    // Tasks enqueued by tasks of this worker are executed by the same worker when possible.
+    scheduler_->BindCurrentThread(index_);
+    while (auto* task = scheduler_->Pop(index_)) {
+      task->Run();
+      task->Done(Status::OK());
     }
+    Scheduler::UnbindCurrentThread();
   }
 
-  ThreadPoolShare* share_;
+  Scheduler* scheduler_;
+  const size_t index_;
   scoped_refptr<yb::Thread> thread_;
-  std::mutex mutex_;
-  std::condition_variable cond_;
-  std::atomic<bool> stop_requested_ = {false};
-  bool waiting_task_ = false;
-  bool added_to_waiting_workers_ = false;
 };
 
 } // namespace
@@ -157,18 +66,19 @@ class Worker {
 class ThreadPool::Impl {
  public:
   explicit Impl(ThreadPoolOptions options)
-      : share_(std::move(options)),
+      : options_(std::move(options)),
+        scheduler_(options_.max_workers),
         queue_full_status_(STATUS_SUBSTITUTE(ServiceUnavailable,
                                              "Queue is full, max items: $0",
-                                             share_.options.queue_limit)) {
-    workers_.reserve(share_.options.max_workers);
-    while (workers_.size() != share_.options.max_workers) {
+                                             options_.queue_limit)) {
+    workers_.reserve(options_.max_workers);
+    while (workers_.size() != options_.max_workers) {
       workers_.emplace_back(nullptr);
     }
   }
 
   const ThreadPoolOptions& options() const {
-    return share_.options;
+    return options_;
   }
 
   bool Enqueue(ThreadPoolTask* task) {
@@ -178,27 +88,27 @@ class ThreadPool::Impl {
       task->Done(shutdown_status_);
       return false;
     }
-    bool added = share_.task_queue.bounded_push(task);
-    --adding_;
-    if (!added) {
+    if (scheduler_.num_queued() >= options_.queue_limit) {
+      --adding_;
       task->Done(queue_full_status_);
       return false;
     }
-    Worker* worker = nullptr;
-    while (share_.waiting_workers.pop(worker)) {
-      if (worker->Notify()) {
-        return true;
-      }
+    scheduler_.Push(task);
+    --adding_;
+
+    // Idle workers will pick up queued tasks, so we don't need a new one.
+    if (scheduler_.HasEnoughIdleWorkers()) {
+      return true;
     }
 
     // We increment created_workers_ every time, the first max_worker increments would produce
     // a new worker. And after that, we will just increment it doing nothing after that.
     // So we could be lock free here.
     auto index = created_workers_++;
-    if (index < share_.options.max_workers) {
+    if (index < options_.max_workers) {
       std::lock_guard<std::mutex> lock(mutex_);
       if (!closing_) {
-        workers_[index].reset(new Worker(&share_, index));
+        workers_[index].reset(new Worker(options_, &scheduler_, index));
       }
     } else {
       --created_workers_;
@@ -212,17 +122,13 @@ class ThreadPool::Impl {
     {
       std::lock_guard<std::mutex> lock(mutex_);
       if (closing_) {
-        CHECK(share_.task_queue.empty());
+        CHECK_EQ(scheduler_.num_queued(), 0);
         CHECK(workers_.empty());
         return;
       }
       closing_ = true;
     }
-    for (auto& worker : workers_) {
-      if (worker) {
-        worker->Stop();
-      }
-    }
+    scheduler_.Stop();
     workers_.clear();
     // Shutdown is quite rare situation otherwise enqueue is quite frequent.
     // Because of this we use "atomic lock" in enqueue and busy wait in shutdown.
@@ -230,14 +136,14 @@ class ThreadPool::Impl {
     while(adding_ != 0) {
       std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
-    ThreadPoolTask* task = nullptr;
-    while (share_.task_queue.pop(task)) {
+    scheduler_.Drain([this](ThreadPoolTask* task) {
       task->Done(shutdown_status_);
-    }
+    });
   }
 
  private:
-  ThreadPoolShare share_;
+  ThreadPoolOptions options_;
+  Scheduler scheduler_;
   std::vector<std::unique_ptr<Worker>> workers_;
   std::atomic<size_t> created_workers_ = {0};
   std::mutex mutex_;
@@ -31,6 +31,9 @@
 //
 
 #include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
@@ -257,6 +260,42 @@ TEST_F(HybridClockTest, TestClockDoesntGoBackwardsWithUpdates) {
   }
 }
 
+// Measures throughput of HybridClock::Now() with different numbers of concurrent readers.
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(HybridClockTest, DISABLED_NowThroughput) {
+  const MonoDelta kDuration = MonoDelta::FromMilliseconds(500);
+  const int max_threads = std::max<int>(4, std::thread::hardware_concurrency());
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> total_calls(0);
+    std::atomic<uint64_t> non_monotonic(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i != num_threads; ++i) {
+      threads.emplace_back([this, &stop, &total_calls, &non_monotonic] {
+        HybridTime prev(0);
+        uint64_t calls = 0;
+        while (!stop.load(std::memory_order_acquire)) {
+          HybridTime t = clock_->Now();
+          if (t.value() <= prev.value()) {
+            ++non_monotonic;
+          }
+          prev = t;
+          ++calls;
+        }
+        total_calls += calls;
+      });
+    }
+    SleepFor(kDuration);
+    stop.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    ASSERT_EQ(0U, non_monotonic.load());
+    LOG(INFO) << num_threads << " threads: "
+              << total_calls.load() * 1000 / kDuration.ToMilliseconds() << " Now() calls/sec";
+  }
+}
+
 TEST_F(HybridClockTest, CompareHybridClocksToDelta) {
   EXPECT_EQ(1, HybridClock::CompareHybridClocksToDelta(
       HybridClock::HybridTimeFromMicrosecondsAndLogicalValue(1000, 10),
@@ -32,8 +32,9 @@
 
 #include "yb/server/hybrid_clock.h"
 
+#include <time.h>
+
 #include <algorithm>
-#include <mutex>
 
 #include <glog/logging.h>
 #include "yb/gutil/bind.h"
@@ -42,7 +43,6 @@
 #include "yb/util/debug/trace_event.h"
 #include "yb/util/errno.h"
 #include "yb/util/flag_tags.h"
-#include "yb/util/locks.h"
 #include "yb/util/logging.h"
 #include "yb/util/metrics.h"
 #include "yb/util/status.h"
@@ -56,6 +56,12 @@ TAG_FLAG(disable_clock_sync_error, advanced);
 TAG_FLAG(max_clock_sync_error_usec, advanced);
 TAG_FLAG(max_clock_sync_error_usec, runtime);
 
+DEFINE_uint64(clock_error_refresh_interval_usec, 100 * 1000,
+              "How often the clock error is read from NTP. Between reads the error is "
+              "extrapolated using the maximal clock frequency error.");
+TAG_FLAG(clock_error_refresh_interval_usec, advanced);
+TAG_FLAG(clock_error_refresh_interval_usec, runtime);
+
 DEFINE_bool(use_hybrid_clock, true,
             "Whether HybridClock should be used as the default clock"
             " implementation. This should be disabled for testing purposes only.");
@@ -98,6 +104,20 @@ Status CheckDeadlineNotWithinMicros(const MonoTime& deadline, int64_t wait_for_u
   return Status::OK();
 }
 
+#if !defined(__APPLE__)
+// Reads the wall clock with clock_gettime(), which is served by vDSO and does not enter the kernel.
+Status RealtimeMicros(uint64_t* now_usec) {
+  timespec ts;
+  if (PREDICT_FALSE(clock_gettime(CLOCK_REALTIME, &ts) != 0)) {
+    return STATUS(ServiceUnavailable, "Error reading clock. clock_gettime() failed",
+                                      ErrnoToString(errno));
+  }
+  *now_usec = ts.tv_sec * MonoTime::kMicrosecondsPerSecond +
+              ts.tv_nsec / MonoTime::kNanosecondsPerMicrosecond;
+  return Status::OK();
+}
+#endif // !defined(__APPLE__)
+
 }  // anonymous namespace
 
 const int HybridClock::kBitsToShift = HybridTime::kBitsForLogicalComponent;
@@ -106,6 +126,8 @@ const uint64_t HybridClock::kLogicalBitMask = HybridTime::kLogicalBitMask;
 
 const uint64_t HybridClock::kNanosPerSec = 1000000;
 
+const uint64_t HybridClock::kClockErrorGrowthDivisor = 2000;
+
 const double HybridClock::kAdjtimexScalingFactor = 65536;
 
 HybridClock::HybridClock()
@@ -115,8 +137,9 @@ HybridClock::HybridClock()
       divisor_(1),
 #endif
       tolerance_adjustment_(1),
-      last_usec_(0),
-      next_logical_(0),
+      next_value_(0),
+      clock_error_base_usec_(0),
+      clock_error_refresh_usec_(0),
       state_(kNotInitialized) {
 }
 
@@ -201,6 +224,12 @@ Status HybridClock::Init() {
   // Tolerance comes in parts per million but needs to be applied a scaling factor.
   tolerance_adjustment_ = (1 + ((timex.tolerance / kAdjtimexScalingFactor) / 1000000.0));
 
+  // Prime the cached clock error, so it is available before the first read of the clock.
+  // The time is read again, because now_usec was read before divisor_ was known.
+  RETURN_NOT_OK(RealtimeMicros(&now_usec));
+  SetCachedClockError(now_usec, error_usec);
+  clock_error_refresh_usec_ = now_usec + FLAGS_clock_error_refresh_interval_usec;
+
   LOG(INFO) << "HybridClock initialized. Resolution in nanos?: " << (divisor_ == 1000)
             << " Wait times tolerance adjustment: " << tolerance_adjustment_
             << " Current error (microseconds): " << error_usec;
@@ -215,8 +244,7 @@ HybridTime HybridClock::Now() {
   HybridTime now;
   uint64_t error;
 
-  std::lock_guard<simple_spinlock> lock(lock_);
-  NowWithErrorUnlocked(&now, &error);
+  NowWithError(&now, &error);
   return now;
 }
 
@@ -224,10 +252,7 @@ HybridTime HybridClock::NowLatest() {
   HybridTime now;
   uint64_t error;
 
-  {
-    std::lock_guard<simple_spinlock> lock(lock_);
-    NowWithErrorUnlocked(&now, &error);
-  }
+  NowWithError(&now, &error);
 
   uint64_t now_latest = GetPhysicalValueMicros(now) + error;
   uint64_t now_logical = GetLogicalValue(now);
@@ -244,33 +269,33 @@ Status HybridClock::GetGlobalLatest(HybridTime* t) {
 }
 
 void HybridClock::NowWithError(HybridTime *hybrid_time, uint64_t *max_error_usec) {
-  std::lock_guard<simple_spinlock> lock(lock_);
-  NowWithErrorUnlocked(hybrid_time, max_error_usec);
-}
-
-void HybridClock::NowWithErrorUnlocked(HybridTime *hybrid_time, uint64_t *max_error_usec) {
-
-  DCHECK(lock_.is_locked());
   DCHECK_EQ(state_, kInitialized) << "Clock not initialized. Must call Init() first.";
 
   uint64_t now_usec;
   uint64_t error_usec;
-  Status s = WalltimeWithError(&now_usec, &error_usec);
+  Status s = WalltimeWithCachedError(&now_usec, &error_usec);
   if (PREDICT_FALSE(!s.ok())) {
     LOG(FATAL) << Substitute("Couldn't get the current time: Clock unsynchronized. "
         "Status: $0", s.ToString());
   }
 
-  // If the current time surpasses the last update just return it
-  if (PREDICT_TRUE(now_usec > last_usec_)) {
-    last_usec_ = now_usec;
-    next_logical_ = 1;
-    *hybrid_time = HybridTimeFromMicroseconds(last_usec_);
+  // If the current time surpasses the last read/update, then it is returned with zero logical
+  // value. Otherwise the last value is returned with incremented logical value.
+  const uint64_t now_value = HybridTimeFromMicroseconds(now_usec).ToUint64();
+  uint64_t next_value = next_value_.load(std::memory_order_acquire);
+  uint64_t result;
+  do {
+    result = std::max(now_value, next_value);
+  } while (!next_value_.compare_exchange_weak(next_value, result + 1, std::memory_order_acq_rel));
+
+  *hybrid_time = HybridTime(result);
+  const uint64_t result_usec = GetPhysicalValueMicros(*hybrid_time);
+  if (PREDICT_TRUE(result_usec <= now_usec)) {
     *max_error_usec = error_usec;
     if (PREDICT_FALSE(VLOG_IS_ON(2))) {
       VLOG(2) << "Current clock is higher than the last one. Resetting logical values."
-          << " Physical Value: " << now_usec << " usec Logical Value: 0  Error: "
-          << error_usec;
+          << " Physical Value: " << now_usec << " usec Logical Value: "
+          << GetLogicalValue(*hybrid_time) << " Error: " << error_usec;
     }
     return;
   }
@@ -293,14 +318,12 @@ void HybridClock::NowWithErrorUnlocked(HybridTime *hybrid_time, uint64_t *max_er
   // This broadens the error interval for both cases but always returns
   // a correct error interval.
 
-  *max_error_usec = last_usec_ - (now_usec - error_usec);
-  *hybrid_time = HybridTimeFromMicrosecondsAndLogicalValue(last_usec_, next_logical_);
+  *max_error_usec = result_usec - (now_usec - error_usec);
   if (PREDICT_FALSE(VLOG_IS_ON(2))) {
     VLOG(2) << "Current clock is lower than the last one. Returning last read and incrementing"
         " logical values. Physical Value: " << now_usec << " usec Logical Value: "
-        << next_logical_ << " Error: " << *max_error_usec;
+        << GetLogicalValue(*hybrid_time) << " Error: " << *max_error_usec;
   }
-  next_logical_++;
 }
 
 void HybridClock::Update(const HybridTime& to_update) {
@@ -308,17 +331,14 @@ void HybridClock::Update(const HybridTime& to_update) {
     return;
   }
 
-  std::lock_guard<simple_spinlock> lock(lock_);
-  HybridTime now;
-  uint64_t error_ignored;
-  NowWithErrorUnlocked(&now, &error_ignored);
-
-  if (PREDICT_TRUE(now.CompareTo(to_update) > 0)) {
-    return;
+  const uint64_t new_next_value = to_update.ToUint64() + 1;
+  uint64_t next_value = next_value_.load(std::memory_order_acquire);
+  while (next_value < new_next_value) {
+    if (next_value_.compare_exchange_weak(
+            next_value, new_next_value, std::memory_order_acq_rel)) {
+      break;
+    }
   }
-
-  last_usec_ = GetPhysicalValueMicros(to_update);
-  next_logical_ = GetLogicalValue(to_update) + 1;
 }
 
 bool HybridClock::SupportsExternalConsistencyMode(ExternalConsistencyMode mode) {
@@ -330,10 +350,7 @@ Status HybridClock::WaitUntilAfter(const HybridTime& then_latest,
   TRACE_EVENT0("clock", "HybridClock::WaitUntilAfter");
   HybridTime now;
   uint64_t error;
-  {
-    std::lock_guard<simple_spinlock> lock(lock_);
-    NowWithErrorUnlocked(&now, &error);
-  }
+  NowWithError(&now, &error);
 
   // "unshift" the hybrid_times so that we can measure actual time
   uint64_t now_usec = GetPhysicalValueMicros(now);
@@ -374,10 +391,7 @@ Status HybridClock::WaitUntilAfterLocally(const HybridTime& then,
   while (true) {
     HybridTime now;
     uint64_t error;
-    {
-      std::lock_guard<simple_spinlock> lock(lock_);
-      NowWithErrorUnlocked(&now, &error);
-    }
+    NowWithError(&now, &error);
     if (now.CompareTo(then) > 0) {
       return Status::OK();
     }
@@ -393,21 +407,15 @@ bool HybridClock::IsAfter(HybridTime t) {
   // a time update.
   uint64_t now_usec;
   uint64_t error_usec;
-  CHECK_OK(WalltimeWithError(&now_usec, &error_usec));
+  CHECK_OK(WalltimeWithCachedError(&now_usec, &error_usec));
 
-  std::lock_guard<simple_spinlock> lock(lock_);
-  now_usec = std::max(now_usec, last_usec_);
-
-  HybridTime now;
-  if (now_usec > last_usec_) {
-    now = HybridTimeFromMicroseconds(now_usec);
-  } else {
-    // last_usec_ may be in the future if we were updated from a remote
-    // node.
-    now = HybridTimeFromMicrosecondsAndLogicalValue(last_usec_, next_logical_);
-  }
+  // The last read/update may be in the future if we were updated from a remote node.
+  return t.value() < NextHybridTimeValue(now_usec);
+}
 
-  return t.value() < now.value();
+uint64_t HybridClock::NextHybridTimeValue(uint64_t now_usec) const {
+  return std::max(HybridTimeFromMicroseconds(now_usec).ToUint64(),
+                  next_value_.load(std::memory_order_acquire));
 }
 
 yb::Status HybridClock::CheckClockSyncError(uint64_t error_usec) {
@@ -421,8 +429,8 @@ yb::Status HybridClock::CheckClockSyncError(uint64_t error_usec) {
 
 yb::Status HybridClock::WalltimeWithError(uint64_t* now_usec, uint64_t* error_usec) {
   if (PREDICT_FALSE(FLAGS_use_mock_wall_clock)) {
-    VLOG(1) << "Current clock time: " << mock_clock_time_usec_ << " error: "
-            << mock_clock_max_error_usec_ << ". Updating to time: " << now_usec
+    VLOG(1) << "Current clock time: " << mock_clock_time_usec_.load() << " error: "
+            << mock_clock_max_error_usec_.load() << ". Updating to time: " << now_usec
             << " and error: " << error_usec;
     *now_usec = mock_clock_time_usec_;
     *error_usec = mock_clock_max_error_usec_;
@@ -447,16 +455,55 @@ yb::Status HybridClock::WalltimeWithError(uint64_t* now_usec, uint64_t* error_us
   return yb::Status::OK();
 }
 
+Status HybridClock::WalltimeWithCachedError(uint64_t* now_usec, uint64_t* error_usec) {
+#if defined(__APPLE__)
+  return WalltimeWithError(now_usec, error_usec);
+#else
+  if (PREDICT_FALSE(FLAGS_use_mock_wall_clock)) {
+    return WalltimeWithError(now_usec, error_usec);
+  }
+
+  RETURN_NOT_OK(RealtimeMicros(now_usec));
+
+  // Only the caller that advances the refresh time reads the error from NTP, others use the
+  // cached value.
+  uint64_t refresh_usec = clock_error_refresh_usec_.load(std::memory_order_acquire);
+  if (PREDICT_FALSE(*now_usec >= refresh_usec) &&
+      clock_error_refresh_usec_.compare_exchange_strong(
+          refresh_usec, *now_usec + FLAGS_clock_error_refresh_interval_usec)) {
+    RETURN_NOT_OK(RefreshClockError());
+  }
+
+  const int64_t error = clock_error_base_usec_.load(std::memory_order_acquire) +
+                        static_cast<int64_t>(*now_usec / kClockErrorGrowthDivisor);
+  *error_usec = std::max<int64_t>(error, 0);
+
+  return CheckClockSyncError(*error_usec);
+#endif // defined(__APPLE__)
+}
+
+Status HybridClock::RefreshClockError() {
+  uint64_t now_usec;
+  uint64_t error_usec;
+  RETURN_NOT_OK(WalltimeWithError(&now_usec, &error_usec));
+  SetCachedClockError(now_usec, error_usec);
+  return Status::OK();
+}
+
+void HybridClock::SetCachedClockError(uint64_t now_usec, uint64_t error_usec) {
+  clock_error_base_usec_.store(
+      static_cast<int64_t>(error_usec) - static_cast<int64_t>(now_usec / kClockErrorGrowthDivisor),
+      std::memory_order_release);
+}
+
 void HybridClock::SetMockClockWallTimeForTests(uint64_t now_usec) {
   CHECK(FLAGS_use_mock_wall_clock);
-  std::lock_guard<simple_spinlock> lock(lock_);
-  CHECK_GE(now_usec, mock_clock_time_usec_);
+  CHECK_GE(now_usec, mock_clock_time_usec_.load());
   mock_clock_time_usec_ = now_usec;
 }
 
 void HybridClock::SetMockMaxClockErrorForTests(uint64_t max_error_usec) {
   CHECK(FLAGS_use_mock_wall_clock);
-  std::lock_guard<simple_spinlock> lock(lock_);
   mock_clock_max_error_usec_ = max_error_usec;
 }
 
@@ -470,8 +517,7 @@ uint64_t HybridClock::ErrorForMetrics() {
   HybridTime now;
   uint64_t error;
 
-  std::lock_guard<simple_spinlock> lock(lock_);
-  NowWithErrorUnlocked(&now, &error);
+  NowWithError(&now, &error);
   return error;
 }
 
@@ -33,6 +33,7 @@
 #ifndef YB_SERVER_HYBRID_CLOCK_H_
 #define YB_SERVER_HYBRID_CLOCK_H_
 
+#include <atomic>
 #include <string>
 #if !defined(__APPLE__)
 #include <sys/timex.h>
@@ -40,7 +41,6 @@
 
 #include "yb/gutil/ref_counted.h"
 #include "yb/server/clock.h"
-#include "yb/util/locks.h"
 #include "yb/util/metrics.h"
 #include "yb/util/status.h"
 
@@ -51,6 +51,13 @@ namespace server {
 //
 // HybridTime should not be used on a distributed cluster running on OS X hosts,
 // since NTP clock error is not available.
+//
+// Reading the clock does not take locks and does not perform syscalls in the common case.
+// Physical time is read with clock_gettime(CLOCK_REALTIME), which is served by vDSO, and the
+// hybrid time is advanced with a compare-and-swap. The NTP maximum error is read with
+// ntp_gettime() at most once per clock_error_refresh_interval_usec, by the caller that notices
+// that the cached value is stale, and extrapolated between reads with the same rate the kernel
+// uses to grow it.
 class HybridClock : public Clock {
  public:
   HybridClock();
@@ -133,9 +140,6 @@ class HybridClock : public Clock {
   // error in micros. This may fail if the clock is unsynchronized or synchronized
   // but the error is too high and, since we can't do anything about it,
   // LOG(FATAL)'s in that case.
-  void NowWithErrorUnlocked(HybridTime* hybrid_time, uint64_t* max_error_usec);
-
-  // Variation of above method with locking.
   void NowWithError(HybridTime* hybrid_time, uint64_t* max_error_usec);
 
   virtual std::string Stringify(HybridTime hybrid_time) override;
@@ -208,6 +212,19 @@ class HybridClock : public Clock {
   // On OS X, the error will always be 0.
   CHECKED_STATUS WalltimeWithError(uint64_t* now_usec, uint64_t* error_usec);
 
+  // Same as WalltimeWithError, but reads the time without syscalls and uses the cached clock
+  // error, refreshing it when it is stale.
+  CHECKED_STATUS WalltimeWithCachedError(uint64_t* now_usec, uint64_t* error_usec);
+
+  // Reads the clock error from NTP and stores it to the cache.
+  CHECKED_STATUS RefreshClockError();
+
+  // Stores the clock error read at the specified time to the cache.
+  void SetCachedClockError(uint64_t now_usec, uint64_t error_usec);
+
+  // Returns the minimal hybrid time that could be returned by Now() for the specified wall time.
+  uint64_t NextHybridTimeValue(uint64_t now_usec) const;
+
   // Returns Status::OK if the clock error_usec provided is within acceptable limits, otherwise
   // it returns a not OK status if disable_clock_sync_error is not true.
   static CHECKED_STATUS CheckClockSyncError(uint64_t error_usec);
@@ -220,11 +237,11 @@ class HybridClock : public Clock {
 
   // Set by calls to SetMockClockWallTimeForTests().
   // For testing purposes only.
-  uint64_t mock_clock_time_usec_;
+  std::atomic<uint64_t> mock_clock_time_usec_;
 
   // Set by calls to SetMockClockErrorForTests().
   // For testing purposes only.
-  uint64_t mock_clock_max_error_usec_;
+  std::atomic<uint64_t> mock_clock_max_error_usec_;
 
 #if !defined(__APPLE__)
   uint64_t divisor_;
@@ -232,12 +249,15 @@ class HybridClock : public Clock {
 
   double tolerance_adjustment_;
 
-  mutable simple_spinlock lock_;
+  // The minimal value of hybrid time that could be returned by Now(), i.e. the last clock
+  // read/update plus one logical tick.
+  std::atomic<uint64_t> next_value_;
 
-  // the last clock read/update, in microseconds.
-  uint64_t last_usec_;
-  // the next logical value to be assigned to a hybrid_time
-  uint64_t next_logical_;
+  // Clock error extrapolated to time 0, i.e. the error at time now_usec is
+  // clock_error_base_usec_ + now_usec / kClockErrorGrowthDivisor.
+  std::atomic<int64_t> clock_error_base_usec_;
+  // Wall time in microseconds after which the cached clock error should be refreshed.
+  std::atomic<uint64_t> clock_error_refresh_usec_;
 
   // How many bits to left shift a microseconds clock read. The remainder
   // of the hybrid_time will be reserved for logical values.
@@ -248,6 +268,10 @@ class HybridClock : public Clock {
 
   static const uint64_t kNanosPerSec;
 
+  // The kernel grows the maximum error of the clock by 500 ppm between NTP adjustments, see
+  // MAXFREQ in timex.h. The cached error is grown at the same rate.
+  static const uint64_t kClockErrorGrowthDivisor;
+
   // The scaling factor used to obtain ppms. From the adjtimex source:
   // "scale factor used by adjtimex freq param.  1 ppm = 65536"
   static const double kAdjtimexScalingFactor;
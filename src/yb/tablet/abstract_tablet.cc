@@ -13,6 +13,7 @@
 
 #include "yb/docdb/doc_operation.h"
 #include "yb/tablet/abstract_tablet.h"
+#include "yb/tablet/ql_scan_cache.h"
 #include "yb/util/trace.h"
 
 namespace yb {
@@ -21,34 +22,47 @@ namespace tablet {
 CHECKED_STATUS AbstractTablet::HandleQLReadRequest(
     HybridTime timestamp, const QLReadRequestPB& ql_read_request,
     const TransactionOperationContextOpt& txn_op_context, QLResponsePB* response,
-    gscoped_ptr<faststring>* rows_data) {
+    gscoped_ptr<faststring>* rows_data, QLScanState* scan) {
 
   // TODO(Robert): verify that all key column values are provided
   docdb::QLReadOperation doc_op(ql_read_request, txn_op_context);
 
-  // Form a schema of columns that are referenced by this query.
   const Schema &schema = SchemaRef();
-  Schema query_schema;
-  const QLReferencedColumnsPB& column_pbs = ql_read_request.column_refs();
-  vector<ColumnId> column_refs;
-  for (int32_t id : column_pbs.static_ids()) {
-    column_refs.emplace_back(id);
+  std::unique_ptr<Schema> query_schema;
+  if (scan != nullptr && scan->iter != nullptr) {
+    // Resume the scan of the previous page with the same projection.
+    query_schema = std::move(scan->query_schema);
+    doc_op.ResumeScan(std::move(scan->iter));
+  } else {
+    // Form a schema of columns that are referenced by this query.
+    query_schema.reset(new Schema());
+    const QLReferencedColumnsPB& column_pbs = ql_read_request.column_refs();
+    vector<ColumnId> column_refs;
+    for (int32_t id : column_pbs.static_ids()) {
+      column_refs.emplace_back(id);
+    }
+    for (int32_t id : column_pbs.ids()) {
+      column_refs.emplace_back(id);
+    }
+    RETURN_NOT_OK(schema.CreateProjectionByIdsIgnoreMissing(column_refs, query_schema.get()));
   }
-  for (int32_t id : column_pbs.ids()) {
-    column_refs.emplace_back(id);
-  }
-  RETURN_NOT_OK(schema.CreateProjectionByIdsIgnoreMissing(column_refs, &query_schema));
 
   QLRSRowDesc rsrow_desc(ql_read_request.rsrow_desc());
   QLResultSet resultset;
   TRACE("Start Execute");
-  const Status s = doc_op.Execute(QLStorage(), timestamp, schema, query_schema, &resultset);
+  const Status s = doc_op.Execute(QLStorage(), timestamp, schema, *query_schema, &resultset);
   TRACE("Done Execute");
   if (!s.ok()) {
     response->set_status(QLResponsePB::YQL_STATUS_RUNTIME_ERROR);
     response->set_error_message(s.message().ToString());
     return Status::OK();
   }
+  if (scan != nullptr) {
+    scan->iter = doc_op.SuspendScan();
+    if (scan->iter != nullptr) {
+      scan->query_schema = std::move(query_schema);
+    }
+  }
   *response = std::move(doc_op.response());
 
   RETURN_NOT_OK(CreatePagingStateForRead(ql_read_request, resultset.rsrow_count(), response));
@@ -21,6 +21,8 @@
 namespace yb {
 namespace tablet {
 
+struct QLScanState;
+
 class AbstractTablet {
  public:
   virtual ~AbstractTablet() {}
@@ -51,10 +53,12 @@ class AbstractTablet {
   virtual HybridTime SafeTimestampToRead() const = 0;
 
  protected:
+  // If scan is not null, the read resumes the scan in it if any, and the scan is suspended in it
+  // if the paging state is returned.
   CHECKED_STATUS HandleQLReadRequest(
       HybridTime timestamp, const QLReadRequestPB& ql_read_request,
       const TransactionOperationContextOpt& txn_op_context, QLResponsePB* response,
-      gscoped_ptr<faststring>* rows_data);
+      gscoped_ptr<faststring>* rows_data, QLScanState* scan = nullptr);
 };
 
 }  // namespace tablet
@@ -428,38 +428,51 @@ void OperationDriver::ApplyTask() {
   // and end up calling Finalize() while we're still in this code.
   scoped_refptr<OperationDriver> ref(this);
 
-  {
-    gscoped_ptr<CommitMsg> commit_msg;
-    CHECK_OK(operation_->Apply(&commit_msg));
-    if (commit_msg) {
-      commit_msg->mutable_commited_op_id()->CopyFrom(op_id_copy_);
-    }
+  gscoped_ptr<CommitMsg> commit_msg;
+  CHECK_OK(operation_->Apply(&commit_msg));
+  if (commit_msg) {
+    commit_msg->mutable_commited_op_id()->CopyFrom(op_id_copy_);
+  }
 
-    // If the client requested COMMIT_WAIT as the external consistency mode
-    // calculate the latest that the prepare hybrid_time could be and wait
-    // until now.earliest > prepare_latest. Only after this are the locks
-    // released.
-    if (mutable_state()->external_consistency_mode() == COMMIT_WAIT) {
-      // TODO: only do this on the leader side
-      TRACE("APPLY: Commit Wait.");
-      // If we can't commit wait and have already applied we might have consistency
-      // issues if we still reply to the client that the operation was a success.
-      // On the other hand we don't have rollbacks as of yet thus we can't undo the
-      // the apply either, so we just CHECK_OK for now.
-      CHECK_OK(CommitWait());
-    }
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE) {
+    CompleteApply(commit_msg.Pass());
+    return;
+  }
 
-    operation_->PreCommit();
+  // Writes of this operation could be postponed until the end of the tablet's apply group, the
+  // operation should not become visible before they are written. Commit messages are only logged
+  // for Kudu tables, so the ones set by the other operations, e.g. alter schema, are dropped.
+  DCHECK(!commit_msg || operation_type() != Operation::WRITE_TXN);
+  mutable_state()->tablet_peer()->tablet()->RunAfterApplyGroup([ref] {
+    ref->CompleteApply(gscoped_ptr<CommitMsg>());
+  });
+}
 
-    // We only write the "commit" records to the local log for legacy Kudu tables. We are not
-    // writing these records for RocksDB-based tables.
-    if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE) {
-      TRACE_EVENT1("operation", "AsyncAppendCommit", "operation", this);
-      CHECK_OK(log_->AsyncAppendCommit(commit_msg.Pass(), Bind(DoNothingStatusCB)));
-    }
+void OperationDriver::CompleteApply(gscoped_ptr<CommitMsg> commit_msg) {
+  // If the client requested COMMIT_WAIT as the external consistency mode
+  // calculate the latest that the prepare hybrid_time could be and wait
+  // until now.earliest > prepare_latest. Only after this are the locks
+  // released.
+  if (mutable_state()->external_consistency_mode() == COMMIT_WAIT) {
+    // TODO: only do this on the leader side
+    TRACE("APPLY: Commit Wait.");
+    // If we can't commit wait and have already applied we might have consistency
+    // issues if we still reply to the client that the operation was a success.
+    // On the other hand we don't have rollbacks as of yet thus we can't undo the
+    // the apply either, so we just CHECK_OK for now.
+    CHECK_OK(CommitWait());
+  }
 
-    Finalize();
+  operation_->PreCommit();
+
+  // We only write the "commit" records to the local log for legacy Kudu tables. We are not
+  // writing these records for RocksDB-based tables.
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE) {
+    TRACE_EVENT1("operation", "AsyncAppendCommit", "operation", this);
+    CHECK_OK(log_->AsyncAppendCommit(commit_msg.Pass(), Bind(DoNothingStatusCB)));
   }
+
+  Finalize();
 }
 
 Status OperationDriver::CommitWait() {
@@ -107,6 +107,11 @@ class PrepareThread;
 //      In-mem data structures that contain the changes made by the operation can now
 //      be made durable.
 //
+//      For RocksDB-backed tables, operations committed together form an apply group of the
+//      tablet, so writes of the group could be postponed and written to RocksDB as a single batch.
+//      In this case the rest of the apply, including Finalize(), is done by CompleteApply() after
+//      the writes of the group are written.
+//
 // [1] - see 'Implementation Techniques for Main Memory Database Systems', DeWitt et. al.
 //
 // This class is thread safe.
@@ -234,6 +239,9 @@ class OperationDriver : public RefCountedThreadSafe<OperationDriver>,
   // results from the Apply().
   void ApplyTask();
 
+  // Does the part of ApplyTask() that follows Operation::Apply().
+  void CompleteApply(gscoped_ptr<consensus::CommitMsg> commit_msg);
+
   // Sleeps until the operation is allowed to commit based on the
   // requested consistency mode.
   CHECKED_STATUS CommitWait();
@@ -0,0 +1,155 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tablet/ql_scan_cache.h"
+
+#include "yb/util/flag_tags.h"
+#include "yb/util/mem_tracker.h"
+#include "yb/util/threadpool.h"
+
+DEFINE_int32(ql_scan_cache_ttl_ms, 10000,
+             "How long the scan of a paged QL read is kept for the read of its next page. "
+             "0 disables the cache.");
+TAG_FLAG(ql_scan_cache_ttl_ms, runtime);
+TAG_FLAG(ql_scan_cache_ttl_ms, advanced);
+
+DEFINE_int64(ql_scan_cache_limit_bytes, 64 * 1024 * 1024,
+             "Approximate memory limit of the scans of paged QL reads kept by a tablet server.");
+TAG_FLAG(ql_scan_cache_limit_bytes, advanced);
+
+DEFINE_int32(ql_scan_prefetch_threads, 4,
+             "Maximum number of threads that prefetch the next pages of paged QL reads.");
+TAG_FLAG(ql_scan_prefetch_threads, advanced);
+
+namespace yb {
+namespace tablet {
+
+namespace {
+
+// Approximate memory held by a suspended iterator: the RocksDB iterators, their pinned blocks and
+// the current row. The memtables and files of the SuperVersion it pins are not charged, the tablet
+// drops its scans when a flush or a compaction installs a new SuperVersion.
+constexpr int64_t kSuspendedScanBytes = 32 * 1024;
+
+} // namespace
+
+QLScanCache::QLScanCache(const std::shared_ptr<MemTracker>& parent_mem_tracker)
+    : mem_tracker_(MemTracker::FindOrCreateTracker(FLAGS_ql_scan_cache_limit_bytes,
+                                                   "QLScanCache", parent_mem_tracker)) {
+  CHECK_OK(ThreadPoolBuilder("ql_prefetch")
+               .set_max_threads(FLAGS_ql_scan_prefetch_threads)
+               .Build(&prefetch_pool_));
+}
+
+QLScanCache::~QLScanCache() {
+  Shutdown();
+}
+
+bool QLScanCache::Enabled() {
+  return FLAGS_ql_scan_cache_ttl_ms > 0;
+}
+
+std::string QLScanCache::ScanKey(const TabletId& tablet_id, const QLReadRequestPB& request) {
+  // Leave out the fields that change from page to page or do not affect the result. Of the paging
+  // state, only the position of the next row to read is kept.
+  QLReadRequestPB key_request(request);
+  key_request.clear_request_id();
+  key_request.clear_remote_endpoint();
+  key_request.clear_query_id();
+  key_request.clear_paging_state();
+  key_request.mutable_paging_state()->set_next_partition_key(
+      request.paging_state().next_partition_key());
+  key_request.mutable_paging_state()->set_next_row_key(request.paging_state().next_row_key());
+  std::string key = tablet_id;
+  key_request.AppendToString(&key);
+  return key;
+}
+
+void QLScanCache::Put(const TabletId& tablet_id, std::string key, QLScanState scan) {
+  int64_t bytes = key.size() + kSuspendedScanBytes + scan.response.SpaceUsed();
+  if (scan.rows_data != nullptr) {
+    bytes += scan.rows_data->capacity();
+  }
+  const MonoTime now = MonoTime::Now(MonoTime::FINE);
+  MonoTime expiration = now;
+  expiration.AddDelta(MonoDelta::FromMilliseconds(FLAGS_ql_scan_cache_ttl_ms));
+
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    EraseUnlocked(it->second);
+  }
+  if (!EvictUnlocked(now, bytes)) {
+    return;
+  }
+  entries_.push_back(Entry{tablet_id, key, std::move(scan), expiration, bytes});
+  index_.emplace(std::move(key), std::prev(entries_.end()));
+}
+
+bool QLScanCache::Take(const std::string& key, QLScanState* scan) {
+  const MonoTime now = MonoTime::Now(MonoTime::FINE);
+  std::lock_guard<std::mutex> l(mutex_);
+  EvictUnlocked(now, 0 /* bytes */);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return false;
+  }
+  *scan = std::move(it->second->scan);
+  EraseUnlocked(it->second);
+  return true;
+}
+
+void QLScanCache::RemoveTablet(const TabletId& tablet_id) {
+  std::lock_guard<std::mutex> l(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto next = std::next(it);
+    if (it->tablet_id == tablet_id) {
+      EraseUnlocked(it);
+    }
+    it = next;
+  }
+}
+
+Status QLScanCache::SubmitPrefetch(const std::function<void()>& task) {
+  return prefetch_pool_->SubmitFunc(task);
+}
+
+void QLScanCache::Shutdown() {
+  prefetch_pool_->Shutdown();
+  std::lock_guard<std::mutex> l(mutex_);
+  while (!entries_.empty()) {
+    EraseUnlocked(entries_.begin());
+  }
+}
+
+bool QLScanCache::EvictUnlocked(const MonoTime& now, int64_t bytes) {
+  while (!entries_.empty() && entries_.front().expiration.ComesBefore(now)) {
+    EraseUnlocked(entries_.begin());
+  }
+  while (!mem_tracker_->TryConsume(bytes)) {
+    if (entries_.empty()) {
+      return false;
+    }
+    EraseUnlocked(entries_.begin());
+  }
+  return true;
+}
+
+void QLScanCache::EraseUnlocked(EntryList::iterator it) {
+  mem_tracker_->Release(it->bytes);
+  index_.erase(it->key);
+  entries_.erase(it);
+}
+
+} // namespace tablet
+} // namespace yb
@@ -0,0 +1,113 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+// This file contains QLScanCache that keeps the scans of paged QL reads suspended between pages.
+// When a page is returned with a paging state, the iterator positioned at the first row of the
+// next page is kept in the cache, so that the read of the next page resumes in place instead of
+// creating a new iterator and seeking RocksDB again. The next page may also be prefetched while
+// the current page is on the wire.
+
+#ifndef YB_TABLET_QL_SCAN_CACHE_H
+#define YB_TABLET_QL_SCAN_CACHE_H
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "yb/common/entity_ids.h"
+#include "yb/common/ql_protocol.pb.h"
+#include "yb/common/ql_rowwise_iterator_interface.h"
+#include "yb/common/schema.h"
+#include "yb/util/faststring.h"
+#include "yb/util/monotime.h"
+#include "yb/util/status.h"
+
+namespace yb {
+
+class MemTracker;
+class ThreadPool;
+
+namespace tablet {
+
+// The state of a paged QL scan between two pages.
+struct QLScanState {
+  // The projection the iterator refers to.
+  std::unique_ptr<Schema> query_schema;
+
+  // The iterator positioned at the first row of the next page.
+  std::unique_ptr<common::QLRowwiseIteratorIf> iter;
+
+  // The next page if it has been prefetched, and the number of rows in it.
+  bool prefetched = false;
+  QLResponsePB response;
+  std::unique_ptr<faststring> rows_data;
+  uint64_t row_count = 0;
+};
+
+class QLScanCache {
+ public:
+  explicit QLScanCache(const std::shared_ptr<MemTracker>& parent_mem_tracker);
+  ~QLScanCache();
+
+  // Whether the scans should be cached.
+  static bool Enabled();
+
+  // The key of the scan that continues the read of the given tablet with the paging state of the
+  // request. All fields of the request that affect the scan or the page returned are part of it.
+  static std::string ScanKey(const TabletId& tablet_id, const QLReadRequestPB& request);
+
+  // Keep the scan with the given key. The scan is dropped if it does not fit in the memory limit.
+  void Put(const TabletId& tablet_id, std::string key, QLScanState scan);
+
+  // Take the scan with the given key out of the cache. Return false if it is not cached.
+  bool Take(const std::string& key, QLScanState* scan);
+
+  // Drop the scans of the given tablet.
+  void RemoveTablet(const TabletId& tablet_id);
+
+  // Run a prefetch task in the background.
+  CHECKED_STATUS SubmitPrefetch(const std::function<void()>& task);
+
+  void Shutdown();
+
+ private:
+  struct Entry {
+    TabletId tablet_id;
+    std::string key;
+    QLScanState scan;
+    MonoTime expiration;
+    int64_t bytes;
+  };
+  typedef std::list<Entry> EntryList;
+
+  // Drop the expired scans, and the oldest scans until the given bytes fit in the memory limit.
+  // Return false if they do not fit.
+  bool EvictUnlocked(const MonoTime& now, int64_t bytes);
+
+  void EraseUnlocked(EntryList::iterator it);
+
+  std::shared_ptr<MemTracker> mem_tracker_;
+  std::unique_ptr<ThreadPool> prefetch_pool_;
+
+  std::mutex mutex_;
+  // The scans from the least to the most recently cached.
+  EntryList entries_;
+  std::unordered_map<std::string, EntryList::iterator> index_;
+};
+
+} // namespace tablet
+} // namespace yb
+
+#endif // YB_TABLET_QL_SCAN_CACHE_H
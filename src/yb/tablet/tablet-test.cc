@@ -39,10 +39,12 @@
 #include "yb/common/scan_spec.h"
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/join.h"
+#include "yb/rocksdb/statistics.h"
 #include "yb/tablet/local_tablet_writer.h"
 #include "yb/tablet/tablet.h"
 #include "yb/tablet/tablet-test-base.h"
 #include "yb/util/slice.h"
+#include "yb/util/stopwatch.h"
 #include "yb/util/test_macros.h"
 
 // Include client header so we can access YBTableType.
@@ -62,6 +64,8 @@ using yb::util::to_underlying;
 DEFINE_int32(testiterator_num_inserts, 1000,
              "Number of rows inserted in TestRowIterator/TestInsert");
 
+DECLARE_int32(max_group_apply_batch_size);
+
 static_assert(to_underlying(TableType::KUDU_COLUMNAR_TABLE_TYPE) ==
                   to_underlying(client::YBTableType::KUDU_COLUMNAR_TABLE_TYPE),
               "Numeric code for KUDU_COLUMNAR_TABLE_TYPE table type must be consistent");
@@ -82,6 +86,29 @@ class TestTablet : public TabletTestBase<SETUP> {
     vector<string> out_rows;
     ASSERT_OK(this->IterateToStringList(&out_rows));
   }
+
+  // Inserts num_rows rows starting from first_key. If group_size is positive, every group_size
+  // inserts are applied as an apply group, like consensus applies operations that are committed
+  // together. rocksdb_writes receives the number of RocksDB writes that were made.
+  void InsertInApplyGroups(int32_t first_key, int32_t num_rows, int32_t group_size,
+                           uint64_t* rocksdb_writes) {
+    const auto& statistics = this->tablet()->rocksdb_statistics();
+    const auto writes_before = statistics->getTickerCount(rocksdb::WRITE_DONE_BY_SELF);
+    LocalTabletWriter writer(this->tablet().get(), &this->client_schema_);
+    const int32_t step = group_size > 0 ? group_size : 1;
+    for (int32_t i = 0; i < num_rows; i += step) {
+      if (group_size > 0) {
+        this->tablet()->StartApplyGroup();
+      }
+      for (int32_t j = i; j < std::min(i + step, num_rows); ++j) {
+        ASSERT_OK_FAST(this->InsertTestRow(&writer, first_key + j, 0));
+      }
+      if (group_size > 0) {
+        this->tablet()->FinishApplyGroup();
+      }
+    }
+    *rocksdb_writes = statistics->getTickerCount(rocksdb::WRITE_DONE_BY_SELF) - writes_before;
+  }
 };
 TYPED_TEST_CASE(TestTablet, TabletTestHelperTypes);
 
@@ -254,6 +281,48 @@ TYPED_TEST(TestTablet, TestMultipleUpdates) {
   ASSERT_EQ(this->setup_.FormatDebugRow(1, 0, false), out_rows[1]);
 }
 
+// Writes of an apply group are written to RocksDB together, in batches of at most
+// max_group_apply_batch_size writes.
+TYPED_TEST(TestTablet, TestGroupApply) {
+  constexpr int32_t kNumRows = 64;
+  constexpr int32_t kGroupSize = 16;
+  uint64_t rocksdb_writes = 0;
+
+  ASSERT_NO_FATALS(this->InsertInApplyGroups(0, kNumRows, 0 /* group_size */, &rocksdb_writes));
+  ASSERT_EQ(static_cast<uint64_t>(kNumRows), rocksdb_writes);
+
+  ASSERT_NO_FATALS(this->InsertInApplyGroups(kNumRows, kNumRows, kGroupSize, &rocksdb_writes));
+  ASSERT_EQ(static_cast<uint64_t>(kNumRows / kGroupSize), rocksdb_writes);
+
+  // Each group of 16 writes is written as batches of 5, 5, 5 and 1 writes.
+  FLAGS_max_group_apply_batch_size = 5;
+  ASSERT_NO_FATALS(this->InsertInApplyGroups(2 * kNumRows, kNumRows, kGroupSize, &rocksdb_writes));
+  ASSERT_EQ(static_cast<uint64_t>(kNumRows / kGroupSize * 4), rocksdb_writes);
+
+  vector<string> rows;
+  ASSERT_OK(this->IterateToStringList(&rows));
+  ASSERT_EQ(3 * kNumRows, rows.size());
+}
+
+// Measures throughput of applying write operations one by one and in apply groups.
+// Timing only, run with --gtest_also_run_disabled_tests.
+TYPED_TEST(TestTablet, DISABLED_BenchmarkGroupApply) {
+  const int32_t num_rows = this->ClampRowCount(FLAGS_testiterator_num_inserts);
+  const int32_t kGroupSize = 16;
+
+  for (bool group : {false, true}) {
+    const int32_t first_key = group ? num_rows : 0;
+    uint64_t rocksdb_writes = 0;
+    Stopwatch stopwatch;
+    stopwatch.start();
+    ASSERT_NO_FATALS(this->InsertInApplyGroups(
+        first_key, num_rows, group ? kGroupSize : 0, &rocksdb_writes));
+    stopwatch.stop();
+    LOG(INFO) << (group ? "Grouped" : "Separate") << " apply of " << num_rows << " writes in "
+              << rocksdb_writes << " RocksDB writes took " << stopwatch.elapsed().ToString();
+  }
+}
+
 // Test that metrics behave properly during tablet initialization
 TYPED_TEST(TestTablet, TestMetricsInit) {
   // Create a tablet, but do not open it
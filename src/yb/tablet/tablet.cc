@@ -46,6 +46,7 @@
 #include <boost/optional.hpp>
 
 #include "yb/rocksdb/db.h"
+#include "yb/rocksdb/listener.h"
 #include "yb/rocksdb/options.h"
 #include "yb/rocksdb/statistics.h"
 #include "yb/rocksdb/utilities/checkpoint.h"
@@ -73,6 +74,7 @@
 #include "yb/docdb/intent.h"
 #include "yb/docdb/primitive_value.h"
 #include "yb/docdb/lock_batch.h"
+#include "yb/docdb/non_blocking_read.h"
 
 #include "yb/gutil/atomicops.h"
 #include "yb/gutil/map-util.h"
@@ -89,6 +91,7 @@
 #include "yb/tablet/diskrowset.h"
 #include "yb/tablet/key_value_iterator.h"
 #include "yb/tablet/maintenance_manager.h"
+#include "yb/tablet/ql_scan_cache.h"
 #include "yb/tablet/row_op.h"
 #include "yb/tablet/rowset_info.h"
 #include "yb/tablet/rowset_tree.h"
@@ -136,6 +139,17 @@ DEFINE_double(tablet_bloom_target_fp_rate, 0.01f,
               "required for bloom filters.");
 TAG_FLAG(tablet_bloom_target_fp_rate, advanced);
 
+DEFINE_int32(max_group_apply_batch_size, 64,
+             "Max number of non-transactional write operations, committed together, that are "
+             "applied to RocksDB as a single write batch. 1 to apply each operation separately.");
+TAG_FLAG(max_group_apply_batch_size, advanced);
+
+DEFINE_bool(ql_scan_prefetch_next_page, false,
+            "Whether to read the next page of a paged QL read in the background while the "
+            "current page is returned. Requires the scan cache to be enabled.");
+TAG_FLAG(ql_scan_prefetch_next_page, runtime);
+TAG_FLAG(ql_scan_prefetch_next_page, advanced);
+
 METRIC_DEFINE_entity(tablet);
 METRIC_DEFINE_gauge_size(tablet, memrowset_size, "MemRowSet Memory Usage",
                          yb::MetricUnit::kBytes,
@@ -298,6 +312,31 @@ CHECKED_STATUS EmitRocksDbMetricsAsPrometheus(
   return Status::OK();
 }
 
+namespace {
+
+// A suspended scan pins the RocksDB SuperVersion it was created with, so the memtables and files
+// replaced by a flush or a compaction are not released while it is cached. Drop the scans of the
+// tablet once a new SuperVersion is installed, the next pages are read with new iterators.
+class QLScanCacheInvalidator : public rocksdb::EventListener {
+ public:
+  QLScanCacheInvalidator(std::shared_ptr<QLScanCache> scan_cache, TabletId tablet_id)
+      : scan_cache_(std::move(scan_cache)), tablet_id_(std::move(tablet_id)) {}
+
+  void OnFlushCompleted(rocksdb::DB* db, const rocksdb::FlushJobInfo& info) override {
+    scan_cache_->RemoveTablet(tablet_id_);
+  }
+
+  void OnCompactionCompleted(rocksdb::DB* db, const rocksdb::CompactionJobInfo& info) override {
+    scan_cache_->RemoveTablet(tablet_id_);
+  }
+
+ private:
+  const std::shared_ptr<QLScanCache> scan_cache_;
+  const TabletId tablet_id_;
+};
+
+} // namespace
+
 const char* Tablet::kDMSMemTrackerId = "DeltaMemStores";
 
 Tablet::Tablet(
@@ -358,7 +397,7 @@ Tablet::Tablet(
 
   if (transaction_participant_context) {
     transaction_participant_ = std::make_unique<TransactionParticipant>(
-        transaction_participant_context);
+        transaction_participant_context, metric_entity_);
   }
 
   if (transaction_coordinator_context) { // TODO(dtxn) Create coordinator only for status tablets
@@ -369,6 +408,10 @@ Tablet::Tablet(
 
   flush_stats_ = make_shared<TabletFlushStats>();
   tablet_options_.listeners.emplace_back(flush_stats_);
+  if (tablet_options_.ql_scan_cache != nullptr) {
+    tablet_options_.listeners.push_back(
+        make_shared<QLScanCacheInvalidator>(tablet_options_.ql_scan_cache, tablet_id()));
+  }
 }
 
 Tablet::~Tablet() {
@@ -406,8 +449,9 @@ Status Tablet::OpenKeyValueTablet() {
 
   // Install the history cleanup handler. Note that TabletRetentionPolicy is going to hold a raw ptr
   // to this tablet. So, we ensure that rocksdb_ is reset before this tablet gets destroyed.
-  rocksdb_options.compaction_filter_factory = make_shared<DocDBCompactionFilterFactory>(
+  auto compaction_filter_factory = make_shared<DocDBCompactionFilterFactory>(
       make_shared<TabletRetentionPolicy>(this));
+  rocksdb_options.compaction_filter_factory = compaction_filter_factory;
 
   const string db_dir = metadata()->rocksdb_dir();
   LOG(INFO) << "Creating RocksDB database in dir " << db_dir;
@@ -433,6 +477,8 @@ Status Tablet::OpenKeyValueTablet() {
     return STATUS(IllegalState, rocksdb_open_status.ToString());
   }
   rocksdb_.reset(db);
+  // Let the compactions resolve the counter deltas against the DB.
+  compaction_filter_factory->SetDB(db);
   ql_storage_.reset(new docdb::QLRocksDBStorage(rocksdb_.get()));
   LOG(INFO) << "Successfully opened a RocksDB database at " << db_dir;
   return Status::OK();
@@ -488,6 +534,11 @@ void Tablet::Shutdown() {
     transaction_coordinator_->Shutdown();
   }
 
+  // Drop the suspended scans before RocksDB is destroyed.
+  if (tablet_options_.ql_scan_cache != nullptr) {
+    tablet_options_.ql_scan_cache->RemoveTablet(tablet_id());
+  }
+
   std::lock_guard<rw_spinlock> lock(component_lock_);
   components_ = nullptr;
   // Shutdown the RocksDB instance for this table, if present.
@@ -913,6 +964,9 @@ void Tablet::ApplyKeyValueRowOperations(const KeyValueWriteBatchPB& put_batch,
                                         rocksdb::WriteBatch* rocksdb_write_batch) {
   // Write batch could be preallocated, here we handle opposite case.
   if (rocksdb_write_batch == nullptr) {
+    if (!put_batch.has_transaction() && AddToApplyGroup(put_batch, op_id, hybrid_time)) {
+      return;
+    }
     WriteBatch write_batch;
     ApplyKeyValueRowOperations(put_batch, op_id, hybrid_time, &write_batch);
     return;
@@ -931,6 +985,113 @@ void Tablet::ApplyKeyValueRowOperations(const KeyValueWriteBatchPB& put_batch,
     PrepareNonTransactionWriteBatch(put_batch, hybrid_time, rocksdb_write_batch);
   }
 
+  // Writes postponed by the apply group precede this one.
+  FlushApplyGroupWrites();
+  WriteToRocksDB(rocksdb_write_batch, hybrid_time);
+}
+
+void Tablet::StartApplyGroup() {
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE || FLAGS_max_group_apply_batch_size <= 1) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(apply_group_mutex_);
+  DCHECK(!apply_group_.active);
+  apply_group_.active = true;
+}
+
+void Tablet::FinishApplyGroup() {
+  std::vector<std::function<void()>> callbacks;
+  {
+    std::lock_guard<std::mutex> lock(apply_group_mutex_);
+    if (!apply_group_.active) {
+      return;
+    }
+    FlushApplyGroupWritesUnlocked();
+    apply_group_.active = false;
+    callbacks.swap(apply_group_.callbacks);
+  }
+  for (const auto& callback : callbacks) {
+    callback();
+  }
+}
+
+void Tablet::RunAfterApplyGroup(std::function<void()> callback) {
+  {
+    std::lock_guard<std::mutex> lock(apply_group_mutex_);
+    if (apply_group_.active) {
+      apply_group_.callbacks.push_back(std::move(callback));
+      return;
+    }
+  }
+  callback();
+}
+
+bool Tablet::AddToApplyGroup(const KeyValueWriteBatchPB& put_batch,
+                             const consensus::OpId& op_id,
+                             HybridTime hybrid_time) {
+  std::lock_guard<std::mutex> lock(apply_group_mutex_);
+  if (!apply_group_.active) {
+    return false;
+  }
+  if (put_batch.kv_pairs_size() == 0) {
+    return true;
+  }
+
+  // Each write keeps its own hybrid time in its keys, while the batch is written atomically, so it
+  // is enough to keep the OpId of the last write as the user frontier of the batch. Applies of
+  // transaction intents are added to the same batch by ApplyIntents.
+  apply_group_.write_batch.SetUserOpId(rocksdb::OpId(op_id.term(), op_id.index()));
+  PrepareNonTransactionWriteBatch(put_batch, hybrid_time, &apply_group_.write_batch);
+  apply_group_.oldest_hybrid_time = std::min(apply_group_.oldest_hybrid_time, hybrid_time);
+  if (++apply_group_.num_writes >= static_cast<size_t>(FLAGS_max_group_apply_batch_size)) {
+    FlushApplyGroupWritesUnlocked();
+  }
+  return true;
+}
+
+void Tablet::FlushApplyGroupWrites() {
+  std::lock_guard<std::mutex> lock(apply_group_mutex_);
+  FlushApplyGroupWritesUnlocked();
+}
+
+void Tablet::FlushApplyGroupWritesUnlocked() {
+  if (apply_group_.num_writes == 0) {
+    return;
+  }
+  WriteToRocksDB(&apply_group_.write_batch, apply_group_.oldest_hybrid_time);
+  apply_group_.write_batch.Clear();
+  apply_group_.num_writes = 0;
+  apply_group_.oldest_hybrid_time = HybridTime::kMax;
+}
+
+void Tablet::ReplayKeyValueRowOperations(WriteOperationState* operation_state,
+                                         rocksdb::WriteBatch* rocksdb_write_batch) {
+  DCHECK_NE(table_type_, TableType::KUDU_COLUMNAR_TABLE_TYPE);
+  last_committed_write_index_.store(operation_state->op_id().index(), std::memory_order_release);
+  StartApplying(operation_state);
+
+  const KeyValueWriteBatchPB& put_batch = operation_state->request()->write_batch();
+  // Transactional writes read transaction metadata from RocksDB, so they could not be batched.
+  DCHECK(!put_batch.has_transaction());
+  if (put_batch.kv_pairs_size() == 0) {
+    return;
+  }
+
+  // The batch is written atomically, so it is enough to keep the OpId of the last write in it.
+  const auto& op_id = operation_state->op_id();
+  rocksdb_write_batch->SetUserOpId(rocksdb::OpId(op_id.term(), op_id.index()));
+  PrepareNonTransactionWriteBatch(put_batch, operation_state->hybrid_time(), rocksdb_write_batch);
+}
+
+void Tablet::WriteReplayedBatch(rocksdb::WriteBatch* rocksdb_write_batch,
+                                HybridTime oldest_hybrid_time) {
+  if (rocksdb_write_batch->Count() != 0) {
+    WriteToRocksDB(rocksdb_write_batch, oldest_hybrid_time);
+  }
+  rocksdb_write_batch->Clear();
+}
+
+void Tablet::WriteToRocksDB(rocksdb::WriteBatch* rocksdb_write_batch, HybridTime hybrid_time) {
   // We are using Raft replication index for the RocksDB sequence number for
   // all members of this write batch.
   rocksdb::WriteOptions write_options;
@@ -1014,10 +1175,99 @@ Status Tablet::HandleQLReadRequest(
   Result<TransactionOperationContextOpt> txn_op_ctx =
       CreateTransactionOperationContext(transaction_metadata);
   RETURN_NOT_OK(txn_op_ctx);
+  // Iterators created in a non blocking read scope report to the scope and read only from memory,
+  // so they cannot be resumed after the scope is gone. Such reads bypass the scan cache, and their
+  // blocking retry uses it.
+  if (tablet_options_.ql_scan_cache != nullptr && QLScanCache::Enabled() &&
+      docdb::NonBlockingReadScope::Current() == nullptr &&
+      !transaction_metadata.has_transaction_id() && ql_read_request.return_paging_state()) {
+    return HandlePagedQLReadRequest(timestamp, ql_read_request, *txn_op_ctx, response, rows_data);
+  }
   return AbstractTablet::HandleQLReadRequest(
       timestamp, ql_read_request, *txn_op_ctx, response, rows_data);
 }
 
+Status Tablet::HandlePagedQLReadRequest(
+    HybridTime timestamp, const QLReadRequestPB& ql_read_request,
+    const TransactionOperationContextOpt& txn_op_context, QLResponsePB* response,
+    gscoped_ptr<faststring>* rows_data) {
+  QLScanCache* const scan_cache = tablet_options_.ql_scan_cache.get();
+  const QLPagingStatePB& paging_state = ql_read_request.paging_state();
+  QLScanState scan;
+  if (!paging_state.next_row_key().empty() &&
+      scan_cache->Take(QLScanCache::ScanKey(tablet_id(), ql_read_request), &scan) &&
+      scan.prefetched) {
+    // The page was prefetched while the previous page was returned. Only the running total of the
+    // rows read depends on the request.
+    TRACE("Found prefetched page");
+    *response = std::move(scan.response);
+    rows_data->reset(scan.rows_data.release());
+    if (response->has_paging_state()) {
+      response->mutable_paging_state()->set_total_num_rows_read(
+          paging_state.total_num_rows_read() + scan.row_count);
+    }
+    return Status::OK();
+  }
+
+  RETURN_NOT_OK(AbstractTablet::HandleQLReadRequest(
+      timestamp, ql_read_request, txn_op_context, response, rows_data, &scan));
+  SuspendQLScan(timestamp, ql_read_request, *response, &scan, FLAGS_ql_scan_prefetch_next_page);
+  return Status::OK();
+}
+
+void Tablet::SuspendQLScan(HybridTime timestamp, const QLReadRequestPB& ql_read_request,
+                           const QLResponsePB& response, QLScanState* scan, bool prefetch) {
+  if (scan->iter == nullptr || response.status() != QLResponsePB::YQL_STATUS_OK) {
+    return;
+  }
+
+  // The read of the next page is the same request continuing from the returned paging state.
+  auto next_request = std::make_shared<QLReadRequestPB>(ql_read_request);
+  *next_request->mutable_paging_state() = response.paging_state();
+  QLScanCache* const scan_cache = tablet_options_.ql_scan_cache.get();
+  if (prefetch) {
+    // The prefetch task keeps RocksDB from being destroyed until it is done or dropped.
+    auto next_scan = std::make_shared<QLScanState>(std::move(*scan));
+    auto pending_op = std::make_shared<ScopedPendingOperation>(&pending_op_counter_);
+    const Status s = scan_cache->SubmitPrefetch(
+        [this, timestamp, next_request, next_scan, pending_op] {
+          PrefetchQLReadPage(timestamp, *next_request, next_scan.get());
+        });
+    if (s.ok()) {
+      return;
+    }
+    *scan = std::move(*next_scan);
+  }
+  scan_cache->Put(tablet_id(), QLScanCache::ScanKey(tablet_id(), *next_request), std::move(*scan));
+}
+
+void Tablet::PrefetchQLReadPage(HybridTime timestamp, const QLReadRequestPB& ql_read_request,
+                                QLScanState* scan) {
+  if (IsShutdownRequested()) {
+    return;
+  }
+  QLScanState page;
+  gscoped_ptr<faststring> rows_data;
+  const Status s = AbstractTablet::HandleQLReadRequest(
+      timestamp, ql_read_request, CreateTransactionOperationContext(boost::none), &page.response,
+      &rows_data, scan);
+  if (!s.ok() || page.response.status() != QLResponsePB::YQL_STATUS_OK) {
+    return;
+  }
+
+  // Keep the scan for the page after the prefetched one, but do not read further ahead.
+  SuspendQLScan(timestamp, ql_read_request, page.response, scan, false /* prefetch */);
+
+  page.prefetched = true;
+  page.rows_data.reset(rows_data.release());
+  if (page.response.has_paging_state()) {
+    page.row_count = page.response.paging_state().total_num_rows_read() -
+                     ql_read_request.paging_state().total_num_rows_read();
+  }
+  tablet_options_.ql_scan_cache->Put(
+      tablet_id(), QLScanCache::ScanKey(tablet_id(), ql_read_request), std::move(page));
+}
+
 CHECKED_STATUS Tablet::CreatePagingStateForRead(const QLReadRequestPB& ql_read_request,
                                                 const size_t row_count,
                                                 QLResponsePB* response) const {
@@ -1390,6 +1640,61 @@ Status Tablet::ImportData(const std::string& source_dir) {
   return rocksdb_->Import(source_dir);
 }
 
+namespace {
+
+// Import id and file name are provided by client, so we should make sure that they could not be
+// used to access files outside of the staging directory.
+Status CheckImportPathComponent(const std::string& component) {
+  if (component.empty() || component == "." || component == ".." ||
+      component.find('/') != std::string::npos) {
+    return STATUS_FORMAT(InvalidArgument, "Invalid import path component: $0", component);
+  }
+  return Status::OK();
+}
+
+} // namespace
+
+Result<std::string> Tablet::ImportStagingDir(const std::string& import_id) const {
+  RETURN_NOT_OK(CheckImportPathComponent(import_id));
+  return metadata()->rocksdb_dir() + ".import." + import_id;
+}
+
+Status Tablet::AppendImportFile(const std::string& import_id,
+                                const std::string& file_name,
+                                uint64_t offset,
+                                const Slice& data) {
+  RETURN_NOT_OK(CheckImportPathComponent(file_name));
+  auto dir = ImportStagingDir(import_id);
+  RETURN_NOT_OK(dir);
+  auto* env = metadata()->fs_manager()->env();
+  RETURN_NOT_OK(metadata()->fs_manager()->CreateDirIfMissing(*dir));
+
+  const auto path = JoinPathSegments(*dir, file_name);
+  WritableFileOptions options;
+  if (offset != 0) {
+    uint64_t file_size = 0;
+    RETURN_NOT_OK(env->GetFileSize(path, &file_size));
+    if (file_size != offset) {
+      return STATUS_FORMAT(InvalidArgument, "Wrong offset of $0: $1, while file size is $2",
+                           path, offset, file_size);
+    }
+    options.mode = Env::OPEN_EXISTING;
+  }
+  gscoped_ptr<WritableFile> file;
+  RETURN_NOT_OK(env->NewWritableFile(options, path, &file));
+  RETURN_NOT_OK(file->Append(data));
+  return file->Close();
+}
+
+Status Tablet::ImportStagedData(const std::string& import_id) {
+  auto dir = ImportStagingDir(import_id);
+  RETURN_NOT_OK(dir);
+  auto status = ImportData(*dir);
+  WARN_NOT_OK(metadata()->fs_manager()->env()->DeleteRecursively(*dir),
+              "Failed to remove import staging directory");
+  return status;
+}
+
 #define INTENT_VALUE_SCHECK(lhs, op, rhs, msg) \
   BOOST_PP_CAT(SCHECK_, op)(lhs, \
                             rhs, \
@@ -1405,6 +1710,38 @@ Status Tablet::ImportData(const std::string& source_dir) {
 // TODO(dtxn) use separate thread for applying intents.
 // TODO(dtxn) use multiple batches when applying really big transaction.
 Status Tablet::ApplyIntents(const TransactionApplyData& data) {
+  KeyValueWriteBatchPB put_batch;
+  {
+    std::lock_guard<std::mutex> lock(apply_group_mutex_);
+    if (apply_group_.active) {
+      // Removal of intents and regular records that replace them are added to the apply group,
+      // so applies of transactions that were committed together are written by a single RocksDB
+      // write. Intents of this transaction are already in RocksDB, even when they were written
+      // during this group, because transactional writes are not grouped.
+      RETURN_NOT_OK(PrepareApplyIntents(data, &put_batch, &apply_group_.write_batch));
+      apply_group_.write_batch.SetUserOpId(rocksdb::OpId(data.op_id.term(), data.op_id.index()));
+      PrepareNonTransactionWriteBatch(put_batch, data.commit_time, &apply_group_.write_batch);
+      apply_group_.oldest_hybrid_time = std::min(apply_group_.oldest_hybrid_time, data.commit_time);
+      if (++apply_group_.num_writes >= static_cast<size_t>(FLAGS_max_group_apply_batch_size)) {
+        FlushApplyGroupWritesUnlocked();
+      }
+      return Status::OK();
+    }
+  }
+
+  WriteBatch rocksdb_write_batch;
+  RETURN_NOT_OK(PrepareApplyIntents(data, &put_batch, &rocksdb_write_batch));
+
+  // data.hybrid_time contains transaction commit time.
+  // We don't set transaction field of put_batch, otherwise we would write another bunch of intents.
+  // TODO(dtxn) commit_time?
+  ApplyKeyValueRowOperations(put_batch, data.op_id, data.commit_time, &rocksdb_write_batch);
+  return Status::OK();
+}
+
+Status Tablet::PrepareApplyIntents(const TransactionApplyData& data,
+                                   KeyValueWriteBatchPB* put_batch,
+                                   rocksdb::WriteBatch* rocksdb_write_batch) {
   auto reverse_index_iter = docdb::CreateRocksDBIterator(
       rocksdb_.get(),
       docdb::BloomFilterMode::DONT_USE_BLOOM_FILTER,
@@ -1422,9 +1759,6 @@ Status Tablet::ApplyIntents(const TransactionApplyData& data) {
 
   reverse_index_iter->Seek(txn_reverse_index_prefix.data());
 
-  KeyValueWriteBatchPB put_batch;
-  WriteBatch rocksdb_write_batch;
-
   while (reverse_index_iter->Valid()) {
     rocksdb::Slice key_slice(reverse_index_iter->key());
 
@@ -1453,28 +1787,24 @@ Status Tablet::ApplyIntents(const TransactionApplyData& data) {
                               "wrong transaction id");
           intent_value.remove_prefix(transaction_id_slice.size());
 
-          auto* pair = put_batch.add_kv_pairs();
+          auto* pair = put_batch->add_kv_pairs();
           // After strip of prefix and suffix intent_key contains just SubDocKey w/o a hybrid time.
           // Time will be added when writing batch to rocks db.
           pair->set_key(intent_key.cdata(), intent_key.size());
           pair->set_value(intent_value.cdata(), intent_value.size());
         }
-        rocksdb_write_batch.Delete(intent_iter->key());
+        rocksdb_write_batch->Delete(intent_iter->key());
       } else {
         LOG(DFATAL) << "Unable to find intent: " << reverse_index_iter->value().ToDebugString()
                     << " for " << reverse_index_iter->key().ToDebugString();
       }
     }
 
-    rocksdb_write_batch.Delete(reverse_index_iter->key());
+    rocksdb_write_batch->Delete(reverse_index_iter->key());
 
     reverse_index_iter->Next();
   }
 
-  // data.hybrid_time contains transaction commit time.
-  // We don't set transaction field of put_batch, otherwise we would write another bunch of intents.
-  // TODO(dtxn) commit_time?
-  ApplyKeyValueRowOperations(put_batch, data.op_id, data.commit_time, &rocksdb_write_batch);
   return Status::OK();
 }
 
@@ -2040,6 +2370,25 @@ yb::OpId Tablet::MaxPersistentOpId() const {
   return rocksdb_->GetFlushedOpId();
 }
 
+size_t Tablet::MemTableSize() const {
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE || !rocksdb_) {
+    return 0;
+  }
+  uint64_t result = 0;
+  if (!rocksdb_->GetIntProperty(rocksdb::DB::Properties::kCurSizeActiveMemTable, &result)) {
+    return 0;
+  }
+  return result;
+}
+
+int64_t Tablet::MemTableLogRetentionSize(const MaxIdxToSegmentMap& max_idx_to_segment_size) const {
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE || !rocksdb_) {
+    return 0;
+  }
+  return GetLogRetentionSizeForIndex(rocksdb_->GetFlushedOpId().index + 1,
+                                     max_idx_to_segment_size);
+}
+
 Status Tablet::FlushMetadata(const RowSetVector& to_remove,
                              const RowSetMetadataVector& to_add,
                              int64_t mrs_being_flushed) {
@@ -2562,6 +2911,21 @@ size_t Tablet::EstimateOnDiskSize() const {
   return ret;
 }
 
+uint64_t Tablet::EstimateNumRows() const {
+  if (table_type_ != TableType::YQL_TABLE_TYPE || !rocksdb_) {
+    return 0;
+  }
+  uint64_t num_keys = 0;
+  if (!rocksdb_->GetIntProperty(rocksdb::DB::Properties::kEstimateNumKeys, &num_keys)) {
+    return 0;
+  }
+  // Each non-key column of a row and the liveness column of an inserted row are separate keys in
+  // RocksDB, so this is a rough estimate that assumes all columns are set.
+  const Schema* schema = this->schema();
+  const size_t keys_per_row = schema->num_columns() - schema->num_key_columns() + 1;
+  return num_keys / keys_per_row;
+}
+
 size_t Tablet::DeltaMemStoresSize() const {
   scoped_refptr<TabletComponents> comps;
   GetComponents(&comps);
@@ -32,6 +32,7 @@
 #ifndef YB_TABLET_TABLET_H_
 #define YB_TABLET_TABLET_H_
 
+#include <functional>
 #include <iosfwd>
 #include <map>
 #include <memory>
@@ -111,6 +112,7 @@ class AlterSchemaOperationState;
 class CompactionPolicy;
 class MemRowSet;
 class MvccSnapshot;
+struct QLScanState;
 struct RowOp;
 class RowSetsInCompaction;
 class RowSetTree;
@@ -140,6 +142,7 @@ class TabletFlushStats : public rocksdb::EventListener {
     uint64_t prev_val = oldest_write_in_memstore_.load(std::memory_order_acquire);
     while (curr_val < prev_val &&
            !oldest_write_in_memstore_.compare_exchange_weak(prev_val, curr_val)) {}
+    num_writes_.fetch_add(1, std::memory_order_relaxed);
   }
 
   // Return the hybrid time of the oldest write in the memstore, or HybridTime::kMax if empty
@@ -152,8 +155,14 @@ class TabletFlushStats : public rocksdb::EventListener {
     return num_flushes_.load(std::memory_order_acquire);
   }
 
+  // Number of writes to RocksDB since the tablet was opened. Used to estimate the write rate.
+  size_t num_writes() const {
+    return num_writes_.load(std::memory_order_relaxed);
+  }
+
  private:
   std::atomic<size_t> num_flushes_{0};
+  std::atomic<size_t> num_writes_{0};
   std::atomic<uint64_t> oldest_write_in_memstore_{std::numeric_limits<uint64_t>::max()};
 };
 
@@ -208,6 +217,16 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
 
   CHECKED_STATUS ImportData(const std::string& source_dir);
 
+  // Appends data to the file of import staging directory, so files could be sent to the tablet
+  // server in chunks. Offset should be equal to the current size of the file.
+  CHECKED_STATUS AppendImportFile(const std::string& import_id,
+                                  const std::string& file_name,
+                                  uint64_t offset,
+                                  const Slice& data);
+
+  // Imports data from the staging directory of the specified import and removes this directory.
+  CHECKED_STATUS ImportStagedData(const std::string& import_id);
+
   CHECKED_STATUS ApplyIntents(const TransactionApplyData& data) override;
 
   // Decode the Write (insert/mutate) operations from within a user's request.
@@ -291,6 +310,30 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
       HybridTime hybrid_time,
       rocksdb::WriteBatch* rocksdb_write_batch = nullptr);
 
+  // Used by tablet bootstrap to replay a non-transactional write. Adds its key-value operations to
+  // rocksdb_write_batch instead of writing them to RocksDB, so that several replayed writes could
+  // be written at once by WriteReplayedBatch.
+  void ReplayKeyValueRowOperations(WriteOperationState* operation_state,
+                                   rocksdb::WriteBatch* rocksdb_write_batch);
+
+  // Writes the batch filled by ReplayKeyValueRowOperations to RocksDB and clears it.
+  // oldest_hybrid_time is the minimal hybrid time of writes in the batch.
+  void WriteReplayedBatch(rocksdb::WriteBatch* rocksdb_write_batch, HybridTime oldest_hybrid_time);
+
+  // Operations applied between StartApplyGroup and FinishApplyGroup form an apply group.
+  // Non-transactional writes and applies of transaction intents of the group are accumulated in a
+  // single RocksDB write batch, that is written by FinishApplyGroup, before a transactional write,
+  // or when it reaches max_group_apply_batch_size writes. Callbacks passed to RunAfterApplyGroup
+  // during the group are invoked by FinishApplyGroup, after all writes of the group were written.
+  //
+  // Used by consensus to group applies of operations that are committed together.
+  void StartApplyGroup();
+  void FinishApplyGroup();
+
+  // Invokes the callback after writes of the current apply group are written, or immediately when
+  // there is no apply group.
+  void RunAfterApplyGroup(std::function<void()> callback);
+
   // Takes a Redis WriteRequestPB as input with its redis_write_batch.
   // Constructs a WriteRequestPB containing a serialized WriteBatch that will be
   // replicated by Raft. (Makes a copy, it is caller's responsibility to deallocate
@@ -424,6 +467,9 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Estimate the total on-disk size of this tablet, in bytes.
   size_t EstimateOnDiskSize() const;
 
+  // Estimate the number of rows in this tablet. Returns 0 for tables other than QL tables.
+  uint64_t EstimateNumRows() const;
+
   // Get the total size of all the DMS
   size_t DeltaMemStoresSize() const;
 
@@ -536,6 +582,13 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Returns the maximum persistent op id from all SSTables in RocksDB.
   yb::OpId MaxPersistentOpId() const;
 
+  // Returns the approximate size of the active RocksDB memtable, in bytes.
+  size_t MemTableSize() const;
+
+  // Returns the size in bytes of the WAL retained because of the data that is not yet flushed to
+  // RocksDB SSTables.
+  int64_t MemTableLogRetentionSize(const MaxIdxToSegmentMap& max_idx_to_segment_size) const;
+
   // Returns the location of the last rocksdb checkpoint. Used for tests only.
   std::string GetLastRocksDBCheckpointDirForTest() { return last_rocksdb_checkpoint_dir_; }
 
@@ -599,6 +652,9 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
 
   CHECKED_STATUS FlushUnlocked(FlushMode mode);
 
+  // Returns directory where files of the specified import are stored before import.
+  Result<std::string> ImportStagingDir(const std::string& import_id) const;
+
   // A version of Insert that does not acquire locks and instead assumes that
   // they were already acquired. Requires that handles for the relevant locks
   // and MVCC transaction are present in the transaction state.
@@ -727,12 +783,46 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
       HybridTime hybrid_time,
       rocksdb::WriteBatch* rocksdb_write_batch);
 
+  void WriteToRocksDB(rocksdb::WriteBatch* rocksdb_write_batch, HybridTime hybrid_time);
+
+  // Adds a non-transactional write to the write batch of the current apply group. Returns false if
+  // there is no apply group.
+  bool AddToApplyGroup(const docdb::KeyValueWriteBatchPB& put_batch,
+                       const consensus::OpId& op_id,
+                       HybridTime hybrid_time);
+
+  // Adds removal of intents of the transaction to rocksdb_write_batch and fills put_batch with
+  // regular records that replace them.
+  CHECKED_STATUS PrepareApplyIntents(const TransactionApplyData& data,
+                                     docdb::KeyValueWriteBatchPB* put_batch,
+                                     rocksdb::WriteBatch* rocksdb_write_batch);
+
+  // Writes the write batch of the current apply group, if it is not empty.
+  void FlushApplyGroupWrites();
+  void FlushApplyGroupWritesUnlocked();
+
   Result<TransactionOperationContextOpt> CreateTransactionOperationContext(
       const TransactionMetadataPB& transaction_metadata) const;
 
   TransactionOperationContextOpt CreateTransactionOperationContext(
       const boost::optional<TransactionId>& transaction_id) const;
 
+  // Read a page of a paged QL read outside of a transaction. The scan is resumed from and
+  // suspended in the scan cache, and the next page is prefetched if enabled.
+  CHECKED_STATUS HandlePagedQLReadRequest(
+      HybridTime timestamp, const QLReadRequestPB& ql_read_request,
+      const TransactionOperationContextOpt& txn_op_context, QLResponsePB* response,
+      gscoped_ptr<faststring>* rows_data);
+
+  // Keep the scan suspended after a page in the scan cache for the read of the next page, or read
+  // the next page in the background if prefetch is true.
+  void SuspendQLScan(HybridTime timestamp, const QLReadRequestPB& ql_read_request,
+                     const QLResponsePB& response, QLScanState* scan, bool prefetch);
+
+  // Read the page of a paged QL read resuming the given scan, and keep the page in the scan cache.
+  void PrefetchQLReadPage(HybridTime timestamp, const QLReadRequestPB& ql_read_request,
+                          QLScanState* scan);
+
   // Lock protecting schema_ and key_schema_.
   //
   // Writers take this lock in shared mode before decoding and projecting
@@ -876,6 +966,18 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // be flushed in RocksDB.
   std::shared_ptr<TabletFlushStats> flush_stats_;
 
+  // State of the current apply group, see StartApplyGroup.
+  struct ApplyGroup {
+    bool active = false;
+    rocksdb::WriteBatch write_batch;
+    size_t num_writes = 0;
+    HybridTime oldest_hybrid_time = HybridTime::kMax;
+    std::vector<std::function<void()>> callbacks;
+  };
+
+  std::mutex apply_group_mutex_;
+  ApplyGroup apply_group_;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(Tablet);
 };
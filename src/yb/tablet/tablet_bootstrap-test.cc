@@ -44,9 +44,18 @@
 #include "yb/tablet/tablet_bootstrap_if.h"
 #include "yb/tablet/tablet-test-util.h"
 #include "yb/tablet/tablet_metadata.h"
+#include "yb/util/monotime.h"
 #include "yb/util/tostring.h"
 #include "yb/tablet/tablet_options.h"
 
+DEFINE_int32(bootstrap_test_num_ops, 5000,
+             "Number of write operations in the log replayed by BenchmarkBootstrap.");
+DEFINE_int32(bootstrap_test_ops_per_segment, 500,
+             "Number of write operations per log segment in BenchmarkBootstrap.");
+
+DECLARE_int32(tablet_bootstrap_read_ahead_segments);
+DECLARE_int32(tablet_bootstrap_replay_batch_ops);
+
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -172,6 +181,36 @@ class BootstrapTest : public LogTestBase {
       VLOG(1) << result;
     }
   }
+
+  // Writes num_ops inserts to a log with ops_per_segment operations per segment, bootstraps the
+  // tablet from it and checks that all of them were replayed. If bootstrap_time is not null, it
+  // receives the time spent in bootstrap.
+  void ReplayMultiSegmentLog(int num_ops, int ops_per_segment, MonoDelta* bootstrap_time) {
+    BuildLog();
+
+    for (int i = 1; i <= num_ops; ++i) {
+      const OpId opid = MakeOpId(1, i);
+      AppendReplicateBatch(opid, opid, {TupleForAppend(i, i, "this is a test insert")});
+      if (i % ops_per_segment == 0 && i != num_ops) {
+        ASSERT_OK(RollLog());
+      }
+    }
+
+    ConsensusBootstrapInfo boot_info;
+    shared_ptr<TabletClass> tablet;
+    auto start = MonoTime::Now(MonoTime::FINE);
+    ASSERT_OK(BootstrapTestTablet(-1, -1, &tablet, &boot_info));
+    if (bootstrap_time) {
+      *bootstrap_time = MonoTime::Now(MonoTime::FINE).GetDeltaSince(start);
+    }
+
+    ASSERT_EQ(boot_info.orphaned_replicates.size(), 0);
+    ASSERT_OPID_EQ(boot_info.last_committed_id, MakeOpId(1, num_ops));
+
+    vector<string> results;
+    IterateTabletRows(tablet.get(), &results);
+    ASSERT_EQ(num_ops, results.size());
+  }
 };
 
 // Tests a normal bootstrap scenario
@@ -341,5 +380,25 @@ TEST_F(BootstrapTest, TestConsensusOnlyOperationOutOfOrderHybridTime) {
   ASSERT_EQ(1, results.size());
 }
 
+// Replays a log of several segments with read-ahead enabled, using batches that do not divide
+// the number of operations in a segment.
+TEST_F(BootstrapTest, TestReplayMultiSegmentLog) {
+  FLAGS_tablet_bootstrap_read_ahead_segments = 2;
+  FLAGS_tablet_bootstrap_replay_batch_ops = 7;
+  ASSERT_NO_FATALS(ReplayMultiSegmentLog(300 /* num_ops */, 50 /* ops_per_segment */, nullptr));
+}
+
+// Measures time of replaying a multi-segment log. Segment read-ahead and batching of replayed
+// writes could be disabled using --tablet_bootstrap_read_ahead_segments=0 and
+// --tablet_bootstrap_replay_batch_ops=1 to compare with sequential replay.
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(BootstrapTest, DISABLED_BenchmarkBootstrap) {
+  MonoDelta bootstrap_time;
+  ASSERT_NO_FATALS(ReplayMultiSegmentLog(
+      FLAGS_bootstrap_test_num_ops, FLAGS_bootstrap_test_ops_per_segment, &bootstrap_time));
+  LOG(INFO) << "Bootstrapped " << FLAGS_bootstrap_test_num_ops << " operations in "
+            << bootstrap_time.ToString();
+}
+
 } // namespace tablet
 } // namespace yb
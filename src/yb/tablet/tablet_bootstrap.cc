@@ -31,6 +31,10 @@
 //
 #include "yb/tablet/tablet_bootstrap.h"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
 #include "yb/consensus/consensus.h"
 #include "yb/consensus/log_anchor_registry.h"
 #include "yb/consensus/log_reader.h"
@@ -45,7 +49,9 @@
 #include "yb/util/flag_tags.h"
 #include "yb/util/opid.h"
 #include "yb/util/logging.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/stopwatch.h"
+#include "yb/util/thread.h"
 
 DEFINE_bool(skip_remove_old_recovery_dir, false,
             "Skip removing WAL recovery dir after startup. (useful for debugging)");
@@ -55,6 +61,22 @@ DEFINE_test_flag(double, fault_crash_during_log_replay, 0.0,
                  "Fraction of the time when the tablet will crash immediately "
                  "after processing a log entry during log replay.");
 
+DEFINE_int32(tablet_bootstrap_read_ahead_segments, 1,
+             "Number of log segments that are read and decoded on a separate thread ahead of the "
+             "segment that is being replayed during tablet bootstrap. 0 to read segments on the "
+             "replaying thread.");
+TAG_FLAG(tablet_bootstrap_read_ahead_segments, advanced);
+
+DEFINE_int32(tablet_bootstrap_replay_batch_ops, 64,
+             "Max number of replayed non-transactional write operations that are written to "
+             "RocksDB as a single batch during tablet bootstrap. 1 to write them one by one.");
+TAG_FLAG(tablet_bootstrap_replay_batch_ops, advanced);
+
+DEFINE_int32(tablet_bootstrap_replay_batch_bytes, 4_MB,
+             "Max size of a RocksDB write batch of replayed write operations during tablet "
+             "bootstrap.");
+TAG_FLAG(tablet_bootstrap_replay_batch_bytes, advanced);
+
 DECLARE_uint64(max_clock_sync_error_usec);
 
 namespace yb {
@@ -102,6 +124,93 @@ static string DebugInfo(const string& tablet_id,
                     segment_path, debug_str);
 }
 
+namespace {
+
+// Reads entries of log segments on a separate thread, up to read_ahead segments ahead of the
+// segment that is being replayed, so that reading and decoding of the log overlaps with replay.
+class SegmentReadAhead {
+ public:
+  SegmentReadAhead(const log::SegmentSequence& segments, size_t read_ahead)
+      : segments_(segments), read_ahead_(read_ahead) {
+  }
+
+  ~SegmentReadAhead() {
+    if (!thread_) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cond_.notify_all();
+    thread_->Join();
+  }
+
+  CHECKED_STATUS Start() {
+    if (read_ahead_ == 0 || segments_.size() < 2) {
+      return Status::OK();
+    }
+    return Thread::Create("tablet", "bootstrap-read-ahead", &SegmentReadAhead::Run, this, &thread_);
+  }
+
+  // Fills 'entries' with entries of the next segment. Returns status of reading this segment,
+  // entries read before the failure are returned as well.
+  CHECKED_STATUS Next(log::LogEntries* entries) {
+    if (!thread_) {
+      return segments_[next_segment_++]->ReadEntries(entries);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return !read_segments_.empty(); });
+    auto& segment = read_segments_.front();
+    *entries = std::move(segment.entries);
+    Status result = std::move(segment.status);
+    read_segments_.pop_front();
+    cond_.notify_all();
+    return result;
+  }
+
+ private:
+  struct ReadSegment {
+    log::LogEntries entries;
+    Status status;
+  };
+
+  void Run() {
+    for (const auto& segment : segments_) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return stop_ || read_segments_.size() < read_ahead_; });
+        if (stop_) {
+          return;
+        }
+      }
+
+      ReadSegment read_segment;
+      read_segment.status = segment->ReadEntries(&read_segment.entries);
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        read_segments_.push_back(std::move(read_segment));
+      }
+      cond_.notify_all();
+    }
+  }
+
+  const log::SegmentSequence& segments_;
+  const size_t read_ahead_;
+  // Used when segments are read on the replaying thread.
+  size_t next_segment_ = 0;
+
+  scoped_refptr<Thread> thread_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<ReadSegment> read_segments_;
+  bool stop_ = false;
+};
+
+} // namespace
+
 // ============================================================================
 //  Class ReplayState.
 // ============================================================================
@@ -755,6 +864,12 @@ Status TabletBootstrap::HandleEntryPair(LogEntryPB* replicate_entry,
   const OperationType op_type =
       commit == nullptr ? replicate_entry->replicate().op_type() : commit->op_type();
 
+  // Only non-transactional writes could be batched, other operations should observe all previous
+  // writes in RocksDB.
+  if (op_type != consensus::WRITE_OP) {
+    FlushReplayedWrites();
+  }
+
   {
     const auto status = HandleOperation(op_type, replicate, commit);
     if (!status.ok()) {
@@ -870,11 +985,18 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
   // writing.
   RETURN_NOT_OK_PREPEND(OpenNewLog(), "Failed to open new log");
 
+  // Entries with index not greater than state.last_stored_op_id are already flushed to RocksDB, so
+  // they are only copied to the new log without being applied. They still have to be read, because
+  // the whole log is rewritten during bootstrap, but the next segments are read on a separate
+  // thread while the current one is being replayed.
+  SegmentReadAhead read_ahead(segments, std::max(FLAGS_tablet_bootstrap_read_ahead_segments, 0));
+  RETURN_NOT_OK(read_ahead.Start());
+
   int segment_count = 0;
   for (const scoped_refptr<ReadableLogSegment>& segment : segments) {
     log::LogEntries entries;
     // TODO: Optimize this to not read the whole thing into memory?
-    Status read_status = segment->ReadEntries(&entries);
+    Status read_status = read_ahead.Next(&entries);
     for (int entry_idx = 0; entry_idx < entries.size(); ++entry_idx) {
       Status s = HandleEntry(&state, &entries[entry_idx]);
       if (!s.ok()) {
@@ -913,6 +1035,8 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
     segment_count++;
   }
 
+  FlushReplayedWrites();
+
   // If we have non-applied commits they all must belong to pending operations and
   // they should only pertain to unflushed stores. This is specific to Kudu tables, because we don't
   // use local COMMIT messages in YB tables.
@@ -1169,7 +1293,21 @@ Status TabletBootstrap::PlayRowOperations(WriteOperationState* operation_state,
       break;
     case TableType::YQL_TABLE_TYPE: FALLTHROUGH_INTENDED;
     case TableType::REDIS_TABLE_TYPE:
-      tablet_->ApplyRowOperations(operation_state);
+      if (FLAGS_tablet_bootstrap_replay_batch_ops > 1 &&
+          !operation_state->request()->write_batch().has_transaction()) {
+        tablet_->ReplayKeyValueRowOperations(operation_state, &replay_write_batch_);
+        ++replay_write_batch_ops_;
+        replay_write_batch_oldest_hybrid_time_ = std::min(
+            replay_write_batch_oldest_hybrid_time_, operation_state->hybrid_time());
+        const auto max_ops = static_cast<size_t>(FLAGS_tablet_bootstrap_replay_batch_ops);
+        const auto max_bytes = static_cast<size_t>(FLAGS_tablet_bootstrap_replay_batch_bytes);
+        if (replay_write_batch_ops_ >= max_ops || replay_write_batch_.GetDataSize() >= max_bytes) {
+          FlushReplayedWrites();
+        }
+      } else {
+        FlushReplayedWrites();
+        tablet_->ApplyRowOperations(operation_state);
+      }
       break;
     default:
       LOG(FATAL) << "Invalid table type: " << tablet_->table_type();
@@ -1178,6 +1316,15 @@ Status TabletBootstrap::PlayRowOperations(WriteOperationState* operation_state,
   return Status::OK();
 }
 
+void TabletBootstrap::FlushReplayedWrites() {
+  if (replay_write_batch_ops_ == 0) {
+    return;
+  }
+  tablet_->WriteReplayedBatch(&replay_write_batch_, replay_write_batch_oldest_hybrid_time_);
+  replay_write_batch_ops_ = 0;
+  replay_write_batch_oldest_hybrid_time_ = HybridTime::kMax;
+}
+
 Status TabletBootstrap::FilterAndApplyOperations(WriteOperationState* operation_state,
                                                  const TxResultPB* orig_result) {
   int32_t op_idx = 0;
@@ -36,6 +36,7 @@
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/log_reader.h"
+#include "yb/rocksdb/write_batch.h"
 
 namespace yb {
 namespace tablet {
@@ -229,6 +230,9 @@ class TabletBootstrap {
   Status PlayRowOperations(WriteOperationState* operation_state,
                            const TxResultPB* result);
 
+  // Writes non-transactional writes, that were replayed but not written to RocksDB yet.
+  void FlushReplayedWrites();
+
   // Pass through all of the decoded operations in operation_state. For
   // each op:
   // - if it was previously failed, mark as failed
@@ -334,6 +338,12 @@ class TabletBootstrap {
 
   HybridTime rocksdb_last_entry_hybrid_time_ = HybridTime::kMin;
 
+  // Non-transactional writes of RocksDB-backed tables are accumulated here during replay and
+  // written to RocksDB together, see FLAGS_tablet_bootstrap_replay_batch_ops.
+  rocksdb::WriteBatch replay_write_batch_;
+  size_t replay_write_batch_ops_ = 0;
+  HybridTime replay_write_batch_oldest_hybrid_time_ = HybridTime::kMax;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(TabletBootstrap);
 };
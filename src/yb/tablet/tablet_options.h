@@ -15,15 +15,29 @@
 
 namespace rocksdb {
 class EventListener;
+class RateLimiter;
 }
 
 namespace yb {
+
+class PriorityThreadPool;
+
 namespace tablet {
 
+class QLScanCache;
+
 struct TabletOptions {
   std::shared_ptr<rocksdb::Cache> block_cache;
   std::shared_ptr<rocksdb::MemoryMonitor> memory_monitor;
   std::vector<std::shared_ptr<rocksdb::EventListener>> listeners;
+  // Rate limiter for flushes and compactions shared across tablets. If not set, each tablet uses
+  // its own rate limiter. Flushes are still run by env, not by the compaction pool below.
+  std::shared_ptr<rocksdb::RateLimiter> rate_limiter;
+  // Thread pool for compactions shared across tablets. If not set, compactions are run by env.
+  std::shared_ptr<PriorityThreadPool> priority_thread_pool_for_compactions;
+  // Cache of the scans of paged QL reads shared across tablets. If not set, every page of a read
+  // starts a new scan.
+  std::shared_ptr<QLScanCache> ql_scan_cache;
 };
 
 } // namespace tablet
@@ -149,7 +149,8 @@ Status TabletPeer::InitTabletPeer(const shared_ptr<TabletClass> &tablet,
                                   const scoped_refptr<server::Clock> &clock,
                                   const shared_ptr<Messenger> &messenger,
                                   const scoped_refptr<Log> &log,
-                                  const scoped_refptr<MetricEntity> &metric_entity) {
+                                  const scoped_refptr<MetricEntity> &metric_entity,
+                                  consensus::MultiRaftManager* multi_raft_manager) {
 
   DCHECK(tablet) << "A TabletPeer must be provided with a Tablet";
   DCHECK(log) << "A TabletPeer must be provided with a Log";
@@ -165,6 +166,7 @@ Status TabletPeer::InitTabletPeer(const shared_ptr<TabletClass> &tablet,
 
     ConsensusOptions options;
     options.tablet_id = meta_->tablet_id();
+    options.multi_raft_manager = multi_raft_manager;
 
     TRACE("Creating consensus instance");
 
@@ -635,6 +637,14 @@ Status TabletPeer::StartReplicaOperation(const scoped_refptr<ConsensusRound>& ro
   return Status::OK();
 }
 
+void TabletPeer::StartApplyGroup() {
+  tablet_->StartApplyGroup();
+}
+
+void TabletPeer::FinishApplyGroup() {
+  tablet_->FinishApplyGroup();
+}
+
 string TabletPeer::permanent_uuid() const {
   if (cached_permanent_uuid_initialized_.load(std::memory_order_acquire)) {
     return cached_permanent_uuid_;
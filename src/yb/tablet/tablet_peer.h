@@ -105,7 +105,8 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
                                 const scoped_refptr<server::Clock> &clock,
                                 const std::shared_ptr<rpc::Messenger> &messenger,
                                 const scoped_refptr<log::Log> &log,
-                                const scoped_refptr<MetricEntity> &metric_entity);
+                                const scoped_refptr<MetricEntity> &metric_entity,
+                                consensus::MultiRaftManager* multi_raft_manager = nullptr);
 
   // Starts the TabletPeer, making it available for Write()s. If this
   // TabletPeer is part of a consensus configuration this will connect it to other peers
@@ -150,6 +151,9 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
   virtual CHECKED_STATUS StartReplicaOperation(
       const scoped_refptr<consensus::ConsensusRound>& round) override;
 
+  void StartApplyGroup() override;
+  void FinishApplyGroup() override;
+
   consensus::Consensus* consensus() const {
     std::lock_guard<simple_spinlock> lock(lock_);
     return consensus_.get();
@@ -185,7 +185,9 @@ class TransactionState {
     }
   }
 
-  CHECKED_STATUS GetStatus(tserver::GetTransactionStatusResponsePB* response) const {
+  // Response is either GetTransactionStatusResponsePB or TransactionStatusEntryPB.
+  template <class Response>
+  CHECKED_STATUS GetStatus(Response* response) const {
     if (status_ == TransactionStatus::COMMITTED) {
       response->set_status(TransactionStatus::COMMITTED);
       response->set_status_hybrid_time(commit_time_.ToUint64());
@@ -481,20 +483,34 @@ class TransactionCoordinator::Impl : public TransactionStateContext {
     rpcs_.Shutdown();
   }
 
-  CHECKED_STATUS GetStatus(const std::string& transaction_id,
+  CHECKED_STATUS GetStatus(const tserver::GetTransactionStatusRequestPB& request,
                            tserver::GetTransactionStatusResponsePB* response) {
-    auto id = FullyDecodeTransactionId(transaction_id);
-    if (!id.ok()) {
-      return std::move(id.status());
+    if (request.transaction_ids().empty()) {
+      auto id = FullyDecodeTransactionId(request.transaction_id());
+      if (!id.ok()) {
+        return std::move(id.status());
+      }
+
+      std::lock_guard<std::mutex> lock(managed_mutex_);
+      return GetStatusUnlocked(*id, response);
     }
 
+    std::vector<TransactionId> ids;
+    ids.reserve(request.transaction_ids().size());
+    for (const auto& transaction_id : request.transaction_ids()) {
+      auto id = FullyDecodeTransactionId(transaction_id);
+      if (!id.ok()) {
+        return std::move(id.status());
+      }
+      ids.push_back(*id);
+    }
+
+    // Statuses of all requested transactions are collected under a single lock acquisition.
     std::lock_guard<std::mutex> lock(managed_mutex_);
-    auto it = managed_transactions_.find(*id);
-    if (it == managed_transactions_.end()) {
-      response->set_status(TransactionStatus::ABORTED);
-      return Status::OK();
+    for (const auto& id : ids) {
+      RETURN_NOT_OK(GetStatusUnlocked(id, response->add_statuses()));
     }
-    return it->GetStatus(response);
+    return Status::OK();
   }
 
   void Abort(const std::string& transaction_id, TransactionAbortCallback callback) {
@@ -596,6 +612,10 @@ class TransactionCoordinator::Impl : public TransactionStateContext {
         request->completion_callback()->CompleteWithStatus(Status::OK());
         return;
       }
+      // APPLYING is sent only after the commit was replicated by the status tablet, so the commit
+      // time is known to the participant before the apply is replicated and intents are resolved
+      // locally meanwhile.
+      transaction_participant_.Committed(*id, HybridTime(state.commit_hybrid_time()));
       context_.SubmitUpdateTransaction(std::move(request));
       return;
     }
@@ -660,6 +680,17 @@ class TransactionCoordinator::Impl : public TransactionStateContext {
       >
   > ManagedTransactions;
 
+  // Should be called with managed_mutex_ held.
+  template <class Response>
+  CHECKED_STATUS GetStatusUnlocked(const TransactionId& id, Response* response) {
+    auto it = managed_transactions_.find(id);
+    if (it == managed_transactions_.end()) {
+      response->set_status(TransactionStatus::ABORTED);
+      return Status::OK();
+    }
+    return it->GetStatus(response);
+  }
+
   void ExecutePostponedLeaderActions(PostponedLeaderActions* actions) {
     if (!actions->leader) {
       return;
@@ -825,9 +856,9 @@ void TransactionCoordinator::Shutdown() {
   impl_->Shutdown();
 }
 
-Status TransactionCoordinator::GetStatus(const std::string& transaction_id,
+Status TransactionCoordinator::GetStatus(const tserver::GetTransactionStatusRequestPB& request,
                                          tserver::GetTransactionStatusResponsePB* response) {
-  return impl_->GetStatus(transaction_id, response);
+  return impl_->GetStatus(request, response);
 }
 
 void TransactionCoordinator::Abort(const std::string& transaction_id,
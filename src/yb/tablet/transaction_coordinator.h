@@ -46,6 +46,7 @@ class Clock;
 namespace tserver {
 
 class AbortTransactionResponsePB;
+class GetTransactionStatusRequestPB;
 class GetTransactionStatusResponsePB;
 class TransactionStatePB;
 
@@ -116,7 +117,8 @@ class TransactionCoordinator {
   // And like most of other Shutdowns in our codebase it wait until shutdown completes.
   void Shutdown();
 
-  CHECKED_STATUS GetStatus(const std::string& transaction_id,
+  // Fills statuses of transactions from request, see GetTransactionStatusRequestPB.
+  CHECKED_STATUS GetStatus(const tserver::GetTransactionStatusRequestPB& request,
                            tserver::GetTransactionStatusResponsePB* response);
 
   void Abort(const std::string& transaction_id, TransactionAbortCallback callback);
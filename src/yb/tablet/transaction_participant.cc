@@ -15,7 +15,9 @@
 
 #include "yb/tablet/transaction_participant.h"
 
+#include <deque>
 #include <mutex>
+#include <unordered_map>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
@@ -25,6 +27,8 @@
 
 #include <boost/uuid/uuid_io.hpp>
 
+#include <gflags/gflags.h>
+
 #include "yb/rocksdb/write_batch.h"
 
 #include "yb/client/transaction_rpc.h"
@@ -36,16 +40,86 @@
 
 #include "yb/tserver/tserver_service.pb.h"
 
+#include "yb/util/flag_tags.h"
 #include "yb/util/locks.h"
+#include "yb/util/metrics.h"
 #include "yb/util/monotime.h"
 
 using namespace std::placeholders;
 
+DEFINE_int32(transaction_status_cache_size, 10000,
+             "Number of finished transactions, whose statuses are remembered by transaction "
+             "participant, so intents of those transactions are resolved without RPC to the "
+             "status tablet.");
+TAG_FLAG(transaction_status_cache_size, advanced);
+
+DEFINE_int32(transaction_status_batch_max_size, 256,
+             "Max number of transactions, whose statuses are requested in a single "
+             "GetTransactionStatus RPC to a status tablet.");
+TAG_FLAG(transaction_status_batch_max_size, advanced);
+
+METRIC_DEFINE_counter(tablet, transaction_status_cache_hits,
+                      "Transaction Status Cache Hits",
+                      yb::MetricUnit::kRequests,
+                      "Number of transaction status requests that were resolved by transaction "
+                      "participant from known statuses, without RPC to the status tablet.");
+
+METRIC_DEFINE_counter(tablet, transaction_status_cache_misses,
+                      "Transaction Status Cache Misses",
+                      yb::MetricUnit::kRequests,
+                      "Number of transaction status requests that required RPC to the status "
+                      "tablet.");
+
+METRIC_DEFINE_counter(tablet, transaction_status_rpcs,
+                      "Transaction Status RPCs",
+                      yb::MetricUnit::kRequests,
+                      "Number of GetTransactionStatus RPCs sent by transaction participant. "
+                      "Single RPC carries statuses of all transactions that were queued for the "
+                      "same status tablet.");
+
+METRIC_DEFINE_counter(tablet, transactions_with_intents,
+                      "Transactions With Intents",
+                      yb::MetricUnit::kTransactions,
+                      "Number of transactions that wrote intents to this tablet. Transactions "
+                      "committed by a single non transactional write are not counted.");
+
 namespace yb {
 namespace tablet {
 
 namespace {
 
+boost::optional<TransactionStatus> GetStatusAt(
+    HybridTime time,
+    HybridTime last_known_status_hybrid_time,
+    TransactionStatus last_known_status) {
+  switch (last_known_status) {
+    case TransactionStatus::ABORTED:
+      return TransactionStatus::ABORTED;
+    case TransactionStatus::COMMITTED:
+      // TODO(dtxn) clock skew
+      return last_known_status_hybrid_time > time
+          ? TransactionStatus::PENDING
+          : TransactionStatus::COMMITTED;
+    case TransactionStatus::PENDING:
+      if (last_known_status_hybrid_time >= time) {
+        return TransactionStatus::PENDING;
+      }
+      return boost::none;
+    default:
+      FATAL_INVALID_ENUM_VALUE(TransactionStatus, last_known_status);
+  }
+}
+
+bool IsFinalStatus(TransactionStatus status) {
+  return status == TransactionStatus::COMMITTED || status == TransactionStatus::ABORTED;
+}
+
+// Status waiter with the result that should be passed to it, after the mutex is released.
+struct StatusNotification {
+  TransactionStatusCallback callback;
+  Result<TransactionStatusResult> result;
+};
+
 class RunningTransaction {
  public:
   RunningTransaction(TransactionMetadata metadata,
@@ -54,12 +128,11 @@ class RunningTransaction {
       : metadata_(std::move(metadata)),
         rpcs_(*rpcs),
         context_(*context),
-        get_status_handle_(rpcs->InvalidHandle()),
         abort_handle_(rpcs->InvalidHandle()) {
   }
 
   ~RunningTransaction() {
-    rpcs_.Abort({&get_status_handle_, &abort_handle_});
+    rpcs_.Abort({&abort_handle_});
   }
 
   const TransactionId& id() const {
@@ -78,38 +151,81 @@ class RunningTransaction {
     local_commit_time_ = time;
   }
 
-  void RequestStatusAt(client::YBClient* client,
-                       HybridTime time,
-                       TransactionStatusCallback callback,
-                       std::unique_lock<std::mutex>* lock) const {
+  void SetCommitted(HybridTime commit_time) const {
+    last_known_status_ = TransactionStatus::COMMITTED;
+    last_known_status_hybrid_time_ = commit_time;
+  }
+
+  // Tries to resolve status at the specified time using known status of this transaction.
+  boost::optional<TransactionStatusResult> KnownStatusAt(HybridTime time) const {
+    if (local_commit_time_.is_valid()) {
+      // Intents of this transaction were applied, so it is committed.
+      auto transaction_status =
+          GetStatusAt(time, local_commit_time_, TransactionStatus::COMMITTED);
+      return TransactionStatusResult{*transaction_status, local_commit_time_};
+    }
     if (last_known_status_hybrid_time_ > HybridTime::kMin) {
       auto transaction_status =
           GetStatusAt(time, last_known_status_hybrid_time_, last_known_status_);
       if (transaction_status) {
-        lock->unlock();
-        callback(TransactionStatusResult{*transaction_status, last_known_status_hybrid_time_});
-        return;
+        return TransactionStatusResult{*transaction_status, last_known_status_hybrid_time_};
       }
     }
+    return boost::none;
+  }
+
+  // Adds waiter, that will be notified when status of this transaction is received from the
+  // status tablet. Returns true if it is the first waiter, i.e. status should be requested.
+  bool AddStatusWaiter(HybridTime time, TransactionStatusCallback callback) const {
     bool was_empty = status_waiters_.empty();
     status_waiters_.push_back(StatusWaiter{std::move(callback), time});
-    if (!was_empty) {
-      return;
+    return was_empty;
+  }
+
+  // Processes status received from the status tablet, should be called with the mutex held.
+  // Waiters that should be notified are appended to notifications.
+  // Returns last known status, if it is final.
+  boost::optional<TransactionStatusResult> StatusReceived(
+      const Status& status,
+      const tserver::TransactionStatusEntryPB* entry,
+      std::vector<StatusNotification>* notifications) const {
+    decltype(status_waiters_) status_waiters;
+    status_waiters_.swap(status_waiters);
+    if (!status.ok()) {
+      for (auto& waiter : status_waiters) {
+        notifications->push_back({std::move(waiter.callback), status});
+      }
+      return boost::none;
     }
-    lock->unlock();
-    auto deadline = MonoTime::FineNow() + MonoDelta::FromSeconds(5); // TODO(dtxn)
-    tserver::GetTransactionStatusRequestPB req;
-    req.set_tablet_id(metadata_.status_tablet);
-    req.set_transaction_id(metadata_.transaction_id.begin(), metadata_.transaction_id.size());
-    req.set_propagated_hybrid_time(context_.Now().ToUint64());
-    rpcs_.RegisterAndStart(
-        client::GetTransactionStatus(
-            deadline,
-            nullptr /* tablet */,
-            client,
-            &req,
-            std::bind(&RunningTransaction::StatusReceived, this, _1, _2, lock->mutex())),
-        &get_status_handle_);
+
+    DCHECK(entry->has_status_hybrid_time() || entry->status() == TransactionStatus::ABORTED);
+    HybridTime time = entry->has_status_hybrid_time()
+        ? HybridTime(entry->status_hybrid_time())
+        : HybridTime::kMax;
+    if (last_known_status_hybrid_time_ <= time) {
+      last_known_status_hybrid_time_ = time;
+      last_known_status_ = entry->status();
+    }
+    time = last_known_status_hybrid_time_;
+    auto transaction_status = last_known_status_;
+    for (auto& waiter : status_waiters) {
+      auto status_for_waiter = GetStatusAt(waiter.time, time, transaction_status);
+      if (status_for_waiter) {
+        notifications->push_back(
+            {std::move(waiter.callback), TransactionStatusResult{*status_for_waiter, time}});
+      } else {
+        notifications->push_back({std::move(waiter.callback), STATUS_FORMAT(
+            TryAgain,
+            "Cannot determine transaction status at $0, last known: $1 at $2",
+            waiter.time,
+            transaction_status,
+            time)});
+      }
+    }
+    if (IsFinalStatus(transaction_status)) {
+      return TransactionStatusResult{transaction_status, time};
+    }
+    return boost::none;
   }
 
   void Abort(client::YBClient* client,
@@ -137,77 +253,6 @@ class RunningTransaction {
   }
 
  private:
-  static boost::optional<TransactionStatus> GetStatusAt(
-      HybridTime time,
-      HybridTime last_known_status_hybrid_time,
-      TransactionStatus last_known_status) {
-    switch (last_known_status) {
-      case TransactionStatus::ABORTED:
-        return TransactionStatus::ABORTED;
-      case TransactionStatus::COMMITTED:
-        // TODO(dtxn) clock skew
-        return last_known_status_hybrid_time > time
-            ? TransactionStatus::PENDING
-            : TransactionStatus::COMMITTED;
-      case TransactionStatus::PENDING:
-        if (last_known_status_hybrid_time >= time) {
-          return TransactionStatus::PENDING;
-        }
-        return boost::none;
-      default:
-        FATAL_INVALID_ENUM_VALUE(TransactionStatus, last_known_status);
-    }
-  }
-
-  void StatusReceived(const Status& status,
-                      const tserver::GetTransactionStatusResponsePB& response,
-                      std::mutex* mutex) const {
-    if (response.has_propagated_hybrid_time()) {
-      context_.UpdateClock(HybridTime(response.propagated_hybrid_time()));
-    }
-
-    rpcs_.Unregister(&get_status_handle_);
-    decltype(status_waiters_) status_waiters;
-    HybridTime time;
-    TransactionStatus transaction_status;
-    {
-      std::unique_lock<std::mutex> lock(*mutex);
-      status_waiters_.swap(status_waiters);
-      if (status.ok()) {
-        DCHECK(response.has_status_hybrid_time() ||
-               response.status() == TransactionStatus::ABORTED);
-        time = response.has_status_hybrid_time()
-            ? HybridTime(response.status_hybrid_time())
-            : HybridTime::kMax;
-        if (last_known_status_hybrid_time_ <= time) {
-          last_known_status_hybrid_time_ = time;
-          last_known_status_ = response.status();
-        }
-        time = last_known_status_hybrid_time_;
-        transaction_status = last_known_status_;
-      }
-    }
-    if (!status.ok()) {
-      for (const auto& waiter : status_waiters) {
-        waiter.callback(status);
-      }
-    } else {
-      for (const auto& waiter : status_waiters) {
-        auto status_for_waiter = GetStatusAt(waiter.time, time, transaction_status);
-        if (status_for_waiter) {
-          waiter.callback(TransactionStatusResult{*status_for_waiter, time});
-        } else {
-          waiter.callback(STATUS_FORMAT(
-              TryAgain,
-              "Cannot determine transaction status at $0, last known: $1 at $2",
-              waiter.time,
-              transaction_status,
-              time));
-        }
-      }
-    }
-  }
-
   static Result<TransactionStatusResult> MakeAbortResult(
       const Status& status,
       const tserver::AbortTransactionResponsePB& response) {
@@ -253,20 +298,69 @@ class RunningTransaction {
   mutable TransactionStatus last_known_status_;
   mutable HybridTime last_known_status_hybrid_time_ = HybridTime::kMin;
   mutable std::vector<StatusWaiter> status_waiters_;
-  mutable rpc::Rpcs::Handle get_status_handle_;
   mutable rpc::Rpcs::Handle abort_handle_;
   mutable std::vector<TransactionStatusCallback> abort_waiters_;
 };
 
+// Bounded cache of statuses of finished, i.e. committed or aborted, transactions. Keeps statuses
+// after the transaction was removed from running transactions. The oldest entry is evicted first.
+class FinishedTransactions {
+ public:
+  boost::optional<TransactionStatusResult> Find(const TransactionId& id) const {
+    auto it = statuses_.find(id);
+    if (it == statuses_.end()) {
+      return boost::none;
+    }
+    return it->second;
+  }
+
+  void Add(const TransactionId& id, const TransactionStatusResult& result) {
+    if (!statuses_.emplace(id, result).second) {
+      return;
+    }
+    order_.push_back(id);
+    const size_t max_size = std::max(FLAGS_transaction_status_cache_size, 0);
+    while (order_.size() > max_size) {
+      statuses_.erase(order_.front());
+      order_.pop_front();
+    }
+  }
+
+ private:
+  std::unordered_map<TransactionId, TransactionStatusResult, TransactionIdHash> statuses_;
+  std::deque<TransactionId> order_;
+};
+
 } // namespace
 
 class TransactionParticipant::Impl {
  public:
-  explicit Impl(TransactionParticipantContext* context)
-      : context_(*context) {}
+  Impl(TransactionParticipantContext* context, const scoped_refptr<MetricEntity>& metric_entity)
+      : context_(*context) {
+    if (metric_entity) {
+      status_cache_hits_ = METRIC_transaction_status_cache_hits.Instantiate(metric_entity);
+      status_cache_misses_ = METRIC_transaction_status_cache_misses.Instantiate(metric_entity);
+      status_rpcs_ = METRIC_transaction_status_rpcs.Instantiate(metric_entity);
+      transactions_with_intents_ = METRIC_transactions_with_intents.Instantiate(metric_entity);
+    }
+  }
 
   ~Impl() {
-    transactions_.clear();
+    std::vector<StatusNotification> notifications;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closing_ = true;
+      // Responses to status requests in progress would not find the transactions after they are
+      // removed, so waiters are notified here.
+      const auto status = STATUS(TryAgain, "Transaction participant is shutting down");
+      for (const auto& transaction : transactions_) {
+        transaction.StatusReceived(status, nullptr /* entry */, &notifications);
+      }
+      transactions_.clear();
+    }
+    for (auto& notification : notifications) {
+      notification.callback(std::move(notification.result));
+    }
     rpcs_.Shutdown();
   }
 
@@ -289,6 +383,7 @@ class TransactionParticipant::Impl {
       }
     }
     if (store) {
+      IncrementCounter(transactions_with_intents_);
       // TODO(dtxn) Load value if it is not loaded.
       docdb::KeyBytes key;
       AppendTransactionKeyPrefix(metadata->transaction_id, &key);
@@ -321,11 +416,31 @@ class TransactionParticipant::Impl {
     std::unique_lock<std::mutex> lock(mutex_);
     auto it = transactions_.find(id);
     if (it == transactions_.end()) {
+      auto finished = finished_transactions_.Find(id);
       lock.unlock();
-      callback(STATUS_FORMAT(NotFound, "Unknown transaction: $1", id));
+      if (finished) {
+        IncrementCounter(status_cache_hits_);
+        auto transaction_status = GetStatusAt(time, finished->status_time, finished->status);
+        callback(TransactionStatusResult{*transaction_status, finished->status_time});
+      } else {
+        callback(STATUS_FORMAT(NotFound, "Unknown transaction: $1", id));
+      }
       return;
     }
-    return it->RequestStatusAt(client(), time, std::move(callback), &lock);
+    auto known_status = it->KnownStatusAt(time);
+    if (known_status) {
+      lock.unlock();
+      IncrementCounter(status_cache_hits_);
+      callback(*known_status);
+      return;
+    }
+    IncrementCounter(status_cache_misses_);
+    if (!it->AddStatusWaiter(time, std::move(callback))) {
+      // Status of this transaction is already requested.
+      return;
+    }
+    auto status_tablet = it->metadata().status_tablet;
+    QueueStatusRequest(status_tablet, id, &lock);
   }
 
   void Abort(const TransactionId& id,
@@ -340,6 +455,16 @@ class TransactionParticipant::Impl {
     return it->Abort(client(), std::move(callback), &lock);
   }
 
+  void Committed(const TransactionId& id, HybridTime commit_time) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = transactions_.find(id);
+    if (it != transactions_.end()) {
+      it->SetCommitted(commit_time);
+    }
+    finished_transactions_.Add(
+        id, TransactionStatusResult{TransactionStatus::COMMITTED, commit_time});
+  }
+
   CHECKED_STATUS ProcessApply(const TransactionApplyData& data) {
     CHECK_OK(data.applier->ApplyIntents(data));
 
@@ -356,6 +481,9 @@ class TransactionParticipant::Impl {
         transactions_.modify(it, [&data](RunningTransaction& transaction) {
           transaction.SetLocalCommitTime(data.commit_time);
         });
+        finished_transactions_.Add(
+            data.transaction_id,
+            TransactionStatusResult{TransactionStatus::COMMITTED, data.commit_time});
         // TODO(dtxn) cleanup
       }
       if (data.mode == ProcessingMode::LEADER) {
@@ -425,19 +553,144 @@ class TransactionParticipant::Impl {
     return it;
   }
 
+  // Transactions, whose statuses should be requested from the same status tablet.
+  struct StatusRequestBatch {
+    std::vector<TransactionId> queued;
+    // Whether GetTransactionStatus RPC to this status tablet is in progress.
+    bool in_flight = false;
+  };
+
+  // Queues status request for the transaction. Requests are sent immediately, when there is no
+  // RPC in progress to the same status tablet. Otherwise they are collected and sent as a single
+  // RPC, when the running one completes. So under load statuses are requested in batches, while
+  // a single request does not wait for anything.
+  // Releases the lock.
+  void QueueStatusRequest(const TabletId& status_tablet,
+                          const TransactionId& id,
+                          std::unique_lock<std::mutex>* lock) {
+    auto& batch = status_batches_[status_tablet];
+    batch.queued.push_back(id);
+    if (batch.in_flight) {
+      lock->unlock();
+      return;
+    }
+    SendStatusRequest(status_tablet, &batch, lock);
+  }
+
+  // Sends queued requests of the batch. Releases the lock.
+  void SendStatusRequest(const TabletId& status_tablet,
+                         StatusRequestBatch* batch,
+                         std::unique_lock<std::mutex>* lock) {
+    if (closing_) {
+      lock->unlock();
+      return;
+    }
+    size_t max_size = std::max(FLAGS_transaction_status_batch_max_size, 1);
+    std::vector<TransactionId> ids;
+    if (batch->queued.size() <= max_size) {
+      ids.swap(batch->queued);
+    } else {
+      ids.assign(batch->queued.begin(), batch->queued.begin() + max_size);
+      batch->queued.erase(batch->queued.begin(), batch->queued.begin() + max_size);
+    }
+    batch->in_flight = true;
+    lock->unlock();
+
+    IncrementCounter(status_rpcs_);
+    auto deadline = MonoTime::FineNow() + MonoDelta::FromSeconds(5); // TODO(dtxn)
+    tserver::GetTransactionStatusRequestPB req;
+    req.set_tablet_id(status_tablet);
+    for (const auto& id : ids) {
+      req.add_transaction_ids(id.begin(), id.size());
+    }
+    req.set_propagated_hybrid_time(context_.Now().ToUint64());
+    auto handle = rpcs_.Prepare();
+    *handle = client::GetTransactionStatus(
+        deadline,
+        nullptr /* tablet */,
+        client(),
+        &req,
+        [this, handle, status_tablet, ids](
+            const Status& status, const tserver::GetTransactionStatusResponsePB& response) {
+          StatusReceived(status, response, status_tablet, ids, handle);
+        });
+    (**handle).SendRpc();
+  }
+
+  void StatusReceived(Status status,
+                      const tserver::GetTransactionStatusResponsePB& response,
+                      const TabletId& status_tablet,
+                      const std::vector<TransactionId>& ids,
+                      rpc::Rpcs::Handle handle) {
+    if (response.has_propagated_hybrid_time()) {
+      context_.UpdateClock(HybridTime(response.propagated_hybrid_time()));
+    }
+    rpcs_.Unregister(handle);
+
+    if (status.ok() && static_cast<size_t>(response.statuses().size()) != ids.size()) {
+      // Conflict resolution expects TryAgain for statuses that could not be determined.
+      status = STATUS_FORMAT(
+          TryAgain, "Wrong number of transaction statuses: $0, expected: $1",
+          response.statuses().size(), ids.size());
+    }
+
+    std::vector<StatusNotification> notifications;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (size_t i = 0; i != ids.size(); ++i) {
+      auto it = transactions_.find(ids[i]);
+      if (it == transactions_.end()) {
+        continue;
+      }
+      auto final_status = it->StatusReceived(
+          status, status.ok() ? &response.statuses(i) : nullptr, &notifications);
+      if (final_status) {
+        finished_transactions_.Add(ids[i], *final_status);
+      }
+    }
+
+    auto batch_it = status_batches_.find(status_tablet);
+    DCHECK(batch_it != status_batches_.end());
+    batch_it->second.in_flight = false;
+    if (batch_it->second.queued.empty()) {
+      status_batches_.erase(batch_it);
+      lock.unlock();
+    } else {
+      SendStatusRequest(status_tablet, &batch_it->second, &lock);
+    }
+
+    for (auto& notification : notifications) {
+      notification.callback(std::move(notification.result));
+    }
+  }
+
+  static void IncrementCounter(const scoped_refptr<Counter>& counter) {
+    if (counter) {
+      counter->Increment();
+    }
+  }
+
   client::YBClient* client() const {
     return context_.client_future().get().get();
   }
 
   TransactionParticipantContext& context_;
 
+  scoped_refptr<Counter> status_cache_hits_;
+  scoped_refptr<Counter> status_cache_misses_;
+  scoped_refptr<Counter> status_rpcs_;
+  scoped_refptr<Counter> transactions_with_intents_;
+
   std::mutex mutex_;
   rpc::Rpcs rpcs_;
   Transactions transactions_;
+  FinishedTransactions finished_transactions_;
+  std::unordered_map<TabletId, StatusRequestBatch> status_batches_;
+  bool closing_ = false;
 };
 
-TransactionParticipant::TransactionParticipant(TransactionParticipantContext* context)
-    : impl_(new Impl(context)) {
+TransactionParticipant::TransactionParticipant(
+    TransactionParticipantContext* context, const scoped_refptr<MetricEntity>& metric_entity)
+    : impl_(new Impl(context, metric_entity)) {
 }
 
 TransactionParticipant::~TransactionParticipant() {
@@ -468,6 +721,10 @@ void TransactionParticipant::Abort(const TransactionId& id,
   return impl_->Abort(id, std::move(callback));
 }
 
+void TransactionParticipant::Committed(const TransactionId& id, HybridTime commit_time) {
+  impl_->Committed(id, commit_time);
+}
+
 CHECKED_STATUS TransactionParticipant::ProcessApply(const TransactionApplyData& data) {
   return impl_->ProcessApply(data);
 }
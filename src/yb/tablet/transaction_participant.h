@@ -29,6 +29,8 @@
 
 #include "yb/consensus/opid_util.h"
 
+#include "yb/gutil/ref_counted.h"
+
 #include "yb/util/opid.pb.h"
 #include "yb/util/result.h"
 
@@ -42,6 +44,7 @@ class WriteBatch;
 namespace yb {
 
 class HybridTime;
+class MetricEntity;
 class TransactionMetadataPB;
 
 namespace tablet {
@@ -81,9 +84,15 @@ class TransactionParticipantContext {
 // TransactionParticipant manages running transactions, i.e. transactions that have intents in
 // appropriate tablet. Since this class manages transactions of tablet there is separate class
 // instance per tablet.
+//
+// Statuses of transactions are requested from their status tablets. Requests to the same status
+// tablet, that were issued while a previous request is in progress, are sent as a single RPC.
+// Statuses of finished transactions are remembered, so subsequent requests are resolved locally.
 class TransactionParticipant : public TransactionStatusManager {
  public:
-  explicit TransactionParticipant(TransactionParticipantContext* context);
+  // metric_entity could be null, in this case metrics are not tracked.
+  TransactionParticipant(TransactionParticipantContext* context,
+                         const scoped_refptr<MetricEntity>& metric_entity);
   virtual ~TransactionParticipant();
 
   // Adds new running transaction.
@@ -99,6 +108,11 @@ class TransactionParticipant : public TransactionStatusManager {
 
   void Abort(const TransactionId& id, TransactionStatusCallback callback) override;
 
+  // Notifies participant that the transaction was committed at the specified time. Invoked when
+  // the request to apply the transaction is received, so intents of this transaction are resolved
+  // without RPC to the status tablet, while the apply is being replicated.
+  void Committed(const TransactionId& id, HybridTime commit_time);
+
   CHECKED_STATUS ProcessApply(const TransactionApplyData& data);
 
  private:
@@ -0,0 +1,355 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tools/bulk_load_sst_writer.h"
+
+#include <algorithm>
+#include <queue>
+
+#include <glog/logging.h>
+
+#include "yb/rocksdb/db.h"
+#include "yb/rocksdb/immutable_options.h"
+#include "yb/rocksdb/sst_file_writer.h"
+#include "yb/rocksdb/util/coding.h"
+
+#include "yb/docdb/docdb.h"
+#include "yb/docdb/primitive_value.h"
+#include "yb/tools/bulk_load_docdb_util.h"
+#include "yb/util/env.h"
+#include "yb/util/env_util.h"
+#include "yb/util/format.h"
+#include "yb/util/path_util.h"
+#include "yb/util/size_literals.h"
+
+namespace yb {
+namespace tools {
+
+namespace {
+
+constexpr size_t kRunFileBufferSize = 1_MB;
+
+// Sorted sequence of records, that could be iterated once.
+class SortedRun {
+ public:
+  virtual ~SortedRun() {}
+
+  // Moves to the next record, should be called before accessing the first one.
+  // Returns false when there are no more records.
+  virtual Result<bool> Next() = 0;
+
+  virtual Slice key() const = 0;
+  virtual Slice value() const = 0;
+};
+
+class MemoryRun : public SortedRun {
+ public:
+  explicit MemoryRun(std::vector<std::pair<std::string, std::string>> records)
+      : records_(std::move(records)) {}
+
+  Result<bool> Next() override {
+    if (started_) {
+      ++index_;
+    }
+    started_ = true;
+    return index_ < records_.size();
+  }
+
+  Slice key() const override { return records_[index_].first; }
+  Slice value() const override { return records_[index_].second; }
+
+ private:
+  std::vector<std::pair<std::string, std::string>> records_;
+  size_t index_ = 0;
+  bool started_ = false;
+};
+
+// Run stored in file, where each record is stored as fixed32 key size, key, fixed32 value size and
+// value.
+class FileRun : public SortedRun {
+ public:
+  static Result<std::unique_ptr<FileRun>> Open(const std::string& path) {
+    gscoped_ptr<SequentialFile> file;
+    RETURN_NOT_OK(Env::Default()->NewSequentialFile(path, &file));
+    return std::unique_ptr<FileRun>(new FileRun(std::move(file)));
+  }
+
+  Result<bool> Next() override {
+    uint32_t size = 0;
+    auto has_data = Read(sizeof(size), &key_);
+    RETURN_NOT_OK(has_data);
+    if (!*has_data) {
+      return false;
+    }
+    size = rocksdb::DecodeFixed32(key_.data());
+    RETURN_NOT_OK(ReadRequired(size, &key_));
+    RETURN_NOT_OK(ReadRequired(sizeof(size), &value_));
+    size = rocksdb::DecodeFixed32(value_.data());
+    RETURN_NOT_OK(ReadRequired(size, &value_));
+    return true;
+  }
+
+  Slice key() const override { return key_; }
+  Slice value() const override { return value_; }
+
+ private:
+  explicit FileRun(gscoped_ptr<SequentialFile> file)
+      : file_(std::move(file)), scratch_(new uint8_t[kRunFileBufferSize]) {}
+
+  // Reads exactly size bytes to out, returns false if the end of file is reached before the first
+  // byte.
+  Result<bool> Read(size_t size, std::string* out) {
+    out->clear();
+    while (out->size() < size) {
+      if (buffer_.empty()) {
+        RETURN_NOT_OK(file_->Read(kRunFileBufferSize, &buffer_, scratch_.get()));
+        if (buffer_.empty()) {
+          if (out->empty()) {
+            return false;
+          }
+          return STATUS_FORMAT(Corruption, "Unexpected end of run file $0", file_->filename());
+        }
+      }
+      const size_t len = std::min(size - out->size(), buffer_.size());
+      out->append(buffer_.cdata(), len);
+      buffer_.remove_prefix(len);
+    }
+    return true;
+  }
+
+  CHECKED_STATUS ReadRequired(size_t size, std::string* out) {
+    auto has_data = Read(size, out);
+    RETURN_NOT_OK(has_data);
+    if (!*has_data && size != 0) {
+      return STATUS_FORMAT(Corruption, "Unexpected end of run file $0", file_->filename());
+    }
+    return Status::OK();
+  }
+
+  gscoped_ptr<SequentialFile> file_;
+  std::unique_ptr<uint8_t[]> scratch_;
+  Slice buffer_;
+  std::string key_;
+  std::string value_;
+};
+
+// Writes merged records to SST files of target size and adds them to DB.
+class OutputWriter {
+ public:
+  OutputWriter(BulkLoadDocDBUtil* db_util, const std::string& tmp_dir, size_t target_file_size)
+      : db_util_(db_util),
+        tmp_dir_(tmp_dir),
+        target_file_size_(target_file_size),
+        ioptions_(db_util->options()) {}
+
+  CHECKED_STATUS Add(const Slice& key, const Slice& value) {
+    if (!writer_) {
+      const auto& options = db_util_->options();
+      writer_.reset(new rocksdb::SstFileWriter(
+          rocksdb::EnvOptions(), ioptions_, options.comparator, options.boundary_extractor.get()));
+      RETURN_NOT_OK(writer_->Open(JoinPathSegments(tmp_dir_, Format("$0.sst", num_files_))));
+      file_size_ = 0;
+    }
+    RETURN_NOT_OK(writer_->Add(key, value));
+    file_size_ += key.size() + value.size();
+    if (file_size_ >= target_file_size_) {
+      return FinishFile();
+    }
+    return Status::OK();
+  }
+
+  CHECKED_STATUS FinishFile() {
+    if (!writer_) {
+      return Status::OK();
+    }
+    rocksdb::ExternalSstFileInfo file_info;
+    RETURN_NOT_OK(writer_->Finish(&file_info));
+    writer_.reset();
+    ++num_files_;
+    return db_util_->rocksdb()->AddFile(&file_info, /* move_file */ true);
+  }
+
+  size_t num_files() const { return num_files_; }
+
+ private:
+  BulkLoadDocDBUtil* const db_util_;
+  const std::string tmp_dir_;
+  const size_t target_file_size_;
+  const rocksdb::ImmutableCFOptions ioptions_;
+  std::unique_ptr<rocksdb::SstFileWriter> writer_;
+  size_t file_size_ = 0;
+  size_t num_files_ = 0;
+};
+
+} // namespace
+
+BulkLoadSstWriter::BulkLoadSstWriter(BulkLoadDocDBUtil* db_util, std::string tmp_dir,
+                                     size_t sort_buffer_size, size_t target_file_size)
+    : db_util_(db_util),
+      tmp_dir_(std::move(tmp_dir)),
+      sort_buffer_size_(sort_buffer_size),
+      target_file_size_(target_file_size) {
+}
+
+BulkLoadSstWriter::~BulkLoadSstWriter() {
+  if (Env::Default()->FileExists(tmp_dir_)) {
+    WARN_NOT_OK(Env::Default()->DeleteRecursively(tmp_dir_),
+                "Failed to remove bulk load temporary directory");
+  }
+}
+
+size_t BulkLoadSstWriter::num_runs() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return run_files_.size();
+}
+
+Status BulkLoadSstWriter::Add(const docdb::DocWriteBatch& write_batch, HybridTime hybrid_time) {
+  // Write id is not incremented, the same as in BulkLoadDocDBUtil::WriteToRocksDB.
+  const auto encoded_ht = docdb::PrimitiveValue(DocHybridTime(hybrid_time, 0)).ToKeyBytes();
+  Records records;
+  records.reserve(write_batch.key_value_pairs().size());
+  size_t size = 0;
+  for (const auto& entry : write_batch.key_value_pairs()) {
+    records.emplace_back(entry.first + encoded_ht.data(), entry.second);
+    size += records.back().first.size() + records.back().second.size();
+  }
+
+  std::string run_path;
+  Records run;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::move(records.begin(), records.end(), std::back_inserter(buffer_));
+    buffer_size_ += size;
+    if (buffer_size_ < sort_buffer_size_) {
+      return Status::OK();
+    }
+    run.swap(buffer_);
+    buffer_size_ = 0;
+    run_path = JoinPathSegments(tmp_dir_, Format("run-$0", run_files_.size()));
+    run_files_.push_back(run_path);
+  }
+
+  // Sort and spill outside of the lock, so other threads could continue to add records.
+  return SpillRun(run_path, std::move(run));
+}
+
+void BulkLoadSstWriter::SortRecords(Records* records) const {
+  const auto* comparator = db_util_->options().comparator;
+  std::stable_sort(records->begin(), records->end(),
+                   [comparator](const auto& lhs, const auto& rhs) {
+    return comparator->Compare(lhs.first, rhs.first) < 0;
+  });
+  // Keep the last one of records with equal keys, as it would be with memtable.
+  auto out = records->begin();
+  for (auto it = records->begin(); it != records->end(); ++it) {
+    auto next = it + 1;
+    if (next != records->end() && comparator->Compare(it->first, next->first) == 0) {
+      continue;
+    }
+    if (out != it) {
+      *out = std::move(*it);
+    }
+    ++out;
+  }
+  records->erase(out, records->end());
+}
+
+Status BulkLoadSstWriter::SpillRun(const std::string& path, Records records) const {
+  SortRecords(&records);
+  RETURN_NOT_OK(env_util::CreateDirIfMissing(Env::Default(), tmp_dir_));
+  gscoped_ptr<WritableFile> file;
+  RETURN_NOT_OK(Env::Default()->NewWritableFile(path, &file));
+  std::string buffer;
+  for (const auto& record : records) {
+    rocksdb::PutFixed32(&buffer, static_cast<uint32_t>(record.first.size()));
+    buffer.append(record.first);
+    rocksdb::PutFixed32(&buffer, static_cast<uint32_t>(record.second.size()));
+    buffer.append(record.second);
+    if (buffer.size() >= kRunFileBufferSize) {
+      RETURN_NOT_OK(file->Append(buffer));
+      buffer.clear();
+    }
+  }
+  RETURN_NOT_OK(file->Append(buffer));
+  return file->Close();
+}
+
+Status BulkLoadSstWriter::Finish() {
+  RETURN_NOT_OK(env_util::CreateDirIfMissing(Env::Default(), tmp_dir_));
+
+  Records last_run;
+  last_run.swap(buffer_);
+  buffer_size_ = 0;
+  SortRecords(&last_run);
+
+  // Runs are ordered by creation, so the records that were added later are in the runs with
+  // higher index.
+  std::vector<std::unique_ptr<SortedRun>> runs;
+  for (const auto& path : run_files_) {
+    auto run = FileRun::Open(path);
+    RETURN_NOT_OK(run);
+    runs.push_back(std::move(*run));
+  }
+  runs.emplace_back(new MemoryRun(std::move(last_run)));
+
+  const auto* comparator = db_util_->options().comparator;
+  // Heap of run indexes, with the smallest key on top. Equal keys are ordered by run index.
+  auto greater = [&runs, comparator](size_t lhs, size_t rhs) {
+    const auto result = comparator->Compare(runs[lhs]->key(), runs[rhs]->key());
+    return result > 0 || (result == 0 && lhs > rhs);
+  };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+  for (size_t i = 0; i != runs.size(); ++i) {
+    auto has_record = runs[i]->Next();
+    RETURN_NOT_OK(has_record);
+    if (*has_record) {
+      heap.push(i);
+    }
+  }
+
+  OutputWriter writer(db_util_, tmp_dir_, target_file_size_);
+  // The record is written only after we make sure that there is no record with equal key in
+  // subsequent runs.
+  std::string pending_key;
+  std::string pending_value;
+  bool has_pending = false;
+  while (!heap.empty()) {
+    const auto index = heap.top();
+    heap.pop();
+    auto& run = *runs[index];
+    if (has_pending && comparator->Compare(pending_key, run.key()) != 0) {
+      RETURN_NOT_OK(writer.Add(pending_key, pending_value));
+    }
+    pending_key.assign(run.key().cdata(), run.key().size());
+    pending_value.assign(run.value().cdata(), run.value().size());
+    has_pending = true;
+
+    auto has_record = run.Next();
+    RETURN_NOT_OK(has_record);
+    if (*has_record) {
+      heap.push(index);
+    }
+  }
+  if (has_pending) {
+    RETURN_NOT_OK(writer.Add(pending_key, pending_value));
+  }
+  RETURN_NOT_OK(writer.FinishFile());
+  num_files_ = writer.num_files();
+
+  LOG(INFO) << "Wrote " << num_files_ << " SST files from " << runs.size() << " sorted runs to "
+            << db_util_->rocksdb_dir();
+  return Status::OK();
+}
+
+} // namespace tools
+} // namespace yb
@@ -0,0 +1,83 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TOOLS_BULK_LOAD_SST_WRITER_H
+#define YB_TOOLS_BULK_LOAD_SST_WRITER_H
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "yb/common/hybrid_time.h"
+#include "yb/util/status.h"
+
+namespace yb {
+
+namespace docdb {
+
+class DocWriteBatch;
+
+} // namespace docdb
+
+namespace tools {
+
+class BulkLoadDocDBUtil;
+
+// Writes DocDB records of a tablet to non overlapping SST files, without going through memtable.
+//
+// Added records are buffered in memory. When the buffer exceeds sort_buffer_size, it is sorted and
+// spilled to a run file in tmp_dir. Finish merges all sorted runs, writes the result to SST files
+// of about target_file_size bytes and adds them to the RocksDB of db_util, so its directory could
+// be imported with Tablet::ImportData.
+class BulkLoadSstWriter {
+ public:
+  BulkLoadSstWriter(BulkLoadDocDBUtil* db_util, std::string tmp_dir, size_t sort_buffer_size,
+                    size_t target_file_size);
+  ~BulkLoadSstWriter();
+
+  // Adds records of the write batch with the specified hybrid time. Thread safe.
+  CHECKED_STATUS Add(const docdb::DocWriteBatch& write_batch, HybridTime hybrid_time);
+
+  // Writes all added records to SST files. Should be called after all Add calls are completed.
+  CHECKED_STATUS Finish();
+
+  size_t num_runs() const;
+  size_t num_files() const { return num_files_; }
+
+ private:
+  typedef std::vector<std::pair<std::string, std::string>> Records;
+
+  // Sorts records by key, only the last added record is kept for equal keys.
+  void SortRecords(Records* records) const;
+
+  CHECKED_STATUS SpillRun(const std::string& path, Records records) const;
+
+  BulkLoadDocDBUtil* const db_util_;
+  const std::string tmp_dir_;
+  const size_t sort_buffer_size_;
+  const size_t target_file_size_;
+
+  mutable std::mutex mutex_;
+  Records buffer_;
+  size_t buffer_size_ = 0;
+  // Run files in order of their creation.
+  std::vector<std::string> run_files_;
+
+  size_t num_files_ = 0;
+};
+
+} // namespace tools
+} // namespace yb
+
+#endif // YB_TOOLS_BULK_LOAD_SST_WRITER_H
@@ -356,6 +356,11 @@ class YBBulkLoadTest : public YBMiniClusterTestBase<MiniCluster> {
   std::vector<std::string> master_addresses_;
   std::string master_addresses_comma_separated_;
   Random random_;
+
+  // Runs partition and bulk load tools with the specified extra arguments of the bulk load tool
+  // and verifies that loaded rows could be read. When export_files is false, generated files are
+  // imported by the test.
+  void TestCLITool(const vector<string>& extra_bulk_load_argv, bool export_files);
 };
 
 TEST_F(YBBulkLoadTest, VerifyPartitions) {
@@ -387,7 +392,8 @@ TEST_F(YBBulkLoadTest, InvalidLines) {
   ASSERT_NOK(partition_generator_->LookupTabletId("123,123.2", &tablet_id, &partition_key));
 }
 
-TEST_F(YBBulkLoadTest, TestCLITool) {
+void YBBulkLoadTest::TestCLITool(const vector<string>& extra_bulk_load_argv,
+                                 bool export_files) {
   string exe_path = GetToolPath(kPartitionToolName);
   vector<string> argv = {kPartitionToolName, "-master_addresses", master_addresses_comma_separated_,
       "-table_name", kTableName, "-namespace_name", kNamespace};
@@ -447,8 +453,6 @@ TEST_F(YBBulkLoadTest, TestCLITool) {
   ASSERT_OK(env->CreateDir(bulk_load_data));
 
   string bulk_load_exec = GetToolPath(kBulkLoadToolName);
-  // -row_batch_size and -flush_batch_for_tests used to ensure we have multiple flushed files per
-  // tablet which ensures we would compact some files.
   vector<string> bulk_load_argv = {
       kBulkLoadToolName,
       "-master_addresses", master_addresses_comma_separated_,
@@ -457,9 +461,10 @@ TEST_F(YBBulkLoadTest, TestCLITool) {
       "-base_dir", bulk_load_data,
       "-initial_seqno", "0",
       "-row_batch_size", std::to_string(kNumIterations/kNumTablets/10),
-      "-bulk_load_num_files_per_tablet", std::to_string(kNumFilesPerTablet),
-      "-flush_batch_for_tests"
+      export_files ? "-export_files" : "-noexport_files"
   };
+  bulk_load_argv.insert(
+      bulk_load_argv.end(), extra_bulk_load_argv.begin(), extra_bulk_load_argv.end());
 
   std::unique_ptr<Subprocess> bulk_load_process;
   ASSERT_OK(StartProcessAndGetStreams(bulk_load_exec, bulk_load_argv, &out, &in,
@@ -488,18 +493,21 @@ TEST_F(YBBulkLoadTest, TestCLITool) {
   for (const master::TabletLocationsPB& tablet_location : resp.tablet_locations()) {
     const string& tablet_id = tablet_location.tablet_id();
     string tablet_path = JoinPathSegments(bulk_load_data, tablet_id);
-    ASSERT_TRUE(env->FileExists(tablet_path));
-
-    // Verify atmost 'bulk_load_num_files_per_tablet' files.
-    vector <string> tablet_files;
-    ASSERT_OK(env->GetChildren(tablet_path, &tablet_files));
-    size_t num_files = 0;
-    for (const string& tablet_file : tablet_files) {
-      if (boost::algorithm::ends_with(tablet_file, ".sst")) {
-        num_files++;
+    // Exported files are deleted by the tool.
+    ASSERT_NE(export_files, env->FileExists(tablet_path));
+
+    if (!export_files) {
+      // Verify atmost 'bulk_load_num_files_per_tablet' files.
+      vector <string> tablet_files;
+      ASSERT_OK(env->GetChildren(tablet_path, &tablet_files));
+      size_t num_files = 0;
+      for (const string& tablet_file : tablet_files) {
+        if (boost::algorithm::ends_with(tablet_file, ".sst")) {
+          num_files++;
+        }
       }
+      ASSERT_GE(kNumFilesPerTablet, num_files);
     }
-    ASSERT_GE(kNumFilesPerTablet, num_files);
 
     Endpoint leader_tserver;
     for (const master::TabletLocationsPB::ReplicaPB& replica : tablet_location.replicas()) {
@@ -519,14 +527,16 @@ TEST_F(YBBulkLoadTest, TestCLITool) {
     // Wait for load generator to generate some traffic.
     SleepFor(MonoDelta::FromSeconds(5));
 
-    // Import the data into the tserver.
-    tserver::ImportDataRequestPB import_req;
-    import_req.set_tablet_id(tablet_id);
-    import_req.set_source_dir(tablet_path);
-    tserver::ImportDataResponsePB import_resp;
-    rpc::RpcController controller;
-    ASSERT_OK(tserver_proxy->ImportData(import_req, &import_resp, &controller));
-    ASSERT_FALSE(import_resp.has_error()) << import_resp.DebugString();
+    if (!export_files) {
+      // Import the data into the tserver.
+      tserver::ImportDataRequestPB import_req;
+      import_req.set_tablet_id(tablet_id);
+      import_req.set_source_dir(tablet_path);
+      tserver::ImportDataResponsePB import_resp;
+      rpc::RpcController controller;
+      ASSERT_OK(tserver_proxy->ImportData(import_req, &import_resp, &controller));
+      ASSERT_FALSE(import_resp.has_error()) << import_resp.DebugString();
+    }
 
     for (const string& row : tabletid_to_line[tablet_id]) {
       // Build read request.
@@ -580,5 +590,34 @@ TEST_F(YBBulkLoadTest, TestCLITool) {
   }
 }
 
+TEST_F(YBBulkLoadTest, TestCLITool) {
+  // -row_batch_size and -flush_batch_for_tests used to ensure we have multiple flushed files per
+  // tablet which ensures we would compact some files.
+  TestCLITool({
+      "-nobulk_load_sort_based",
+      "-bulk_load_num_files_per_tablet", std::to_string(kNumFilesPerTablet),
+      "-flush_batch_for_tests"
+  }, /* export_files */ false);
+}
+
+TEST_F(YBBulkLoadTest, TestCLIToolSortBased) {
+  // Small sort buffer and target file size are used to spill several sorted runs and to write
+  // several SST files per tablet.
+  TestCLITool({
+      "-bulk_load_sort_based",
+      "-bulk_load_sort_buffer_bytes", "16384",
+      "-bulk_load_target_file_size_bytes", "65536",
+      "-bulk_load_num_parallel_tablets", "2"
+  }, /* export_files */ false);
+}
+
+TEST_F(YBBulkLoadTest, TestCLIToolExportViaRpc) {
+  TestCLITool({
+      "-bulk_load_sort_based",
+      "-bulk_load_sort_buffer_bytes", "16384",
+      "-bulk_load_upload_chunk_size_bytes", "4096"
+  }, /* export_files */ true);
+}
+
 } // namespace tools
 } // namespace yb
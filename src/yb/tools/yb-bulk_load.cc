@@ -32,6 +32,7 @@
 #include "yb/rpc/messenger.h"
 #include "yb/rpc/rpc_controller.h"
 #include "yb/tools/bulk_load_docdb_util.h"
+#include "yb/tools/bulk_load_sst_writer.h"
 #include "yb/tools/bulk_load_utils.h"
 #include "yb/tools/yb-generate_partitions.h"
 #include "yb/tserver/tserver_service.proxy.h"
@@ -42,6 +43,7 @@
 #include "yb/util/threadpool.h"
 #include "yb/util/flags.h"
 #include "yb/util/logging.h"
+#include "yb/util/oid_generator.h"
 #include "yb/util/path_util.h"
 #include "yb/util/subprocess.h"
 
@@ -55,6 +57,7 @@ using yb::client::YBClientBuilder;
 using yb::client::YBTable;
 using yb::client::YBTableName;
 using yb::operator"" _GB;
+using yb::operator"" _MB;
 
 DEFINE_string(master_addresses, "", "Comma-separated list of YB Master server addresses");
 DEFINE_string(table_name, "", "Name of the table to generate partitions for");
@@ -79,16 +82,47 @@ DEFINE_int32(bulk_load_max_background_flushes, 2, "Number of flushes to perform
 DEFINE_uint64(bulk_load_num_files_per_tablet, 5,
               "Determines how to compact the data of a tablet to ensure we have only a certain "
               "number of sst files per tablet");
+DEFINE_bool(bulk_load_sort_based, true,
+            "Generate SST files by sorting records of a tablet and writing them directly, instead "
+            "of writing them through memtable and compacting flushed files");
+DEFINE_int64(bulk_load_sort_buffer_bytes, 512_MB,
+             "Amount of records of a tablet, that is sorted in memory before being spilled to a "
+             "temporary file. Used with --bulk_load_sort_based");
+DEFINE_int64(bulk_load_target_file_size_bytes, 256_MB,
+             "Approximate size of generated SST files. Used with --bulk_load_sort_based");
+DEFINE_int32(bulk_load_num_parallel_tablets, 4,
+             "Number of tablets whose SST files are written and exported in parallel. Used with "
+             "--bulk_load_sort_based");
+DEFINE_uint64(bulk_load_hybrid_time_micros, yb::kYugaByteMicrosecondEpoch,
+              "Hybrid time in microseconds of loaded records");
+DEFINE_bool(export_files_via_rpc, true,
+            "Upload files to all replicas of a tablet via RPC, instead of using bulk load helper "
+            "script and ssh");
+DEFINE_int32(bulk_load_upload_chunk_size_bytes, 1_MB,
+             "Size of file chunks uploaded to tablet servers with --export_files_via_rpc");
 
 namespace yb {
 namespace tools {
 
 namespace {
 
+HybridTime BulkLoadHybridTime() {
+  return HybridTime::FromMicros(FLAGS_bulk_load_hybrid_time_micros);
+}
+
+// State of the bulk load of a single tablet.
+struct TabletLoad {
+  TabletId tablet_id;
+  unique_ptr<BulkLoadDocDBUtil> db_fixture;
+  // Used only with --bulk_load_sort_based.
+  unique_ptr<BulkLoadSstWriter> sst_writer;
+};
+
 class BulkLoadTask : public Runnable {
  public:
   BulkLoadTask(vector<pair<TabletId, string>> rows, BulkLoadDocDBUtil *db_fixture,
-               const YBTable *table, YBPartitionGenerator *partition_generator);
+               BulkLoadSstWriter *sst_writer, const YBTable *table,
+               YBPartitionGenerator *partition_generator);
   void Run();
  private:
   CHECKED_STATUS PopulateColumnValue(const string &column,
@@ -101,6 +135,7 @@ class BulkLoadTask : public Runnable {
                            YBPartitionGenerator *const partition_generator);
   vector<pair<TabletId, string>> rows_;
   BulkLoadDocDBUtil *const db_fixture_;
+  BulkLoadSstWriter *const sst_writer_;
   const YBTable *const table_;
   YBPartitionGenerator *const partition_generator_;
 };
@@ -121,16 +156,30 @@ class BulkLoad {
  private:
   CHECKED_STATUS InitYBBulkLoad();
   CHECKED_STATUS InitDBUtil(const TabletId &tablet_id);
-  CHECKED_STATUS FinishTabletProcessing(const TabletId &tablet_id,
-                                        vector<pair<TabletId, string>> rows);
+  CHECKED_STATUS FinishTabletProcessing(vector<pair<TabletId, string>> rows);
+  // Writes SST files of the tablet and exports them if requested.
+  CHECKED_STATUS FinishTablet(TabletLoad* load);
   CHECKED_STATUS RetryableSubmit(vector<pair<TabletId, string>> rows);
-  CHECKED_STATUS CompactFiles();
+  CHECKED_STATUS CompactFiles(BulkLoadDocDBUtil* db_fixture);
+  CHECKED_STATUS ExportFilesViaSsh(const TabletId& tablet_id,
+                                   const master::TabletLocationsPB& tablet_locations,
+                                   const string& dir);
+  CHECKED_STATUS ExportFilesViaRpc(const TabletId& tablet_id,
+                                   const master::TabletLocationsPB& tablet_locations,
+                                   const string& dir);
+  CHECKED_STATUS WaitForFinishTablets();
 
   shared_ptr<YBClient> client_;
   shared_ptr<YBTable> table_;
   unique_ptr<YBPartitionGenerator> partition_generator_;
   gscoped_ptr<ThreadPool> thread_pool_;
-  unique_ptr<BulkLoadDocDBUtil> db_fixture_;
+  // Pool for writing and exporting SST files of tablets, used with --bulk_load_sort_based.
+  gscoped_ptr<ThreadPool> finish_pool_;
+  shared_ptr<rpc::Messenger> client_messenger_;
+  shared_ptr<TabletLoad> tablet_load_;
+
+  std::mutex finish_mutex_;
+  Status finish_status_;
 };
 
 CompactionTask::CompactionTask(const vector<string>& sst_filenames, BulkLoadDocDBUtil* db_fixture)
@@ -151,10 +200,11 @@ void CompactionTask::Run() {
 }
 
 BulkLoadTask::BulkLoadTask(vector<pair<TabletId, string>> rows,
-                           BulkLoadDocDBUtil *db_fixture, const YBTable *table,
-                           YBPartitionGenerator *partition_generator)
+                           BulkLoadDocDBUtil *db_fixture, BulkLoadSstWriter *sst_writer,
+                           const YBTable *table, YBPartitionGenerator *partition_generator)
     : rows_(std::move(rows)),
       db_fixture_(db_fixture),
+      sst_writer_(sst_writer),
       table_(table),
       partition_generator_(partition_generator) {
 }
@@ -170,9 +220,14 @@ void BulkLoadTask::Run() {
                        partition_generator_));
   }
 
+  if (sst_writer_) {
+    CHECK_OK(sst_writer_->Add(*doc_write_batch, BulkLoadHybridTime()));
+    return;
+  }
+
   // Flush the batch.
   CHECK_OK(db_fixture_->WriteToRocksDB(
-      *doc_write_batch, HybridTime::FromMicros(kYugaByteMicrosecondEpoch),
+      *doc_write_batch, BulkLoadHybridTime(),
       /* decode_dockey */ false, /* increment_write_id */ false));
 
   if (FLAGS_flush_batch_for_tests) {
@@ -275,15 +330,15 @@ Status BulkLoadTask::InsertRow(const string &row,
   // once we have secondary indexes we probably might need to ensure bulk load builds the indexes
   // as well.
   docdb::QLWriteOperation op(&req, schema, &resp, boost::none);
-  RETURN_NOT_OK(op.Apply(doc_write_batch, db_fixture->rocksdb(),
-                         HybridTime::FromMicros(kYugaByteMicrosecondEpoch)));
+  RETURN_NOT_OK(op.Apply(doc_write_batch, db_fixture->rocksdb(), BulkLoadHybridTime()));
   return Status::OK();
 }
 
 
 Status BulkLoad::RetryableSubmit(vector<pair<TabletId, string>> rows) {
   auto runnable = std::make_shared<BulkLoadTask>(
-      std::move(rows), db_fixture_.get(), table_.get(), partition_generator_.get());
+      std::move(rows), tablet_load_->db_fixture.get(), tablet_load_->sst_writer.get(),
+      table_.get(), partition_generator_.get());
 
   Status s;
   do {
@@ -302,9 +357,9 @@ Status BulkLoad::RetryableSubmit(vector<pair<TabletId, string>> rows) {
   return Status::OK();
 }
 
-Status BulkLoad::CompactFiles() {
+Status BulkLoad::CompactFiles(BulkLoadDocDBUtil* db_fixture) {
   std::vector<rocksdb::LiveFileMetaData> live_files_metadata;
-  db_fixture_->rocksdb()->GetLiveFilesMetaData(&live_files_metadata);
+  db_fixture->rocksdb()->GetLiveFilesMetaData(&live_files_metadata);
   if (live_files_metadata.empty()) {
     return STATUS(IllegalState, "Need atleast one sst file");
   }
@@ -330,7 +385,7 @@ Status BulkLoad::CompactFiles() {
       auto end_iter = (i == FLAGS_bulk_load_num_files_per_tablet - 1) ? sst_files.end()
                                                                       : start_iter + batch_size;
       auto runnable = std::make_shared<CompactionTask>(vector<string>(start_iter, end_iter),
-                                                       db_fixture_.get());
+                                                       db_fixture);
       RETURN_NOT_OK(thread_pool_->Submit(runnable));
       start_iter = end_iter;
     }
@@ -339,15 +394,14 @@ Status BulkLoad::CompactFiles() {
     thread_pool_->Wait();
 
     // Reopen rocksdb to clean up deleted files.
-    return db_fixture_->ReopenRocksDB();
+    return db_fixture->ReopenRocksDB();
   }
   return Status::OK();
 }
 
-Status BulkLoad::FinishTabletProcessing(const TabletId &tablet_id,
-                                        vector<pair<TabletId, string>> rows) {
-  if (!db_fixture_) {
-    // Skip processing since db_fixture wasn't initialized indicating empty input.
+Status BulkLoad::FinishTabletProcessing(vector<pair<TabletId, string>> rows) {
+  if (!tablet_load_) {
+    // Skip processing since tablet load wasn't initialized indicating empty input.
     return Status::OK();
   }
 
@@ -357,11 +411,53 @@ Status BulkLoad::FinishTabletProcessing(const TabletId &tablet_id,
   // Wait for all tasks for the tablet to complete.
   thread_pool_->Wait();
 
-  // Now flush the DB.
-  RETURN_NOT_OK(db_fixture_->FlushRocksDB());
+  auto load = std::move(tablet_load_);
+  if (!finish_pool_) {
+    return FinishTablet(load.get());
+  }
+
+  // Writing SST files does not use thread_pool_, so rows of the next tablet could be processed
+  // meanwhile.
+  auto task = [this, load] {
+    auto status = FinishTablet(load.get());
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to finish tablet " << load->tablet_id << ": " << status;
+      std::lock_guard<std::mutex> lock(finish_mutex_);
+      if (finish_status_.ok()) {
+        finish_status_ = status;
+      }
+    }
+  };
+  for (;;) {
+    auto status = finish_pool_->SubmitFunc(task);
+    if (!status.IsServiceUnavailable()) {
+      return status;
+    }
+    // Queue is full, i.e. maximal number of tablets is being finished.
+    SleepFor(MonoDelta::FromMilliseconds(100));
+  }
+}
+
+Status BulkLoad::WaitForFinishTablets() {
+  if (finish_pool_) {
+    finish_pool_->Wait();
+  }
+  std::lock_guard<std::mutex> lock(finish_mutex_);
+  return finish_status_;
+}
 
-  // Perform the necessary compactions.
-  RETURN_NOT_OK(CompactFiles());
+Status BulkLoad::FinishTablet(TabletLoad* load) {
+  BulkLoadDocDBUtil* db_fixture = load->db_fixture.get();
+  if (load->sst_writer) {
+    RETURN_NOT_OK(load->sst_writer->Finish());
+    load->sst_writer.reset();
+  } else {
+    // Now flush the DB.
+    RETURN_NOT_OK(db_fixture->FlushRocksDB());
+
+    // Perform the necessary compactions.
+    RETURN_NOT_OK(CompactFiles(db_fixture));
+  }
 
   if (!FLAGS_export_files) {
     return Status::OK();
@@ -369,7 +465,20 @@ Status BulkLoad::FinishTabletProcessing(const TabletId &tablet_id,
 
   // Find replicas for the tablet.
   master::TabletLocationsPB tablet_locations;
-  RETURN_NOT_OK(client_->GetTabletLocation(tablet_id, &tablet_locations));
+  RETURN_NOT_OK(client_->GetTabletLocation(load->tablet_id, &tablet_locations));
+  if (FLAGS_export_files_via_rpc) {
+    RETURN_NOT_OK(ExportFilesViaRpc(load->tablet_id, tablet_locations, db_fixture->rocksdb_dir()));
+  } else {
+    RETURN_NOT_OK(ExportFilesViaSsh(load->tablet_id, tablet_locations, db_fixture->rocksdb_dir()));
+  }
+
+  // Delete the data once the import is done.
+  return yb::Env::Default()->DeleteRecursively(db_fixture->rocksdb_dir());
+}
+
+Status BulkLoad::ExportFilesViaSsh(const TabletId& tablet_id,
+                                   const master::TabletLocationsPB& tablet_locations,
+                                   const string& dir) {
   string csv_replicas;
   std::map<string, int32_t> host_to_rpcport;
   for (const master::TabletLocationsPB_ReplicaPB &replica : tablet_locations.replicas()) {
@@ -383,7 +492,7 @@ Status BulkLoad::FinishTabletProcessing(const TabletId &tablet_id,
 
   // Invoke the bulk_load_helper script.
   vector<string> argv = {FLAGS_bulk_load_helper_script, "-t", tablet_id, "-r", csv_replicas, "-i",
-      FLAGS_ssh_key_file, "-d", db_fixture_->rocksdb_dir()};
+      FLAGS_ssh_key_file, "-d", dir};
   string bulk_load_helper_stdout;
   RETURN_NOT_OK(Subprocess::Call(argv, &bulk_load_helper_stdout));
 
@@ -392,9 +501,6 @@ Status BulkLoad::FinishTabletProcessing(const TabletId &tablet_id,
   LOG(INFO) << "Helper script stdout: " << bulk_load_helper_stdout;
 
   // Finalize the import.
-  rpc::MessengerBuilder bld("Client");
-  std::shared_ptr<rpc::Messenger> client_messenger;
-  RETURN_NOT_OK(bld.Build(&client_messenger));
   vector<string> lines;
   boost::split(lines, bulk_load_helper_stdout, boost::is_any_of("\n"));
   for (const string &line : lines) {
@@ -407,7 +513,7 @@ Status BulkLoad::FinishTabletProcessing(const TabletId &tablet_id,
     const string &directory = tokens[1];
     Endpoint endpoint(IpAddress::from_string(replica_host), host_to_rpcport[replica_host]);
 
-    tserver::TabletServerServiceProxy proxy(client_messenger, endpoint);
+    tserver::TabletServerServiceProxy proxy(client_messenger_, endpoint);
     tserver::ImportDataRequestPB req;
     req.set_tablet_id(tablet_id);
     req.set_source_dir(directory);
@@ -426,19 +532,92 @@ Status BulkLoad::FinishTabletProcessing(const TabletId &tablet_id,
         replica_host, "-i", FLAGS_ssh_key_file};
     RETURN_NOT_OK(Subprocess::Call(cleanup_script));
   }
+  return Status::OK();
+}
 
-  // Delete the data once the import is done.
-  return yb::Env::Default()->DeleteRecursively(db_fixture_->rocksdb_dir());
+Status BulkLoad::ExportFilesViaRpc(const TabletId& tablet_id,
+                                   const master::TabletLocationsPB& tablet_locations,
+                                   const string& dir) {
+  Env* env = Env::Default();
+  vector<string> children;
+  RETURN_NOT_OK(env->GetChildren(dir, &children));
+  vector<string> files;
+  for (const auto& child : children) {
+    // Only files required by RocksDB import are uploaded, i.e. CURRENT, MANIFEST and SST files.
+    if (child == "CURRENT" || boost::starts_with(child, "MANIFEST-") ||
+        child.find(".sst") != string::npos) {
+      files.push_back(child);
+    }
+  }
+
+  const string import_id = ObjectIdGenerator().Next();
+  std::unique_ptr<uint8_t[]> scratch(new uint8_t[FLAGS_bulk_load_upload_chunk_size_bytes]);
+  for (const auto& replica : tablet_locations.replicas()) {
+    Endpoint endpoint;
+    RETURN_NOT_OK(EndpointFromHostPortPB(replica.ts_info().rpc_addresses(0), &endpoint));
+    tserver::TabletServerServiceProxy proxy(client_messenger_, endpoint);
+
+    for (const auto& file_name : files) {
+      gscoped_ptr<SequentialFile> file;
+      RETURN_NOT_OK(env->NewSequentialFile(JoinPathSegments(dir, file_name), &file));
+      uint64_t offset = 0;
+      for (;;) {
+        Slice chunk;
+        RETURN_NOT_OK(file->Read(FLAGS_bulk_load_upload_chunk_size_bytes, &chunk, scratch.get()));
+        // Empty files are uploaded too, so the first chunk is always sent.
+        if (chunk.empty() && offset != 0) {
+          break;
+        }
+        tserver::UploadImportFileRequestPB req;
+        req.set_tablet_id(tablet_id);
+        req.set_import_id(import_id);
+        req.set_file_name(file_name);
+        req.set_offset(offset);
+        req.set_data(chunk.cdata(), chunk.size());
+        tserver::UploadImportFileResponsePB resp;
+        rpc::RpcController controller;
+        RETURN_NOT_OK(proxy.UploadImportFile(req, &resp, &controller));
+        if (resp.has_error()) {
+          RETURN_NOT_OK(StatusFromPB(resp.error().status()));
+        }
+        offset += chunk.size();
+        if (chunk.empty()) {
+          break;
+        }
+      }
+    }
+
+    tserver::ImportDataRequestPB req;
+    req.set_tablet_id(tablet_id);
+    req.set_import_id(import_id);
+    tserver::ImportDataResponsePB resp;
+    rpc::RpcController controller;
+    LOG(INFO) << "Importing " << files.size() << " files on " << endpoint << " for tablet_id: "
+              << tablet_id;
+    RETURN_NOT_OK(proxy.ImportData(req, &resp, &controller));
+    if (resp.has_error()) {
+      RETURN_NOT_OK(StatusFromPB(resp.error().status()));
+    }
+  }
+  return Status::OK();
 }
 
 
 CHECKED_STATUS BulkLoad::InitDBUtil(const TabletId &tablet_id) {
-  db_fixture_.reset(new BulkLoadDocDBUtil(tablet_id, FLAGS_base_dir,
-                                          FLAGS_memtable_size_bytes,
-                                          FLAGS_bulk_load_num_memtables,
-                                          FLAGS_bulk_load_max_background_flushes));
-  RETURN_NOT_OK(db_fixture_->InitRocksDBOptions());
-  RETURN_NOT_OK(db_fixture_->DisableCompactions()); // This opens rocksdb.
+  auto load = std::make_shared<TabletLoad>();
+  load->tablet_id = tablet_id;
+  load->db_fixture.reset(new BulkLoadDocDBUtil(tablet_id, FLAGS_base_dir,
+                                               FLAGS_memtable_size_bytes,
+                                               FLAGS_bulk_load_num_memtables,
+                                               FLAGS_bulk_load_max_background_flushes));
+  RETURN_NOT_OK(load->db_fixture->InitRocksDBOptions());
+  RETURN_NOT_OK(load->db_fixture->DisableCompactions()); // This opens rocksdb.
+  if (FLAGS_bulk_load_sort_based) {
+    load->sst_writer.reset(new BulkLoadSstWriter(
+        load->db_fixture.get(), JoinPathSegments(FLAGS_base_dir, tablet_id + ".tmp"),
+        FLAGS_bulk_load_sort_buffer_bytes, FLAGS_bulk_load_target_file_size_bytes));
+  }
+  tablet_load_ = std::move(load);
   return Status::OK();
 }
 
@@ -455,7 +634,18 @@ Status BulkLoad::InitYBBulkLoad() {
   partition_generator_.reset(new YBPartitionGenerator(table_name, {FLAGS_master_addresses}));
   RETURN_NOT_OK(partition_generator_->Init());
 
-  db_fixture_ = nullptr;
+  rpc::MessengerBuilder bld("Client");
+  RETURN_NOT_OK(bld.Build(&client_messenger_));
+
+  tablet_load_ = nullptr;
+  if (FLAGS_bulk_load_sort_based) {
+    RETURN_NOT_OK(
+        ThreadPoolBuilder("bulk_load_finish")
+            .set_min_threads(FLAGS_bulk_load_num_parallel_tablets)
+            .set_max_threads(FLAGS_bulk_load_num_parallel_tablets)
+            .set_max_queue_size(FLAGS_bulk_load_num_parallel_tablets)
+            .Build(&finish_pool_));
+  }
   CHECK_OK(
       ThreadPoolBuilder("bulk_load_tasks")
           .set_min_threads(FLAGS_bulk_load_num_threads)
@@ -489,7 +679,7 @@ Status BulkLoad::RunBulkLoad() {
     // Reinitialize rocksdb if needed.
     if (current_tablet_id.empty() || current_tablet_id != tablet_id) {
       // Flush all of the data before opening a new rocksdb.
-      RETURN_NOT_OK(FinishTabletProcessing(current_tablet_id, std::move(rows)));
+      RETURN_NOT_OK(FinishTabletProcessing(std::move(rows)));
       RETURN_NOT_OK(InitDBUtil(tablet_id));
     }
     current_tablet_id = tablet_id;
@@ -502,8 +692,8 @@ Status BulkLoad::RunBulkLoad() {
   }
 
   // Process last tablet.
-  RETURN_NOT_OK(FinishTabletProcessing(current_tablet_id, std::move(rows)));
-  return Status::OK();
+  RETURN_NOT_OK(FinishTabletProcessing(std::move(rows)));
+  return WaitForFinishTablets();
 }
 
 } // anonymous namespace
@@ -520,8 +710,9 @@ int main(int argc, char** argv) {
         "--base_dir";
   }
 
-  if (FLAGS_export_files && FLAGS_ssh_key_file.empty()) {
-    LOG(FATAL) << "Need to specify --ssh_key_file with --export_files";
+  if (FLAGS_export_files && !FLAGS_export_files_via_rpc && FLAGS_ssh_key_file.empty()) {
+    LOG(FATAL) << "Need to specify --ssh_key_file with --export_files and "
+        "--noexport_files_via_rpc";
   }
 
   // Verify the bulk load path exists.
@@ -70,6 +70,11 @@ DEFINE_int32(heartbeat_max_failures_before_backoff, 3,
              "rather than retrying.");
 TAG_FLAG(heartbeat_max_failures_before_backoff, advanced);
 
+DEFINE_int32(tablet_size_report_interval_ms, 60000,
+             "Interval at which the TS reports the estimated sizes of the tablets it leads to the "
+             "master in its heartbeats. The sizes are used to split table scans.");
+TAG_FLAG(tablet_size_report_interval_ms, advanced);
+
 using google::protobuf::RepeatedPtrField;
 using yb::HostPortPB;
 using yb::consensus::RaftPeerPB;
@@ -178,6 +183,9 @@ class Heartbeater::Thread {
   // This is tracked so as to back-off heartbeating.
   int consecutive_failed_heartbeats_;
 
+  // The last time the tablet sizes were sent in a heartbeat.
+  MonoTime last_tablet_sizes_time_;
+
   // Mutex/condition pair to trigger the heartbeater thread
   // to either heartbeat early or exit.
   Mutex mutex_;
@@ -367,6 +375,14 @@ Status Heartbeater::Thread::TryHeartbeat() {
   }
   req.set_num_live_tablets(server_->tablet_manager()->GetNumLiveTablets());
 
+  const MonoTime now = MonoTime::Now(MonoTime::FINE);
+  if (!last_tablet_sizes_time_.Initialized() ||
+      now.GetDeltaSince(last_tablet_sizes_time_).ToMilliseconds() >=
+          FLAGS_tablet_size_report_interval_ms) {
+    server_->tablet_manager()->GetLeaderTabletSizes(req.mutable_tablet_sizes());
+    last_tablet_sizes_time_ = now;
+  }
+
   RpcController rpc;
   rpc.set_timeout(MonoDelta::FromSeconds(10));
 
@@ -0,0 +1,223 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tserver/memstore_flush_policy.h"
+
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include "yb/util/format.h"
+#include "yb/util/size_literals.h"
+#include "yb/util/test_util.h"
+
+DECLARE_int32(memstore_flush_max_parallel_flushes);
+DECLARE_int32(memstore_flush_target_percentage);
+DECLARE_int32(memstore_flush_write_rate_window_ms);
+
+namespace yb {
+namespace tserver {
+
+namespace {
+
+constexpr size_t kMemoryLimit = 64_MB;
+constexpr size_t kWriteSize = 1_KB;
+
+// Simulated tablet server with one hot tablet and many almost idle tablets.
+class SkewedWriteSimulation {
+ public:
+  SkewedWriteSimulation(int num_idle_tablets, bool use_policy)
+      : use_policy_(use_policy), policy_(nullptr) {
+    tablets_.resize(num_idle_tablets + 1);
+    for (size_t i = 0; i != tablets_.size(); ++i) {
+      tablets_[i].tablet_id = Format("tablet-$0", i);
+    }
+  }
+
+  void Run(int ticks) {
+    MonoTime now = MonoTime::Now(MonoTime::FINE);
+    for (int tick = 0; tick != ticks; ++tick) {
+      now += MonoDelta::FromMilliseconds(100);
+      // Tablet 0 is hot and receives 1000 writes per tick, others receive a write every 10 ticks.
+      Write(0, 1000, tick);
+      if (tick % 10 == 0) {
+        for (size_t i = 1; i != tablets_.size(); ++i) {
+          Write(i, 1, tick);
+        }
+      }
+      while (MemoryUsage() >= kMemoryLimit) {
+        ASSERT_NO_FATALS(FlushSelected(now));
+      }
+    }
+  }
+
+  int num_flushes() const { return num_flushes_; }
+  int num_small_flushes() const { return num_small_flushes_; }
+
+ private:
+  void Write(size_t idx, size_t count, int tick) {
+    auto& tablet = tablets_[idx];
+    tablet.memstore_bytes += count * kWriteSize;
+    // Each write also appends to WAL, that is retained until flush.
+    tablet.wal_retained_bytes += count * kWriteSize * 2;
+    tablet.num_writes += count;
+    if (tablet.oldest_write_in_memstore == HybridTime::kMax) {
+      tablet.oldest_write_in_memstore = HybridTime(tick + 1);
+    }
+  }
+
+  size_t MemoryUsage() const {
+    size_t result = 0;
+    for (const auto& tablet : tablets_) {
+      result += tablet.memstore_bytes;
+    }
+    return result;
+  }
+
+  void FlushSelected(MonoTime now) {
+    std::vector<size_t> to_flush;
+    if (use_policy_) {
+      to_flush = policy_.SelectTabletsToFlush(tablets_, MemoryUsage(), kMemoryLimit, now);
+    } else {
+      // Previous policy: flush the tablet with the oldest write in memstore.
+      size_t oldest = 0;
+      for (size_t i = 1; i != tablets_.size(); ++i) {
+        if (tablets_[i].oldest_write_in_memstore < tablets_[oldest].oldest_write_in_memstore) {
+          oldest = i;
+        }
+      }
+      to_flush.push_back(oldest);
+    }
+    ASSERT_FALSE(to_flush.empty());
+    for (auto idx : to_flush) {
+      auto& tablet = tablets_[idx];
+      ++num_flushes_;
+      if (tablet.memstore_bytes < 1_MB) {
+        ++num_small_flushes_;
+      }
+      tablet.memstore_bytes = 0;
+      tablet.wal_retained_bytes = 0;
+      tablet.oldest_write_in_memstore = HybridTime::kMax;
+    }
+  }
+
+  const bool use_policy_;
+  MemstoreFlushPolicy policy_;
+  std::vector<MemstoreFlushCandidate> tablets_;
+  int num_flushes_ = 0;
+  int num_small_flushes_ = 0;
+};
+
+std::vector<MemstoreFlushCandidate> EqualCandidates(int count, size_t memstore_bytes) {
+  std::vector<MemstoreFlushCandidate> result(count);
+  for (int i = 0; i != count; ++i) {
+    result[i].tablet_id = Format("tablet-$0", i);
+    result[i].memstore_bytes = memstore_bytes;
+    result[i].oldest_write_in_memstore = HybridTime(i + 1);
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(MemstoreFlushPolicyTest, SkewedWrites) {
+  constexpr int kNumIdleTablets = 50;
+  constexpr int kTicks = 1000;
+
+  SkewedWriteSimulation oldest_write(kNumIdleTablets, false /* use_policy */);
+  ASSERT_NO_FATALS(oldest_write.Run(kTicks));
+  SkewedWriteSimulation policy(kNumIdleTablets, true /* use_policy */);
+  ASSERT_NO_FATALS(policy.Run(kTicks));
+
+  LOG(INFO) << "Oldest write policy flushes: " << oldest_write.num_flushes()
+            << ", small flushes: " << oldest_write.num_small_flushes();
+  LOG(INFO) << "Memstore flush policy flushes: " << policy.num_flushes()
+            << ", small flushes: " << policy.num_small_flushes();
+
+  ASSERT_GT(oldest_write.num_small_flushes(), 0);
+  ASSERT_LT(policy.num_small_flushes(), oldest_write.num_small_flushes());
+  ASSERT_LT(policy.num_flushes(), oldest_write.num_flushes());
+}
+
+TEST(MemstoreFlushPolicyTest, ParallelFlushes) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_memstore_flush_max_parallel_flushes = 4;
+  FLAGS_memstore_flush_target_percentage = 80;
+
+  MemstoreFlushPolicy policy(nullptr);
+  auto candidates = EqualCandidates(8, 10_MB);
+
+  // Slightly over the limit, so it is enough to flush 2 tablets to get under target.
+  auto selected = policy.SelectTabletsToFlush(candidates, 81_MB, 80_MB);
+  ASSERT_EQ(2U, selected.size());
+  // Scores are equal, so tablets with older writes are preferred.
+  ASSERT_EQ(0U, selected[0]);
+  ASSERT_EQ(1U, selected[1]);
+
+  // Far over the limit, number of flushes is capped.
+  selected = policy.SelectTabletsToFlush(candidates, 160_MB, 80_MB);
+  ASSERT_EQ(4U, selected.size());
+
+  // Tablets that are empty or already scheduled for flush are not selected.
+  for (size_t i = 1; i != candidates.size(); ++i) {
+    candidates[i].oldest_write_in_memstore = HybridTime::kMax;
+  }
+  selected = policy.SelectTabletsToFlush(candidates, 160_MB, 80_MB);
+  ASSERT_EQ(1U, selected.size());
+  ASSERT_EQ(0U, selected[0]);
+
+  candidates[0].oldest_write_in_memstore = HybridTime::kMax;
+  ASSERT_TRUE(policy.SelectTabletsToFlush(candidates, 160_MB, 80_MB).empty());
+}
+
+TEST(MemstoreFlushPolicyTest, WalRetention) {
+  MemstoreFlushPolicy policy(nullptr);
+  auto candidates = EqualCandidates(3, 1_MB);
+  candidates[2].wal_retained_bytes = 100_MB;
+
+  auto selected = policy.SelectTabletsToFlush(candidates, 3_MB, 3_MB);
+  ASSERT_EQ(1U, selected.size());
+  ASSERT_EQ(2U, selected[0]);
+}
+
+TEST(MemstoreFlushPolicyTest, WriteRateWindow) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_memstore_flush_write_rate_window_ms = 1000;
+
+  MemstoreFlushPolicy policy(nullptr);
+  auto candidates = EqualCandidates(1, 1_MB);
+  MonoTime now = MonoTime::Now(MonoTime::FINE);
+  policy.SelectTabletsToFlush(candidates, 1_MB, 1_MB, now);
+
+  candidates[0].num_writes = 1000;
+  now += MonoDelta::FromSeconds(1);
+  policy.SelectTabletsToFlush(candidates, 1_MB, 1_MB, now);
+  ASSERT_DOUBLE_EQ(1000, policy.WriteRate(candidates[0].tablet_id));
+
+  // Decisions made in quick succession, without new writes, keep the measured rate.
+  for (int i = 0; i != 10; ++i) {
+    now += MonoDelta::FromMilliseconds(10);
+    policy.SelectTabletsToFlush(candidates, 1_MB, 1_MB, now);
+    ASSERT_DOUBLE_EQ(1000, policy.WriteRate(candidates[0].tablet_id));
+  }
+
+  // Once the window has passed, the rate covers the whole interval since the last measurement.
+  candidates[0].num_writes = 1500;
+  now += MonoDelta::FromMilliseconds(900);
+  policy.SelectTabletsToFlush(candidates, 1_MB, 1_MB, now);
+  ASSERT_DOUBLE_EQ(500, policy.WriteRate(candidates[0].tablet_id));
+}
+
+} // namespace tserver
+} // namespace yb
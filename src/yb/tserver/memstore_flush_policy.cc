@@ -0,0 +1,226 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tserver/memstore_flush_policy.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "yb/util/flag_tags.h"
+#include "yb/util/metrics.h"
+
+DEFINE_double(memstore_flush_size_weight, 1.0,
+              "Weight of the tablet's share of total memstore memory when choosing tablets to "
+              "flush because the global memstore limit is exceeded.");
+TAG_FLAG(memstore_flush_size_weight, advanced);
+
+DEFINE_double(memstore_flush_wal_retention_weight, 0.5,
+              "Weight of the tablet's share of WAL bytes retained by unflushed memstores when "
+              "choosing tablets to flush because the global memstore limit is exceeded.");
+TAG_FLAG(memstore_flush_wal_retention_weight, advanced);
+
+DEFINE_double(memstore_flush_write_rate_weight, 0.5,
+              "Weight of the tablet's share of the recent write rate when choosing tablets to "
+              "flush because the global memstore limit is exceeded.");
+TAG_FLAG(memstore_flush_write_rate_weight, advanced);
+
+DEFINE_int32(memstore_flush_write_rate_window_ms, 1000,
+             "Minimal interval over which the tablet's write rate is measured for the memstore "
+             "flush policy. Flush decisions made more often reuse the previously measured rate.");
+TAG_FLAG(memstore_flush_write_rate_window_ms, advanced);
+
+DEFINE_int32(memstore_flush_max_parallel_flushes, 4,
+             "Maximal number of tablets that could be scheduled for flush at once when the global "
+             "memstore limit is exceeded.");
+TAG_FLAG(memstore_flush_max_parallel_flushes, advanced);
+
+DEFINE_int32(memstore_flush_target_percentage, 80,
+             "When the global memstore limit is exceeded, tablets are scheduled for flush until "
+             "the memory they hold brings memstore usage down to this percentage of the limit.");
+TAG_FLAG(memstore_flush_target_percentage, advanced);
+
+METRIC_DEFINE_counter(server, memstore_flush_policy_tablets_flushed,
+                      "Tablets Flushed By Memstore Limit",
+                      yb::MetricUnit::kOperations,
+                      "Number of tablet flushes scheduled because the global memstore limit was "
+                      "exceeded.");
+
+METRIC_DEFINE_counter(server, memstore_flush_policy_bytes_flushed,
+                      "Memstore Bytes Flushed By Memstore Limit",
+                      yb::MetricUnit::kBytes,
+                      "Memstore bytes of the tablets scheduled for flush because the global "
+                      "memstore limit was exceeded.");
+
+METRIC_DEFINE_counter(server, memstore_flush_policy_wal_bytes_released,
+                      "WAL Bytes Released By Memstore Limit Flushes",
+                      yb::MetricUnit::kBytes,
+                      "WAL bytes retained by the tablets scheduled for flush because the global "
+                      "memstore limit was exceeded.");
+
+METRIC_DEFINE_histogram(server, memstore_flush_policy_parallel_flushes,
+                        "Parallel Flushes Per Memstore Limit Decision",
+                        yb::MetricUnit::kTasks,
+                        "Number of tablets scheduled for flush at once because the global "
+                        "memstore limit was exceeded.",
+                        1000, 2);
+
+namespace yb {
+namespace tserver {
+
+namespace {
+
+double Share(double value, double total) {
+  return total > 0 ? value / total : 0;
+}
+
+} // namespace
+
+MemstoreFlushPolicy::MemstoreFlushPolicy(const scoped_refptr<MetricEntity>& metric_entity) {
+  if (metric_entity) {
+    tablets_flushed_ = METRIC_memstore_flush_policy_tablets_flushed.Instantiate(metric_entity);
+    bytes_flushed_ = METRIC_memstore_flush_policy_bytes_flushed.Instantiate(metric_entity);
+    wal_bytes_released_ =
+        METRIC_memstore_flush_policy_wal_bytes_released.Instantiate(metric_entity);
+    parallel_flushes_ = METRIC_memstore_flush_policy_parallel_flushes.Instantiate(metric_entity);
+  }
+}
+
+std::vector<size_t> MemstoreFlushPolicy::SelectTabletsToFlush(
+    const std::vector<MemstoreFlushCandidate>& candidates,
+    size_t memory_usage,
+    size_t memory_limit) {
+  return SelectTabletsToFlush(
+      candidates, memory_usage, memory_limit, MonoTime::Now(MonoTime::FINE));
+}
+
+std::vector<size_t> MemstoreFlushPolicy::SelectTabletsToFlush(
+    const std::vector<MemstoreFlushCandidate>& candidates,
+    size_t memory_usage,
+    size_t memory_limit,
+    MonoTime now) {
+  UpdateWriteRates(candidates, now);
+
+  double total_memstore_bytes = 0;
+  double total_wal_retained_bytes = 0;
+  double total_write_rate = 0;
+  std::vector<size_t> eligible;
+  eligible.reserve(candidates.size());
+  for (size_t i = 0; i != candidates.size(); ++i) {
+    const auto& candidate = candidates[i];
+    // Memstore is empty or flush was already scheduled.
+    if (candidate.oldest_write_in_memstore == HybridTime::kMax) {
+      continue;
+    }
+    eligible.push_back(i);
+    total_memstore_bytes += candidate.memstore_bytes;
+    total_wal_retained_bytes += candidate.wal_retained_bytes;
+    total_write_rate += WriteRate(candidate.tablet_id);
+  }
+
+  if (eligible.empty()) {
+    return eligible;
+  }
+
+  std::vector<double> scores(candidates.size());
+  for (auto idx : eligible) {
+    const auto& candidate = candidates[idx];
+    scores[idx] =
+        FLAGS_memstore_flush_size_weight *
+            Share(candidate.memstore_bytes, total_memstore_bytes) +
+        FLAGS_memstore_flush_wal_retention_weight *
+            Share(candidate.wal_retained_bytes, total_wal_retained_bytes) +
+        FLAGS_memstore_flush_write_rate_weight *
+            Share(WriteRate(candidate.tablet_id), total_write_rate);
+  }
+
+  // Prefer tablets with higher score, then tablets with older writes, like the previous policy.
+  std::sort(eligible.begin(), eligible.end(), [&candidates, &scores](size_t lhs, size_t rhs) {
+    if (scores[lhs] != scores[rhs]) {
+      return scores[lhs] > scores[rhs];
+    }
+    return candidates[lhs].oldest_write_in_memstore < candidates[rhs].oldest_write_in_memstore;
+  });
+
+  const size_t target_usage = memory_limit * FLAGS_memstore_flush_target_percentage / 100;
+  const size_t bytes_to_free = memory_usage > target_usage ? memory_usage - target_usage : 0;
+  const size_t max_flushes = std::max(FLAGS_memstore_flush_max_parallel_flushes, 1);
+
+  std::vector<size_t> result;
+  size_t bytes_freed = 0;
+  int64_t wal_bytes_released = 0;
+  for (auto idx : eligible) {
+    if (!result.empty() && (bytes_freed >= bytes_to_free || result.size() >= max_flushes)) {
+      break;
+    }
+    result.push_back(idx);
+    bytes_freed += candidates[idx].memstore_bytes;
+    wal_bytes_released += candidates[idx].wal_retained_bytes;
+    VLOG(1) << "Scheduling flush of " << candidates[idx].tablet_id << ", score: " << scores[idx]
+            << ", memstore bytes: " << candidates[idx].memstore_bytes
+            << ", WAL retained bytes: " << candidates[idx].wal_retained_bytes
+            << ", write rate: " << WriteRate(candidates[idx].tablet_id);
+  }
+
+  if (tablets_flushed_) {
+    tablets_flushed_->IncrementBy(result.size());
+    bytes_flushed_->IncrementBy(bytes_freed);
+    wal_bytes_released_->IncrementBy(wal_bytes_released);
+    parallel_flushes_->Increment(result.size());
+  }
+
+  return result;
+}
+
+double MemstoreFlushPolicy::WriteRate(const std::string& tablet_id) const {
+  auto it = write_rates_.find(tablet_id);
+  return it != write_rates_.end() ? it->second.rate : 0;
+}
+
+void MemstoreFlushPolicy::UpdateWriteRates(const std::vector<MemstoreFlushCandidate>& candidates,
+                                           MonoTime now) {
+  std::unordered_set<std::string> alive;
+  for (const auto& candidate : candidates) {
+    alive.insert(candidate.tablet_id);
+    auto& state = write_rates_[candidate.tablet_id];
+    if (state.last_update) {
+      // Flush decisions could be made many times per second while memory usage stays over the
+      // limit, so the rate is only recomputed once the window has passed. Otherwise it would be
+      // measured over tiny intervals and drop to zero for tablets with infrequent writes.
+      const MonoDelta elapsed = now.GetDeltaSince(state.last_update);
+      if (elapsed.ToMilliseconds() < std::max(FLAGS_memstore_flush_write_rate_window_ms, 1)) {
+        continue;
+      }
+      const double seconds = elapsed.ToSeconds();
+      // Number of writes could go backward if the tablet was reopened.
+      const size_t delta = candidate.num_writes >= state.num_writes
+          ? candidate.num_writes - state.num_writes : candidate.num_writes;
+      state.rate = delta / seconds;
+    }
+    state.num_writes = candidate.num_writes;
+    state.last_update = now;
+  }
+
+  for (auto it = write_rates_.begin(); it != write_rates_.end();) {
+    if (alive.count(it->first)) {
+      ++it;
+    } else {
+      it = write_rates_.erase(it);
+    }
+  }
+}
+
+} // namespace tserver
+} // namespace yb
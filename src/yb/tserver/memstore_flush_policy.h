@@ -0,0 +1,99 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TSERVER_MEMSTORE_FLUSH_POLICY_H
+#define YB_TSERVER_MEMSTORE_FLUSH_POLICY_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/common/hybrid_time.h"
+#include "yb/gutil/ref_counted.h"
+#include "yb/util/monotime.h"
+
+namespace yb {
+
+class Counter;
+class Histogram;
+class MetricEntity;
+
+namespace tserver {
+
+// Per-tablet input of the memstore flush policy.
+struct MemstoreFlushCandidate {
+  std::string tablet_id;
+
+  // Size of the active memtable, i.e. memory that would be released by the flush.
+  size_t memstore_bytes = 0;
+
+  // WAL bytes that could not be garbage collected because of unflushed memtable data.
+  int64_t wal_retained_bytes = 0;
+
+  // Total number of writes to the tablet's RocksDB since the tablet was opened.
+  size_t num_writes = 0;
+
+  // Hybrid time of the oldest write in the memstore, HybridTime::kMax if memstore is empty.
+  HybridTime oldest_write_in_memstore = HybridTime::kMax;
+};
+
+// Decides which tablets should be flushed when the global memstore limit is exceeded.
+//
+// Each candidate gets a score combining its share of total memstore memory, its share of retained
+// WAL bytes and its share of the recent write rate. The best candidates are flushed first, and
+// when memory usage is far above the limit several tablets are picked at once, so that their
+// flushes run in parallel.
+//
+// Not thread safe, expected to be used from the flush background task only.
+class MemstoreFlushPolicy {
+ public:
+  explicit MemstoreFlushPolicy(const scoped_refptr<MetricEntity>& metric_entity);
+
+  // Returns indexes of candidates that should be flushed, ordered by decreasing priority.
+  // memory_usage and memory_limit describe the state of the global memstore memory monitor.
+  std::vector<size_t> SelectTabletsToFlush(const std::vector<MemstoreFlushCandidate>& candidates,
+                                           size_t memory_usage,
+                                           size_t memory_limit);
+
+  // Same as above, but uses the specified time for write rate calculation.
+  std::vector<size_t> SelectTabletsToFlush(const std::vector<MemstoreFlushCandidate>& candidates,
+                                           size_t memory_usage,
+                                           size_t memory_limit,
+                                           MonoTime now);
+
+  // Write rate, in writes per second, that was last computed for the specified tablet.
+  double WriteRate(const std::string& tablet_id) const;
+
+ private:
+  struct WriteRateState {
+    size_t num_writes = 0;
+    MonoTime last_update;
+    double rate = 0;
+  };
+
+  // Updates write rate state for all candidates and forgets about tablets that are gone.
+  // The rate of a tablet is recomputed at most once per memstore_flush_write_rate_window_ms.
+  void UpdateWriteRates(const std::vector<MemstoreFlushCandidate>& candidates, MonoTime now);
+
+  std::unordered_map<std::string, WriteRateState> write_rates_;
+
+  scoped_refptr<Counter> tablets_flushed_;
+  scoped_refptr<Counter> bytes_flushed_;
+  scoped_refptr<Counter> wal_bytes_released_;
+  scoped_refptr<Histogram> parallel_flushes_;
+};
+
+} // namespace tserver
+} // namespace yb
+
+#endif // YB_TSERVER_MEMSTORE_FLUSH_POLICY_H
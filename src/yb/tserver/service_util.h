@@ -92,23 +92,16 @@ StatusCallback BindHandleResponse(RespType* resp,
 }
 
 // Lookup the given tablet, ensuring that it both exists and is RUNNING.
-// If it is not, respond to the RPC associated with 'context' after setting
-// resp->mutable_error() to indicate the failure reason.
-//
-// Returns true if successful.
-template<class RespClass>
-bool LookupTabletPeerOrRespond(TabletPeerLookupIf* tablet_manager,
-                               const string& tablet_id,
-                               RespClass* resp,
-                               rpc::RpcContext* context,
-                               scoped_refptr<tablet::TabletPeer>* peer) {
+// If it is not, returns the failure reason and sets *error_code accordingly.
+inline CHECKED_STATUS LookupTabletPeer(TabletPeerLookupIf* tablet_manager,
+                                       const string& tablet_id,
+                                       scoped_refptr<tablet::TabletPeer>* peer,
+                                       TabletServerErrorPB::Code* error_code) {
   Status status = tablet_manager->GetTabletPeer(tablet_id, peer);
   if (PREDICT_FALSE(!status.ok())) {
-    TabletServerErrorPB::Code code = status.IsServiceUnavailable() ?
-                                     TabletServerErrorPB::UNKNOWN_ERROR :
-                                     TabletServerErrorPB::TABLET_NOT_FOUND;
-    SetupErrorAndRespond(resp->mutable_error(), status, code, context);
-    return false;
+    *error_code = status.IsServiceUnavailable() ? TabletServerErrorPB::UNKNOWN_ERROR
+                                                : TabletServerErrorPB::TABLET_NOT_FOUND;
+    return status;
   }
 
   // Check RUNNING state.
@@ -119,8 +112,27 @@ bool LookupTabletPeerOrRespond(TabletPeerLookupIf* tablet_manager,
     if (state == tablet::FAILED) {
       s = s.CloneAndAppend((*peer)->error().ToString());
     }
-    SetupErrorAndRespond(resp->mutable_error(), s,
-                         TabletServerErrorPB::TABLET_NOT_RUNNING, context);
+    *error_code = TabletServerErrorPB::TABLET_NOT_RUNNING;
+    return s;
+  }
+  return Status::OK();
+}
+
+// Lookup the given tablet, ensuring that it both exists and is RUNNING.
+// If it is not, respond to the RPC associated with 'context' after setting
+// resp->mutable_error() to indicate the failure reason.
+//
+// Returns true if successful.
+template<class RespClass>
+bool LookupTabletPeerOrRespond(TabletPeerLookupIf* tablet_manager,
+                               const string& tablet_id,
+                               RespClass* resp,
+                               rpc::RpcContext* context,
+                               scoped_refptr<tablet::TabletPeer>* peer) {
+  TabletServerErrorPB::Code error_code;
+  Status status = LookupTabletPeer(tablet_manager, tablet_id, peer, &error_code);
+  if (PREDICT_FALSE(!status.ok())) {
+    SetupErrorAndRespond(resp->mutable_error(), status, error_code, context);
     return false;
   }
   return true;
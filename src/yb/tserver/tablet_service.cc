@@ -33,6 +33,8 @@
 #include "yb/tserver/tablet_service.h"
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -43,6 +45,7 @@
 #include "yb/consensus/consensus.h"
 #include "yb/consensus/leader_lease.h"
 #include "yb/docdb/doc_operation.h"
+#include "yb/docdb/non_blocking_read.h"
 #include "yb/gutil/bind.h"
 #include "yb/gutil/casts.h"
 #include "yb/gutil/stl_util.h"
@@ -72,6 +75,7 @@
 #include "yb/util/monotime.h"
 #include "yb/util/status.h"
 #include "yb/util/status_callback.h"
+#include "yb/util/threadpool.h"
 #include "yb/util/trace.h"
 #include "yb/consensus/consensus.pb.h"
 #include "yb/tserver/service_util.h"
@@ -109,6 +113,23 @@ DEFINE_bool(tserver_noop_read_write, false, "Respond NOOP to read/write.");
 TAG_FLAG(tserver_noop_read_write, unsafe);
 TAG_FLAG(tserver_noop_read_write, hidden);
 
+DEFINE_bool(tserver_non_blocking_reads, false,
+            "Serve reads from memtables and block cache on the RPC service thread, and continue "
+            "reads that require disk IO in a separate thread pool. So a small number of service "
+            "threads is not blocked by disk IO.");
+TAG_FLAG(tserver_non_blocking_reads, advanced);
+TAG_FLAG(tserver_non_blocking_reads, runtime);
+
+DEFINE_int32(tserver_read_io_threads, 32,
+             "Max number of threads that perform reads requiring disk IO, when "
+             "tserver_non_blocking_reads is set.");
+TAG_FLAG(tserver_read_io_threads, advanced);
+
+DEFINE_int32(multi_raft_update_threads, 16,
+             "Max number of threads that apply requests of MultiRaftUpdateConsensus RPCs, so "
+             "requests of different tablets in the same RPC are applied concurrently.");
+TAG_FLAG(multi_raft_update_threads, advanced);
+
 namespace yb {
 namespace tserver {
 
@@ -150,21 +171,63 @@ using tablet::WriteOperationState;
 
 namespace {
 
+Status GetConsensus(const scoped_refptr<TabletPeer>& tablet_peer,
+                    scoped_refptr<Consensus>* consensus,
+                    TabletServerErrorPB::Code* error_code) {
+  *consensus = tablet_peer->shared_consensus();
+  if (PREDICT_FALSE(!*consensus)) {
+    *error_code = TabletServerErrorPB::TABLET_NOT_RUNNING;
+    return STATUS(ServiceUnavailable, "Consensus unavailable. Tablet not running");
+  }
+  return Status::OK();
+}
+
 template<class RespClass>
 bool GetConsensusOrRespond(const scoped_refptr<TabletPeer>& tablet_peer,
                            RespClass* resp,
                            rpc::RpcContext* context,
                            scoped_refptr<Consensus>* consensus) {
-  *consensus = tablet_peer->shared_consensus();
-  if (!*consensus) {
-    Status s = STATUS(ServiceUnavailable, "Consensus unavailable. Tablet not running");
-    SetupErrorAndRespond(resp->mutable_error(), s,
-                         TabletServerErrorPB::TABLET_NOT_RUNNING, context);
+  TabletServerErrorPB::Code error_code;
+  Status s = GetConsensus(tablet_peer, consensus, &error_code);
+  if (PREDICT_FALSE(!s.ok())) {
+    SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
     return false;
   }
   return true;
 }
 
+// Applies a single request of MultiRaftUpdateConsensus. Errors are reported in resp->error(), since
+// other requests of the batch should still be processed.
+void UpdateConsensusFromBatch(TabletPeerLookupIf* tablet_manager,
+                              ConsensusRequestPB* req,
+                              ConsensusResponsePB* resp) {
+  TabletServerErrorPB::Code error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+  Status s;
+  const string& local_uuid = tablet_manager->NodeInstance().permanent_uuid();
+  if (PREDICT_FALSE(req->has_dest_uuid() && req->dest_uuid() != local_uuid)) {
+    error_code = TabletServerErrorPB::WRONG_SERVER_UUID;
+    s = STATUS_SUBSTITUTE(InvalidArgument,
+                          "MultiRaftUpdateConsensus: Wrong destination UUID requested. "
+                          "Local UUID: $0. Requested UUID: $1",
+                          local_uuid, req->dest_uuid());
+  } else {
+    scoped_refptr<TabletPeer> tablet_peer;
+    scoped_refptr<Consensus> consensus;
+    s = LookupTabletPeer(tablet_manager, req->tablet_id(), &tablet_peer, &error_code);
+    if (s.ok()) {
+      s = GetConsensus(tablet_peer, &consensus, &error_code);
+    }
+    if (s.ok()) {
+      s = consensus->Update(req, resp);
+    }
+  }
+  if (PREDICT_FALSE(!s.ok())) {
+    resp->Clear();
+    StatusToPB(s, resp->mutable_error()->mutable_status());
+    resp->mutable_error()->set_code(error_code);
+  }
+}
+
 Status GetTabletRef(const scoped_refptr<TabletPeer>& tablet_peer,
                     shared_ptr<Tablet>* tablet,
                     TabletServerErrorPB::Code* error_code) {
@@ -484,6 +547,9 @@ static size_t GetMaxBatchSizeBytesHint(const ScanRequestPB* req) {
 TabletServiceImpl::TabletServiceImpl(TabletServerIf* server)
     : TabletServerServiceIf(server->MetricEnt()),
       server_(server) {
+  CHECK_OK(ThreadPoolBuilder("read-io")
+               .set_max_threads(FLAGS_tserver_read_io_threads)
+               .Build(&read_io_pool_));
 }
 
 TabletServiceAdminImpl::TabletServiceAdminImpl(TabletServer* server)
@@ -603,8 +669,7 @@ void TabletServiceImpl::GetTransactionStatus(const GetTransactionStatusRequestPB
     return;
   }
 
-  auto status = tablet_peer->tablet()->transaction_coordinator()->GetStatus(
-      req->transaction_id(), resp);
+  auto status = tablet_peer->tablet()->transaction_coordinator()->GetStatus(*req, resp);
   resp->set_propagated_hybrid_time(server_->Clock()->Now().ToUint64());
   if (status.ok()) {
     context.RespondSuccess();
@@ -926,6 +991,49 @@ bool TabletServiceImpl::GetTabletOrRespond(const ReadRequestPB* req,
   return true;
 }
 
+struct TabletServiceImpl::ReadContext {
+  ReadContext(std::shared_ptr<tablet::AbstractTablet> tablet_, const ReadRequestPB* req_,
+              ReadResponsePB* resp_, rpc::RpcContext context_)
+      : tablet(std::move(tablet_)), read_tx(tablet.get()), req(req_), resp(resp_),
+        context(std::move(context_)) {
+  }
+
+  ~ReadContext() {
+    if (!responded) {
+      SetupErrorAndRespond(resp->mutable_error(), STATUS(Aborted, "Read was aborted"),
+                           TabletServerErrorPB::UNKNOWN_ERROR, &context);
+    }
+  }
+
+  std::shared_ptr<tablet::AbstractTablet> tablet;
+  tablet::ScopedReadOperation read_tx;
+  const ReadRequestPB* req;
+  ReadResponsePB* resp;
+  rpc::RpcContext context;
+  // Index of the first sub-request of the batch, that was not processed yet.
+  int next_index = 0;
+  bool responded = false;
+};
+
+namespace {
+
+// Performs the read. When blocking is false, the read is performed only from memory, and
+// Incomplete is returned if it requires disk IO. Partial result of such read should be discarded.
+template <class F>
+Status PerformRead(bool blocking, const F& read) {
+  if (blocking) {
+    return read();
+  }
+  docdb::NonBlockingReadScope scope;
+  Status status = read();
+  if (scope.incomplete()) {
+    return STATUS(Incomplete, "Read requires disk IO");
+  }
+  return status;
+}
+
+} // namespace
+
 void TabletServiceImpl::Read(const ReadRequestPB* req,
                              ReadResponsePB* resp,
                              rpc::RpcContext context) {
@@ -943,23 +1051,63 @@ void TabletServiceImpl::Read(const ReadRequestPB* req,
     return;
   }
 
-  Status s;
-  tablet::ScopedReadOperation read_tx(tablet.get());
+  auto read_context = std::make_shared<ReadContext>(
+      std::move(tablet), req, resp, std::move(context));
+  ProcessRead(read_context, !FLAGS_tserver_non_blocking_reads);
+}
+
+void TabletServiceImpl::ProcessRead(const std::shared_ptr<ReadContext>& read_context,
+                                    bool blocking) {
+  Status s = ReadBatch(read_context.get(), blocking);
+  if (!blocking && s.IsIncomplete()) {
+    // Suspend the read, so this thread does not wait for disk IO, and continue it in the pool.
+    TRACE("Read requires disk IO");
+    s = read_io_pool_->SubmitFunc([this, read_context] {
+      ProcessRead(read_context, true /* blocking */);
+    });
+    if (s.ok()) {
+      return;
+    }
+    // The pool does not accept the read, so fall back to the blocking read in this thread.
+    s = ReadBatch(read_context.get(), true /* blocking */);
+  }
+
+  read_context->responded = true;
+  auto* resp = read_context->resp;
+  auto* context = &read_context->context;
+  RETURN_UNKNOWN_ERROR_IF_NOT_OK(s, resp, context);
+  if (read_context->req->include_trace() && Trace::CurrentTrace() != nullptr) {
+    resp->set_trace_buffer(Trace::CurrentTrace()->DumpToString(true));
+  }
+  RpcOperationCompletionCallback<ReadResponsePB> callback(
+      std::move(*context), resp, server_->Clock());
+  callback.OperationCompleted();
+  TRACE("Done Read");
+}
+
+Status TabletServiceImpl::ReadBatch(ReadContext* read_context, bool blocking) {
+  auto* tablet = read_context->tablet.get();
+  const auto* req = read_context->req;
+  auto* resp = read_context->resp;
+  const HybridTime read_time = read_context->read_tx.GetReadTimestamp();
+  int& index = read_context->next_index;
   switch (tablet->table_type()) {
     case TableType::REDIS_TABLE_TYPE: {
-      for (const RedisReadRequestPB& redis_read_req : req->redis_batch()) {
+      for (; index < req->redis_batch_size(); ++index) {
+        const RedisReadRequestPB& redis_read_req = req->redis_batch(index);
         RedisResponsePB redis_response;
-        s = tablet->HandleRedisReadRequest(
-            read_tx.GetReadTimestamp(), redis_read_req, &redis_response);
-        RETURN_UNKNOWN_ERROR_IF_NOT_OK(s, resp, &context);
+        RETURN_NOT_OK(PerformRead(blocking, [&] {
+          return tablet->HandleRedisReadRequest(read_time, redis_read_req, &redis_response);
+        }));
         *(resp->add_redis_batch()) = redis_response;
       }
       break;
     }
     case TableType::YQL_TABLE_TYPE: {
-      for (const QLReadRequestPB& ql_read_req : req->ql_batch()) {
+      for (; index < req->ql_batch_size(); ++index) {
+        const QLReadRequestPB& ql_read_req = req->ql_batch(index);
         // Update the remote endpoint.
-        const auto& remote_address = context.remote_address();
+        const auto& remote_address = read_context->context.remote_address();
         HostPortPB *hostPortPB =
             const_cast<QLReadRequestPB&>(ql_read_req).mutable_remote_endpoint();
         hostPortPB->set_host(remote_address.address().to_string());
@@ -969,13 +1117,14 @@ void TabletServiceImpl::Read(const ReadRequestPB* req,
         gscoped_ptr<faststring> rows_data;
         int rows_data_sidecar_idx = 0;
         TRACE("Start HandleQLReadRequest");
-        s = tablet->HandleQLReadRequest(
-            read_tx.GetReadTimestamp(), ql_read_req, req->transaction(), &ql_response, &rows_data);
+        RETURN_NOT_OK(PerformRead(blocking, [&] {
+          return tablet->HandleQLReadRequest(
+              read_time, ql_read_req, req->transaction(), &ql_response, &rows_data);
+        }));
         TRACE("Done HandleQLReadRequest");
-        RETURN_UNKNOWN_ERROR_IF_NOT_OK(s, resp, &context);
         if (rows_data.get() != nullptr) {
-          s = context.AddRpcSidecar(RefCntBuffer(*rows_data), &rows_data_sidecar_idx);
-          RETURN_UNKNOWN_ERROR_IF_NOT_OK(s, resp, &context);
+          RETURN_NOT_OK(read_context->context.AddRpcSidecar(
+              RefCntBuffer(*rows_data), &rows_data_sidecar_idx));
           ql_response.set_rows_data_sidecar(rows_data_sidecar_idx);
         }
         *(resp->add_ql_batch()) = ql_response;
@@ -990,22 +1139,20 @@ void TabletServiceImpl::Read(const ReadRequestPB* req,
       LOG(FATAL) << "Unknown table type: " << tablet->table_type();
       break;
   }
-  if (req->include_trace() && Trace::CurrentTrace() != nullptr) {
-    resp->set_trace_buffer(Trace::CurrentTrace()->DumpToString(true));
-  }
-  RpcOperationCompletionCallback<ReadResponsePB> callback(
-      std::move(context), resp, server_->Clock());
-  callback.OperationCompleted();
-  TRACE("Done Read");
+  return Status::OK();
 }
 
 ConsensusServiceImpl::ConsensusServiceImpl(const scoped_refptr<MetricEntity>& metric_entity,
                                            TabletPeerLookupIf* tablet_manager)
     : ConsensusServiceIf(metric_entity),
       tablet_manager_(tablet_manager) {
+  CHECK_OK(ThreadPoolBuilder("multi-raft-update")
+               .set_max_threads(FLAGS_multi_raft_update_threads)
+               .Build(&multi_raft_update_pool_));
 }
 
 ConsensusServiceImpl::~ConsensusServiceImpl() {
+  multi_raft_update_pool_->Shutdown();
 }
 
 void ConsensusServiceImpl::UpdateConsensus(const ConsensusRequestPB* req,
@@ -1042,6 +1189,60 @@ void ConsensusServiceImpl::UpdateConsensus(const ConsensusRequestPB* req,
   context.RespondSuccess();
 }
 
+void ConsensusServiceImpl::MultiRaftUpdateConsensus(
+    const consensus::MultiRaftConsensusRequestPB* req,
+    consensus::MultiRaftConsensusResponsePB* resp,
+    rpc::RpcContext context) {
+  DVLOG(3) << "Received Multi Raft Consensus Update RPC with " << req->consensus_request_size()
+           << " requests";
+  const int num_requests = req->consensus_request_size();
+  if (num_requests == 0) {
+    context.RespondSuccess();
+    return;
+  }
+
+  // Requests of different tablets are independent, so they are applied concurrently, and the
+  // response is sent when the last of them finishes. Responses are added upfront, so each request
+  // fills its own one.
+  for (int i = 0; i != num_requests; ++i) {
+    resp->add_consensus_response();
+  }
+  struct MultiRaftUpdateState {
+    rpc::RpcContext context;
+    std::atomic<int> pending;
+
+    MultiRaftUpdateState(rpc::RpcContext context_, int pending_)
+        : context(std::move(context_)), pending(pending_) {}
+
+    ~MultiRaftUpdateState() {
+      if (pending != 0) {
+        // Pool shutdown dropped some of the updates.
+        context.RespondRpcFailure(rpc::ErrorStatusPB::ERROR_SERVER_TOO_BUSY,
+                                  STATUS(ServiceUnavailable, "Consensus service is shutting down"));
+      }
+    }
+  };
+  auto state = std::make_shared<MultiRaftUpdateState>(std::move(context), num_requests);
+
+  // See UpdateConsensus for the reason of const_cast.
+  auto* requests = const_cast<consensus::MultiRaftConsensusRequestPB*>(req)
+      ->mutable_consensus_request();
+  for (int i = 0; i != num_requests; ++i) {
+    auto* consensus_req = requests->Mutable(i);
+    auto* consensus_resp = resp->mutable_consensus_response(i);
+    std::function<void()> update = [this, consensus_req, consensus_resp, state] {
+      UpdateConsensusFromBatch(tablet_manager_, consensus_req, consensus_resp);
+      if (--state->pending == 0) {
+        state->context.RespondSuccess();
+      }
+    };
+    if (!multi_raft_update_pool_->SubmitFunc(update).ok()) {
+      // The pool does not accept the update, so apply it in this thread.
+      update();
+    }
+  }
+}
+
 void ConsensusServiceImpl::RequestConsensusVote(const VoteRequestPB* req,
                                                 VoteResponsePB* resp,
                                                 rpc::RpcContext context) {
@@ -1496,7 +1697,28 @@ void TabletServiceImpl::ImportData(const ImportDataRequestPB* req,
                                  &peer)) {
     return;
   }
-  auto status = peer->tablet()->ImportData(req->source_dir());
+  auto status = req->has_import_id() ? peer->tablet()->ImportStagedData(req->import_id())
+                                      : peer->tablet()->ImportData(req->source_dir());
+  if (!status.ok()) {
+    SetupErrorAndRespond(resp->mutable_error(),
+                         status,
+                         TabletServerErrorPB::UNKNOWN_ERROR,
+                         &context);
+    return;
+  }
+  context.RespondSuccess();
+}
+
+void TabletServiceImpl::UploadImportFile(const UploadImportFileRequestPB* req,
+                                         UploadImportFileResponsePB* resp,
+                                         rpc::RpcContext context) {
+  tablet::TabletPeerPtr peer;
+  if (!LookupTabletPeerOrRespond(server_->tablet_manager(), req->tablet_id(), resp, &context,
+                                 &peer)) {
+    return;
+  }
+  auto status = peer->tablet()->AppendImportFile(
+      req->import_id(), req->file_name(), req->offset(), req->data());
   if (!status.ok()) {
     SetupErrorAndRespond(resp->mutable_error(),
                          status,
@@ -1508,6 +1730,8 @@ void TabletServiceImpl::ImportData(const ImportDataRequestPB* req,
 }
 
 void TabletServiceImpl::Shutdown() {
+  // Queued reads are destroyed without running, and ReadContext responds to them.
+  read_io_pool_->Shutdown();
 }
 
 // Extract a void* pointer suitable for use in a ColumnRangePredicate from the
@@ -48,6 +48,7 @@ class RowwiseIterator;
 class Schema;
 class Status;
 class HybridTime;
+class ThreadPool;
 
 namespace tablet {
 class Tablet;
@@ -99,6 +100,10 @@ class TabletServiceImpl : public TabletServerServiceIf {
                   ImportDataResponsePB* resp,
                   rpc::RpcContext context) override;
 
+  void UploadImportFile(const UploadImportFileRequestPB* req,
+                        UploadImportFileResponsePB* resp,
+                        rpc::RpcContext context) override;
+
   void UpdateTransaction(const UpdateTransactionRequestPB* req,
                          UpdateTransactionResponsePB* resp,
                          rpc::RpcContext context) override;
@@ -114,6 +119,16 @@ class TabletServiceImpl : public TabletServerServiceIf {
   void Shutdown() override;
 
  private:
+  struct ReadContext;
+
+  // Processes sub-requests of the read batch, that were not processed yet. When blocking is false,
+  // reads that require disk IO are not performed, instead the read is continued in read_io_pool_.
+  // Responds to the read when it is completed.
+  void ProcessRead(const std::shared_ptr<ReadContext>& read_context, bool blocking);
+
+  // Returns Incomplete when blocking is false and the next sub-request requires disk IO.
+  CHECKED_STATUS ReadBatch(ReadContext* read_context, bool blocking);
+
   CHECKED_STATUS HandleNewScanRequest(tablet::TabletPeer* tablet_peer,
                               const ScanRequestPB* req,
                               const rpc::RpcContext* rpc_context,
@@ -165,6 +180,9 @@ class TabletServiceImpl : public TabletServerServiceIf {
                      tablet::TabletPtr* tablet);
 
   TabletServerIf *const server_;
+
+  // Performs reads that could not be served from memory, when tserver_non_blocking_reads is set.
+  std::unique_ptr<ThreadPool> read_io_pool_;
 };
 
 class TabletServiceAdminImpl : public TabletServerAdminServiceIf {
@@ -197,6 +215,10 @@ class ConsensusServiceImpl : public consensus::ConsensusServiceIf {
                                consensus::ConsensusResponsePB *resp,
                                rpc::RpcContext context) override;
 
+  virtual void MultiRaftUpdateConsensus(const consensus::MultiRaftConsensusRequestPB *req,
+                                        consensus::MultiRaftConsensusResponsePB *resp,
+                                        rpc::RpcContext context) override;
+
   virtual void RequestConsensusVote(const consensus::VoteRequestPB* req,
                                     consensus::VoteResponsePB* resp,
                                     rpc::RpcContext context) override;
@@ -235,6 +257,9 @@ class ConsensusServiceImpl : public consensus::ConsensusServiceIf {
 
  private:
   TabletPeerLookupIf* tablet_manager_;
+
+  // Applies requests of MultiRaftUpdateConsensus RPCs.
+  std::unique_ptr<ThreadPool> multi_raft_update_pool_;
 };
 
 }  // namespace tserver
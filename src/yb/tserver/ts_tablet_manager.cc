@@ -49,6 +49,7 @@
 #include "yb/consensus/log.h"
 #include "yb/consensus/log_anchor_registry.h"
 #include "yb/consensus/metadata.pb.h"
+#include "yb/consensus/multi_raft_batcher.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/quorum_util.h"
 
@@ -61,6 +62,7 @@
 #include "yb/master/sys_catalog.h"
 
 #include "yb/rocksdb/memory_monitor.h"
+#include "yb/rocksdb/rate_limiter.h"
 
 #include "yb/rpc/messenger.h"
 
@@ -70,9 +72,11 @@
 #include "yb/tablet/tablet_bootstrap_if.h"
 #include "yb/tablet/tablet_metadata.h"
 #include "yb/tablet/tablet_peer.h"
+#include "yb/tablet/ql_scan_cache.h"
 #include "yb/tablet/tablet_options.h"
 
 #include "yb/tserver/heartbeater.h"
+#include "yb/tserver/memstore_flush_policy.h"
 #include "yb/tserver/remote_bootstrap_client.h"
 #include "yb/tserver/tablet_server.h"
 
@@ -85,6 +89,7 @@
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
 #include "yb/util/pb_util.h"
+#include "yb/util/priority_thread_pool.h"
 #include "yb/util/stopwatch.h"
 #include "yb/util/trace.h"
 #include "yb/util/tsan_util.h"
@@ -155,6 +160,23 @@ DEFINE_int32(db_block_cache_size_percentage, 50,
              "Default percentage of total available memory to use as block cache size, if not "
              "asking for a raw number, through FLAGS_db_block_cache_size_bytes.");
 
+DEFINE_int32(tserver_compaction_threads, -1,
+             "Number of threads in the tablet server wide pool that runs compactions of all "
+             "tablets, ordered by level0 backlog and write stall risk of tablets. -1 means use "
+             "rocksdb_max_background_compactions threads, 0 disables the shared pool.");
+TAG_FLAG(tserver_compaction_threads, advanced);
+
+DEFINE_bool(rocksdb_compact_flush_rate_limit_shared, false,
+            "Whether rocksdb_compact_flush_rate_limit_bytes_per_sec is a budget shared by all "
+            "tablets of the tablet server, instead of a limit for each tablet. Flushes are "
+            "charged to this budget with high I/O priority, but they are not run by the "
+            "tserver compaction pool, so the budget should be sized for flushes of all tablets.");
+TAG_FLAG(rocksdb_compact_flush_rate_limit_shared, advanced);
+
+DECLARE_int32(rocksdb_max_background_compactions);
+DECLARE_int64(rocksdb_compact_flush_rate_limit_bytes_per_sec);
+DECLARE_bool(rocksdb_disable_compactions);
+
 DEFINE_test_flag(int32, sleep_after_tombstoning_tablet_secs, 0,
                  "Whether we sleep in LogAndTombstone after calling DeleteTabletData.");
 
@@ -188,6 +210,29 @@ METRIC_DEFINE_histogram(server, op_apply_run_time, "Operation Apply Run Time",
                         "that operations consist of very large batches.",
                         10000000, 2);
 
+METRIC_DEFINE_histogram(server, compaction_queue_length, "Compaction Queue Length",
+                        MetricUnit::kTasks,
+                        "Number of compactions waiting to be started in the tablet server wide "
+                        "compaction pool.",
+                        10000, 2);
+
+METRIC_DEFINE_histogram(server, compaction_queue_time, "Compaction Queue Time",
+                        MetricUnit::kMicroseconds,
+                        "Time that compactions spent waiting in the tablet server wide compaction "
+                        "pool before being started.",
+                        60000000LU, 2);
+
+METRIC_DEFINE_histogram(server, compaction_run_time, "Compaction Run Time",
+                        MetricUnit::kMicroseconds,
+                        "Time that compactions spent running in the tablet server wide compaction "
+                        "pool.",
+                        3600000000LU, 2);
+
+METRIC_DEFINE_counter(server, compactions_prioritized, "Compactions Prioritized",
+                      MetricUnit::kTasks,
+                      "Number of compactions that were started before compactions submitted "
+                      "earlier, because of tablet priority or fairness.");
+
 using consensus::ConsensusMetadata;
 using consensus::ConsensusStatePB;
 using consensus::OpId;
@@ -220,34 +265,56 @@ void TSTabletManager::MaybeFlushTablet() {
   int iteration = 0;
   while (memory_monitor()->Exceeded() ||
          (iteration++ == 0 && FLAGS_pretend_memory_exceeded_enforce_flush)) {
-    scoped_refptr<TabletPeer> tablet_to_flush = TabletToFlush();
-    // TODO(bojanserafimov): If tablet_to_flush flushes now because of other reasons,
+    // TODO(bojanserafimov): If a tablet to flush flushes now because of other reasons,
     // we will schedule a second flush, which will unnecessarily stall writes for a short time. This
     // will not happen often, but should be fixed.
-    if (tablet_to_flush) {
+    for (const auto& tablet_to_flush : TabletsToFlush()) {
       WARN_NOT_OK(tablet_to_flush->tablet()->Flush(tablet::FlushMode::kAsync),
           Substitute("Flush failed on $0", tablet_to_flush->tablet_id()));
     }
   }
 }
 
-// Return the tablet with the oldest write in memstore, or nullptr if all
+// Return the tablets chosen by the memstore flush policy, or an empty vector if all
 // tablet memstores are empty or about to flush.
-scoped_refptr<TabletPeer> TSTabletManager::TabletToFlush() {
-  boost::shared_lock<rw_spinlock> lock(lock_); // For using the tablet map
-  HybridTime oldest_write_in_memstores = HybridTime::kMax;
-  scoped_refptr<TabletPeer> tablet_to_flush;
-  for (const TabletMap::value_type& entry : tablet_map_) {
-    const auto tablet = entry.second->shared_tablet();
-    if (tablet) {
-      const HybridTime oldest_write_in_memstore = tablet->flush_stats()->oldest_write_in_memstore();
-      if (oldest_write_in_memstore < oldest_write_in_memstores) {
-        oldest_write_in_memstores = oldest_write_in_memstore;
-        tablet_to_flush = entry.second;
-      }
+std::vector<scoped_refptr<TabletPeer>> TSTabletManager::TabletsToFlush() {
+  std::vector<scoped_refptr<TabletPeer>> peers;
+  {
+    boost::shared_lock<rw_spinlock> lock(lock_); // For using the tablet map
+    peers.reserve(tablet_map_.size());
+    for (const TabletMap::value_type& entry : tablet_map_) {
+      peers.push_back(entry.second);
+    }
+  }
+
+  std::vector<scoped_refptr<TabletPeer>> tablet_peers;
+  std::vector<MemstoreFlushCandidate> candidates;
+  tablet_peers.reserve(peers.size());
+  candidates.reserve(peers.size());
+  for (auto& peer : peers) {
+    const auto tablet = peer->shared_tablet();
+    if (!tablet) {
+      continue;
     }
+    MemstoreFlushCandidate candidate;
+    candidate.tablet_id = peer->tablet_id();
+    candidate.memstore_bytes = tablet->MemTableSize();
+    candidate.num_writes = tablet->flush_stats()->num_writes();
+    candidate.oldest_write_in_memstore = tablet->flush_stats()->oldest_write_in_memstore();
+    TabletPeer::MaxIdxToSegmentSizeMap max_idx_to_segment_size;
+    if (peer->GetMaxIndexesToSegmentSizeMap(&max_idx_to_segment_size).ok()) {
+      candidate.wal_retained_bytes = tablet->MemTableLogRetentionSize(max_idx_to_segment_size);
+    }
+    candidates.push_back(std::move(candidate));
+    tablet_peers.push_back(std::move(peer));
+  }
+
+  std::vector<scoped_refptr<TabletPeer>> result;
+  for (auto idx : memstore_flush_policy_->SelectTabletsToFlush(
+           candidates, memory_monitor()->memory_usage(), memory_monitor()->limit())) {
+    result.push_back(tablet_peers[idx]);
   }
-  return tablet_to_flush;
+  return result;
 }
 
 TSTabletManager::TSTabletManager(FsManager* fs_manager,
@@ -289,6 +356,32 @@ TSTabletManager::TSTabletManager(FsManager* fs_manager,
     tablet_options_.block_cache->SetMetrics(server_->metric_entity());
   }
 
+  if (!FLAGS_rocksdb_disable_compactions) {
+    if (FLAGS_rocksdb_compact_flush_rate_limit_shared &&
+        FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec > 0) {
+      tablet_options_.rate_limiter.reset(
+          rocksdb::NewGenericRateLimiter(FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec));
+    }
+    int compaction_threads = FLAGS_tserver_compaction_threads;
+    if (compaction_threads < 0) {
+      compaction_threads = FLAGS_rocksdb_max_background_compactions;
+    }
+    if (compaction_threads > 0) {
+      auto pool = std::make_shared<PriorityThreadPool>("compaction", compaction_threads);
+      pool->SetQueueLengthHistogram(
+          METRIC_compaction_queue_length.Instantiate(server_->metric_entity()));
+      pool->SetQueueTimeMicrosHistogram(
+          METRIC_compaction_queue_time.Instantiate(server_->metric_entity()));
+      pool->SetRunTimeMicrosHistogram(
+          METRIC_compaction_run_time.Instantiate(server_->metric_entity()));
+      pool->SetPreemptedCounter(
+          METRIC_compactions_prioritized.Instantiate(server_->metric_entity()));
+      tablet_options_.priority_thread_pool_for_compactions = std::move(pool);
+    }
+  }
+
+  tablet_options_.ql_scan_cache = std::make_shared<tablet::QLScanCache>(server_->mem_tracker());
+
   // Calculate memstore_size_bytes
   bool should_count_memory = FLAGS_global_memstore_size_percentage > 0;
   CHECK(FLAGS_global_memstore_size_percentage > 0 && FLAGS_global_memstore_size_percentage <= 100)
@@ -305,6 +398,7 @@ TSTabletManager::TSTabletManager(FsManager* fs_manager,
 
   // Add memory monitor and background thread for flushing
   if (should_count_memory) {
+    memstore_flush_policy_.reset(new MemstoreFlushPolicy(server_->metric_entity()));
     background_task_.reset(new BackgroundTask(
       std::function<void()>([this](){ MaybeFlushTablet(); }),
       "tablet manager",
@@ -341,6 +435,9 @@ Status TSTabletManager::Init() {
 
   InitLocalRaftPeerPB();
 
+  multi_raft_manager_ = std::make_unique<consensus::MultiRaftManager>(
+      server_->messenger(), server_->metric_entity());
+
   vector<scoped_refptr<TabletMetadata> > metas;
 
   // First, load all of the tablet metadata. We do this before we start
@@ -875,7 +972,8 @@ void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
                                     scoped_refptr<server::Clock>(server_->clock()),
                                     server_->messenger(),
                                     log,
-                                    tablet->GetMetricEntity());
+                                    tablet->GetMetricEntity(),
+                                    multi_raft_manager_.get());
 
     if (!s.ok()) {
       LOG(ERROR) << kLogPrefix << "Tablet failed to init: "
@@ -952,6 +1050,12 @@ void TSTabletManager::Shutdown() {
   // Shut down the apply pool.
   apply_pool_->Shutdown();
 
+  if (tablet_options_.priority_thread_pool_for_compactions) {
+    tablet_options_.priority_thread_pool_for_compactions->Shutdown();
+  }
+
+  tablet_options_.ql_scan_cache->Shutdown();
+
   {
     std::lock_guard<rw_spinlock> l(lock_);
     // We don't expect anyone else to be modifying the map after we start the
@@ -1053,6 +1157,25 @@ int TSTabletManager::GetNumLiveTablets() const {
   return count;
 }
 
+void TSTabletManager::GetLeaderTabletSizes(
+    google::protobuf::RepeatedPtrField<master::TabletSizePB>* tablet_sizes) const {
+  boost::shared_lock<rw_spinlock> lock(lock_);
+  for (const auto& entry : tablet_map_) {
+    const scoped_refptr<TabletPeer>& tablet_peer = entry.second;
+    if (tablet_peer->state() != tablet::RUNNING ||
+        tablet_peer->LeaderStatus() != consensus::Consensus::LeaderStatus::LEADER_AND_READY) {
+      continue;
+    }
+    auto tablet = tablet_peer->shared_tablet();
+    if (tablet == nullptr) {
+      continue;
+    }
+    master::TabletSizePB* tablet_size = tablet_sizes->Add();
+    tablet_size->set_tablet_id(entry.first);
+    tablet_size->set_estimated_num_rows(tablet->EstimateNumRows());
+  }
+}
+
 void TSTabletManager::MarkDirtyUnlocked(const std::string& tablet_id,
                                         std::shared_ptr<consensus::StateChangeContext> context) {
   TabletReportState* state = FindOrNull(dirty_tablets_, tablet_id);
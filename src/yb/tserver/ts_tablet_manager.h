@@ -75,6 +75,7 @@ class RaftConfigPB;
 namespace master {
 class ReportedTabletPB;
 class TabletReportPB;
+class TabletSizePB;
 } // namespace master
 
 namespace tablet {
@@ -85,6 +86,7 @@ class TabletStatusListener;
 }
 
 namespace tserver {
+class MemstoreFlushPolicy;
 class TabletServer;
 class TSMemoryMonitorListener;
 
@@ -241,6 +243,10 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // Return the number of tablets in RUNNING or BOOTSTRAPPING state.
   int GetNumLiveTablets() const;
 
+  // Add the estimated sizes of the running tablets led by this tablet server.
+  void GetLeaderTabletSizes(
+      google::protobuf::RepeatedPtrField<master::TabletSizePB>* tablet_sizes) const;
+
   CHECKED_STATUS RunAllLogGC();
 
   // Creates and updates the map of table to the set of tablets assigned per table per disk
@@ -273,7 +279,7 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
 
   MemoryMonitor* memory_monitor() { return tablet_options_.memory_monitor.get(); }
 
-  // Flush some tablet if the memstore memory limit is exceeded
+  // Flush some tablets if the memstore memory limit is exceeded
   void MaybeFlushTablet();
 
  private:
@@ -366,8 +372,9 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // TABLET_DATA_READY state. Generally, we tombstone the replica.
   CHECKED_STATUS HandleNonReadyTabletOnStartup(const scoped_refptr<tablet::TabletMetadata>& meta);
 
-  // Return the tablet with oldest write still in its memstore
-  scoped_refptr<tablet::TabletPeer> TabletToFlush();
+  // Return the tablets that should be flushed to get memstore memory usage back under the limit,
+  // as decided by memstore_flush_policy_.
+  std::vector<scoped_refptr<tablet::TabletPeer>> TabletsToFlush();
 
   TSTabletManagerStatePB state() const {
     boost::shared_lock<rw_spinlock> lock(lock_);
@@ -427,12 +434,19 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // Thread pool for apply transactions, shared between all tablets.
   gscoped_ptr<ThreadPool> apply_pool_;
 
+  // Chooses tablets to flush when the memstore memory limit is exceeded. Only used from
+  // background_task_.
+  std::unique_ptr<MemstoreFlushPolicy> memstore_flush_policy_;
+
   // Used for scheduling flushes
   std::unique_ptr<BackgroundTask> background_task_;
 
   // For block cache and memory monitor shared across tablets
   tablet::TabletOptions tablet_options_;
 
+  // Batches heartbeats of tablets hosted by this server to other servers.
+  std::unique_ptr<consensus::MultiRaftManager> multi_raft_manager_;
+
   yb::client::AsyncClientInitialiser async_client_init_;
 
   DISALLOW_COPY_AND_ASSIGN(TSTabletManager);
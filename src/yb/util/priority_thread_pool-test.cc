@@ -0,0 +1,147 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/util/priority_thread_pool.h"
+
+#include <mutex>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "yb/util/countdown_latch.h"
+#include "yb/util/test_macros.h"
+#include "yb/util/test_util.h"
+
+namespace yb {
+
+namespace {
+
+// Groups are identified by addresses, so use elements of this array as group ids.
+int groups[4];
+
+class RecordingTask : public PriorityThreadPoolTask {
+ public:
+  RecordingTask(int id, std::mutex* mutex, std::vector<int>* order, CountDownLatch* start = nullptr,
+                CountDownLatch* started = nullptr)
+      : id_(id), mutex_(mutex), order_(order), start_(start), started_(started) {}
+
+  void Run(const Status& status) override {
+    if (started_) {
+      started_->CountDown();
+    }
+    if (start_) {
+      start_->Wait();
+    }
+    std::lock_guard<std::mutex> lock(*mutex_);
+    order_->push_back(status.ok() ? id_ : -id_);
+  }
+
+ private:
+  const int id_;
+  std::mutex* mutex_;
+  std::vector<int>* order_;
+  CountDownLatch* start_;
+  CountDownLatch* started_;
+};
+
+} // namespace
+
+class PriorityThreadPoolTest : public YBTest {
+ protected:
+  std::unique_ptr<PriorityThreadPoolTask> MakeTask(int id, CountDownLatch* start = nullptr,
+                                                   CountDownLatch* started = nullptr) {
+    return std::make_unique<RecordingTask>(id, &mutex_, &order_, start, started);
+  }
+
+  std::vector<int> Order() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return order_;
+  }
+
+  CHECKED_STATUS WaitForTasks(size_t count, const std::string& description) {
+    return WaitFor([this, count]() -> Result<bool> { return Order().size() == count; },
+                   MonoDelta::FromSeconds(10), description);
+  }
+
+  std::mutex mutex_;
+  std::vector<int> order_;
+};
+
+TEST_F(PriorityThreadPoolTest, Priority) {
+  PriorityThreadPool pool("test", 1);
+  CountDownLatch start(1);
+  CountDownLatch started(1);
+  ASSERT_OK(pool.Submit(0, MakeTask(1, &start, &started), &groups[0]));
+  started.Wait();
+
+  ASSERT_OK(pool.Submit(1, MakeTask(2), &groups[1]));
+  ASSERT_OK(pool.Submit(5, MakeTask(3), &groups[2]));
+  ASSERT_OK(pool.Submit(3, MakeTask(4), &groups[0]));
+  ASSERT_OK(pool.Submit(5, MakeTask(5), &groups[3]));
+  ASSERT_EQ(4U, pool.num_queued_tasks());
+  start.CountDown();
+
+  ASSERT_OK(WaitForTasks(5, "All tasks complete"));
+  ASSERT_EQ(std::vector<int>({1, 3, 5, 4, 2}), Order());
+  pool.Shutdown();
+}
+
+TEST_F(PriorityThreadPoolTest, Fairness) {
+  PriorityThreadPool pool("test", 2);
+  CountDownLatch start1(1);
+  CountDownLatch start2(1);
+  CountDownLatch started(2);
+  // Occupy both threads.
+  ASSERT_OK(pool.Submit(0, MakeTask(1, &start1, &started), &groups[0]));
+  ASSERT_OK(pool.Submit(0, MakeTask(2, &start2, &started), &groups[2]));
+  started.Wait();
+
+  ASSERT_OK(pool.Submit(10, MakeTask(3), &groups[0]));
+  ASSERT_OK(pool.Submit(1, MakeTask(4), &groups[1]));
+  start2.CountDown();
+
+  // Task 4 is started before task 3 despite lower priority, because group 0 already has a running
+  // task.
+  ASSERT_OK(WaitForTasks(3, "Queued tasks complete"));
+  ASSERT_EQ(std::vector<int>({2, 4, 3}), Order());
+
+  start1.CountDown();
+  ASSERT_OK(WaitForTasks(4, "All tasks complete"));
+  pool.Shutdown();
+}
+
+TEST_F(PriorityThreadPoolTest, RemoveAndShutdown) {
+  PriorityThreadPool pool("test", 1);
+  CountDownLatch start(1);
+  CountDownLatch started(1);
+  ASSERT_OK(pool.Submit(0, MakeTask(1, &start, &started), &groups[0]));
+  started.Wait();
+
+  ASSERT_OK(pool.Submit(0, MakeTask(2), &groups[1]));
+  ASSERT_OK(pool.Submit(0, MakeTask(3), &groups[2]));
+  ASSERT_OK(pool.Submit(0, MakeTask(4), &groups[1]));
+
+  // Queued tasks of group 1 are aborted, running task is not affected.
+  ASSERT_EQ(2U, pool.Remove(&groups[1]));
+  ASSERT_EQ(0U, pool.Remove(&groups[0]));
+  ASSERT_EQ(std::vector<int>({-2, -4}), Order());
+
+  start.CountDown();
+  ASSERT_OK(WaitForTasks(4, "All tasks complete"));
+  pool.Shutdown();
+  ASSERT_EQ(std::vector<int>({-2, -4, 1, 3}), Order());
+
+  ASSERT_NOK(pool.Submit(0, MakeTask(5), &groups[0]));
+}
+
+} // namespace yb
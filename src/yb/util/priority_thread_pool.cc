@@ -0,0 +1,201 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/util/priority_thread_pool.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include <glog/logging.h>
+
+#include "yb/util/format.h"
+#include "yb/util/metrics.h"
+#include "yb/util/thread.h"
+
+namespace yb {
+
+PriorityThreadPool::PriorityThreadPool(const std::string& name, size_t max_running_tasks)
+    : name_(name), max_running_tasks_(std::max<size_t>(max_running_tasks, 1)) {
+}
+
+PriorityThreadPool::~PriorityThreadPool() {
+  Shutdown();
+}
+
+Status PriorityThreadPool::Submit(int priority, std::unique_ptr<PriorityThreadPoolTask> task,
+                                  const void* group) {
+  size_t queue_length;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closing_) {
+      return STATUS_FORMAT(ServiceUnavailable, "Thread pool $0 is shutting down", name_);
+    }
+    queue_length = queue_.size();
+    queue_.push_back(QueuedTask{
+        priority, next_serial_no_++, group, MonoTime::Now(MonoTime::FINE), std::move(task)});
+    if (threads_.size() < max_running_tasks_ && threads_.size() < num_running_ + queue_.size()) {
+      scoped_refptr<Thread> thread;
+      auto status = Thread::Create(
+          "priority_thread_pool", Format("$0 [worker]", name_), &PriorityThreadPool::Execute,
+          this, &thread);
+      if (!status.ok()) {
+        // Task will be picked by one of existing threads.
+        if (threads_.empty()) {
+          queue_.pop_back();
+          return status;
+        }
+        LOG(WARNING) << "Failed to start worker for " << name_ << ": " << status;
+      } else {
+        threads_.push_back(std::move(thread));
+      }
+    }
+  }
+  cond_.notify_one();
+  if (queue_length_histogram_) {
+    queue_length_histogram_->Increment(queue_length);
+  }
+  return Status::OK();
+}
+
+size_t PriorityThreadPool::Remove(const void* group) {
+  std::vector<QueuedTask> removed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::stable_partition(queue_.begin(), queue_.end(), [group](const QueuedTask& task) {
+      return task.group != group;
+    });
+    std::move(it, queue_.end(), std::back_inserter(removed));
+    queue_.erase(it, queue_.end());
+  }
+  const auto status = STATUS(Aborted, "Task removed from thread pool");
+  for (auto& task : removed) {
+    task.task->Run(status);
+  }
+  return removed.size();
+}
+
+void PriorityThreadPool::Shutdown() {
+  std::vector<QueuedTask> removed;
+  std::vector<scoped_refptr<Thread>> threads;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closing_ && threads_.empty() && queue_.empty()) {
+      return;
+    }
+    closing_ = true;
+    removed.swap(queue_);
+    threads.swap(threads_);
+  }
+  cond_.notify_all();
+  const auto status = STATUS_FORMAT(Aborted, "Thread pool $0 is shutting down", name_);
+  for (auto& task : removed) {
+    task.task->Run(status);
+  }
+  for (auto& thread : threads) {
+    thread->Join();
+  }
+}
+
+size_t PriorityThreadPool::num_queued_tasks() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
+size_t PriorityThreadPool::num_running_tasks() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_running_;
+}
+
+std::string PriorityThreadPool::StateToString() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Format("{ name: $0 queued: $1 running: $2 threads: $3 groups_running: $4 }",
+                name_, queue_.size(), num_running_, threads_.size(), running_per_group_.size());
+}
+
+void PriorityThreadPool::SetQueueLengthHistogram(const scoped_refptr<Histogram>& hist) {
+  queue_length_histogram_ = hist;
+}
+
+void PriorityThreadPool::SetQueueTimeMicrosHistogram(const scoped_refptr<Histogram>& hist) {
+  queue_time_us_histogram_ = hist;
+}
+
+void PriorityThreadPool::SetRunTimeMicrosHistogram(const scoped_refptr<Histogram>& hist) {
+  run_time_us_histogram_ = hist;
+}
+
+void PriorityThreadPool::SetPreemptedCounter(const scoped_refptr<Counter>& counter) {
+  preempted_counter_ = counter;
+}
+
+std::vector<PriorityThreadPool::QueuedTask>::iterator PriorityThreadPool::PickTaskUnlocked() {
+  auto running_in_group = [this](const void* group) -> size_t {
+    auto it = running_per_group_.find(group);
+    return it != running_per_group_.end() ? it->second : 0;
+  };
+  return std::min_element(
+      queue_.begin(), queue_.end(),
+      [&running_in_group](const QueuedTask& lhs, const QueuedTask& rhs) {
+        const auto lhs_running = running_in_group(lhs.group);
+        const auto rhs_running = running_in_group(rhs.group);
+        if (lhs_running != rhs_running) {
+          return lhs_running < rhs_running;
+        }
+        if (lhs.priority != rhs.priority) {
+          return lhs.priority > rhs.priority;
+        }
+        return lhs.serial_no < rhs.serial_no;
+      });
+}
+
+void PriorityThreadPool::Execute() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    cond_.wait(lock, [this] { return closing_ || !queue_.empty(); });
+    if (closing_) {
+      break;
+    }
+    auto it = PickTaskUnlocked();
+    const bool preempted = std::any_of(queue_.begin(), queue_.end(),
+        [&it](const QueuedTask& task) { return task.serial_no < it->serial_no; });
+    QueuedTask task = std::move(*it);
+    queue_.erase(it);
+    ++running_per_group_[task.group];
+    ++num_running_;
+    lock.unlock();
+
+    const auto start_time = MonoTime::Now(MonoTime::FINE);
+    if (queue_time_us_histogram_) {
+      queue_time_us_histogram_->Increment(
+          start_time.GetDeltaSince(task.submit_time).ToMicroseconds());
+    }
+    if (preempted && preempted_counter_) {
+      preempted_counter_->Increment();
+    }
+    task.task->Run(Status::OK());
+    task.task.reset();
+    if (run_time_us_histogram_) {
+      run_time_us_histogram_->Increment(
+          MonoTime::Now(MonoTime::FINE).GetDeltaSince(start_time).ToMicroseconds());
+    }
+
+    lock.lock();
+    --num_running_;
+    auto group_it = running_per_group_.find(task.group);
+    if (--group_it->second == 0) {
+      running_per_group_.erase(group_it);
+    }
+  }
+}
+
+} // namespace yb
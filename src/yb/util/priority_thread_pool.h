@@ -0,0 +1,120 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_UTIL_PRIORITY_THREAD_POOL_H
+#define YB_UTIL_PRIORITY_THREAD_POOL_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/gutil/ref_counted.h"
+#include "yb/util/monotime.h"
+#include "yb/util/status.h"
+
+namespace yb {
+
+class Counter;
+class Histogram;
+class Thread;
+
+class PriorityThreadPoolTask {
+ public:
+  virtual ~PriorityThreadPoolTask() = default;
+
+  // If status is not OK, then the task was aborted before it was started, and it should only
+  // release its resources.
+  virtual void Run(const Status& status) = 0;
+};
+
+// Thread pool that runs tasks in order of their priority, with per group fairness.
+//
+// Each task belongs to a group, identified by an opaque pointer (for instance RocksDB instance
+// that submitted the task). When a thread becomes available, it picks the queued task whose group
+// has the least number of running tasks. Among such tasks the one with the highest priority is
+// picked, and among tasks with equal priority the one that was submitted first.
+class PriorityThreadPool {
+ public:
+  PriorityThreadPool(const std::string& name, size_t max_running_tasks);
+  ~PriorityThreadPool();
+
+  // Submits task to the pool. Higher value of priority means that the task should be started
+  // earlier.
+  CHECKED_STATUS Submit(int priority, std::unique_ptr<PriorityThreadPoolTask> task,
+                        const void* group);
+
+  // Removes all queued tasks of the specified group, tasks are notified via Run with
+  // Aborted status. Running tasks are not affected.
+  // Returns number of removed tasks.
+  size_t Remove(const void* group);
+
+  // Stops accepting new tasks, aborts queued tasks and waits for running tasks to complete.
+  void Shutdown();
+
+  size_t num_queued_tasks() const;
+  size_t num_running_tasks() const;
+
+  std::string StateToString() const;
+
+  // Attach a histogram which measures the queue length seen by newly submitted tasks.
+  void SetQueueLengthHistogram(const scoped_refptr<Histogram>& hist);
+
+  // Attach a histogram which measures the amount of time that tasks spend waiting in the queue.
+  void SetQueueTimeMicrosHistogram(const scoped_refptr<Histogram>& hist);
+
+  // Attach a histogram which measures the amount of time that tasks spend running.
+  void SetRunTimeMicrosHistogram(const scoped_refptr<Histogram>& hist);
+
+  // Attach a counter of tasks that were started while another task with lower priority was
+  // queued longer, i.e. tasks that benefited from prioritization.
+  void SetPreemptedCounter(const scoped_refptr<Counter>& counter);
+
+ private:
+  struct QueuedTask {
+    int priority;
+    uint64_t serial_no;
+    const void* group;
+    MonoTime submit_time;
+    std::unique_ptr<PriorityThreadPoolTask> task;
+  };
+
+  void Execute();
+
+  // Returns iterator to the task that should be started next. Should be called when queue is not
+  // empty.
+  std::vector<QueuedTask>::iterator PickTaskUnlocked();
+
+  const std::string name_;
+  const size_t max_running_tasks_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cond_;
+  bool closing_ = false;
+  uint64_t next_serial_no_ = 0;
+  std::vector<QueuedTask> queue_;
+  std::unordered_map<const void*, size_t> running_per_group_;
+  size_t num_running_ = 0;
+  std::vector<scoped_refptr<Thread>> threads_;
+
+  scoped_refptr<Histogram> queue_length_histogram_;
+  scoped_refptr<Histogram> queue_time_us_histogram_;
+  scoped_refptr<Histogram> run_time_us_histogram_;
+  scoped_refptr<Counter> preempted_counter_;
+};
+
+} // namespace yb
+
+#endif // YB_UTIL_PRIORITY_THREAD_POOL_H
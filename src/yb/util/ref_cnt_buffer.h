@@ -52,8 +52,9 @@ class RefCntBuffer {
 
   ~RefCntBuffer();
 
+  // Size of a buffer that was not allocated is zero, so it could be used as an empty buffer.
   size_t size() const {
-    return size_reference();
+    return data_ ? size_reference() : 0;
   }
 
   bool empty() const {
@@ -30,8 +30,11 @@
 // under the License.
 //
 
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include <glog/logging.h>
 #include <gtest/gtest.h>
@@ -315,4 +318,77 @@ TEST_F(TestThreadPool, TestMetrics) {
   ASSERT_EQ(kNumItems, run_time->TotalCount());
 }
 
+namespace {
+
+const std::initializer_list<int> kBenchmarkThreads = {1, 2, 4, 8, 16, 32, 64};
+
+void LogThroughput(const char* name, int threads, size_t tasks, MonoTime start) {
+  auto passed = MonoTime::Now(MonoTime::FINE).GetDeltaSince(start);
+  LOG(INFO) << name << ", threads: " << threads << ", time: " << passed.ToMilliseconds()
+            << "ms, tasks/s: " << tasks / passed.ToSeconds();
+}
+
+// Submits the rest of the chain from the pool thread, after the task is done.
+void RunChain(ThreadPool* pool, size_t left, CountDownLatch* latch) {
+  if (left > 1) {
+    CHECK_OK(pool->SubmitFunc(std::bind(&RunChain, pool, left - 1, latch)));
+  }
+  latch->CountDown();
+}
+
+} // namespace
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(TestThreadPool, DISABLED_BenchmarkProducers) {
+  FLAGS_enable_tracing = false;
+  constexpr size_t kTotalTasks = 100000;
+  constexpr size_t kProducers = 4;
+  for (int threads : kBenchmarkThreads) {
+    gscoped_ptr<ThreadPool> thread_pool;
+    ASSERT_OK(BuildMinMaxTestPool(threads, threads, &thread_pool));
+    std::atomic<size_t> counter(0);
+    std::vector<std::thread> producers;
+    std::vector<Status> statuses(kProducers);
+    auto start = MonoTime::Now(MonoTime::FINE);
+    for (size_t i = 0; i != kProducers; ++i) {
+      producers.emplace_back([&thread_pool, &counter, status = &statuses[i]] {
+        for (size_t j = 0; j != kTotalTasks / kProducers && status->ok(); ++j) {
+          *status = thread_pool->SubmitFunc([&counter] { ++counter; });
+        }
+      });
+    }
+    for (auto& producer : producers) {
+      producer.join();
+    }
+    for (const auto& status : statuses) {
+      ASSERT_OK(status);
+    }
+    thread_pool->Wait();
+    LogThroughput("Producers", threads, kTotalTasks, start);
+    ASSERT_EQ(kTotalTasks, counter.load());
+    thread_pool->Shutdown();
+  }
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST_F(TestThreadPool, DISABLED_BenchmarkChains) {
+  FLAGS_enable_tracing = false;
+  constexpr size_t kChains = 256;
+  constexpr size_t kChainLength = 400;
+  for (int threads : kBenchmarkThreads) {
+    gscoped_ptr<ThreadPool> thread_pool;
+    ASSERT_OK(BuildMinMaxTestPool(threads, threads, &thread_pool));
+    CountDownLatch latch(kChains * kChainLength);
+    auto start = MonoTime::Now(MonoTime::FINE);
+    for (size_t i = 0; i != kChains; ++i) {
+      ASSERT_OK(thread_pool->SubmitFunc(
+          std::bind(&RunChain, thread_pool.get(), kChainLength, &latch)));
+    }
+    latch.Wait();
+    LogThroughput("Chains", threads, kChains * kChainLength, start);
+    thread_pool->Wait();
+    thread_pool->Shutdown();
+  }
+}
+
 } // namespace yb
@@ -33,6 +33,7 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <thread>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
@@ -45,6 +46,7 @@
 #include "yb/util/thread.h"
 #include "yb/util/threadpool.h"
 #include "yb/util/trace.h"
+#include "yb/util/work_stealing_scheduler.h"
 
 namespace yb {
 
@@ -126,10 +128,14 @@ ThreadPool::ThreadPool(const ThreadPoolBuilder& builder)
     pool_status_(STATUS(Uninitialized, "The pool was not initialized.")),
     idle_cond_(&lock_),
     no_threads_cond_(&lock_),
-    not_empty_(&lock_),
     num_threads_(0),
     active_threads_(0),
-    queue_size_(0) {
+    queue_size_(0),
+    scheduler_(new WorkStealingScheduler<QueueEntry>(max_threads_)) {
+  free_slots_.reserve(max_threads_);
+  for (int i = max_threads_; i-- > 0;) {
+    free_slots_.push_back(i);
+  }
 }
 
 ThreadPool::~ThreadPool() {
@@ -142,6 +148,7 @@ Status ThreadPool::Init() {
     return STATUS(NotSupported, "The thread pool is already initialized");
   }
   pool_status_ = Status::OK();
+  accepting_tasks_ = true;
   for (int i = 0; i < min_threads_; i++) {
     Status status = CreateThreadUnlocked();
     if (!status.ok()) {
@@ -153,26 +160,37 @@ Status ThreadPool::Init() {
 }
 
 void ThreadPool::ClearQueue() {
-  for (QueueEntry& e : queue_) {
-    if (e.trace) {
-      e.trace->Release();
+  scheduler_->Drain([](QueueEntry* entry) {
+    if (entry->trace) {
+      entry->trace->Release();
     }
-  }
-  queue_.clear();
+    delete entry;
+  });
   queue_size_ = 0;
 }
 
 void ThreadPool::Shutdown() {
-  MutexLock unique_lock(lock_);
-  pool_status_ = STATUS(ServiceUnavailable, "The pool has been shut down.");
-  ClearQueue();
-  not_empty_.Broadcast();
+  {
+    MutexLock unique_lock(lock_);
+    pool_status_ = STATUS(ServiceUnavailable, "The pool has been shut down.");
+    accepting_tasks_ = false;
+  }
 
+  // Submit does not take the lock, so wait for submissions that did not notice the shutdown.
+  // Shutdown is rare, so busy wait here is cheaper than synchronization in Submit.
+  while (adding_ != 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  scheduler_->Stop();
+
+  MutexLock unique_lock(lock_);
   // The Runnable doesn't have Abort() so we must wait
   // and hopefully the abort is done outside before calling Shutdown().
   while (num_threads_ > 0) {
     no_threads_cond_.Wait();
   }
+  ClearQueue();
+  idle_cond_.Broadcast();
 }
 
 Status ThreadPool::SubmitClosure(const Closure& task) {
@@ -188,15 +206,25 @@ Status ThreadPool::SubmitFunc(const std::function<void()>& func) {
 Status ThreadPool::Submit(const std::shared_ptr<Runnable>& task) {
   MonoTime submit_time = MonoTime::Now(MonoTime::FINE);
 
-  MutexLock guard(lock_);
-  if (PREDICT_FALSE(!pool_status_.ok())) {
+  ++adding_;
+  Status status = DoSubmit(task, submit_time);
+  --adding_;
+  return status;
+}
+
+Status ThreadPool::DoSubmit(const std::shared_ptr<Runnable>& task, const MonoTime& submit_time) {
+  if (PREDICT_FALSE(!accepting_tasks_.load(std::memory_order_acquire))) {
+    MutexLock guard(lock_);
     return pool_status_;
   }
 
   // Size limit check.
-  if (queue_size_ == max_queue_size_) {
+  int length_at_submit = queue_size_++;
+  if (length_at_submit >= max_queue_size_) {
+    --queue_size_;
+    NotifyIfIdle();
     return STATUS(ServiceUnavailable, Substitute("Thread pool queue is full ($0 items)",
-                                                 queue_size_));
+                                                 length_at_submit));
   }
 
   // Should we create another thread?
@@ -207,39 +235,45 @@ Status ThreadPool::Submit(const std::shared_ptr<Runnable>& task) {
   // However, this race is unavoidable, since we don't do the work under a lock.
   // It's also harmless.
   //
+  // num_threads_ is read after queue_size_ is incremented, while a thread that is about to exit
+  // decrements num_threads_ before checking queue_size_. So either we create a new thread here,
+  // or the exiting thread notices the task and stays.
+  //
   // Of course, we never create more than max_threads_ threads no matter what.
   int inactive_threads = num_threads_ - active_threads_;
-  int additional_threads = (queue_size_ + 1) - inactive_threads;
+  int additional_threads = (length_at_submit + 1) - inactive_threads;
   if (additional_threads > 0 && num_threads_ < max_threads_) {
-    Status status = CreateThreadUnlocked();
-    if (!status.ok()) {
-      if (num_threads_ == 0) {
-        // If we have no threads, we can't do any work.
-        return status;
-      } else {
-        // If we failed to create a thread, but there are still some other
-        // worker threads, log a warning message and continue.
-        LOG(WARNING) << "Thread pool failed to create thread: "
-                     << status.ToString();
+    MutexLock guard(lock_);
+    if (num_threads_ < max_threads_ && pool_status_.ok()) {
+      Status status = CreateThreadUnlocked();
+      if (!status.ok()) {
+        if (num_threads_ == 0) {
+          // If we have no threads, we can't do any work.
+          guard.Unlock();
+          --queue_size_;
+          NotifyIfIdle();
+          return status;
+        } else {
+          // If we failed to create a thread, but there are still some other
+          // worker threads, log a warning message and continue.
+          LOG(WARNING) << "Thread pool failed to create thread: "
+                       << status.ToString();
+        }
       }
     }
   }
 
-  QueueEntry e;
-  e.runnable = task;
-  e.trace = Trace::CurrentTrace();
+  auto* entry = new QueueEntry;
+  entry->runnable = task;
+  entry->trace = Trace::CurrentTrace();
   // Need to AddRef, since the thread which submitted the task may go away,
   // and we don't want the trace to be destructed while waiting in the queue.
-  if (e.trace) {
-    e.trace->AddRef();
+  if (entry->trace) {
+    entry->trace->AddRef();
   }
-  e.submit_time = submit_time;
+  entry->submit_time = submit_time;
 
-  queue_.push_back(e);
-  int length_at_submit = queue_size_++;
-
-  guard.Unlock();
-  not_empty_.Signal();
+  scheduler_->Push(entry);
 
   if (queue_length_histogram_) {
     queue_length_histogram_->Increment(length_at_submit);
@@ -248,9 +282,16 @@ Status ThreadPool::Submit(const std::shared_ptr<Runnable>& task) {
   return Status::OK();
 }
 
+void ThreadPool::NotifyIfIdle() {
+  if (active_threads_ == 0 && queue_size_ == 0) {
+    MutexLock unique_lock(lock_);
+    idle_cond_.Broadcast();
+  }
+}
+
 void ThreadPool::Wait() {
   MutexLock unique_lock(lock_);
-  while ((!queue_.empty()) || (active_threads_ > 0)) {
+  while (queue_size_ > 0 || active_threads_ > 0) {
     idle_cond_.Wait();
   }
 }
@@ -262,7 +303,7 @@ bool ThreadPool::WaitUntil(const MonoTime& until) {
 
 bool ThreadPool::WaitFor(const MonoDelta& delta) {
   MutexLock unique_lock(lock_);
-  while ((!queue_.empty()) || (active_threads_ > 0)) {
+  while (queue_size_ > 0 || active_threads_ > 0) {
     if (!idle_cond_.TimedWait(delta)) {
       return false;
     }
@@ -284,89 +325,82 @@ void ThreadPool::SetRunTimeMicrosHistogram(const scoped_refptr<Histogram>& hist)
 }
 
 
-void ThreadPool::DispatchThread(bool permanent) {
-  MutexLock unique_lock(lock_);
+void ThreadPool::DispatchThread(bool permanent, size_t index) {
+  // Tasks submitted to a single threaded pool by its own tasks are expected to be executed in
+  // the order of submission, so the LIFO slot of the scheduler is used only by larger pools.
+  if (max_threads_ > 1) {
+    scheduler_->BindCurrentThread(index);
+  }
+  const MonoDelta idle_timeout = permanent ? MonoDelta() : idle_timeout_;
   while (true) {
-    // Note: STATUS(Aborted, ) is used to indicate normal shutdown.
-    if (!pool_status_.ok()) {
-      VLOG(2) << "DispatchThread exiting: " << pool_status_.ToString();
-      break;
-    }
-
-    if (queue_.empty()) {
-      if (permanent) {
-        not_empty_.Wait();
+    std::unique_ptr<QueueEntry> entry(scheduler_->Pop(index, idle_timeout));
+    if (!entry) {
+      // The pool was shut down, or there was no work for idle_timeout_.
+      MutexLock unique_lock(lock_);
+      --num_threads_;
+      if (pool_status_.ok() && queue_size_ != 0) {
+        // A task was submitted right when we decided to exit, see DoSubmit.
+        ++num_threads_;
+        continue;
+      }
+      // Note: STATUS(Aborted, ) is used to indicate normal shutdown.
+      if (!pool_status_.ok()) {
+        VLOG(2) << "DispatchThread exiting: " << pool_status_.ToString();
       } else {
-        if (!not_empty_.TimedWait(idle_timeout_)) {
-          // After much investigation, it appears that pthread condition variables have
-          // a weird behavior in which they can return ETIMEDOUT from timed_wait even if
-          // another thread did in fact signal. Apparently after a timeout there is some
-          // brief period during which another thread may actually grab the internal mutex
-          // protecting the state, signal, and release again before we get the mutex. So,
-          // we'll recheck the empty queue case regardless.
-          if (queue_.empty()) {
-            VLOG(3) << "Releasing worker thread from pool " << name_ << " after "
-                    << idle_timeout_.ToMilliseconds() << "ms of idle time.";
-            break;
-          }
-        }
+        VLOG(3) << "Releasing worker thread from pool " << name_ << " after "
+                << idle_timeout_.ToMilliseconds() << "ms of idle time.";
+      }
+      free_slots_.push_back(index);
+      if (num_threads_ == 0) {
+        no_threads_cond_.Broadcast();
       }
-      continue;
+      break;
     }
 
-    // Fetch a pending task
-    QueueEntry entry = queue_.front();
-    queue_.pop_front();
-    queue_size_--;
+    // Active threads are incremented before queue size is decremented, so Submit never
+    // underestimates the number of threads that are required.
     ++active_threads_;
-
-    unique_lock.Unlock();
+    --queue_size_;
 
     // Update metrics
     if (queue_time_us_histogram_) {
       MonoTime now(MonoTime::Now(MonoTime::FINE));
-      queue_time_us_histogram_->Increment(now.GetDeltaSince(entry.submit_time).ToMicroseconds());
+      queue_time_us_histogram_->Increment(now.GetDeltaSince(entry->submit_time).ToMicroseconds());
     }
 
-    ADOPT_TRACE(entry.trace);
-    // Release the reference which was held by the queued item.
-    if (entry.trace) {
-      entry.trace->Release();
-    }
-    // Execute the task
     {
-      ScopedLatencyMetric m(run_time_us_histogram_.get());
-      entry.runnable->Run();
+      ADOPT_TRACE(entry->trace);
+      // Release the reference which was held by the queued item.
+      if (entry->trace) {
+        entry->trace->Release();
+      }
+      // Execute the task
+      {
+        ScopedLatencyMetric m(run_time_us_histogram_.get());
+        entry->runnable->Run();
+      }
+      entry.reset();
     }
-    unique_lock.Lock();
 
-    if (--active_threads_ == 0) {
-      idle_cond_.Broadcast();
-    }
+    --active_threads_;
+    NotifyIfIdle();
   }
 
-  // It's important that we hold the lock between exiting the loop and dropping
-  // num_threads_. Otherwise it's possible someone else could come along here
-  // and add a new task just as the last running thread is about to exit.
-  CHECK(unique_lock.OwnsLock());
-
-  if (--num_threads_ == 0) {
-    no_threads_cond_.Broadcast();
-
-    // Sanity check: if we're the last thread exiting, the queue ought to be
-    // empty. Otherwise it will never get processed.
-    CHECK(queue_.empty());
-    DCHECK_EQ(0, queue_size_);
-  }
+  WorkStealingScheduler<QueueEntry>::UnbindCurrentThread();
 }
 
 Status ThreadPool::CreateThreadUnlocked() {
   // The first few threads are permanent, and do not time out.
   bool permanent = (num_threads_ < min_threads_);
+  CHECK(!free_slots_.empty());
+  size_t index = free_slots_.back();
+  free_slots_.pop_back();
   Status s = yb::Thread::Create("thread pool", strings::Substitute("$0 [worker]", name_),
-                                  &ThreadPool::DispatchThread, this, permanent, nullptr);
+                                  &ThreadPool::DispatchThread, this, permanent, index, nullptr);
   if (s.ok()) {
     num_threads_++;
+  } else {
+    free_slots_.push_back(index);
   }
   return s;
 }
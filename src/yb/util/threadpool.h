@@ -32,8 +32,8 @@
 #ifndef YB_UTIL_THREAD_POOL_H
 #define YB_UTIL_THREAD_POOL_H
 
+#include <atomic>
 #include <functional>
-#include <list>
 #include <memory>
 #include <string>
 #include <vector>
@@ -56,6 +56,9 @@ class Histogram;
 class ThreadPool;
 class Trace;
 
+template <class Task>
+class WorkStealingScheduler;
+
 class Runnable {
  public:
   virtual void Run() = 0;
@@ -119,6 +122,10 @@ class ThreadPoolBuilder {
 // The pool can execute a class that implements the Runnable interface, or a
 // std::function, which can be obtained via std::bind().
 //
+// Tasks are distributed between threads by WorkStealingScheduler, so Submit does not take
+// the pool lock unless a new thread should be started. Tasks submitted by a task running in
+// a pool with more than one thread are preferably executed by the same thread.
+//
 // Usage Example:
 //    static void Func(int n) { ... }
 //    class Task : public Runnable { ... }
@@ -169,7 +176,7 @@ class ThreadPool {
   // Return the current number of tasks waiting in the queue.
   // Typically used for metrics.
   int queue_length() const {
-    return ANNOTATE_UNPROTECTED_READ(queue_size_);
+    return queue_size_.load(std::memory_order_relaxed);
   }
 
   // Attach a histogram which measures the queue length seen by tasks when they enter
@@ -192,11 +199,17 @@ class ThreadPool {
   // Initialize the thread pool by starting the minimum number of threads.
   CHECKED_STATUS Init();
 
-  // Clear all entries from queue_. Requires that lock_ is held.
+  CHECKED_STATUS DoSubmit(const std::shared_ptr<Runnable>& task, const MonoTime& submit_time);
+
+  // Clear all queued entries. Requires that lock_ is held and all threads exited.
   void ClearQueue();
 
-  // Dispatcher responsible for dequeueing and executing the tasks
-  void DispatchThread(bool permanent);
+  // Wakes up threads waiting for the pool to become idle, if there are no queued or running tasks.
+  void NotifyIfIdle();
+
+  // Dispatcher responsible for dequeueing and executing the tasks.
+  // index is the slot of the thread in the scheduler.
+  void DispatchThread(bool permanent, size_t index);
 
   // Create new thread. Required that lock_ is held.
   CHECKED_STATUS CreateThreadUnlocked();
@@ -220,14 +233,22 @@ class ThreadPool {
   const MonoDelta idle_timeout_;
 
   Status pool_status_;
+  // Protects pool_status_, thread creation and exit.
   Mutex lock_;
   ConditionVariable idle_cond_;
   ConditionVariable no_threads_cond_;
-  ConditionVariable not_empty_;
-  int num_threads_;
-  int active_threads_;
-  int queue_size_;
-  std::list<QueueEntry> queue_;
+  // Modified under lock_, but read without it.
+  std::atomic<int> num_threads_;
+  // Number of threads running a task. Modified by workers without lock_.
+  std::atomic<int> active_threads_;
+  // Number of submitted tasks that were not yet picked by a thread.
+  std::atomic<int> queue_size_;
+  std::atomic<bool> accepting_tasks_{false};
+  // Number of Submit calls in progress, Shutdown waits for them before clearing the queue.
+  std::atomic<size_t> adding_{0};
+  // Scheduler slots that are not used by any thread.
+  std::vector<size_t> free_slots_;
+  std::unique_ptr<WorkStealingScheduler<QueueEntry>> scheduler_;
 
   scoped_refptr<Histogram> queue_length_histogram_;
   scoped_refptr<Histogram> queue_time_us_histogram_;
@@ -0,0 +1,170 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "yb/util/countdown_latch.h"
+#include "yb/util/test_util.h"
+#include "yb/util/work_stealing_scheduler.h"
+
+namespace yb {
+
+namespace {
+
+struct TestTask {
+  std::function<void()> run;
+};
+
+typedef WorkStealingScheduler<TestTask> TestScheduler;
+
+class WorkStealingSchedulerTest : public YBTest {
+ protected:
+  void StartWorkers(size_t num_workers) {
+    scheduler_.reset(new TestScheduler(num_workers));
+    auto* scheduler = scheduler_.get();
+    for (size_t index = 0; index != num_workers; ++index) {
+      workers_.emplace_back([scheduler, index] {
+        scheduler->BindCurrentThread(index);
+        while (auto* task = scheduler->Pop(index)) {
+          task->run();
+        }
+        TestScheduler::UnbindCurrentThread();
+      });
+    }
+  }
+
+  // Should be called before tasks are destroyed, since workers could still be inside them.
+  void StopWorkers() {
+    if (!scheduler_) {
+      return;
+    }
+    scheduler_->Stop();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+    workers_.clear();
+    scheduler_->Drain([](TestTask*) {});
+    scheduler_.reset();
+  }
+
+  std::unique_ptr<TestScheduler> scheduler_;
+  std::vector<std::thread> workers_;
+};
+
+} // namespace
+
+// A worker that takes a task while spinning should wake up a parked worker when there are more
+// queued tasks, even though nobody else is spinning. Here the first task waits for the second one,
+// so without the wakeup the first task times out.
+TEST_F(WorkStealingSchedulerTest, WakeUpAfterSpinningPop) {
+  constexpr int kIterations = 50;
+
+  struct Iteration {
+    CountDownLatch second_done{1};
+    CountDownLatch all_done{3};
+    std::atomic<bool> timed_out{false};
+    TestTask wake_up;
+    TestTask first;
+    TestTask second;
+  };
+
+  std::vector<std::unique_ptr<Iteration>> iterations;
+  StartWorkers(2);
+
+  int failed_iteration = -1;
+  for (int i = 0; i != kIterations; ++i) {
+    iterations.emplace_back(new Iteration);
+    auto* it = iterations.back().get();
+    it->wake_up.run = [it] { it->all_done.CountDown(); };
+    it->first.run = [it] {
+      if (!it->second_done.WaitFor(MonoDelta::FromSeconds(1))) {
+        it->timed_out = true;
+      }
+      it->all_done.CountDown();
+    };
+    it->second.run = [it] {
+      it->second_done.CountDown();
+      it->all_done.CountDown();
+    };
+
+    // Let both workers park.
+    SleepFor(MonoDelta::FromMilliseconds(10));
+
+    // Wake up one worker, after running this task it spins in Pop, while the other one is parked.
+    scheduler_->Push(&it->wake_up);
+    scheduler_->Push(&it->first);
+    scheduler_->Push(&it->second);
+
+    it->all_done.Wait();
+    if (it->timed_out.load()) {
+      failed_iteration = i;
+      break;
+    }
+  }
+
+  StopWorkers();
+  ASSERT_EQ(-1, failed_iteration);
+}
+
+// Tasks pushed from outside and tasks spawned by workers are all executed exactly once.
+TEST_F(WorkStealingSchedulerTest, AllTasksExecuted) {
+  constexpr size_t kNumWorkers = 4;
+  constexpr int kNumProducers = 4;
+  constexpr int kTasksPerProducer = 10000;
+
+  // Every external task spawns one more task from the worker that runs it.
+  std::vector<TestTask> tasks(kNumProducers * kTasksPerProducer * 2);
+  std::atomic<size_t> executed{0};
+  CountDownLatch done(static_cast<int>(tasks.size()));
+  StartWorkers(kNumWorkers);
+  auto* scheduler = scheduler_.get();
+  for (size_t i = 0; i != tasks.size(); i += 2) {
+    auto* child = &tasks[i + 1];
+    child->run = [&executed, &done] {
+      ++executed;
+      done.CountDown();
+    };
+    tasks[i].run = [scheduler, &executed, &done, child] {
+      ++executed;
+      scheduler->Push(child);
+      done.CountDown();
+    };
+  }
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p != kNumProducers; ++p) {
+    producers.emplace_back([scheduler, &tasks, p] {
+      for (int i = 0; i != kTasksPerProducer; ++i) {
+        scheduler->Push(&tasks[(p * kTasksPerProducer + i) * 2]);
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  bool all_done = done.WaitFor(MonoDelta::FromSeconds(30));
+  size_t num_queued = scheduler->num_queued();
+  StopWorkers();
+  ASSERT_TRUE(all_done);
+  ASSERT_EQ(tasks.size(), executed.load());
+  ASSERT_EQ(0U, num_queued);
+}
+
+} // namespace yb
@@ -0,0 +1,371 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_UTIL_WORK_STEALING_SCHEDULER_H
+#define YB_UTIL_WORK_STEALING_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/lockfree/queue.hpp>
+
+#include <glog/logging.h>
+
+#include "yb/gutil/macros.h"
+#include "yb/gutil/port.h"
+#include "yb/util/locks.h"
+#include "yb/util/monotime.h"
+
+namespace yb {
+
+// Distributes tasks between a fixed number of worker slots. Thread management is left to the
+// user: each worker thread owns a slot, identified by its index, and repeatedly calls Pop with it.
+//
+// Every slot has its own deque and a single task LIFO slot. Tasks pushed by a thread bound to a
+// slot (see BindCurrentThread) are placed to the LIFO slot of this thread, so the task that was
+// spawned last is executed next by the same thread while its data is still hot in cache. The task
+// previously stored in the LIFO slot is moved to the deque of the slot. Tasks pushed by other
+// threads are placed to the shared injection queue.
+//
+// A worker that ran out of local tasks takes them from the injection queue, then steals half of
+// the deque of another worker, and as a last resort takes a task from the LIFO slot of another
+// worker. Before going to sleep a worker spins for a while, so a quickly following task is picked
+// up without a context switch.
+//
+// Task is not owned by the scheduler, it just passes pointers around.
+template <class Task>
+class WorkStealingScheduler {
+ public:
+  explicit WorkStealingScheduler(size_t num_workers)
+      : num_workers_(num_workers),
+        workers_(new Worker[num_workers]),
+        injection_queue_(kInitialInjectionQueueCapacity) {
+  }
+
+  ~WorkStealingScheduler() {
+    DCHECK_EQ(num_queued(), 0);
+    auto& current = current_worker();
+    if (current.scheduler == this) {
+      current.scheduler = nullptr;
+    }
+  }
+
+  // Binds the current thread to the worker slot with the specified index, so tasks pushed from
+  // this thread are placed to the LIFO slot of this worker.
+  void BindCurrentThread(size_t index) {
+    DCHECK_LT(index, num_workers_);
+    auto& current = current_worker();
+    current.scheduler = this;
+    current.index = index;
+  }
+
+  static void UnbindCurrentThread() {
+    current_worker().scheduler = nullptr;
+  }
+
+  void Push(Task* task) {
+    // Counter is incremented before the task becomes visible, so it never drops below zero.
+    // A worker that observed the increment before the task is actually pushed just retries.
+    queued_.fetch_add(1);
+
+    auto& current = current_worker();
+    if (current.scheduler == this) {
+      auto& worker = workers_[current.index];
+      Task* displaced = worker.lifo_slot.exchange(task, std::memory_order_acq_rel);
+      if (displaced) {
+        std::lock_guard<simple_spinlock> lock(worker.lock);
+        worker.deque.push_back(displaced);
+        worker.deque_size.store(worker.deque.size(), std::memory_order_release);
+      }
+    } else {
+      injection_queue_.push(task);
+    }
+
+    WakeUpParked();
+  }
+
+  // Returns the next task for the worker with the specified index. Blocks until there is a task.
+  // Returns nullptr when the scheduler is stopped, or when idle_timeout is initialized and there
+  // was no task during this time.
+  Task* Pop(size_t index, const MonoDelta& idle_timeout = MonoDelta()) {
+    DCHECK_LT(index, num_workers_);
+    bool has_deadline = idle_timeout.Initialized();
+    std::chrono::steady_clock::time_point deadline;
+    if (has_deadline) {
+      deadline = std::chrono::steady_clock::now() + idle_timeout.ToSteadyDuration();
+    }
+    for (;;) {
+      if (stop_.load(std::memory_order_acquire)) {
+        return nullptr;
+      }
+      Task* task = TryPop(index, /* spinning= */ false);
+      if (task) {
+        return task;
+      }
+
+      spinning_.fetch_add(1);
+      for (size_t i = 0; i != kSpinIterations; ++i) {
+        std::this_thread::yield();
+        if (stop_.load(std::memory_order_acquire)) {
+          break;
+        }
+        // When a task is found, TryPop leaves the spinning state itself.
+        task = TryPop(index, /* spinning= */ true);
+        if (task) {
+          return task;
+        }
+      }
+      spinning_.fetch_sub(1);
+
+      if (!Park(has_deadline ? &deadline : nullptr)) {
+        return nullptr;
+      }
+    }
+  }
+
+  // Wakes up all workers, after that Pop returns nullptr. Tasks that are still queued should be
+  // retrieved with Drain, after all workers have left Pop.
+  void Stop() {
+    stop_.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    park_cond_.notify_all();
+  }
+
+  // Invokes the functor for each queued task and removes all of them.
+  // Should not be called concurrently with Push or Pop.
+  template <class F>
+  void Drain(const F& f) {
+    Task* task = nullptr;
+    while (injection_queue_.pop(task)) {
+      f(task);
+      queued_.fetch_sub(1);
+    }
+    for (size_t i = 0; i != num_workers_; ++i) {
+      auto& worker = workers_[i];
+      task = worker.lifo_slot.exchange(nullptr, std::memory_order_acq_rel);
+      if (task) {
+        f(task);
+        queued_.fetch_sub(1);
+      }
+      std::deque<Task*> deque;
+      {
+        std::lock_guard<simple_spinlock> lock(worker.lock);
+        deque.swap(worker.deque);
+        worker.deque_size.store(0, std::memory_order_release);
+      }
+      for (auto* task : deque) {
+        f(task);
+        queued_.fetch_sub(1);
+      }
+    }
+  }
+
+  // Number of tasks that were pushed, but not yet popped.
+  size_t num_queued() const {
+    return queued_.load(std::memory_order_acquire);
+  }
+
+  // Whether there are enough workers spinning or sleeping in Pop to pick up all queued tasks.
+  bool HasEnoughIdleWorkers() const {
+    return spinning_.load() + parked_.load() >= queued_.load();
+  }
+
+  size_t num_workers() const {
+    return num_workers_;
+  }
+
+ private:
+  static constexpr size_t kInitialInjectionQueueCapacity = 128;
+  static constexpr size_t kSpinIterations = 64;
+  // How many times in a row a worker could take a task from its LIFO slot, before picking
+  // other tasks. Prevents starvation of queued tasks by tasks that respawn themselves.
+  static constexpr size_t kMaxLifoRunsInRow = 16;
+  // Once in this number of pops, the worker checks the injection queue before its own deque.
+  static constexpr size_t kInjectionQueueCheckInterval = 61;
+
+  struct Worker {
+    std::atomic<Task*> lifo_slot{nullptr};
+    simple_spinlock lock;
+    std::deque<Task*> deque;  // Protected by lock.
+    std::atomic<size_t> deque_size{0};
+
+    // Accessed by owner only.
+    size_t lifo_runs = 0;
+    size_t ticks = 0;
+
+    char padding[CACHELINE_SIZE];
+  };
+
+  struct CurrentWorker {
+    const WorkStealingScheduler* scheduler = nullptr;
+    size_t index = 0;
+  };
+
+  static CurrentWorker& current_worker() {
+    static thread_local CurrentWorker result;
+    return result;
+  }
+
+  // spinning should be true when the worker is counted in spinning_. In this case the worker
+  // leaves the spinning state as soon as it gets a task.
+  Task* TryPop(size_t index, bool spinning) {
+    auto& worker = workers_[index];
+    Task* task = nullptr;
+    if (++worker.ticks % kInjectionQueueCheckInterval == 0) {
+      injection_queue_.pop(task);
+    }
+    if (!task) {
+      task = PopLocal(&worker);
+    }
+    if (!task) {
+      injection_queue_.pop(task);
+    }
+    if (!task) {
+      task = Steal(index);
+    }
+    if (!task) {
+      return nullptr;
+    }
+
+    // This worker is busy from now on. It should not be counted as spinning when deciding whether
+    // to wake up somebody, otherwise WakeUpParked expects this worker to pick up the rest of tasks.
+    if (spinning) {
+      spinning_.fetch_sub(1);
+    }
+
+    // There are more tasks, so wake up somebody to take care of them.
+    if (queued_.fetch_sub(1) > 1) {
+      WakeUpParked();
+    }
+    return task;
+  }
+
+  Task* PopLocal(Worker* worker) {
+    if (worker->lifo_runs < kMaxLifoRunsInRow) {
+      Task* task = worker->lifo_slot.exchange(nullptr, std::memory_order_acq_rel);
+      if (task) {
+        ++worker->lifo_runs;
+        return task;
+      }
+    }
+    worker->lifo_runs = 0;
+    return PopFront(worker);
+  }
+
+  static Task* PopFront(Worker* worker) {
+    if (worker->deque_size.load(std::memory_order_acquire) == 0) {
+      return nullptr;
+    }
+    std::lock_guard<simple_spinlock> lock(worker->lock);
+    if (worker->deque.empty()) {
+      return nullptr;
+    }
+    Task* task = worker->deque.front();
+    worker->deque.pop_front();
+    worker->deque_size.store(worker->deque.size(), std::memory_order_release);
+    return task;
+  }
+
+  Task* Steal(size_t index) {
+    auto& worker = workers_[index];
+    for (size_t i = 1; i != num_workers_; ++i) {
+      auto& victim = workers_[(index + i) % num_workers_];
+      if (victim.deque_size.load(std::memory_order_acquire) == 0) {
+        continue;
+      }
+      std::vector<Task*> stolen;
+      {
+        std::lock_guard<simple_spinlock> lock(victim.lock);
+        // Take half of the victim's tasks, rounding up, from the back of its deque.
+        size_t count = (victim.deque.size() + 1) / 2;
+        stolen.assign(victim.deque.end() - count, victim.deque.end());
+        victim.deque.resize(victim.deque.size() - count);
+        victim.deque_size.store(victim.deque.size(), std::memory_order_release);
+      }
+      if (stolen.empty()) {
+        continue;
+      }
+      if (stolen.size() > 1) {
+        std::lock_guard<simple_spinlock> lock(worker.lock);
+        worker.deque.insert(worker.deque.end(), stolen.begin() + 1, stolen.end());
+        worker.deque_size.store(worker.deque.size(), std::memory_order_release);
+      }
+      return stolen.front();
+    }
+
+    // The task in the LIFO slot is stolen only as the last resort. Otherwise it could wait for
+    // the owner of the slot forever, when the owner is blocked by this task.
+    for (size_t i = 1; i != num_workers_; ++i) {
+      auto& victim = workers_[(index + i) % num_workers_];
+      if (victim.lifo_slot.load(std::memory_order_relaxed)) {
+        Task* task = victim.lifo_slot.exchange(nullptr, std::memory_order_acq_rel);
+        if (task) {
+          return task;
+        }
+      }
+    }
+    return nullptr;
+  }
+
+  // Returns false if deadline was reached and there are no tasks.
+  bool Park(const std::chrono::steady_clock::time_point* deadline) {
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    // parked_ is incremented before checking queued_, while Push increments queued_ before checking
+    // parked_. So at least one of them observes the other one and the wakeup is not lost.
+    parked_.fetch_add(1);
+    bool result = true;
+    while (queued_.load() == 0 && !stop_.load(std::memory_order_acquire)) {
+      if (!deadline) {
+        park_cond_.wait(lock);
+      } else if (park_cond_.wait_until(lock, *deadline) == std::cv_status::timeout) {
+        result = queued_.load() != 0 || stop_.load(std::memory_order_acquire);
+        break;
+      }
+    }
+    parked_.fetch_sub(1);
+    return result;
+  }
+
+  void WakeUpParked() {
+    // Spinning worker would pick up the task by itself.
+    if (parked_.load() == 0 || spinning_.load() != 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    park_cond_.notify_one();
+  }
+
+  const size_t num_workers_;
+  std::unique_ptr<Worker[]> workers_;
+  boost::lockfree::queue<Task*> injection_queue_;
+
+  std::atomic<size_t> queued_{0};
+  std::atomic<size_t> spinning_{0};
+  std::atomic<size_t> parked_{0};
+  std::atomic<bool> stop_{false};
+
+  std::mutex park_mutex_;
+  std::condition_variable park_cond_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingScheduler);
+};
+
+} // namespace yb
+
+#endif // YB_UTIL_WORK_STEALING_SCHEDULER_H